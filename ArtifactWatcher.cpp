@@ -0,0 +1,307 @@
+﻿#include "ArtifactWatcher.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <QWinEventNotifier>
+
+#include <qt_windows.h>
+#endif
+
+namespace
+{
+const int kStableCheckMs = 500;
+}
+
+#ifdef Q_OS_WIN
+struct ArtifactWatcher::DirectoryChanges
+{
+    HANDLE directory = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = {};
+    QWinEventNotifier* notifier = nullptr;
+    // ReadDirectoryChangesW 要求缓冲区按 DWORD 对齐
+    alignas(DWORD) char buffer[64 * 1024];
+};
+#endif
+
+ArtifactWatcher::ArtifactWatcher(QObject* parent)
+    : QObject(parent)
+{
+    m_stableTimer = new QTimer(this);
+    m_stableTimer->setSingleShot(true);
+    m_stableTimer->setInterval(kStableCheckMs);
+    connect(m_stableTimer, &QTimer::timeout, this, [this]() { checkStable(false); });
+}
+
+ArtifactWatcher::~ArtifactWatcher()
+{
+#ifdef Q_OS_LINUX
+    if (m_notifyFd >= 0)
+        ::close(m_notifyFd);
+#endif
+#ifdef Q_OS_WIN
+    stopDirectoryChanges();
+#endif
+}
+
+void ArtifactWatcher::start(const QString& directory)
+{
+    finish();
+    m_directory = directory;
+    m_closed.clear();
+    m_overflowed = false;
+
+#ifdef Q_OS_LINUX
+    m_notifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_notifyFd >= 0)
+    {
+        // 求解器直接写入与先写临时文件再改名两种方式都要覆盖
+        const int wd = ::inotify_add_watch(m_notifyFd, QFile::encodeName(directory).constData(),
+                                           IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd >= 0)
+        {
+            m_notifier = new QSocketNotifier(m_notifyFd, QSocketNotifier::Read, this);
+            connect(m_notifier, &QSocketNotifier::activated, this, [this]() { readNotifyEvents(); });
+            return;
+        }
+        ::close(m_notifyFd);
+        m_notifyFd = -1;
+    }
+#endif
+
+    m_known.clear();
+    m_pending.clear();
+    const QFileInfoList files = QDir(directory).entryInfoList(QDir::Files);
+    for (const QFileInfo& info : files)
+        m_known.insert(info.fileName(), qMakePair(info.size(), info.lastModified()));
+
+#ifdef Q_OS_WIN
+    if (startDirectoryChanges(directory))
+        return;
+#endif
+    // 只监视目录本身，不为每个文件单独添加监视
+    m_fsWatcher = new QFileSystemWatcher(this);
+    m_fsWatcher->addPath(directory);
+    connect(m_fsWatcher, &QFileSystemWatcher::directoryChanged, this, [this]() { scanDirectory(); });
+}
+
+void ArtifactWatcher::finish()
+{
+    if (m_directory.isEmpty())
+        return;
+
+#ifdef Q_OS_LINUX
+    if (m_notifyFd >= 0)
+    {
+        readNotifyEvents();
+        delete m_notifier;
+        m_notifier = nullptr;
+        ::close(m_notifyFd);
+        m_notifyFd = -1;
+    }
+#endif
+#ifdef Q_OS_WIN
+    if (m_changes)
+    {
+        readDirectoryChanges();
+        stopDirectoryChanges();
+        // 进程已经结束，补查一次目录，剩余的候选文件不必再等待稳定
+        scanDirectory();
+        checkStable(true);
+    }
+#endif
+    if (m_fsWatcher)
+    {
+        // 进程已经结束，剩余的候选文件不必再等待稳定
+        scanDirectory();
+        checkStable(true);
+        delete m_fsWatcher;
+        m_fsWatcher = nullptr;
+    }
+    m_stableTimer->stop();
+    m_directory.clear();
+}
+
+void ArtifactWatcher::markClosed(const QString& name)
+{
+    m_closed.removeAll(name);
+    m_closed.append(name);
+    emit fileClosed(QDir(m_directory).filePath(name));
+}
+
+#ifdef Q_OS_LINUX
+void ArtifactWatcher::readNotifyEvents()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;)
+    {
+        const ssize_t length = ::read(m_notifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        ssize_t offset = 0;
+        while (offset < length)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += ssize_t(sizeof(inotify_event)) + event->len;
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                m_overflowed = true;
+                continue;
+            }
+            if ((event->mask & IN_ISDIR) || event->len == 0)
+                continue;
+            markClosed(QFile::decodeName(event->name));
+        }
+    }
+}
+#endif
+
+#ifdef Q_OS_WIN
+bool ArtifactWatcher::startDirectoryChanges(const QString& directory)
+{
+    const HANDLE handle = ::CreateFileW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(directory).utf16()),
+                                        FILE_LIST_DIRECTORY,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    m_changes = new DirectoryChanges;
+    m_changes->directory = handle;
+    m_changes->overlapped.hEvent = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!m_changes->overlapped.hEvent || !queueDirectoryChanges())
+    {
+        stopDirectoryChanges();
+        return false;
+    }
+    m_changes->notifier = new QWinEventNotifier(m_changes->overlapped.hEvent, this);
+    connect(m_changes->notifier, &QWinEventNotifier::activated, this, [this]() { readDirectoryChanges(); });
+    return true;
+}
+
+bool ArtifactWatcher::queueDirectoryChanges()
+{
+    ::ResetEvent(m_changes->overlapped.hEvent);
+    return ::ReadDirectoryChangesW(m_changes->directory, m_changes->buffer, sizeof(m_changes->buffer), FALSE,
+                                   FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                                       FILE_NOTIFY_CHANGE_LAST_WRITE,
+                                   nullptr, &m_changes->overlapped, nullptr) != 0;
+}
+
+void ArtifactWatcher::readDirectoryChanges()
+{
+    if (!m_changes)
+        return;
+    DWORD bytes = 0;
+    if (!::GetOverlappedResult(m_changes->directory, &m_changes->overlapped, &bytes, FALSE))
+        return;
+
+    // 返回零字节表示系统缓冲区溢出，变化的文件名已经丢失
+    if (bytes == 0)
+        m_overflowed = true;
+    const char* cursor = m_changes->buffer;
+    while (bytes > 0)
+    {
+        const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+        if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED ||
+            info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+            notePending(QString::fromWCharArray(info->FileName, int(info->FileNameLength / sizeof(WCHAR))));
+        if (info->NextEntryOffset == 0)
+            break;
+        cursor += info->NextEntryOffset;
+    }
+    if (!queueDirectoryChanges())
+        m_overflowed = true;
+    if (!m_pending.isEmpty() && !m_stableTimer->isActive())
+        m_stableTimer->start();
+}
+
+void ArtifactWatcher::stopDirectoryChanges()
+{
+    if (!m_changes)
+        return;
+    if (m_changes->overlapped.hEvent)
+    {
+        // 缓冲区在取消的读取真正结束后才能释放
+        DWORD bytes = 0;
+        if (::CancelIoEx(m_changes->directory, &m_changes->overlapped) || ::GetLastError() != ERROR_NOT_FOUND)
+            ::GetOverlappedResult(m_changes->directory, &m_changes->overlapped, &bytes, TRUE);
+        delete m_changes->notifier;
+        ::CloseHandle(m_changes->overlapped.hEvent);
+    }
+    ::CloseHandle(m_changes->directory);
+    delete m_changes;
+    m_changes = nullptr;
+}
+#endif
+
+void ArtifactWatcher::notePending(const QString& name)
+{
+    const QFileInfo info(QDir(m_directory).filePath(name));
+    if (!info.isFile())
+        return;
+    const QPair<qint64, QDateTime> state(info.size(), info.lastModified());
+    if (m_known.value(name) == state)
+        return;
+    m_known.insert(name, state);
+    m_pending.insert(name, state);
+}
+
+void ArtifactWatcher::scanDirectory()
+{
+    if (m_directory.isEmpty())
+        return;
+
+    // 目录通知不区分是哪个文件，只能整体比较
+    const QFileInfoList files = QDir(m_directory).entryInfoList(QDir::Files);
+    for (const QFileInfo& info : files)
+    {
+        const QPair<qint64, QDateTime> state(info.size(), info.lastModified());
+        const QString name = info.fileName();
+        if (m_known.value(name) == state)
+            continue;
+        m_known.insert(name, state);
+        m_pending.insert(name, state);
+    }
+    if (!m_pending.isEmpty() && !m_stableTimer->isActive())
+        m_stableTimer->start();
+}
+
+void ArtifactWatcher::checkStable(bool final)
+{
+    const QDir dir(m_directory);
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        const QFileInfo info(dir.filePath(it.key()));
+        if (!info.exists())
+        {
+            it = m_pending.erase(it);
+            continue;
+        }
+        const QPair<qint64, QDateTime> state(info.size(), info.lastModified());
+        if (final || state == it.value())
+        {
+            const QString name = it.key();
+            it = m_pending.erase(it);
+            markClosed(name);
+        }
+        else
+        {
+            it.value() = state;
+            m_known.insert(it.key(), state);
+            ++it;
+        }
+    }
+    if (!m_pending.isEmpty() && !final)
+        m_stableTimer->start();
+}
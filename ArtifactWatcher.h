@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QStringList>
+
+class QFileSystemWatcher;
+class QSocketNotifier;
+class QTimer;
+class QWinEventNotifier;
+
+// 监视求解目录中写完的文件。Linux 上使用 inotify 的 IN_CLOSE_WRITE，
+// 文件一关闭即可得知；Windows 上用 ReadDirectoryChangesW 得到变化的文件名，只检查这些文件；
+// 其他平台退化为 QFileSystemWatcher 监视目录。后两种方式都以大小稳定判断写完
+class ArtifactWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ArtifactWatcher(QObject* parent = nullptr);
+    ~ArtifactWatcher() override;
+
+    void start(const QString& directory);
+    // 进程结束后调用：处理尚未读取的事件，之后不再发出信号
+    void finish();
+
+    bool isWatching() const { return !m_directory.isEmpty(); }
+    // 事件队列溢出时可能漏掉文件，调用方需要自行补充
+    bool hasOverflowed() const { return m_overflowed; }
+    // 本次监视期间写完的文件名，按最后一次关闭的先后排列
+    QStringList closedFiles() const { return m_closed; }
+
+signals:
+    void fileClosed(const QString& path);
+
+private:
+    void markClosed(const QString& name);
+#ifdef Q_OS_LINUX
+    void readNotifyEvents();
+#endif
+#ifdef Q_OS_WIN
+    bool startDirectoryChanges(const QString& directory);
+    bool queueDirectoryChanges();
+    void readDirectoryChanges();
+    void stopDirectoryChanges();
+#endif
+    // 只检查一个文件，大小或时间变化后加入候选
+    void notePending(const QString& name);
+    void scanDirectory();
+    void checkStable(bool final);
+
+    QString m_directory;
+    QStringList m_closed;
+    bool m_overflowed = false;
+
+#ifdef Q_OS_LINUX
+    int m_notifyFd = -1;
+    QSocketNotifier* m_notifier = nullptr;
+#endif
+#ifdef Q_OS_WIN
+    struct DirectoryChanges;
+    DirectoryChanges* m_changes = nullptr;
+#endif
+    // 变化的文件先记为候选，两次检查之间大小与时间不变才认为写完
+    QFileSystemWatcher* m_fsWatcher = nullptr;
+    QTimer* m_stableTimer = nullptr;
+    QHash<QString, QPair<qint64, QDateTime>> m_known;
+    QHash<QString, QPair<qint64, QDateTime>> m_pending;
+};
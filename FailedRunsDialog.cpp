@@ -0,0 +1,123 @@
+﻿#include "FailedRunsDialog.h"
+
+#include <QColor>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace
+{
+enum Column {
+    FinishedColumn = 0,
+    SchemeColumn,
+    ModelColumn,
+    StatusColumn,
+    ExitCodeColumn,
+    ErrorColumn,
+    ColumnCount
+};
+
+const int kMaxRows = 1000;
+
+QTableWidgetItem* makeItem(const QString& text)
+{
+    auto* item = new QTableWidgetItem(text);
+    item->setToolTip(text);
+    return item;
+}
+}
+
+FailedRunsDialog::FailedRunsDialog(const QString& catalogPath, QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("失败的运行"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(900, 520);
+
+    auto* v = new QVBoxLayout(this);
+    v->setContentsMargins(12, 12, 12, 12);
+    v->setSpacing(8);
+
+    auto* filter = new QHBoxLayout;
+    filter->addWidget(new QLabel(tr("最近"), this));
+    m_daysSpin = new QSpinBox(this);
+    m_daysSpin->setRange(1, 3650);
+    m_daysSpin->setValue(7);
+    m_daysSpin->setSuffix(tr(" 天"));
+    filter->addWidget(m_daysSpin);
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setStyleSheet("font-weight:600;");
+    filter->addSpacing(12);
+    filter->addWidget(m_summaryLabel, 1);
+    v->addLayout(filter);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("结束时间") << tr("方案") << tr("模型")
+                                                     << tr("状态") << tr("退出码") << tr("错误信息"));
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int row, int) {
+        if (row >= 0 && row < m_entries.size())
+            emit showHistoryRequested(m_entries.at(row).modelId);
+    });
+    v->addWidget(m_table, 1);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto* refreshButton = buttons->addButton(tr("刷新"), QDialogButtonBox::ActionRole);
+    connect(refreshButton, &QPushButton::clicked, this, &FailedRunsDialog::reload);
+    connect(buttons, &QDialogButtonBox::rejected, this, &FailedRunsDialog::close);
+    v->addWidget(buttons);
+
+    connect(m_daysSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &FailedRunsDialog::reload);
+
+    QString error;
+    if (!m_catalog.open(catalogPath, &error))
+        m_summaryLabel->setText(error);
+    else
+        reload();
+}
+
+void FailedRunsDialog::reload()
+{
+    if (!m_catalog.isOpen())
+        return;
+
+    QString error;
+    const QDateTime since = QDateTime::currentDateTime().addDays(-m_daysSpin->value());
+    m_entries = m_catalog.failedRuns(since, kMaxRows, &error);
+
+    m_table->setRowCount(0);
+    m_table->setRowCount(m_entries.size());
+    for (int row = 0; row < m_entries.size(); ++row)
+    {
+        const ProjectCatalog::RunEntry& entry = m_entries.at(row);
+        const RunRecord& record = entry.record;
+        m_table->setItem(row, FinishedColumn,
+                         makeItem(record.finishedAt.toString("yyyy-MM-dd HH:mm:ss")));
+        m_table->setItem(row, SchemeColumn, makeItem(entry.schemeName));
+        // 已删除的模型只剩运行记录
+        m_table->setItem(row, ModelColumn,
+                         makeItem(entry.modelName.isEmpty() ? tr("（已删除）") : entry.modelName));
+        auto* status = makeItem(record.statusText());
+        status->setForeground(QColor("#b91c1c"));
+        m_table->setItem(row, StatusColumn, status);
+        m_table->setItem(row, ExitCodeColumn, makeItem(QString::number(record.exitCode)));
+        m_table->setItem(row, ErrorColumn, makeItem(record.errorMessage));
+    }
+    m_table->resizeColumnsToContents();
+
+    if (!error.isEmpty())
+        m_summaryLabel->setText(error);
+    else if (m_entries.size() >= kMaxRows)
+        m_summaryLabel->setText(tr("失败 %1 次以上，仅显示最近的 %1 次").arg(kMaxRows));
+    else
+        m_summaryLabel->setText(tr("失败 %1 次").arg(m_entries.size()));
+}
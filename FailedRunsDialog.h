@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include "ProjectCatalog.h"
+
+class QLabel;
+class QSpinBox;
+class QTableWidget;
+
+// 工程目录中最近失败的运行：直接查询 catalog.sqlite，不读取各模型目录
+class FailedRunsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    FailedRunsDialog(const QString& catalogPath, QWidget* parent = nullptr);
+
+    void reload();
+
+signals:
+    void showHistoryRequested(const QString& modelId);
+
+private:
+    ProjectCatalog m_catalog;
+    QVector<ProjectCatalog::RunEntry> m_entries;
+    QSpinBox* m_daysSpin = nullptr;
+    QTableWidget* m_table = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+};
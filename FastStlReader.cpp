@@ -0,0 +1,762 @@
+﻿#include "FastStlReader.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+
+namespace
+{
+const qint64 kBinaryHeaderBytes = 84;
+const qint64 kBinaryFacetBytes = 50;
+// ASCII 切块的最小尺寸，太小的块切分开销大于并行收益
+const qint64 kMinAsciiChunkBytes = 1 << 20;
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("FastStlReader", text);
+}
+
+bool isCancelled(const std::atomic_bool* cancel)
+{
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+// 把某一阶段的完成量折算到整体百分比的 [from, to] 区间，可被多个线程同时推进
+class ProgressRange
+{
+public:
+    ProgressRange(std::atomic_int* target, int from, int to, qint64 total)
+        : m_target(target), m_from(from), m_to(to), m_total(qMax<qint64>(1, total))
+    {
+    }
+
+    void advance(qint64 amount)
+    {
+        if (!m_target)
+            return;
+        const qint64 done = qMin(m_total, m_done.fetch_add(amount) + amount);
+        raise(m_from + int((m_to - m_from) * done / m_total));
+    }
+
+    void finish() { raise(m_to); }
+
+private:
+    void raise(int value)
+    {
+        if (!m_target)
+            return;
+        int current = m_target->load(std::memory_order_relaxed);
+        while (current < value && !m_target->compare_exchange_weak(current, value))
+        {
+        }
+    }
+
+    std::atomic_int* m_target;
+    const int m_from;
+    const int m_to;
+    const qint64 m_total;
+    std::atomic<qint64> m_done{ 0 };
+};
+
+// 把 [0, count) 均分成若干块交给 vtkSMPTools，每块内顺序处理；只有一块时直接在当前线程执行
+template <typename Body>
+void forEachChunk(qint64 count, qint64 chunks, const Body& body)
+{
+    if (chunks <= 1)
+    {
+        body(0, 0, count);
+        return;
+    }
+    vtkSMPTools::For(0, chunks, 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType chunk = first; chunk < last; ++chunk)
+            body(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+    });
+}
+
+qint64 chunkCountFor(qint64 count)
+{
+    const qint64 threads = qMax(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+    return qBound<qint64>(1, count / 4096, threads * 4);
+}
+
+// 并行前缀和：index[i] 为 [0, i) 中满足 keep 的个数，返回总数
+template <typename Keep>
+quint32 exclusiveScan(qint64 count, const Keep& keep, std::vector<quint32>& index)
+{
+    index.resize(size_t(count));
+    const qint64 chunks = chunkCountFor(count);
+    std::vector<quint32> totals(size_t(chunks) + 1, 0);
+    forEachChunk(count, chunks, [&](qint64 chunk, qint64 begin, qint64 end) {
+        quint32 kept = 0;
+        for (qint64 i = begin; i < end; ++i)
+            kept += keep(i) ? 1 : 0;
+        totals[size_t(chunk) + 1] = kept;
+    });
+    for (qint64 chunk = 0; chunk < chunks; ++chunk)
+        totals[size_t(chunk) + 1] += totals[size_t(chunk)];
+    forEachChunk(count, chunks, [&](qint64 chunk, qint64 begin, qint64 end) {
+        quint32 running = totals[size_t(chunk)];
+        for (qint64 i = begin; i < end; ++i)
+        {
+            index[size_t(i)] = running;
+            running += keep(i) ? 1 : 0;
+        }
+    });
+    return totals[size_t(chunks)];
+}
+
+// ---------- 解析 ----------
+
+bool looksBinary(const char* data, qint64 size, quint32* triangles)
+{
+    if (size < kBinaryHeaderBytes)
+        return false;
+    const quint32 count = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data) + 80);
+    const qint64 expected = kBinaryHeaderBytes + kBinaryFacetBytes * qint64(count);
+    // 部分导出程序在二进制文件头里也写 "solid"，以文件长度为准
+    if (expected == size)
+    {
+        *triangles = count;
+        return true;
+    }
+    // 也有导出程序在面片之后追加数据。长度足够且文件头之后不是文本时按二进制读取，
+    // 否则要先把整个文件当作 ASCII 扫描一遍，失败后再由后备读取器重读
+    if (count == 0 || expected > size)
+        return false;
+    const qint64 probeEnd = qMin(expected, kBinaryHeaderBytes + 256);
+    for (qint64 i = kBinaryHeaderBytes; i < probeEnd; ++i)
+    {
+        const uchar c = uchar(data[i]);
+        if (c >= 0x80 || (c < 0x20 && !isSpace(char(c))))
+        {
+            *triangles = count;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseBinary(const char* data, quint32 triangles, std::vector<float>& coords,
+                 const std::atomic_bool* cancel, ProgressRange& progress)
+{
+    coords.resize(size_t(triangles) * 9);
+    const uchar* base = reinterpret_cast<const uchar*>(data) + kBinaryHeaderBytes;
+    float* out = coords.data();
+    forEachChunk(triangles, chunkCountFor(triangles), [&](qint64, qint64 begin, qint64 end) {
+        if (isCancelled(cancel))
+            return;
+        for (qint64 t = begin; t < end; ++t)
+        {
+            // 每个面片：法向 12 字节、三个顶点 36 字节、属性 2 字节；法向由 VTK 重新计算
+            const uchar* facet = base + t * kBinaryFacetBytes + 12;
+            float* dst = out + t * 9;
+            for (int k = 0; k < 9; ++k)
+            {
+                const quint32 bits = qFromLittleEndian<quint32>(facet + 4 * k);
+                std::memcpy(dst + k, &bits, sizeof(float));
+            }
+        }
+        progress.advance(end - begin);
+    });
+    return !isCancelled(cancel);
+}
+
+const char* findWord(const char* begin, const char* end, const char* word, size_t length)
+{
+    const char* p = begin;
+    while (p + length <= end)
+    {
+        p = static_cast<const char*>(std::memchr(p, word[0], size_t(end - p)));
+        if (!p || p + length > end)
+            return nullptr;
+        if (std::memcmp(p, word, length) == 0 &&
+            (p == begin || isSpace(p[-1])) &&
+            (p + length == end || isSpace(p[length])))
+            return p;
+        ++p;
+    }
+    return nullptr;
+}
+
+// 不依赖区域设置、也不要求以 '\0' 结尾的浮点数解析
+bool parseFloat(const char*& p, const char* end, float* value)
+{
+    static const double kPow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    while (p < end && isSpace(*p))
+        ++p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+    {
+        if (mantissa < 100000000000000000ULL)
+            mantissa = mantissa * 10 + quint64(*p - '0');
+        else
+            ++exponent;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+        {
+            if (mantissa < 100000000000000000ULL)
+            {
+                mantissa = mantissa * 10 + quint64(*p - '0');
+                --exponent;
+            }
+        }
+    }
+    if (digits == 0)
+        return false;
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExp = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negativeExp = (*p++ == '-');
+        int e = 0;
+        bool any = false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+            e = qMin(e * 10 + (*p - '0'), 10000);
+        if (!any)
+            return false;
+        exponent += negativeExp ? -e : e;
+    }
+
+    double result = double(mantissa);
+    if (mantissa != 0)
+    {
+        if (exponent >= 0 && exponent <= 22)
+            result *= kPow10[exponent];
+        else if (exponent < 0 && exponent >= -22)
+            result /= kPow10[-exponent];
+        else
+            result *= std::pow(10.0, exponent);
+    }
+    *value = float(negative ? -result : result);
+    return true;
+}
+
+bool parseAscii(const char* data, qint64 size, std::vector<float>& coords,
+                const std::atomic_bool* cancel, QString* error, ProgressRange& progress)
+{
+    static const char kVertex[] = "vertex";
+    static const char kEndFacet[] = "endfacet";
+
+    // 块边界移到 endfacet 之后，保证每块都包含完整的面片
+    const qint64 threads = qMax(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+    const qint64 chunks = qBound<qint64>(1, size / kMinAsciiChunkBytes, threads * 4);
+    std::vector<const char*> bounds(size_t(chunks) + 1);
+    bounds[0] = data;
+    bounds[size_t(chunks)] = data + size;
+    for (qint64 k = 1; k < chunks; ++k)
+    {
+        const char* from = std::max(data + size * k / chunks, bounds[size_t(k) - 1]);
+        const char* hit = findWord(from, data + size, kEndFacet, sizeof(kEndFacet) - 1);
+        bounds[size_t(k)] = hit ? hit + sizeof(kEndFacet) - 1 : data + size;
+    }
+
+    std::vector<std::vector<float>> parts(static_cast<size_t>(chunks));
+    std::atomic_bool malformed(false);
+    vtkSMPTools::For(0, chunks, 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType k = first; k < last; ++k)
+        {
+            const char* p = bounds[size_t(k)];
+            const char* end = bounds[size_t(k) + 1];
+            std::vector<float>& part = parts[size_t(k)];
+            // 每个顶点行约 40 字节
+            part.reserve(size_t((end - p) / 40 * 3));
+            int sinceCheck = 0;
+            while ((p = findWord(p, end, kVertex, sizeof(kVertex) - 1)) != nullptr)
+            {
+                p += sizeof(kVertex) - 1;
+                float xyz[3];
+                if (!parseFloat(p, end, &xyz[0]) || !parseFloat(p, end, &xyz[1]) ||
+                    !parseFloat(p, end, &xyz[2]))
+                {
+                    malformed = true;
+                    return;
+                }
+                part.insert(part.end(), xyz, xyz + 3);
+                if (++sinceCheck == 65536)
+                {
+                    sinceCheck = 0;
+                    if (isCancelled(cancel) || malformed)
+                        return;
+                }
+            }
+            progress.advance(bounds[size_t(k) + 1] - bounds[size_t(k)]);
+        }
+    });
+    if (isCancelled(cancel))
+        return false;
+
+    std::vector<size_t> offsets(parts.size() + 1, 0);
+    for (size_t k = 0; k < parts.size(); ++k)
+        offsets[k + 1] = offsets[k] + parts[k].size();
+    if (malformed || offsets.back() % 9 != 0)
+    {
+        if (error)
+            *error = tr("ASCII STL 格式错误：顶点坐标无法解析或面片不完整");
+        return false;
+    }
+
+    coords.resize(offsets.back());
+    vtkSMPTools::For(0, vtkIdType(parts.size()), 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType k = first; k < last; ++k)
+        {
+            std::copy(parts[size_t(k)].begin(), parts[size_t(k)].end(), coords.begin() + offsets[size_t(k)]);
+            std::vector<float>().swap(parts[size_t(k)]);
+        }
+    });
+    return true;
+}
+
+// ---------- 顶点合并 ----------
+
+// 坐标按位比较，+0 与 -0 视为同一点，与 vtkMergePoints 的 == 比较一致
+quint32 keyBits(float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits == 0x80000000u ? 0u : bits;
+}
+
+struct VertexKeys
+{
+    const float* coords = nullptr;
+
+    bool same(quint32 a, quint32 b) const
+    {
+        const float* pa = coords + size_t(a) * 3;
+        const float* pb = coords + size_t(b) * 3;
+        return keyBits(pa[0]) == keyBits(pb[0]) && keyBits(pa[1]) == keyBits(pb[1]) &&
+               keyBits(pa[2]) == keyBits(pb[2]);
+    }
+
+    quint64 hash(quint32 v) const
+    {
+        const float* p = coords + size_t(v) * 3;
+        quint64 h = (quint64(keyBits(p[0])) << 32 | keyBits(p[1])) * 0x9E3779B97F4A7C15ULL;
+        h ^= quint64(keyBits(p[2])) * 0xC2B2AE3D27D4EB4FULL;
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return h ^ (h >> 32);
+    }
+};
+
+// 开放寻址的无锁哈希表，槽里存顶点序号 +1（0 表示空）。
+// 同一坐标的顶点竞争同一个槽，用原子取最小保证代表点是首次出现的那个，结果与线程调度无关
+bool weldVertices(const std::vector<float>& coords, std::vector<quint32>& representative,
+                  const std::atomic_bool* cancel, ProgressRange& progress)
+{
+    const qint64 count = qint64(coords.size() / 3);
+    size_t capacity = 16;
+    while (capacity < size_t(count) * 2)
+        capacity <<= 1;
+    const size_t mask = capacity - 1;
+
+    std::unique_ptr<std::atomic<quint32>[]> table(new std::atomic<quint32>[capacity]);
+    vtkSMPTools::For(0, vtkIdType(capacity), [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType i = first; i < last; ++i)
+            table[size_t(i)].store(0, std::memory_order_relaxed);
+    });
+
+    VertexKeys keys;
+    keys.coords = coords.data();
+    const qint64 chunks = chunkCountFor(count);
+    forEachChunk(count, chunks, [&](qint64, qint64 begin, qint64 end) {
+        if (isCancelled(cancel))
+            return;
+        for (qint64 i = begin; i < end; ++i)
+        {
+            const quint32 value = quint32(i) + 1;
+            size_t slot = size_t(keys.hash(quint32(i))) & mask;
+            for (;;)
+            {
+                quint32 current = table[slot].load(std::memory_order_acquire);
+                if (current == 0)
+                {
+                    if (table[slot].compare_exchange_strong(current, value, std::memory_order_acq_rel))
+                        break;
+                    // 被其他线程抢先占用，current 已是新的值，继续比较
+                }
+                if (keys.same(current - 1, quint32(i)))
+                {
+                    while (value < current &&
+                           !table[slot].compare_exchange_weak(current, value, std::memory_order_acq_rel))
+                    {
+                    }
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+        progress.advance(end - begin);
+    });
+    if (isCancelled(cancel))
+        return false;
+
+    // 插入全部完成后再查一次，拿到每个坐标最终的代表点
+    representative.resize(size_t(count));
+    forEachChunk(count, chunks, [&](qint64, qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+        {
+            size_t slot = size_t(keys.hash(quint32(i))) & mask;
+            for (;;)
+            {
+                const quint32 current = table[slot].load(std::memory_order_relaxed);
+                if (keys.same(current - 1, quint32(i)))
+                {
+                    representative[size_t(i)] = current - 1;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+        progress.advance(end - begin);
+    });
+    return !isCancelled(cancel);
+}
+
+vtkSmartPointer<vtkPolyData> buildPolyData(const std::vector<float>& coords,
+                                           const std::vector<quint32>& representative,
+                                           FastStlReader::Stats* stats)
+{
+    const qint64 vertexCount = qint64(representative.size());
+    const qint64 triangleCount = vertexCount / 3;
+
+    // 代表点按出现顺序编号
+    std::vector<quint32> pointIndex;
+    const quint32 pointCount = exclusiveScan(vertexCount, [&](qint64 i) {
+        return representative[size_t(i)] == quint32(i);
+    }, pointIndex);
+
+    auto pointData = vtkSmartPointer<vtkFloatArray>::New();
+    pointData->SetNumberOfComponents(3);
+    pointData->SetNumberOfTuples(pointCount);
+    float* pointOut = pointData->GetPointer(0);
+    forEachChunk(vertexCount, chunkCountFor(vertexCount), [&](qint64, qint64 begin, qint64 end) {
+        for (qint64 i = begin; i < end; ++i)
+        {
+            if (representative[size_t(i)] == quint32(i))
+                std::memcpy(pointOut + size_t(pointIndex[size_t(i)]) * 3, coords.data() + size_t(i) * 3,
+                            3 * sizeof(float));
+        }
+    });
+
+    auto welded = [&](qint64 vertex) {
+        return vtkIdType(pointIndex[representative[size_t(vertex)]]);
+    };
+    auto keep = [&](qint64 t) {
+        const vtkIdType a = welded(3 * t), b = welded(3 * t + 1), c = welded(3 * t + 2);
+        return a != b && a != c && b != c;
+    };
+    std::vector<quint32> cellIndex;
+    const quint32 cellCount = exclusiveScan(triangleCount, keep, cellIndex);
+
+    auto offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(vtkIdType(cellCount) + 1);
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(vtkIdType(cellCount) * 3);
+    vtkIdType* offsetOut = offsets->GetPointer(0);
+    vtkIdType* connOut = connectivity->GetPointer(0);
+    forEachChunk(triangleCount, chunkCountFor(triangleCount), [&](qint64, qint64 begin, qint64 end) {
+        for (qint64 t = begin; t < end; ++t)
+        {
+            if (!keep(t))
+                continue;
+            const vtkIdType cell = cellIndex[size_t(t)];
+            offsetOut[cell] = cell * 3;
+            for (int k = 0; k < 3; ++k)
+                connOut[cell * 3 + k] = welded(3 * t + k);
+        }
+    });
+    offsetOut[cellCount] = vtkIdType(cellCount) * 3;
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointData);
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(polys);
+
+    if (stats)
+    {
+        stats->points = pointCount;
+        stats->cells = cellCount;
+    }
+    return polyData;
+}
+
+// 预览用的三角面片集合：每个面片独占三个点，不做合并
+vtkSmartPointer<vtkPolyData> buildSoup(const std::vector<float>& coords)
+{
+    const qint64 vertexCount = qint64(coords.size() / 3);
+    const qint64 triangleCount = vertexCount / 3;
+
+    auto pointData = vtkSmartPointer<vtkFloatArray>::New();
+    pointData->SetNumberOfComponents(3);
+    pointData->SetNumberOfTuples(vertexCount);
+    std::copy(coords.begin(), coords.end(), pointData->GetPointer(0));
+
+    auto offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(triangleCount + 1);
+    auto connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(vertexCount);
+    for (qint64 t = 0; t <= triangleCount; ++t)
+        offsets->SetValue(t, t * 3);
+    for (qint64 v = 0; v < vertexCount; ++v)
+        connectivity->SetValue(v, v);
+
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointData);
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsets, connectivity);
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(polys);
+    return polyData;
+}
+}
+
+vtkSmartPointer<vtkPolyData> FastStlReader::read(const QString& filePath,
+                                                 QString* error,
+                                                 const std::atomic_bool* cancel,
+                                                 Stats* stats,
+                                                 std::atomic_int* progress)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Stats local;
+    Stats& s = stats ? *stats : local;
+    s = Stats();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = tr("无法打开 STL 文件：%1").arg(file.errorString());
+        return nullptr;
+    }
+    s.fileBytes = file.size();
+
+    // 映射失败（例如特殊文件系统）时退化为整体读入
+    QByteArray buffer;
+    const char* data = reinterpret_cast<const char*>(s.fileBytes > 0 ? file.map(0, s.fileBytes) : nullptr);
+    if (!data)
+    {
+        buffer = file.readAll();
+        data = buffer.constData();
+    }
+
+    // 解析约占总耗时的四成，其余为顶点合并与建立连接关系
+    std::vector<float> coords;
+    quint32 binaryTriangles = 0;
+    s.binary = looksBinary(data, s.fileBytes, &binaryTriangles);
+    ProgressRange parseProgress(progress, 0, 40, s.binary ? qint64(binaryTriangles) : s.fileBytes);
+    if (s.binary)
+    {
+        if (!parseBinary(data, binaryTriangles, coords, cancel, parseProgress))
+            return nullptr;
+    }
+    else if (!parseAscii(data, s.fileBytes, coords, cancel, error, parseProgress))
+    {
+        return nullptr;
+    }
+    parseProgress.finish();
+    // 映射在解析结束后即可释放，之后只使用 coords
+    file.close();
+    buffer.clear();
+    s.triangles = qint64(coords.size() / 9);
+    s.parseMs = timer.elapsed();
+
+    if (s.triangles == 0)
+    {
+        if (error)
+            *error = tr("STL 文件中没有三角面片");
+        return nullptr;
+    }
+    if (coords.size() / 3 >= size_t(std::numeric_limits<quint32>::max()))
+    {
+        if (error)
+            *error = tr("STL 文件过大：顶点数超过 %1").arg(std::numeric_limits<quint32>::max());
+        return nullptr;
+    }
+
+    // 合并分插入与查找两遍，各按顶点数推进进度
+    std::vector<quint32> representative;
+    ProgressRange weldProgress(progress, 40, 80, qint64(coords.size() / 3) * 2);
+    if (!weldVertices(coords, representative, cancel, weldProgress))
+        return nullptr;
+    weldProgress.finish();
+    vtkSmartPointer<vtkPolyData> polyData = buildPolyData(coords, representative, &s);
+    ProgressRange(progress, 80, 100, 1).finish();
+    s.totalMs = timer.elapsed();
+    s.weldMs = s.totalMs - s.parseMs;
+    if (isCancelled(cancel))
+        return nullptr;
+    return polyData;
+}
+
+vtkSmartPointer<vtkPolyData> FastStlReader::readPreview(const QString& filePath,
+                                                        qint64 maxTriangles,
+                                                        QString* error,
+                                                        const std::atomic_bool* cancel,
+                                                        qint64* totalTriangles,
+                                                        bool parallel)
+{
+    static const char kOuter[] = "outer";
+    static const char kVertex[] = "vertex";
+    // ASCII 面片约 250 字节，取样间隔不小于一个面片
+    const qint64 kAsciiFacetBytes = 250;
+    // 取样间隔小于一页时逐个跳读仍会触及每一页，改为在文件中均匀取若干段连续面片，
+    // 每段约占一页，访问的页数与取样数成正比
+    const qint64 kPageBytes = 4096;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (error)
+            *error = tr("无法打开 STL 文件：%1").arg(file.errorString());
+        return nullptr;
+    }
+    const qint64 size = file.size();
+    const char* data = reinterpret_cast<const char*>(size > 0 ? file.map(0, size) : nullptr);
+    if (!data || maxTriangles <= 0)
+    {
+        // 预览只在能映射的大文件上有意义，失败时由完整读取处理
+        if (error)
+            *error = tr("无法映射 STL 文件");
+        return nullptr;
+    }
+
+    std::vector<float> coords;
+    quint32 binaryTriangles = 0;
+    if (looksBinary(data, size, &binaryTriangles))
+    {
+        if (totalTriangles)
+            *totalTriangles = binaryTriangles;
+        const qint64 total = binaryTriangles;
+        const qint64 stride = qMax<qint64>(1, (total + maxTriangles - 1) / maxTriangles);
+        const qint64 facetsPerPage = kPageBytes / kBinaryFacetBytes;
+        const qint64 run = stride < facetsPerPage ? facetsPerPage : 1;
+        const qint64 runs = (qMin(total, maxTriangles) + run - 1) / run;
+
+        // 第 r 段从 starts[r] 开始，读到下一段起点或满 run 个为止；offsets 为输出位置
+        std::vector<qint64> starts(size_t(runs) + 1);
+        std::vector<qint64> offsets(size_t(runs) + 1, 0);
+        for (qint64 r = 0; r < runs; ++r)
+            starts[size_t(r)] = total * r / runs;
+        starts[size_t(runs)] = total;
+        for (qint64 r = 0; r < runs; ++r)
+            offsets[size_t(r) + 1] = offsets[size_t(r)] + qMin(run, starts[size_t(r) + 1] - starts[size_t(r)]);
+        coords.resize(size_t(offsets[size_t(runs)]) * 9);
+
+        const uchar* base = reinterpret_cast<const uchar*>(data) + kBinaryHeaderBytes;
+        forEachChunk(runs, parallel ? chunkCountFor(runs) : 1, [&](qint64, qint64 begin, qint64 end) {
+            if (isCancelled(cancel))
+                return;
+            for (qint64 r = begin; r < end; ++r)
+            {
+                const qint64 count = offsets[size_t(r) + 1] - offsets[size_t(r)];
+                for (qint64 t = 0; t < count; ++t)
+                {
+                    const uchar* facet = base + (starts[size_t(r)] + t) * kBinaryFacetBytes + 12;
+                    float* dst = &coords[size_t(offsets[size_t(r)] + t) * 9];
+                    for (int k = 0; k < 9; ++k)
+                    {
+                        const quint32 bits = qFromLittleEndian<quint32>(facet + 4 * k);
+                        std::memcpy(dst + k, &bits, sizeof(float));
+                    }
+                }
+            }
+        });
+    }
+    else
+    {
+        if (totalTriangles)
+            *totalTriangles = size / kAsciiFacetBytes;
+        const qint64 samples = qMax<qint64>(1, qMin(maxTriangles, size / kAsciiFacetBytes));
+        const qint64 facetsPerPage = kPageBytes / kAsciiFacetBytes;
+        const qint64 run = size / samples < kPageBytes ? facetsPerPage : 1;
+        const qint64 runs = (samples + run - 1) / run;
+        std::vector<float> sampled(size_t(runs * run) * 9);
+        std::vector<char> valid(size_t(runs * run), 0);
+        const char* end = data + size;
+        forEachChunk(runs, parallel ? chunkCountFor(runs) : 1, [&](qint64, qint64 begin, qint64 last) {
+            if (isCancelled(cancel))
+                return;
+            for (qint64 r = begin; r < last; ++r)
+            {
+                // 从取样位置向后逐个找面片的 outer loop 读出三个顶点，不越过下一段的起点
+                const char* runEnd = data + size * (r + 1) / runs;
+                const char* p = data + size * r / runs;
+                for (qint64 j = 0; j < run; ++j)
+                {
+                    p = findWord(p, end, kOuter, sizeof(kOuter) - 1);
+                    if (!p || (j > 0 && p >= runEnd))
+                        break;
+                    bool ok = true;
+                    for (int v = 0; v < 3 && ok; ++v)
+                    {
+                        p = findWord(p, end, kVertex, sizeof(kVertex) - 1);
+                        if (!p)
+                        {
+                            ok = false;
+                            break;
+                        }
+                        p += sizeof(kVertex) - 1;
+                        float* dst = &sampled[size_t(r * run + j) * 9 + size_t(v) * 3];
+                        ok = parseFloat(p, end, dst) && parseFloat(p, end, dst + 1) && parseFloat(p, end, dst + 2);
+                    }
+                    valid[size_t(r * run + j)] = ok ? 1 : 0;
+                    if (!ok)
+                        break;
+                }
+            }
+        });
+        for (qint64 i = 0; i < runs * run; ++i)
+        {
+            if (valid[size_t(i)])
+                coords.insert(coords.end(), sampled.begin() + i * 9, sampled.begin() + (i + 1) * 9);
+        }
+    }
+    file.close();
+
+    if (isCancelled(cancel))
+        return nullptr;
+    if (coords.empty())
+    {
+        if (error)
+            *error = tr("STL 文件中没有三角面片");
+        return nullptr;
+    }
+    return buildSoup(coords);
+}
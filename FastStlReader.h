@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <QString>
+
+#include <atomic>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// 结果网格专用的 STL 读取器：文件整体映射到内存，二进制面片直接拷入 VTK 数组，
+// ASCII 按面片边界切块并行解析，重复顶点用并行哈希表合并。
+// 输出与开启 Merging 的 vtkSTLReader 一致：点按首次出现的顺序编号，退化三角形被丢弃
+class FastStlReader
+{
+public:
+    struct Stats
+    {
+        bool binary = false;
+        qint64 fileBytes = 0;
+        qint64 triangles = 0;       // 文件中的面片数
+        qint64 points = 0;          // 合并后的点数
+        qint64 cells = 0;           // 去掉退化三角形后的单元数
+        qint64 parseMs = 0;
+        qint64 weldMs = 0;
+        qint64 totalMs = 0;
+    };
+
+    // 读取失败返回空指针并给出原因；cancel 置位时尽快返回空指针，error 为空。
+    // progress 不为空时写入 0-100 的完成百分比，可在其他线程轮询
+    static vtkSmartPointer<vtkPolyData> read(const QString& filePath,
+                                             QString* error = nullptr,
+                                             const std::atomic_bool* cancel = nullptr,
+                                             Stats* stats = nullptr,
+                                             std::atomic_int* progress = nullptr);
+
+    // 预览：在整个文件中均匀抽取至多 maxTriangles 个面片，不合并顶点。
+    // 二进制文件按面片下标跳读，ASCII 文件按字节位置跳读，只访问被抽中的部分；
+    // 取样间隔小于一页时改为读取均匀分布的若干段连续面片，避免触及每一页。
+    // totalTriangles 返回文件中的面片总数，ASCII 文件为估计值。
+    // parallel 为 false 时全部在调用线程中完成，供低优先级的后台任务使用
+    static vtkSmartPointer<vtkPolyData> readPreview(const QString& filePath,
+                                                    qint64 maxTriangles,
+                                                    QString* error = nullptr,
+                                                    const std::atomic_bool* cancel = nullptr,
+                                                    qint64* totalTriangles = nullptr,
+                                                    bool parallel = true);
+};
@@ -1,4 +1,4 @@
-QT       += core gui
+﻿QT       += core gui concurrent sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -18,21 +18,84 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    ArtifactWatcher.cpp \
+    FailedRunsDialog.cpp \
+    FastStlReader.cpp \
+    GeometryBenchmark.cpp \
+    GeometryCache.cpp \
+    GeometryDiff.cpp \
+    GeometryDiffDialog.cpp \
+    GeometryDiskCache.cpp \
+    GeometryLoader.cpp \
+    GeometryLod.cpp \
+    HeadlessRunner.cpp \
+    JobQueue.cpp \
+    JobQueueDock.cpp \
     JsonPageBuilder.cpp \
     MainWindow.cpp \
+    ModelFiles.cpp \
+    ParameterSweep.cpp \
+    ParameterSweepDialog.cpp \
+    PersistenceWorker.cpp \
+    ProjectCatalog.cpp \
+    ProjectRegistry.cpp \
+    ProjectValidator.cpp \
+    RegistryBenchmark.cpp \
+    ResourceMonitor.cpp \
+    ResultCache.cpp \
+    ResultReaderRegistry.cpp \
+    RunHistoryDialog.cpp \
+    RunJournal.cpp \
     SchemeCardWidget.cpp \
     SchemeGalleryWidget.cpp \
     SchemeSettingsDialog.cpp \
+    SchemeStorage.cpp \
     SchemeTreeWidget.cpp \
+    SolverJob.cpp \
+    SolverLogTail.cpp \
+    SweepResultsDialog.cpp \
+    ThumbnailService.cpp \
     main.cpp
 
 HEADERS += \
+    ArtifactWatcher.h \
+    FailedRunsDialog.h \
+    FastStlReader.h \
+    GeometryBenchmark.h \
+    GeometryCache.h \
+    GeometryDiff.h \
+    GeometryDiffDialog.h \
+    GeometryDiskCache.h \
+    GeometryLoader.h \
+    GeometryLod.h \
+    HeadlessRunner.h \
+    JobQueue.h \
+    JobQueueDock.h \
     JsonPageBuilder.h \
     MainWindow.h \
+    ModelFiles.h \
+    ParameterSweep.h \
+    ParameterSweepDialog.h \
+    PersistenceWorker.h \
+    ProjectCatalog.h \
+    ProjectRegistry.h \
+    ProjectTypes.h \
+    ProjectValidator.h \
+    RegistryBenchmark.h \
+    ResourceMonitor.h \
+    ResultCache.h \
+    ResultReaderRegistry.h \
+    RunHistoryDialog.h \
+    RunJournal.h \
     SchemeCardWidget.h \
     SchemeGalleryWidget.h \
     SchemeSettingsDialog.h \
-    SchemeTreeWidget.h
+    SchemeStorage.h \
+    SchemeTreeWidget.h \
+    SolverJob.h \
+    SolverLogTail.h \
+    SweepResultsDialog.h \
+    ThumbnailService.h
 
 FORMS += \
     MainWindow.ui \
@@ -49,6 +112,8 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 
+win32: LIBS += -lpsapi
+
 msvc {
     QMAKE_CFLAGS += /utf-8
     QMAKE_CXXFLAGS += /utf-8
@@ -0,0 +1,169 @@
+﻿#include "GeometryBenchmark.h"
+#include "FastStlReader.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkSTLReader.h>
+#include <vtkSmartPointer.h>
+
+namespace
+{
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("GeometryBenchmark", text);
+}
+
+struct Timing
+{
+    QVector<qint64> samples;
+    qint64 points = -1;
+    qint64 cells = -1;
+
+    qint64 best() const { return samples.isEmpty() ? 0 : *std::min_element(samples.begin(), samples.end()); }
+    qint64 median() const
+    {
+        if (samples.isEmpty())
+            return 0;
+        QVector<qint64> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted.at(sorted.size() / 2);
+    }
+};
+
+// 逐点比较坐标、逐单元比较连接关系；一致时返回空字符串，否则返回第一处差异
+QString compareGeometry(vtkPolyData* fast, vtkPolyData* reference)
+{
+    if (!fast || !reference)
+        return tr("读取失败");
+    if (fast->GetNumberOfPoints() != reference->GetNumberOfPoints() ||
+        fast->GetNumberOfCells() != reference->GetNumberOfCells())
+        return tr("点数或单元数不同");
+
+    for (vtkIdType i = 0; i < fast->GetNumberOfPoints(); ++i)
+    {
+        double a[3];
+        double b[3];
+        fast->GetPoint(i, a);
+        reference->GetPoint(i, b);
+        if (a[0] != b[0] || a[1] != b[1] || a[2] != b[2])
+            return tr("第 %1 个点的坐标不同").arg(i);
+    }
+
+    vtkCellArray* fastPolys = fast->GetPolys();
+    vtkCellArray* referencePolys = reference->GetPolys();
+    if (fastPolys->GetNumberOfCells() != referencePolys->GetNumberOfCells())
+        return tr("面片单元数不同");
+    for (vtkIdType cell = 0; cell < fastPolys->GetNumberOfCells(); ++cell)
+    {
+        vtkIdType fastSize = 0;
+        vtkIdType referenceSize = 0;
+        const vtkIdType* fastIds = nullptr;
+        const vtkIdType* referenceIds = nullptr;
+        fastPolys->GetCellAtId(cell, fastSize, fastIds);
+        referencePolys->GetCellAtId(cell, referenceSize, referenceIds);
+        if (fastSize != referenceSize || !std::equal(fastIds, fastIds + fastSize, referenceIds))
+            return tr("第 %1 个单元的连接关系不同").arg(cell);
+    }
+    return QString();
+}
+
+QString describe(const QString& name, const Timing& timing)
+{
+    return tr("  %1  最短 %2 ms  中位 %3 ms  点 %4  单元 %5")
+        .arg(name, -14)
+        .arg(timing.best(), 8)
+        .arg(timing.median(), 8)
+        .arg(timing.points)
+        .arg(timing.cells);
+}
+}
+
+namespace GeometryBenchmark
+{
+int compareStlReaders(const QStringList& files, int repeat, QTextStream& out)
+{
+    repeat = qMax(1, repeat);
+    const QLocale locale;
+    out << tr("STL 读取对比：每个文件各读取 %1 次，SMP 后端 %2，线程 %3")
+               .arg(repeat)
+               .arg(QString::fromLatin1(vtkSMPTools::GetBackend()))
+               .arg(vtkSMPTools::GetEstimatedNumberOfThreads())
+        << '\n';
+    out.flush();
+
+    int mismatches = 0;
+    for (const QString& path : files)
+    {
+        const QFileInfo info(path);
+        if (!info.exists())
+        {
+            out << tr("文件不存在：%1").arg(path) << '\n';
+            ++mismatches;
+            continue;
+        }
+
+        Timing fast;
+        Timing reference;
+        FastStlReader::Stats stats;
+        QString error;
+        vtkSmartPointer<vtkPolyData> fastOutput;
+        vtkSmartPointer<vtkPolyData> referenceOutput;
+        // 交替运行两种实现，减少页缓存对先运行者的偏向；只保留最后一次的结果用于比较
+        for (int i = 0; i < repeat; ++i)
+        {
+            fastOutput = nullptr;
+            referenceOutput = nullptr;
+            QElapsedTimer timer;
+            timer.start();
+            vtkSmartPointer<vtkPolyData> polyData =
+                FastStlReader::read(info.absoluteFilePath(), &error, nullptr, &stats);
+            fast.samples << timer.elapsed();
+            fast.points = polyData ? polyData->GetNumberOfPoints() : -1;
+            fast.cells = polyData ? polyData->GetNumberOfCells() : -1;
+            if (i + 1 == repeat)
+                fastOutput = polyData;
+            polyData = nullptr;
+
+            timer.restart();
+            auto reader = vtkSmartPointer<vtkSTLReader>::New();
+            reader->SetFileName(QFile::encodeName(info.absoluteFilePath()).constData());
+            reader->Update();
+            reference.samples << timer.elapsed();
+            reference.points = reader->GetOutput()->GetNumberOfPoints();
+            reference.cells = reader->GetOutput()->GetNumberOfCells();
+            if (i + 1 == repeat)
+                referenceOutput = reader->GetOutput();
+        }
+
+        out << tr("%1（%2，%3，%4 个面片）")
+                   .arg(info.fileName(), locale.formattedDataSize(info.size()),
+                        stats.binary ? tr("二进制") : QStringLiteral("ASCII"))
+                   .arg(stats.triangles)
+            << '\n';
+        out << describe(QStringLiteral("FastStlReader"), fast) << '\n';
+        out << tr("    解析 %1 ms  合并 %2 ms（最后一次）").arg(stats.parseMs).arg(stats.weldMs) << '\n';
+        out << describe(QStringLiteral("vtkSTLReader"), reference) << '\n';
+        if (fast.best() > 0)
+            out << tr("  加速比 %1x").arg(double(reference.best()) / fast.best(), 0, 'f', 2) << '\n';
+        const QString difference = compareGeometry(fastOutput, referenceOutput);
+        if (!difference.isEmpty())
+        {
+            out << tr("  结果不一致：%1").arg(error.isEmpty() ? difference : error) << '\n';
+            ++mismatches;
+        }
+        out.flush();
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+}
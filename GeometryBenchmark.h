@@ -0,0 +1,13 @@
+﻿#pragma once
+
+#include <QStringList>
+
+class QTextStream;
+
+// 命令行下的几何读取基准测试，用于对比不同实现在大文件上的耗时
+namespace GeometryBenchmark
+{
+// FastStlReader 与 vtkSTLReader 各读取 repeat 次，输出最短与中位耗时；
+// 两者得到的点坐标或单元连接关系不一致时返回非零
+int compareStlReaders(const QStringList& files, int repeat, QTextStream& out);
+}
@@ -0,0 +1,136 @@
+﻿#include "GeometryCache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+GeometryCache::Key GeometryCache::Key::forFile(const QString& filePath, int timeStep)
+{
+    Key key;
+    const QFileInfo info(filePath);
+    if (!info.exists())
+        return key;
+    key.canonicalPath = info.canonicalFilePath();
+    key.size = info.size();
+    key.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+    key.timeStep = timeStep;
+    return key;
+}
+
+QString GeometryCache::Key::id() const
+{
+    // 第 0 个时间步沿用没有时间维度时的写法，已有的磁盘缓存仍然有效
+    const QString base = QStringLiteral("%1|%2|%3").arg(canonicalPath).arg(size).arg(modifiedMs);
+    return timeStep == 0 ? base : base + QStringLiteral("|t%1").arg(timeStep);
+}
+
+GeometryCache& GeometryCache::instance()
+{
+    static GeometryCache cache;
+    return cache;
+}
+
+void GeometryCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = qMax<qint64>(0, maxBytes);
+    evictLocked();
+}
+
+qint64 GeometryCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxBytes;
+}
+
+qint64 GeometryCache::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalBytes;
+}
+
+int GeometryCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+bool GeometryCache::lookup(const Key& key, Entry* entry)
+{
+    if (!key.isValid())
+        return false;
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(key.id());
+    if (it == m_entries.end())
+        return false;
+    it->lastUsed = ++m_useCounter;
+    if (entry)
+        *entry = *it;
+    return true;
+}
+
+GeometryCache::Entry GeometryCache::insert(const Key& key, vtkPolyData* polyData)
+{
+    Entry entry;
+    if (!polyData)
+        return entry;
+    entry.polyData = polyData;
+    entry.mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    entry.mapper->SetInputData(polyData);
+    // GetActualMemorySize 以 KiB 为单位，mapper 的显存不计入
+    entry.bytes = qint64(polyData->GetActualMemorySize()) * 1024;
+
+    QMutexLocker locker(&m_mutex);
+    if (!key.isValid() || m_maxBytes <= 0 || entry.bytes > m_maxBytes)
+        return entry;
+
+    entry.lastUsed = ++m_useCounter;
+    auto existing = m_entries.find(key.id());
+    if (existing != m_entries.end())
+    {
+        m_totalBytes -= existing->bytes;
+        m_entries.erase(existing);
+    }
+    m_entries.insert(key.id(), entry);
+    m_totalBytes += entry.bytes;
+    evictLocked();
+    return entry;
+}
+
+void GeometryCache::setLodMapper(const Key& key, vtkPolyDataMapper* lodMapper)
+{
+    if (!key.isValid() || !lodMapper)
+        return;
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(key.id());
+    if (it == m_entries.end() || it->lodMapper)
+        return;
+    it->lodMapper = lodMapper;
+    const qint64 bytes = qint64(lodMapper->GetInput()->GetActualMemorySize()) * 1024;
+    it->bytes += bytes;
+    m_totalBytes += bytes;
+    evictLocked();
+}
+
+void GeometryCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_totalBytes = 0;
+}
+
+void GeometryCache::evictLocked()
+{
+    // 条目通常只有几十个，线性查找最久未使用者即可
+    while (m_totalBytes > m_maxBytes && !m_entries.isEmpty())
+    {
+        auto victim = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->lastUsed < victim->lastUsed)
+                victim = it;
+        }
+        m_totalBytes -= victim->bytes;
+        m_entries.erase(victim);
+    }
+}
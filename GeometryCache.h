@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkSmartPointer.h>
+
+// 进程内的几何缓存：按规范路径、文件大小与修改时间缓存已读入的 vtkPolyData
+// 以及可直接渲染的 mapper，超出内存预算时淘汰最久未使用的条目。
+// 所有接口均可在工作线程中调用
+class GeometryCache
+{
+public:
+    struct Key
+    {
+        QString canonicalPath;
+        qint64 size = -1;
+        qint64 modifiedMs = 0;
+        int timeStep = 0;           // 带时间维度的结果中的时间步序号
+
+        // 文件不存在时返回无效的键
+        static Key forFile(const QString& filePath, int timeStep = 0);
+        bool isValid() const { return !canonicalPath.isEmpty(); }
+        QString id() const;
+    };
+
+    struct Entry
+    {
+        vtkSmartPointer<vtkPolyData> polyData;
+        vtkSmartPointer<vtkPolyDataMapper> mapper;
+        vtkSmartPointer<vtkPolyDataMapper> lodMapper;   // 交互时使用的简化层级，尚未生成时为空
+        qint64 bytes = 0;
+        quint64 lastUsed = 0;
+    };
+
+    static GeometryCache& instance();
+
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 totalBytes() const;
+    int count() const;
+
+    // 命中时刷新最近使用顺序
+    bool lookup(const Key& key, Entry* entry);
+    // 为 polyData 建立 mapper 并放入缓存；超过预算的单个模型只返回条目，不缓存
+    Entry insert(const Key& key, vtkPolyData* polyData);
+    // 后台生成的简化层级补充到已有条目中
+    void setLodMapper(const Key& key, vtkPolyDataMapper* lodMapper);
+    void clear();
+
+private:
+    GeometryCache() = default;
+    void evictLocked();
+
+    mutable QMutex m_mutex;
+    qint64 m_maxBytes = 1024LL * 1024 * 1024;
+    qint64 m_totalBytes = 0;
+    quint64 m_useCounter = 0;
+    QHash<QString, Entry> m_entries;
+};
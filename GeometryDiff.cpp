@@ -0,0 +1,252 @@
+﻿#include "GeometryDiff.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+
+#include <vtkFloatArray.h>
+#include <vtkGenericCell.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkStaticCellLocator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+const int kHistogramBins = 41;
+// 每块查询的点数，也是检查取消标记的间隔
+const vtkIdType kGrainSize = 4096;
+const int kCachedResults = 4;
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("GeometryDiff", text);
+}
+
+struct Accumulator
+{
+    double minDistance = std::numeric_limits<double>::max();
+    double maxDistance = -std::numeric_limits<double>::max();
+    double sumAbs = 0.0;
+    double sumSquares = 0.0;
+    qint64 count = 0;
+};
+
+// 每个线程各用一个 vtkGenericCell，定位器与基准网格只读共享
+struct SignedDistanceWorker
+{
+    vtkPolyData* Reference = nullptr;
+    vtkStaticCellLocator* Locator = nullptr;
+    vtkPoints* Points = nullptr;
+    float* Output = nullptr;
+    const std::atomic_bool* Cancel = nullptr;
+    vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+    vtkSMPThreadLocal<Accumulator> Stats;
+
+    void Initialize() { Stats.Local() = Accumulator(); }
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+        if (Cancel && Cancel->load(std::memory_order_relaxed))
+            return;
+
+        vtkGenericCell* cell = Cell.Local();
+        Accumulator& stats = Stats.Local();
+        double x[3];
+        double closest[3];
+        double p0[3];
+        double p1[3];
+        double p2[3];
+        for (vtkIdType i = begin; i < end; ++i)
+        {
+            Points->GetPoint(i, x);
+            vtkIdType cellId = -1;
+            int subId = 0;
+            double dist2 = 0.0;
+            Locator->FindClosestPoint(x, closest, cell, cellId, subId, dist2);
+            if (cellId < 0)
+            {
+                Output[i] = 0.0f;
+                continue;
+            }
+
+            // 符号取自最近面片的法向：在法向一侧为正
+            double distance = std::sqrt(dist2);
+            Reference->GetCell(cellId, cell);
+            vtkPoints* cellPoints = cell->GetPoints();
+            if (cellPoints->GetNumberOfPoints() >= 3)
+            {
+                cellPoints->GetPoint(0, p0);
+                cellPoints->GetPoint(1, p1);
+                cellPoints->GetPoint(2, p2);
+                const double u[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                const double v[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                const double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2],
+                                      u[0] * v[1] - u[1] * v[0] };
+                const double side = n[0] * (x[0] - closest[0]) + n[1] * (x[1] - closest[1]) +
+                                    n[2] * (x[2] - closest[2]);
+                if (side < 0.0)
+                    distance = -distance;
+            }
+
+            Output[i] = float(distance);
+            stats.minDistance = std::min(stats.minDistance, distance);
+            stats.maxDistance = std::max(stats.maxDistance, distance);
+            stats.sumAbs += std::fabs(distance);
+            stats.sumSquares += distance * distance;
+            ++stats.count;
+        }
+    }
+
+    void Reduce() {}
+};
+
+QString pairKey(const GeometryCache::Key& reference, const GeometryCache::Key& target)
+{
+    return reference.id() + QLatin1Char('|') + target.id();
+}
+
+QMutex g_cacheMutex;
+QList<QPair<QString, GeometryDiff::Result>> g_cache;   // 最近使用的在前
+}
+
+namespace GeometryDiff
+{
+const char* const kDistanceArrayName = "Distance";
+
+QColor divergingColor(double t)
+{
+    static const QColor kNegative(59, 76, 192);
+    static const QColor kZero(242, 242, 242);
+    static const QColor kPositive(180, 4, 38);
+    t = qBound(0.0, t, 1.0);
+    const QColor& from = t < 0.5 ? kNegative : kZero;
+    const QColor& to = t < 0.5 ? kZero : kPositive;
+    const double f = t < 0.5 ? t * 2.0 : (t - 0.5) * 2.0;
+    return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * f,
+                            from.greenF() + (to.greenF() - from.greenF()) * f,
+                            from.blueF() + (to.blueF() - from.blueF()) * f);
+}
+
+Result compute(vtkPolyData* reference, vtkPolyData* target, const std::atomic_bool* cancel)
+{
+    Result result;
+    QElapsedTimer timer;
+    timer.start();
+    if (!reference || !target || reference->GetNumberOfCells() == 0 || target->GetNumberOfPoints() == 0)
+    {
+        result.errorMessage = tr("参与比较的网格为空");
+        return result;
+    }
+
+    // 输入可能正被界面线程绘制，单元表建在浅拷贝上；多线程调用 GetCell 之前单元表必须已经建立
+    auto surface = vtkSmartPointer<vtkPolyData>::New();
+    surface->ShallowCopy(reference);
+    surface->BuildCells();
+    auto locator = vtkSmartPointer<vtkStaticCellLocator>::New();
+    locator->SetDataSet(surface);
+    locator->BuildLocator();
+
+    const vtkIdType pointCount = target->GetNumberOfPoints();
+    auto distances = vtkSmartPointer<vtkFloatArray>::New();
+    distances->SetName(kDistanceArrayName);
+    distances->SetNumberOfValues(pointCount);
+
+    SignedDistanceWorker worker;
+    worker.Reference = surface;
+    worker.Locator = locator;
+    worker.Points = target->GetPoints();
+    worker.Output = distances->GetPointer(0);
+    worker.Cancel = cancel;
+    vtkSMPTools::For(0, pointCount, kGrainSize, worker);
+    if (cancel && cancel->load())
+    {
+        result.cancelled = true;
+        return result;
+    }
+
+    Accumulator total;
+    for (auto it = worker.Stats.begin(); it != worker.Stats.end(); ++it)
+    {
+        total.minDistance = std::min(total.minDistance, it->minDistance);
+        total.maxDistance = std::max(total.maxDistance, it->maxDistance);
+        total.sumAbs += it->sumAbs;
+        total.sumSquares += it->sumSquares;
+        total.count += it->count;
+    }
+    if (total.count == 0)
+    {
+        result.errorMessage = tr("没有找到可比较的顶点");
+        return result;
+    }
+    result.minDistance = total.minDistance;
+    result.maxDistance = total.maxDistance;
+    result.meanAbsDistance = total.sumAbs / double(total.count);
+    result.rmsDistance = std::sqrt(total.sumSquares / double(total.count));
+
+    // 直方图关于零对称，颜色表也按同一范围映射
+    result.histogramRange = std::max(std::fabs(result.minDistance), std::fabs(result.maxDistance));
+    if (result.histogramRange <= 0.0)
+        result.histogramRange = 1e-12;
+    result.histogram.fill(0, kHistogramBins);
+    const float* values = distances->GetPointer(0);
+    const double binScale = kHistogramBins / (2.0 * result.histogramRange);
+    for (vtkIdType i = 0; i < pointCount; ++i)
+    {
+        const int bin = int((values[i] + result.histogramRange) * binScale);
+        ++result.histogram[qBound(0, bin, kHistogramBins - 1)];
+    }
+
+    result.mesh = vtkSmartPointer<vtkPolyData>::New();
+    result.mesh->ShallowCopy(target);
+    result.mesh->GetPointData()->AddArray(distances);
+    result.mesh->GetPointData()->SetActiveScalars(kDistanceArrayName);
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+bool lookup(const GeometryCache::Key& reference, const GeometryCache::Key& target, Result* result)
+{
+    if (!reference.isValid() || !target.isValid())
+        return false;
+    const QString key = pairKey(reference, target);
+    QMutexLocker locker(&g_cacheMutex);
+    for (int i = 0; i < g_cache.size(); ++i)
+    {
+        if (g_cache.at(i).first != key)
+            continue;
+        g_cache.move(i, 0);
+        if (result)
+            *result = g_cache.first().second;
+        return true;
+    }
+    return false;
+}
+
+void insert(const GeometryCache::Key& reference, const GeometryCache::Key& target, const Result& result)
+{
+    if (!reference.isValid() || !target.isValid() || !result.isValid())
+        return;
+    const QString key = pairKey(reference, target);
+    QMutexLocker locker(&g_cacheMutex);
+    for (int i = 0; i < g_cache.size(); ++i)
+    {
+        if (g_cache.at(i).first == key)
+        {
+            g_cache.removeAt(i);
+            break;
+        }
+    }
+    g_cache.prepend(qMakePair(key, result));
+    while (g_cache.size() > kCachedResults)
+        g_cache.removeLast();
+}
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <QColor>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include "GeometryCache.h"
+
+// 两次计算结果之间的形状差异：对比网格的每个顶点到基准网格表面的有符号距离，
+// 沿基准面片法向为正。基准网格建立 vtkStaticCellLocator，查询用 vtkSMPTools 并行执行
+namespace GeometryDiff
+{
+struct Result
+{
+    vtkSmartPointer<vtkPolyData> mesh;  // 对比网格的浅拷贝，点数据 "Distance" 为当前标量
+    double minDistance = 0.0;
+    double maxDistance = 0.0;
+    double meanAbsDistance = 0.0;
+    double rmsDistance = 0.0;
+    double histogramRange = 0.0;        // 直方图覆盖 [-histogramRange, histogramRange]
+    QVector<qint64> histogram;
+    qint64 elapsedMs = 0;
+    bool cancelled = false;
+    QString errorMessage;
+
+    bool isValid() const { return mesh && errorMessage.isEmpty() && !cancelled; }
+};
+
+extern const char* const kDistanceArrayName;
+
+// 蓝-白-红的发散色表，t 在 [0, 1]，0.5 对应零距离。直方图与三维视图的颜色表共用
+QColor divergingColor(double t);
+
+Result compute(vtkPolyData* reference, vtkPolyData* target, const std::atomic_bool* cancel = nullptr);
+
+// 按两份结果文件的缓存键保存最近几次的计算结果，同一对结果不必重复计算
+bool lookup(const GeometryCache::Key& reference, const GeometryCache::Key& target, Result* result);
+void insert(const GeometryCache::Key& reference, const GeometryCache::Key& target, const Result& result);
+}
@@ -0,0 +1,97 @@
+﻿#include "GeometryDiffDialog.h"
+
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QPainter>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+class HistogramWidget : public QWidget
+{
+public:
+    HistogramWidget(const QVector<qint64>& bins, double range, QWidget* parent)
+        : QWidget(parent)
+        , m_bins(bins)
+        , m_range(range)
+    {
+        setMinimumSize(480, 220);
+    }
+
+protected:
+    void paintEvent(QPaintEvent*) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::white);
+        if (m_bins.isEmpty())
+            return;
+
+        const int axisHeight = fontMetrics().height() + 6;
+        const QRect plot = rect().adjusted(8, 8, -8, -axisHeight);
+        const qint64 peak = std::max<qint64>(1, *std::max_element(m_bins.begin(), m_bins.end()));
+        const double barWidth = double(plot.width()) / m_bins.size();
+        for (int i = 0; i < m_bins.size(); ++i)
+        {
+            // 个别区间的点数可能比其余区间大几个数量级，高度按对数缩放
+            const double ratio = std::log1p(double(m_bins.at(i))) / std::log1p(double(peak));
+            const int height = int(plot.height() * ratio);
+            const QRectF bar(plot.left() + i * barWidth, plot.bottom() - height, barWidth, height);
+            painter.fillRect(bar, GeometryDiff::divergingColor((i + 0.5) / m_bins.size()));
+        }
+        painter.setPen(QColor(100, 116, 139));
+        painter.drawLine(plot.bottomLeft(), plot.bottomRight());
+        painter.drawLine(QPoint(plot.center().x(), plot.top()), QPoint(plot.center().x(), plot.bottom()));
+
+        const QRect labels(plot.left(), plot.bottom() + 3, plot.width(), axisHeight);
+        painter.drawText(labels, Qt::AlignLeft | Qt::AlignTop, QString::number(-m_range, 'g', 4));
+        painter.drawText(labels, Qt::AlignHCenter | Qt::AlignTop, QStringLiteral("0"));
+        painter.drawText(labels, Qt::AlignRight | Qt::AlignTop, QString::number(m_range, 'g', 4));
+    }
+
+private:
+    QVector<qint64> m_bins;
+    double m_range = 0.0;
+};
+}
+
+GeometryDiffDialog::GeometryDiffDialog(const QString& referenceName,
+                                       const QString& targetName,
+                                       const GeometryDiff::Result& result,
+                                       QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("形状差异 - %1 相对于 %2").arg(targetName, referenceName));
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    auto* v = new QVBoxLayout(this);
+    v->setContentsMargins(12, 12, 12, 12);
+    v->setSpacing(8);
+
+    auto* summary = new QLabel(this);
+    summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    summary->setText(tr("基准：%1\n对比：%2\n"
+                        "最小距离 %3，最大距离 %4\n"
+                        "平均绝对距离 %5，均方根 %6\n"
+                        "顶点数 %7，用时 %8 秒")
+                         .arg(referenceName, targetName)
+                         .arg(result.minDistance, 0, 'g', 5)
+                         .arg(result.maxDistance, 0, 'g', 5)
+                         .arg(result.meanAbsDistance, 0, 'g', 5)
+                         .arg(result.rmsDistance, 0, 'g', 5)
+                         .arg(result.mesh ? result.mesh->GetNumberOfPoints() : 0)
+                         .arg(result.elapsedMs / 1000.0, 0, 'f', 1));
+    v->addWidget(summary);
+
+    auto* hint = new QLabel(tr("正值表示对比结果位于基准表面法向一侧（纵轴为对数刻度）"), this);
+    hint->setStyleSheet("color:#64748b;");
+    v->addWidget(hint);
+
+    v->addWidget(new HistogramWidget(result.histogram, result.histogramRange, this), 1);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    v->addWidget(buttons);
+}
@@ -0,0 +1,16 @@
+﻿#pragma once
+
+#include <QDialog>
+
+#include "GeometryDiff.h"
+
+// 形状差异的统计与距离直方图；颜色与三维视图中的色表一致
+class GeometryDiffDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    GeometryDiffDialog(const QString& referenceName,
+                       const QString& targetName,
+                       const GeometryDiff::Result& result,
+                       QWidget* parent = nullptr);
+};
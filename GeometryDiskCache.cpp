@@ -0,0 +1,213 @@
+﻿#include "GeometryDiskCache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QUuid>
+#include <QVector>
+#include <algorithm>
+
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLPolyDataWriter.h>
+
+namespace
+{
+// 预处理方式或文件内容发生变化时递增，旧条目自然失效
+const char kKeyVersion[] = "flexsim-geometry-cache-v1";
+const char kSuffix[] = ".vtp";
+}
+
+GeometryDiskCache::GeometryDiskCache(const QString& rootPath, qint64 maxBytes)
+    : m_rootPath(rootPath)
+    , m_maxBytes(maxBytes)
+{
+}
+
+void GeometryDiskCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = maxBytes;
+    ensureIndexLoaded();
+    evictLocked();
+}
+
+qint64 GeometryDiskCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxBytes;
+}
+
+qint64 GeometryDiskCache::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalBytes;
+}
+
+QString GeometryDiskCache::entryName(const GeometryCache::Key& key)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(kKeyVersion);
+    hash.addData(key.id().toUtf8());
+    return QString::fromLatin1(hash.result().toHex()) + QLatin1String(kSuffix);
+}
+
+bool GeometryDiskCache::contains(const GeometryCache::Key& key)
+{
+    if (!key.isValid())
+        return false;
+    QMutexLocker locker(&m_mutex);
+    ensureIndexLoaded();
+    return m_items.contains(entryName(key));
+}
+
+vtkSmartPointer<vtkPolyData> GeometryDiskCache::load(const GeometryCache::Key& key)
+{
+    if (!key.isValid())
+        return nullptr;
+
+    const QString name = entryName(key);
+    const QString path = QDir(m_rootPath).filePath(name);
+    {
+        QMutexLocker locker(&m_mutex);
+        ensureIndexLoaded();
+        if (!m_items.contains(name))
+            return nullptr;
+    }
+
+    // 读取在锁外进行，大文件不阻塞其他线程的查询
+    auto reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
+    reader->SetFileName(QFile::encodeName(path).constData());
+    reader->Update();
+    vtkPolyData* output = reader->GetOutput();
+
+    QMutexLocker locker(&m_mutex);
+    if (!output || output->GetNumberOfCells() == 0 || reader->GetErrorCode() != 0)
+    {
+        removeLocked(name);
+        return nullptr;
+    }
+
+    auto it = m_items.find(name);
+    if (it != m_items.end())
+    {
+        it->lastUsed = QDateTime::currentDateTime();
+        QFile file(path);
+        if (file.open(QIODevice::ReadWrite))
+            file.setFileTime(it->lastUsed, QFileDevice::FileModificationTime);
+    }
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(output);
+    return polyData;
+}
+
+bool GeometryDiskCache::store(const GeometryCache::Key& key, vtkPolyData* polyData)
+{
+    if (!key.isValid() || !polyData)
+        return false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_maxBytes <= 0)
+            return false;
+        ensureIndexLoaded();
+    }
+
+    QDir root(m_rootPath);
+    if (!root.mkpath(QStringLiteral(".")))
+        return false;
+
+    // 先写到临时文件再改名，中途退出不会留下半个条目
+    const QString name = entryName(key);
+    const QString staging = root.filePath(QStringLiteral(".%1.tmp")
+                                              .arg(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    auto writer = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+    writer->SetFileName(QFile::encodeName(staging).constData());
+    writer->SetInputData(polyData);
+    writer->SetDataModeToAppended();
+    writer->EncodeAppendedDataOff();
+    writer->SetCompressorTypeToLZ4();
+    if (writer->Write() != 1)
+    {
+        QFile::remove(staging);
+        return false;
+    }
+
+    const QString finalPath = root.filePath(name);
+    QMutexLocker locker(&m_mutex);
+    removeLocked(name);
+    QFile::remove(finalPath);
+    if (!QFile::rename(staging, finalPath))
+    {
+        QFile::remove(staging);
+        return false;
+    }
+
+    Item item;
+    item.bytes = QFileInfo(finalPath).size();
+    item.lastUsed = QDateTime::currentDateTime();
+    m_items.insert(name, item);
+    m_totalBytes += item.bytes;
+    evictLocked();
+    return m_items.contains(name);
+}
+
+void GeometryDiskCache::ensureIndexLoaded()
+{
+    if (m_indexLoaded)
+        return;
+    m_indexLoaded = true;
+
+    QDir root(m_rootPath);
+    if (!root.exists())
+        return;
+
+    const QFileInfoList files = root.entryInfoList(QDir::Files | QDir::Hidden);
+    for (const QFileInfo& info : files)
+    {
+        if (info.fileName().startsWith(QLatin1Char('.')))
+        {
+            // 上次进程中断留下的临时文件
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+        if (!info.fileName().endsWith(QLatin1String(kSuffix)))
+            continue;
+        Item item;
+        item.bytes = info.size();
+        item.lastUsed = info.lastModified();
+        m_items.insert(info.fileName(), item);
+        m_totalBytes += item.bytes;
+    }
+    evictLocked();
+}
+
+void GeometryDiskCache::evictLocked()
+{
+    if (m_maxBytes < 0 || m_totalBytes <= m_maxBytes)
+        return;
+
+    QVector<QPair<QDateTime, QString>> order;
+    order.reserve(m_items.size());
+    for (auto it = m_items.cbegin(); it != m_items.cend(); ++it)
+        order.push_back(qMakePair(it->lastUsed, it.key()));
+    std::sort(order.begin(), order.end());
+
+    for (const auto& victim : order)
+    {
+        if (m_totalBytes <= m_maxBytes)
+            break;
+        removeLocked(victim.second);
+    }
+}
+
+void GeometryDiskCache::removeLocked(const QString& name)
+{
+    auto it = m_items.find(name);
+    if (it == m_items.end())
+        return;
+    m_totalBytes -= it->bytes;
+    m_items.erase(it);
+    QFile::remove(QDir(m_rootPath).filePath(name));
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include "GeometryCache.h"
+
+// 预处理后几何的磁盘缓存：<工程>/.flexcache/geometry/<hash>.vtp
+// 保存合并后的点、连接关系与法向，使用 LZ4 压缩。文件名由 STL 的规范路径、
+// 大小与修改时间决定，源文件改变后旧条目不再命中，最终按容量淘汰。
+// 所有接口均可在工作线程中调用
+class GeometryDiskCache
+{
+public:
+    GeometryDiskCache(const QString& rootPath, qint64 maxBytes);
+
+    QString rootPath() const { return m_rootPath; }
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 totalBytes() const;
+
+    // 只查索引，不读取文件
+    bool contains(const GeometryCache::Key& key);
+    // 未命中或文件损坏时返回空指针；损坏的条目会被删除
+    vtkSmartPointer<vtkPolyData> load(const GeometryCache::Key& key);
+    bool store(const GeometryCache::Key& key, vtkPolyData* polyData);
+
+private:
+    struct Item {
+        qint64 bytes = 0;
+        QDateTime lastUsed;
+    };
+
+    static QString entryName(const GeometryCache::Key& key);
+    void ensureIndexLoaded();
+    void evictLocked();
+    void removeLocked(const QString& name);
+
+    const QString m_rootPath;
+    mutable QMutex m_mutex;
+    qint64 m_maxBytes = 0;
+    qint64 m_totalBytes = 0;
+    bool m_indexLoaded = false;
+    QHash<QString, Item> m_items;   // 文件名 -> 大小与最近使用时间
+};
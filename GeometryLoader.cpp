@@ -0,0 +1,295 @@
+﻿#include "GeometryLoader.h"
+#include "FastStlReader.h"
+#include "GeometryDiskCache.h"
+#include "ResultReaderRegistry.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+
+namespace
+{
+// 超过该大小的文件才生成预览，小文件完整读取本身就很快
+const qint64 kPreviewMinBytes = 256LL * 1024 * 1024;
+// 由粗到细的预览面片数，只保留明显少于整个文件的级别
+const qint64 kPreviewStages[] = { 100000, 1000000 };
+const int kProgressIntervalMs = 500;
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("GeometryLoader", text);
+}
+
+// STL 不带可用的点法向，统一在这里计算，结果随磁盘缓存保存；已有法向的结果保持原样
+vtkSmartPointer<vtkPolyData> withNormals(vtkPolyData* input)
+{
+    if (input->GetPointData()->GetNormals())
+        return input;
+    auto normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+    normals->SetInputData(input);
+    normals->ComputePointNormalsOn();
+    normals->ComputeCellNormalsOff();
+    // 求解器输出的面片朝向一致，省去耗时的一致性检查
+    normals->ConsistencyOff();
+    normals->AutoOrientNormalsOff();
+    normals->Update();
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    output->ShallowCopy(normals->GetOutput());
+    return output;
+}
+}
+
+GeometryLoader::GeometryLoader(QObject* parent)
+    : QObject(parent)
+{
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(kProgressIntervalMs);
+    connect(m_progressTimer, &QTimer::timeout, this, &GeometryLoader::pollProgress);
+}
+
+GeometryLoader::~GeometryLoader()
+{
+    // 工作线程只持有文件路径与取消标记，可以在对象销毁后自行结束
+    if (m_token)
+        m_token->store(true);
+}
+
+void GeometryLoader::load(const QString& filePath, bool persistent, int timeStep)
+{
+    const bool wasLoading = isLoading();
+    if (m_token)
+        m_token->store(true);
+
+    m_token = std::make_shared<std::atomic_bool>(false);
+    m_currentFile = filePath;
+    const quint64 requestId = ++m_requestId;
+
+    auto* watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher, requestId, filePath]() {
+        onFinished(watcher, requestId, filePath);
+    });
+    const CancelToken token = m_token;
+    const QSharedPointer<GeometryDiskCache> diskCache = m_diskCache;
+    const std::shared_ptr<std::atomic_int> progress = std::make_shared<std::atomic_int>(0);
+    m_progress = progress;
+    m_lastProgress = -1;
+    watcher->setFuture(QtConcurrent::run([filePath, token, diskCache, persistent, progress, timeStep]() {
+        return readFile(filePath, token, diskCache, persistent, progress.get(), timeStep);
+    }));
+
+    // 大 STL 文件另起一路抽样预览，与完整读取并行，不推迟最终结果。
+    // 中间帧很快会被替换，不做预览
+    const QFileInfo info(filePath);
+    const bool isStl = info.suffix().compare(QStringLiteral("stl"), Qt::CaseInsensitive) == 0;
+    if (persistent && isStl && info.size() >= kPreviewMinBytes)
+    {
+        // 按二进制每面片 50 字节估计；ASCII 文件面片更少，多出的级别会在抽样时被跳过
+        const qint64 estimated = info.size() / 50;
+        QVector<qint64> stages;
+        for (qint64 stage : kPreviewStages)
+        {
+            if (stage * 4 <= estimated)
+                stages.append(stage);
+        }
+        if (!stages.isEmpty())
+            startPreview(requestId, filePath, stages);
+        m_progressTimer->start();
+    }
+    else
+    {
+        m_progressTimer->stop();
+    }
+
+    if (!wasLoading)
+        emit busyChanged(true);
+}
+
+void GeometryLoader::startPreview(quint64 requestId, const QString& filePath, QVector<qint64> stages)
+{
+    const qint64 maxTriangles = stages.takeFirst();
+    auto* watcher = new QFutureWatcher<Preview>(this);
+    connect(watcher, &QFutureWatcher<Preview>::finished, this,
+            [this, watcher, requestId, filePath, stages, maxTriangles]() {
+        const Preview preview = watcher->result();
+        watcher->deleteLater();
+        // 完整网格已经显示或请求已被取代时不再预览
+        if (requestId != m_requestId || !isLoading() || !preview.polyData)
+            return;
+        emit previewLoaded(filePath, preview.polyData, preview.polyData->GetNumberOfCells(),
+                           preview.totalTriangles);
+        // ASCII 文件在第一次抽样后才知道大致的面片数
+        QVector<qint64> next;
+        for (qint64 stage : stages)
+        {
+            if (stage > maxTriangles && stage * 4 <= preview.totalTriangles)
+                next.append(stage);
+        }
+        if (!next.isEmpty())
+            startPreview(requestId, filePath, next);
+    });
+
+    const CancelToken token = m_token;
+    const QSharedPointer<GeometryDiskCache> diskCache = m_diskCache;
+    watcher->setFuture(QtConcurrent::run([filePath, token, diskCache, maxTriangles]() {
+        Preview preview;
+        if (token && token->load())
+            return preview;
+        // 磁盘缓存命中时完整结果很快就到，预览反而多余
+        if (diskCache && diskCache->contains(GeometryCache::Key::forFile(filePath)))
+            return preview;
+        preview.polyData = FastStlReader::readPreview(filePath, maxTriangles, nullptr, token.get(),
+                                                      &preview.totalTriangles);
+        return preview;
+    }));
+}
+
+void GeometryLoader::pollProgress()
+{
+    if (!isLoading() || !m_progress)
+    {
+        m_progressTimer->stop();
+        return;
+    }
+    const int percent = m_progress->load();
+    if (percent == m_lastProgress)
+        return;
+    m_lastProgress = percent;
+    emit progressChanged(m_currentFile, percent);
+}
+
+void GeometryLoader::cancel()
+{
+    if (m_token)
+        m_token->store(true);
+    m_token.reset();
+    m_progress.reset();
+    m_progressTimer->stop();
+    ++m_requestId;
+    if (isLoading())
+    {
+        m_currentFile.clear();
+        emit busyChanged(false);
+    }
+}
+
+void GeometryLoader::onFinished(QFutureWatcher<Result>* watcher, quint64 requestId, const QString& filePath)
+{
+    const Result result = watcher->result();
+    watcher->deleteLater();
+    // 已被新的请求取代，结果直接丢弃
+    if (requestId != m_requestId)
+        return;
+
+    m_currentFile.clear();
+    m_token.reset();
+    m_progress.reset();
+    m_progressTimer->stop();
+    emit busyChanged(false);
+
+    if (result.cancelled)
+        return;
+    if (!result.errorMessage.isEmpty())
+    {
+        emit failed(filePath, result.errorMessage);
+        return;
+    }
+    if (!result.timeSteps.isEmpty())
+        emit timeStepsLoaded(filePath, result.timeSteps);
+    emit loaded(filePath, result.key, result.polyData, result.elapsedMs);
+}
+
+GeometryLoader::Result GeometryLoader::readFile(const QString& filePath, const CancelToken& token,
+                                                const QSharedPointer<GeometryDiskCache>& diskCache,
+                                                bool persistent, std::atomic_int* progress,
+                                                int timeStep)
+{
+    Result result;
+    auto isCancelled = [&token]() { return token && token->load(); };
+    // 排队期间选择已经改变的请求不必开始读取
+    if (isCancelled())
+    {
+        result.cancelled = true;
+        return result;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QFileInfo info(filePath);
+    if (!info.exists())
+    {
+        result.errorMessage = tr("未找到结果文件：%1").arg(filePath);
+        return result;
+    }
+
+    const std::shared_ptr<ResultReader> reader = ResultReaderRegistry::instance().readerFor(filePath);
+    if (!reader)
+    {
+        result.errorMessage = tr("不支持的结果文件格式：%1").arg(filePath);
+        return result;
+    }
+    // 时间步列表只读元数据，磁盘缓存命中时同样需要
+    ResultReader::Info readerInfo;
+    if (reader->readInfo(info.absoluteFilePath(), &readerInfo, nullptr))
+        result.timeSteps = readerInfo.timeSteps;
+    if (timeStep < 0 || (timeStep > 0 && timeStep >= result.timeSteps.size()))
+        timeStep = 0;
+
+    result.key = GeometryCache::Key::forFile(info.absoluteFilePath(), timeStep);
+    const bool useDiskCache = persistent && diskCache;
+    if (useDiskCache)
+    {
+        result.polyData = diskCache->load(result.key);
+        if (result.polyData)
+        {
+            result.fromDiskCache = true;
+            result.elapsedMs = timer.elapsed();
+            return result;
+        }
+    }
+
+    QString readError;
+    vtkSmartPointer<vtkPolyData> polyData = reader->read(info.absoluteFilePath(), timeStep, token.get(),
+                                                         progress, &readError);
+    // 部分读取器不检查中止标记，被作废的加载读完后在这里丢弃
+    if (isCancelled())
+    {
+        result.cancelled = true;
+        return result;
+    }
+    if (!polyData)
+    {
+        result.errorMessage = readError.isEmpty() ? tr("无法读取结果文件：%1").arg(filePath) : readError;
+        return result;
+    }
+
+    if (persistent)
+    {
+        polyData = withNormals(polyData);
+        if (isCancelled())
+        {
+            result.cancelled = true;
+            return result;
+        }
+    }
+    if (useDiskCache)
+    {
+        // 写缓存不影响本次显示。写入器会改动输入的管线信息，而结果随后交给界面线程绘制，
+        // 所以在交出之前做一份浅拷贝给写入任务，两边不共享数据对象
+        const GeometryCache::Key key = result.key;
+        auto snapshot = vtkSmartPointer<vtkPolyData>::New();
+        snapshot->ShallowCopy(polyData);
+        QtConcurrent::run([diskCache, key, snapshot]() { diskCache->store(key, snapshot); });
+    }
+
+    result.polyData = polyData;
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
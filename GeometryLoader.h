@@ -0,0 +1,92 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include "GeometryCache.h"
+
+template <typename T> class QFutureWatcher;
+class GeometryDiskCache;
+class QTimer;
+
+// 在后台线程读取结果文件并生成 vtkPolyData，读完后在界面线程发出信号。
+// 文件格式由 ResultReaderRegistry 按扩展名选择，带时间维度的结果每次只读取一个时间步。
+// 同一时间只关心最后一次请求：新的请求会作废之前尚未完成的加载。
+// 很大的文件在完整读取的同时先抽样生成由粗到细的预览，几百毫秒内就有图可看
+class GeometryLoader : public QObject
+{
+    Q_OBJECT
+public:
+    // 置位后工作线程尽快放弃当前加载
+    using CancelToken = std::shared_ptr<std::atomic_bool>;
+
+    struct Result
+    {
+        vtkSmartPointer<vtkPolyData> polyData;
+        GeometryCache::Key key;     // 读取前记录的文件状态，读取期间文件被改写时缓存自然失效
+        QString errorMessage;
+        QVector<double> timeSteps;  // 文件中全部时间步的时间值，没有时间维度时为空
+        qint64 elapsedMs = 0;
+        bool cancelled = false;
+        bool fromDiskCache = false;
+    };
+
+    explicit GeometryLoader(QObject* parent = nullptr);
+    ~GeometryLoader() override;
+
+    // 磁盘缓存按工程设置，为空时每次都从 STL 读取
+    void setDiskCache(const QSharedPointer<GeometryDiskCache>& cache) { m_diskCache = cache; }
+
+    // persistent 为 false 的加载（求解中的中间帧）只读取文件，不做预处理也不写入磁盘缓存
+    void load(const QString& filePath, bool persistent = true, int timeStep = 0);
+    void cancel();
+
+    bool isLoading() const { return !m_currentFile.isEmpty(); }
+    QString currentFile() const { return m_currentFile; }
+
+    // 在调用线程中同步读取，供后台任务与命令行使用。progress 写入 0-100 的完成百分比
+    static Result readFile(const QString& filePath, const CancelToken& token,
+                           const QSharedPointer<GeometryDiskCache>& diskCache = QSharedPointer<GeometryDiskCache>(),
+                           bool persistent = false, std::atomic_int* progress = nullptr,
+                           int timeStep = 0);
+
+signals:
+    void loaded(const QString& filePath, const GeometryCache::Key& key,
+                vtkSmartPointer<vtkPolyData> polyData, qint64 elapsedMs);
+    // 在 loaded 之前发出，只有带时间维度的结果才会发出
+    void timeStepsLoaded(const QString& filePath, const QVector<double>& timeSteps);
+    // 完整网格就绪前的抽样预览，sampledTriangles 逐次增加；totalTriangles 对 ASCII 文件为估计值
+    void previewLoaded(const QString& filePath, vtkSmartPointer<vtkPolyData> polyData,
+                       qint64 sampledTriangles, qint64 totalTriangles);
+    // 完整读取的进度，大文件加载期间定时发出
+    void progressChanged(const QString& filePath, int percent);
+    void failed(const QString& filePath, const QString& message);
+    void busyChanged(bool busy);
+
+private:
+    struct Preview
+    {
+        vtkSmartPointer<vtkPolyData> polyData;
+        qint64 totalTriangles = 0;
+    };
+
+    void onFinished(QFutureWatcher<Result>* watcher, quint64 requestId, const QString& filePath);
+    void startPreview(quint64 requestId, const QString& filePath, QVector<qint64> stages);
+    void pollProgress();
+
+    quint64 m_requestId = 0;
+    QString m_currentFile;
+    CancelToken m_token;
+    std::shared_ptr<std::atomic_int> m_progress;
+    int m_lastProgress = -1;
+    QTimer* m_progressTimer = nullptr;
+    QSharedPointer<GeometryDiskCache> m_diskCache;
+};
@@ -0,0 +1,75 @@
+﻿#include "GeometryLod.h"
+
+#include <cmath>
+
+#include <vtkBinnedDecimation.h>
+
+namespace
+{
+// 笔记本集显大约每秒绘制一亿个三角形
+const double kTrianglesPerSecond = 1.0e8;
+}
+
+QJsonObject LodSettings::toJson() const
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("enabled"), enabled);
+    obj.insert(QStringLiteral("minTriangles"), double(minTriangles));
+    obj.insert(QStringLiteral("targetTriangles"), double(targetTriangles));
+    obj.insert(QStringLiteral("interactiveFps"), interactiveFps);
+    return obj;
+}
+
+LodSettings LodSettings::fromJson(const QJsonObject& obj)
+{
+    LodSettings settings;
+    settings.enabled = obj.value(QStringLiteral("enabled")).toBool(settings.enabled);
+    settings.minTriangles = qMax<qint64>(
+        1, qint64(obj.value(QStringLiteral("minTriangles")).toDouble(double(settings.minTriangles))));
+    settings.targetTriangles = qMax<qint64>(
+        1000, qint64(obj.value(QStringLiteral("targetTriangles")).toDouble(double(settings.targetTriangles))));
+    settings.interactiveFps = qBound(1.0, obj.value(QStringLiteral("interactiveFps")).toDouble(settings.interactiveFps),
+                                     120.0);
+    return settings;
+}
+
+namespace GeometryLod
+{
+vtkSmartPointer<vtkPolyData> decimate(vtkPolyData* input, qint64 targetTriangles)
+{
+    if (!input || input->GetNumberOfCells() <= targetTriangles)
+        return nullptr;
+
+    // 分箱简化是线性时间且按线程并行，千万级面片也能在数秒内完成。
+    // 表面占据的箱子数约与每个方向箱数的平方成正比，每个箱子约产生两个三角形
+    double bounds[6];
+    input->GetBounds(bounds);
+    const double extent[3] = { bounds[1] - bounds[0], bounds[3] - bounds[2], bounds[5] - bounds[4] };
+    const double longest = qMax(extent[0], qMax(extent[1], extent[2]));
+    if (longest <= 0.0)
+        return nullptr;
+    const double perAxis = std::sqrt(double(targetTriangles) / 2.0) * 1.5;
+    int divisions[3];
+    for (int axis = 0; axis < 3; ++axis)
+        divisions[axis] = qBound(1, int(std::ceil(perAxis * extent[axis] / longest)), 4096);
+
+    auto decimation = vtkSmartPointer<vtkBinnedDecimation>::New();
+    decimation->SetInputData(input);
+    decimation->SetNumberOfDivisions(divisions);
+    decimation->AutoAdjustNumberOfDivisionsOff();
+    decimation->SetPointGenerationModeToUseInputPoints();
+    decimation->ProducePointDataOn();
+    decimation->Update();
+
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    output->ShallowCopy(decimation->GetOutput());
+    if (output->GetNumberOfCells() == 0 || output->GetNumberOfCells() >= input->GetNumberOfCells())
+        return nullptr;
+    return output;
+}
+
+double estimatedRenderSeconds(qint64 triangles)
+{
+    return double(triangles) / kTrianglesPerSecond;
+}
+}
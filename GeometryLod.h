@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include <QJsonObject>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// 大模型的细节层级设置，保存在 app_state.json 的 "lod" 中
+struct LodSettings
+{
+    bool enabled = true;
+    qint64 minTriangles = 1000000;      // 面片数达到该值才生成交互用的简化层级
+    qint64 targetTriangles = 250000;    // 简化层级的目标面片数
+    double interactiveFps = 15.0;       // 旋转、缩放时的目标帧率
+
+    QJsonObject toJson() const;
+    static LodSettings fromJson(const QJsonObject& obj);
+};
+
+namespace GeometryLod
+{
+// 在调用线程中生成简化网格，保留输入点上的法向；面片数已不超过目标时返回空指针
+vtkSmartPointer<vtkPolyData> decimate(vtkPolyData* input, qint64 targetTriangles);
+
+// 渲染时间的初始估计（秒），VTK 在实际渲染后会自行修正
+double estimatedRenderSeconds(qint64 triangles);
+}
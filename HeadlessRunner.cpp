@@ -0,0 +1,440 @@
+﻿#include "HeadlessRunner.h"
+#include "GeometryBenchmark.h"
+#include "JobQueue.h"
+#include "ProjectCatalog.h"
+#include "RegistryBenchmark.h"
+#include "ResultCache.h"
+#include "SchemeStorage.h"
+#include "SolverJob.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+
+namespace
+{
+const int kInterruptPollMs = 200;
+const int kDefaultCacheLimitMb = 2048;
+
+volatile std::sig_atomic_t g_interruptRequested = 0;
+
+void handleInterrupt(int)
+{
+    g_interruptRequested = 1;
+}
+
+QString statusText(const QString& status)
+{
+    if (status == QLatin1String("succeeded"))
+        return QCoreApplication::translate("HeadlessRunner", "成功");
+    if (status == QLatin1String("cancelled"))
+        return QCoreApplication::translate("HeadlessRunner", "已取消");
+    if (status == QLatin1String("missing"))
+        return QCoreApplication::translate("HeadlessRunner", "缺少参数文件");
+    return QCoreApplication::translate("HeadlessRunner", "失败");
+}
+}
+
+HeadlessRunner::HeadlessRunner(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool HeadlessRunner::isHeadlessInvocation(int argc, char* argv[])
+{
+    // 在创建 QApplication 之前判断，避免无显示环境下初始化 GUI
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+            return true;
+    }
+    return false;
+}
+
+bool HeadlessRunner::start(const QStringList& arguments, QString* error)
+{
+    m_startedAt = QDateTime::currentDateTime();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("FlexSimulate 无界面批处理模式"));
+    parser.addHelpOption();
+    const QCommandLineOption headlessOption(QStringLiteral("headless"), tr("不启动图形界面"));
+    const QCommandLineOption projectOption(QStringLiteral("project"), tr("工程目录"), tr("dir"));
+    const QCommandLineOption schemeOption(QStringLiteral("scheme"),
+                                          tr("要计算的方案名称或 ID，可重复；缺省为全部方案"),
+                                          tr("name"));
+    const QCommandLineOption modelOption(QStringLiteral("model"),
+                                         tr("只计算指定名称或 ID 的模型，可重复"), tr("name"));
+    const QCommandLineOption jobsOption(QStringLiteral("jobs"), tr("同时运行的任务数"), tr("n"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"),
+                                           tr("每个任务占用的核数（默认 1）"), tr("n"));
+    const QCommandLineOption licensesOption(QStringLiteral("licenses"),
+                                            tr("许可证数量上限（默认不限）"), tr("n"));
+    const QCommandLineOption summaryOption(QStringLiteral("summary"),
+                                           tr("运行汇总输出路径（默认 <工程>/run_summary.json）"),
+                                           tr("file"));
+    const QCommandLineOption noCacheOption(QStringLiteral("no-cache"), tr("不使用结果缓存"));
+    const QCommandLineOption verboseOption(QStringLiteral("verbose"), tr("输出求解脚本的日志"));
+    const QCommandLineOption benchmarkStlOption(QStringLiteral("benchmark-stl"),
+                                                tr("对比 STL 读取实现的耗时，可重复；不需要 --project"),
+                                                tr("file"));
+    const QCommandLineOption benchmarkRegistryOption(QStringLiteral("benchmark-registry"),
+                                                     tr("测量方案与模型查找耗时，最多到 n 个模型（建议 100000）；不需要 --project"),
+                                                     tr("n"));
+    const QCommandLineOption repeatOption(QStringLiteral("repeat"),
+                                          tr("基准测试的重复次数（默认 3）"), tr("n"));
+    parser.addOptions({ headlessOption, projectOption, schemeOption, modelOption, jobsOption,
+                        threadsOption, licensesOption, summaryOption, noCacheOption,
+                        verboseOption, benchmarkStlOption, benchmarkRegistryOption, repeatOption });
+    parser.process(arguments);
+
+    if (parser.isSet(benchmarkStlOption))
+    {
+        QTextStream out(stdout);
+        const int repeat = parser.isSet(repeatOption) ? parser.value(repeatOption).toInt() : 3;
+        const int code = GeometryBenchmark::compareStlReaders(parser.values(benchmarkStlOption),
+                                                              repeat, out);
+        QTimer::singleShot(0, this, [code]() { QCoreApplication::exit(code); });
+        return true;
+    }
+
+    if (parser.isSet(benchmarkRegistryOption))
+    {
+        QTextStream out(stdout);
+        const int code = RegistryBenchmark::measureLookups(parser.value(benchmarkRegistryOption).toInt(),
+                                                           out);
+        QTimer::singleShot(0, this, [code]() { QCoreApplication::exit(code); });
+        return true;
+    }
+
+    const QString projectArg = parser.value(projectOption).trimmed();
+    if (projectArg.isEmpty())
+    {
+        *error = tr("缺少 --project 参数");
+        return false;
+    }
+    const QDir projectDir(projectArg);
+    if (!projectDir.exists())
+    {
+        *error = tr("工程目录不存在：%1").arg(QDir::toNativeSeparators(projectArg));
+        return false;
+    }
+    m_projectRoot = QDir::cleanPath(projectDir.canonicalPath());
+
+    QVector<SchemeRecord> schemes;
+    if (ProjectCatalog::exists(m_projectRoot))
+    {
+        // 已迁移到 SQLite 目录的工程，运行记录也写入目录
+        QString catalogError;
+        if (!m_catalog.open(ProjectCatalog::catalogPath(m_projectRoot), &catalogError) ||
+            !m_catalog.load(&schemes, nullptr, &catalogError))
+        {
+            *error = tr("无法读取工程目录：%1").arg(catalogError);
+            return false;
+        }
+    }
+    else
+    {
+        const QString storagePath = QDir(m_projectRoot).filePath(QStringLiteral("schemes.json"));
+        if (!SchemeStorage::load(storagePath, m_projectRoot, &schemes, nullptr))
+        {
+            *error = tr("无法读取方案列表：%1").arg(QDir::toNativeSeparators(storagePath));
+            return false;
+        }
+    }
+
+    const QStringList wantedSchemes = parser.values(schemeOption);
+    const QStringList wantedModels = parser.values(modelOption);
+    QVector<const SchemeRecord*> selected;
+    for (const SchemeRecord& scheme : schemes)
+    {
+        if (wantedSchemes.isEmpty() || wantedSchemes.contains(scheme.name) ||
+            wantedSchemes.contains(scheme.id))
+            selected.push_back(&scheme);
+    }
+    for (const QString& wanted : wantedSchemes)
+    {
+        const bool found = std::any_of(schemes.cbegin(), schemes.cend(),
+                                       [&wanted](const SchemeRecord& scheme) {
+            return scheme.name == wanted || scheme.id == wanted;
+        });
+        if (!found)
+        {
+            QStringList names;
+            for (const SchemeRecord& scheme : schemes)
+                names << scheme.name;
+            *error = tr("未找到方案“%1”，可用方案：%2").arg(wanted, names.join(QStringLiteral(", ")));
+            return false;
+        }
+    }
+
+    // 模型只在选中的方案中查找，任何一个值都没有对应的模型时报错，而不是什么也不算
+    for (const QString& wanted : wantedModels)
+    {
+        const bool found = std::any_of(selected.cbegin(), selected.cend(), [&wanted](const SchemeRecord* scheme) {
+            return std::any_of(scheme->models.cbegin(), scheme->models.cend(), [&wanted](const ModelRecord& model) {
+                return model.name == wanted || model.id == wanted;
+            });
+        });
+        if (!found)
+        {
+            *error = tr("在所选方案中未找到模型“%1”").arg(wanted);
+            return false;
+        }
+    }
+
+    const int threads = qMax(1, parser.value(threadsOption).toInt());
+    m_jobs = parser.isSet(jobsOption) ? qMax(1, parser.value(jobsOption).toInt())
+                                      : qMax(1, QThread::idealThreadCount() / threads);
+    m_verbose = parser.isSet(verboseOption);
+    m_summaryPath = parser.isSet(summaryOption)
+                        ? QFileInfo(parser.value(summaryOption)).absoluteFilePath()
+                        : QDir(m_projectRoot).filePath(QStringLiteral("run_summary.json"));
+
+    m_queue = new JobQueue(this);
+    m_queue->setMaxCores(m_jobs * threads);
+    m_queue->setLicenseTokens(qMax(0, parser.value(licensesOption).toInt()));
+    if (!parser.isSet(noCacheOption))
+    {
+        m_cache.reset(new ResultCache(
+            QDir(m_projectRoot).filePath(QStringLiteral(".flexcache/results")),
+            qint64(kDefaultCacheLimitMb) * 1024 * 1024));
+        m_queue->setResultCache(m_cache);
+    }
+    connect(m_queue, &JobQueue::jobStarted, this,
+            [this](quint64, const QString& modelId, SolverJob* job) {
+        onJobStarted(modelId, job);
+    });
+    connect(m_queue, &JobQueue::jobFinished, this,
+            [this](quint64, const QString& modelId, SolverJob* job) {
+        onJobFinished(modelId, job);
+    });
+
+    for (const SchemeRecord* scheme : selected)
+    {
+        for (const ModelRecord& model : scheme->models)
+        {
+            if (!wantedModels.isEmpty() && !wantedModels.contains(model.name) &&
+                !wantedModels.contains(model.id))
+                continue;
+
+            ModelRun run;
+            run.schemeName = scheme->name;
+            run.model = model;
+            const QFileInfo jsonInfo(model.jsonPath);
+            run.status = jsonInfo.exists() ? QStringLiteral("queued") : QStringLiteral("missing");
+            m_runIndex.insert(model.id, m_runs.size());
+            m_runs.push_back(run);
+        }
+    }
+
+    printLine(tr("工程：%1，共 %2 个模型，并发 %3 个任务，每个任务 %4 核")
+                  .arg(QDir::toNativeSeparators(m_projectRoot))
+                  .arg(m_runs.size()).arg(m_jobs).arg(threads));
+
+    std::signal(SIGINT, handleInterrupt);
+    std::signal(SIGTERM, handleInterrupt);
+    m_interruptTimer = new QTimer(this);
+    m_interruptTimer->setInterval(kInterruptPollMs);
+    connect(m_interruptTimer, &QTimer::timeout, this, &HeadlessRunner::checkInterrupt);
+    m_interruptTimer->start();
+
+    // 先登记全部模型再入队，任务在回调中能找到对应记录
+    m_submitting = true;
+    for (const ModelRun& run : m_runs)
+    {
+        if (run.status != QLatin1String("queued"))
+        {
+            printLine(tr("[%1 / %2] 缺少参数文件：%3")
+                          .arg(run.schemeName, run.model.name,
+                               QDir::toNativeSeparators(run.model.jsonPath)));
+            continue;
+        }
+        JobRequest request;
+        request.modelId = run.model.id;
+        request.name = QStringLiteral("%1 / %2").arg(run.schemeName, run.model.name);
+        request.workingDirectory = QFileInfo(run.model.jsonPath).absolutePath();
+        request.parameterFile = run.model.jsonPath;
+        request.launcherScript = run.model.batPath;
+        request.threads = threads;
+        m_queue->enqueue(request);
+    }
+
+    m_submitting = false;
+
+    // 事件循环启动后再检查，保证没有任务时也能正常退出
+    QTimer::singleShot(0, this, &HeadlessRunner::finishIfIdle);
+    return true;
+}
+
+void HeadlessRunner::onJobStarted(const QString& modelId, SolverJob* job)
+{
+    const int index = m_runIndex.value(modelId, -1);
+    if (index < 0)
+        return;
+
+    ModelRun& run = m_runs[index];
+    run.status = QStringLiteral("running");
+    run.startedAt = QDateTime::currentDateTime();
+    const QString label = QStringLiteral("%1 / %2").arg(run.schemeName, run.model.name);
+    printLine(tr("[%1] 开始计算").arg(label));
+    if (m_verbose)
+    {
+        connect(job, &SolverJob::outputReceived, this, [this, label](const QString& text) {
+            printLine(QStringLiteral("[%1] %2").arg(label, text));
+        });
+    }
+    connect(job, &SolverJob::problemDetected, this, [this, label](const QString& message) {
+        printLine(tr("[%1] 求解器报告错误：%2").arg(label, message));
+    });
+}
+
+void HeadlessRunner::onJobFinished(const QString& modelId, SolverJob* job)
+{
+    if (m_catalog.isOpen() && job->runRecord().isValid())
+        m_catalog.addRuns(modelId, QVector<RunRecord>{ job->runRecord() });
+    const int index = m_runIndex.value(modelId, -1);
+    if (index >= 0)
+    {
+        ModelRun& run = m_runs[index];
+        const SolverRunResult& result = job->result();
+        if (result.cancelled)
+            run.status = QStringLiteral("cancelled");
+        else if (result.exitCode == 0 && result.errorMessage.isEmpty())
+            run.status = QStringLiteral("succeeded");
+        else
+            run.status = QStringLiteral("failed");
+        run.exitCode = result.exitCode;
+        run.errorMessage = result.errorMessage;
+        run.message = result.message;
+        run.stlPath = result.stlPath;
+        run.fromCache = result.fromCache;
+        run.usage = result.usage;
+        run.startedAt = result.startedAt;
+        run.finishedAt = result.finishedAt;
+
+        const double seconds = run.startedAt.msecsTo(run.finishedAt) / 1000.0;
+        printLine(tr("[%1 / %2] %3，退出码 %4，用时 %5 秒%6")
+                      .arg(run.schemeName, run.model.name, statusText(run.status))
+                      .arg(run.exitCode)
+                      .arg(seconds, 0, 'f', 1)
+                      .arg(run.fromCache ? tr("（结果缓存）") : QString()));
+        if (!run.errorMessage.isEmpty())
+            printLine(tr("    错误信息：%1").arg(run.errorMessage));
+        if (m_verbose && run.usage.valid)
+            printLine(tr("    资源：%1").arg(run.usage.summaryText()));
+    }
+    finishIfIdle();
+}
+
+void HeadlessRunner::checkInterrupt()
+{
+    if (!g_interruptRequested || m_interrupted)
+        return;
+
+    m_interrupted = true;
+    printLine(tr("收到中断信号，正在终止全部计算..."));
+    m_queue->cancelAll();
+    finishIfIdle();
+}
+
+void HeadlessRunner::finishIfIdle()
+{
+    if (m_finished || m_submitting || !m_queue || m_queue->activeCount() > 0)
+        return;
+    m_finished = true;
+    m_interruptTimer->stop();
+
+    // 中断时仍在排队的任务不会收到完成回调
+    for (ModelRun& run : m_runs)
+    {
+        if (run.status == QLatin1String("queued") || run.status == QLatin1String("running"))
+            run.status = QStringLiteral("cancelled");
+    }
+
+    int succeeded = 0;
+    for (const ModelRun& run : m_runs)
+        succeeded += run.status == QLatin1String("succeeded") ? 1 : 0;
+    const int unsuccessful = m_runs.size() - succeeded;
+
+    if (writeSummary())
+        printLine(tr("运行汇总已写入：%1").arg(QDir::toNativeSeparators(m_summaryPath)));
+    else
+        printLine(tr("无法写入运行汇总：%1").arg(QDir::toNativeSeparators(m_summaryPath)));
+    printLine(tr("完成：成功 %1 个，未成功 %2 个").arg(succeeded).arg(unsuccessful));
+
+    QCoreApplication::exit(unsuccessful == 0 ? 0 : 1);
+}
+
+bool HeadlessRunner::writeSummary() const
+{
+    const QDateTime finishedAt = QDateTime::currentDateTime();
+    QJsonArray models;
+    QHash<QString, int> counts;
+    int cacheHits = 0;
+    for (const ModelRun& run : m_runs)
+    {
+        QJsonObject obj;
+        obj.insert(QStringLiteral("scheme"), run.schemeName);
+        obj.insert(QStringLiteral("model"), run.model.name);
+        obj.insert(QStringLiteral("id"), run.model.id);
+        obj.insert(QStringLiteral("directory"), run.model.directory);
+        obj.insert(QStringLiteral("status"), run.status);
+        obj.insert(QStringLiteral("exitCode"), run.exitCode);
+        obj.insert(QStringLiteral("errorMessage"), run.errorMessage);
+        obj.insert(QStringLiteral("message"), run.message);
+        obj.insert(QStringLiteral("stl"), run.stlPath);
+        obj.insert(QStringLiteral("fromCache"), run.fromCache);
+        if (run.startedAt.isValid())
+            obj.insert(QStringLiteral("startedAt"), run.startedAt.toString(Qt::ISODateWithMs));
+        if (run.finishedAt.isValid())
+            obj.insert(QStringLiteral("finishedAt"), run.finishedAt.toString(Qt::ISODateWithMs));
+        if (run.startedAt.isValid() && run.finishedAt.isValid())
+            obj.insert(QStringLiteral("elapsedSeconds"),
+                       run.startedAt.msecsTo(run.finishedAt) / 1000.0);
+        if (run.usage.valid)
+            obj.insert(QStringLiteral("resources"), run.usage.toJson());
+        models.append(obj);
+        counts[run.status] += 1;
+        cacheHits += run.fromCache ? 1 : 0;
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("project"), m_projectRoot);
+    root.insert(QStringLiteral("startedAt"), m_startedAt.toString(Qt::ISODateWithMs));
+    root.insert(QStringLiteral("finishedAt"), finishedAt.toString(Qt::ISODateWithMs));
+    root.insert(QStringLiteral("elapsedSeconds"), m_startedAt.msecsTo(finishedAt) / 1000.0);
+    root.insert(QStringLiteral("jobs"), m_jobs);
+    root.insert(QStringLiteral("interrupted"), m_interrupted);
+    root.insert(QStringLiteral("total"), m_runs.size());
+    root.insert(QStringLiteral("succeeded"), counts.value(QStringLiteral("succeeded")));
+    root.insert(QStringLiteral("failed"), counts.value(QStringLiteral("failed")));
+    root.insert(QStringLiteral("cancelled"), counts.value(QStringLiteral("cancelled")));
+    root.insert(QStringLiteral("missing"), counts.value(QStringLiteral("missing")));
+    root.insert(QStringLiteral("cacheHits"), cacheHits);
+    root.insert(QStringLiteral("models"), models);
+
+    QSaveFile file(m_summaryPath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+void HeadlessRunner::printLine(const QString& text) const
+{
+    QTextStream out(stdout);
+    out << QDateTime::currentDateTime().toString(QStringLiteral("[hh:mm:ss] ")) << text << '\n';
+    out.flush();
+}
@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include "ProjectCatalog.h"
+#include "ProjectTypes.h"
+#include "ResourceMonitor.h"
+
+class JobQueue;
+class ResultCache;
+class SolverJob;
+class QTimer;
+
+// 无界面批处理：只依赖 QCoreApplication，读取工程的 schemes.json（或 catalog.sqlite），
+// 通过与界面相同的 JobQueue 运行模型，结束后写出 run_summary.json。
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HeadlessRunner(QObject* parent = nullptr);
+
+    static bool isHeadlessInvocation(int argc, char* argv[]);
+
+    // 解析参数并提交任务；返回 false 时 error 中给出原因，调用方直接退出
+    bool start(const QStringList& arguments, QString* error);
+
+private:
+    struct ModelRun {
+        QString schemeName;
+        ModelRecord model;
+        QString status;         // queued / running / succeeded / failed / cancelled / missing
+        int exitCode = -1;
+        QString errorMessage;
+        QString message;
+        QString stlPath;
+        bool fromCache = false;
+        ResourceUsage usage;
+        QDateTime startedAt;
+        QDateTime finishedAt;
+    };
+
+    void onJobStarted(const QString& modelId, SolverJob* job);
+    void onJobFinished(const QString& modelId, SolverJob* job);
+    void checkInterrupt();
+    void finishIfIdle();
+    bool writeSummary() const;
+    void printLine(const QString& text) const;
+
+    JobQueue* m_queue = nullptr;
+    QSharedPointer<ResultCache> m_cache;
+    ProjectCatalog m_catalog;
+    QTimer* m_interruptTimer = nullptr;
+    QString m_projectRoot;
+    QString m_summaryPath;
+    bool m_verbose = false;
+    bool m_interrupted = false;
+    bool m_finished = false;
+    bool m_submitting = false;
+    int m_jobs = 1;
+    QDateTime m_startedAt;
+    QVector<ModelRun> m_runs;
+    QHash<QString, int> m_runIndex;     // modelId -> m_runs 下标
+};
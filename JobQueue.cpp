@@ -0,0 +1,477 @@
+﻿#include "JobQueue.h"
+
+#include <QScopedValueRollback>
+#include <QThread>
+
+#include <algorithm>
+
+JobQueue::JobQueue(QObject* parent)
+    : QObject(parent)
+    , m_maxCores(qMax(1, QThread::idealThreadCount()))
+{
+}
+
+void JobQueue::setMaxCores(int cores)
+{
+    m_maxCores = qMax(1, cores);
+    schedule();
+}
+
+void JobQueue::setLicenseTokens(int tokens)
+{
+    m_licenseTokens = qMax(0, tokens);
+    schedule();
+}
+
+int JobQueue::concurrencyLimit(int threadsPerJob) const
+{
+    int limit = qMax(1, m_maxCores / qBound(1, threadsPerJob, m_maxCores));
+    if (m_licenseTokens > 0)
+        limit = qMin(limit, m_licenseTokens);
+    return limit;
+}
+
+void JobQueue::setResultCache(const QSharedPointer<ResultCache>& cache)
+{
+    m_resultCache = cache;
+}
+
+void JobQueue::setAutoPreempt(bool enabled)
+{
+    if (m_autoPreempt == enabled)
+        return;
+    m_autoPreempt = enabled;
+    schedule();
+}
+
+quint64 JobQueue::enqueue(const JobRequest& request)
+{
+    if (request.modelId.isEmpty() || isModelActive(request.modelId))
+        return 0;
+
+    Entry entry;
+    entry.id = m_nextId++;
+    entry.request = request;
+    entry.enqueuedAt = QDateTime::currentDateTime();
+    m_entries.push_back(entry);
+    schedule();
+    return entry.id;
+}
+
+void JobQueue::cancel(quint64 id)
+{
+    const int index = indexOf(id);
+    if (index < 0)
+        return;
+
+    Entry& entry = m_entries[index];
+    if (entry.status == Queued)
+    {
+        entry.status = Cancelled;
+        entry.finishedAt = QDateTime::currentDateTime();
+        entry.message = tr("已从队列中取消");
+        emit queueChanged();
+    }
+    else if (entry.status == Running && entry.job)
+    {
+        entry.job->cancel();
+    }
+}
+
+void JobQueue::cancelModel(const QString& modelId)
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId &&
+            (entry.status == Queued || entry.status == Running))
+        {
+            cancel(entry.id);
+            return;
+        }
+    }
+}
+
+void JobQueue::cancelAll()
+{
+    // 先清空排队任务，避免取消运行中任务后被调度补位
+    QVector<quint64> running;
+    for (Entry& entry : m_entries)
+    {
+        if (entry.status == Queued)
+        {
+            entry.status = Cancelled;
+            entry.finishedAt = QDateTime::currentDateTime();
+            entry.message = tr("已从队列中取消");
+        }
+        else if (entry.status == Running)
+        {
+            running.push_back(entry.id);
+        }
+    }
+    for (quint64 id : running)
+        cancel(id);
+    emit queueChanged();
+}
+
+void JobQueue::setPriority(quint64 id, int priority)
+{
+    const int index = indexOf(id);
+    if (index < 0 || m_entries[index].request.priority == priority)
+        return;
+    m_entries[index].request.priority = priority;
+    schedule();
+}
+
+bool JobQueue::setThreads(quint64 id, int threads)
+{
+    const int index = indexOf(id);
+    if (index < 0 || m_entries[index].status != Queued || threads < 1)
+        return false;
+    if (m_entries[index].request.threads != threads)
+    {
+        m_entries[index].request.threads = threads;
+        schedule();
+    }
+    return true;
+}
+
+bool JobQueue::suspend(quint64 id)
+{
+    const int index = indexOf(id);
+    if (index < 0 || !suspendEntry(m_entries[index], false))
+        return false;
+    // 归还的核数可以先给排队任务使用
+    schedule();
+    return true;
+}
+
+bool JobQueue::resume(quint64 id)
+{
+    const int index = indexOf(id);
+    if (index < 0)
+        return false;
+
+    Entry& entry = m_entries[index];
+    if (entry.status != Running || !entry.suspended || !entry.job || !entry.job->resume())
+        return false;
+    // 手动恢复不等待空闲核数，短时间内可能超出上限，新任务会等到占用回落；
+    // 许可证在暂停期间一直由求解进程持有，这里不再计数
+    entry.suspended = false;
+    entry.preempted = false;
+    m_usedCores += entry.allocatedThreads;
+    emit queueChanged();
+    return true;
+}
+
+bool JobQueue::suspendModel(const QString& modelId)
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId && entry.status == Running)
+            return suspend(entry.id);
+    }
+    return false;
+}
+
+bool JobQueue::resumeModel(const QString& modelId)
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId && entry.status == Running)
+            return resume(entry.id);
+    }
+    return false;
+}
+
+void JobQueue::clearFinished()
+{
+    QVector<Entry> remaining;
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.status == Queued || entry.status == Running)
+            remaining.push_back(entry);
+    }
+    m_entries = remaining;
+    emit queueChanged();
+}
+
+bool JobQueue::isModelActive(const QString& modelId) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId &&
+            (entry.status == Queued || entry.status == Running))
+            return true;
+    }
+    return false;
+}
+
+bool JobQueue::isModelQueued(const QString& modelId) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId && entry.status == Queued)
+            return true;
+    }
+    return false;
+}
+
+bool JobQueue::isModelSuspended(const QString& modelId) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId && entry.status == Running)
+            return entry.suspended;
+    }
+    return false;
+}
+
+SolverJob* JobQueue::runningJobForModel(const QString& modelId) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.request.modelId == modelId && entry.status == Running)
+            return entry.job;
+    }
+    return nullptr;
+}
+
+int JobQueue::activeCount() const
+{
+    int count = 0;
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.status == Queued || entry.status == Running)
+            ++count;
+    }
+    return count;
+}
+
+QVector<JobQueue::Entry> JobQueue::entries() const
+{
+    return m_entries;
+}
+
+void JobQueue::schedule()
+{
+    if (m_scheduling)
+        return;
+
+    {
+        QScopedValueRollback<bool> guard(m_scheduling, true);
+        // 被抢占的任务已经算过一部分，核数空出后先于排队任务恢复；
+        // 还有任务等待恢复时只启动紧急任务，空出的核数不会被普通任务占去
+        bool preemptedWaiting = false;
+        for (const Entry& entry : qAsConst(m_entries))
+            preemptedWaiting = preemptedWaiting || (entry.status == Running && entry.preempted);
+        if (preemptedWaiting && !hasQueuedUrgent())
+            preemptedWaiting = resumePreempted();
+
+        for (;;)
+        {
+            // 紧急任务优先，其余严格按优先级（同级先入先出）出队，避免大任务被小任务长期插队
+            int next = -1;
+            for (int i = 0; i < m_entries.size(); ++i)
+            {
+                const Entry& entry = m_entries.at(i);
+                if (entry.status != Queued)
+                    continue;
+                if (next < 0)
+                {
+                    next = i;
+                    continue;
+                }
+                const JobRequest& best = m_entries.at(next).request;
+                if (entry.request.urgent != best.urgent ? entry.request.urgent
+                                                        : entry.request.priority > best.priority)
+                    next = i;
+            }
+            if (next < 0)
+                break;
+
+            const JobRequest& request = m_entries.at(next).request;
+            const int threads = effectiveThreads(request);
+            if (preemptedWaiting && !request.urgent)
+                break;
+            if (!fits(threads) && !(request.urgent && m_autoPreempt && preemptFor(threads)))
+                break;
+
+            Entry& entry = m_entries[next];
+            auto* job = new SolverJob(entry.request.workingDirectory, this);
+            job->setThreadCount(threads);
+            job->setParameterFile(entry.request.parameterFile);
+            job->setLauncherScript(entry.request.launcherScript);
+            if (entry.request.useCache && m_resultCache)
+                job->setResultCache(m_resultCache);
+            entry.job = job;
+            entry.status = Running;
+            entry.allocatedThreads = threads;
+            entry.startedAt = QDateTime::currentDateTime();
+            m_usedCores += threads;
+            ++m_usedTokens;
+
+            const quint64 id = entry.id;
+            const QString modelId = entry.request.modelId;
+            connect(job, &SolverJob::finished, this, [this, id]() {
+                onJobFinished(id);
+            });
+            emit jobStarted(id, modelId, job);
+            job->start();
+        }
+    }
+    emit queueChanged();
+}
+
+void JobQueue::onJobFinished(quint64 id)
+{
+    const int index = indexOf(id);
+    if (index < 0)
+        return;
+
+    Entry& entry = m_entries[index];
+    SolverJob* job = entry.job;
+    if (!job)
+        return;
+
+    const SolverRunResult& result = job->result();
+    if (result.cancelled)
+        entry.status = Cancelled;
+    else if (result.exitCode == 0 && result.errorMessage.isEmpty())
+        entry.status = Succeeded;
+    else
+        entry.status = Failed;
+    entry.finishedAt = result.finishedAt;
+    entry.message = result.message;
+    entry.job = nullptr;
+
+    if (!entry.suspended)
+        m_usedCores -= entry.allocatedThreads;
+    --m_usedTokens;
+    entry.allocatedThreads = 0;
+    entry.suspended = false;
+    entry.preempted = false;
+
+    const QString modelId = entry.request.modelId;
+    emit jobFinished(id, modelId, job);
+    job->deleteLater();
+    schedule();
+}
+
+int JobQueue::indexOf(quint64 id) const
+{
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries.at(i).id == id)
+            return i;
+    }
+    return -1;
+}
+
+int JobQueue::effectiveThreads(const JobRequest& request) const
+{
+    return qBound(1, request.threads, m_maxCores);
+}
+
+bool JobQueue::hasQueuedUrgent() const
+{
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.status == Queued && entry.request.urgent)
+            return true;
+    }
+    return false;
+}
+
+bool JobQueue::resumePreempted()
+{
+    // 优先级高的先恢复，同级先开始的先恢复；排在前面的放不下时后面的也不恢复，
+    // 否则核数大的任务会一直被小任务抢在前面
+    QVector<int> candidates;
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        const Entry& entry = m_entries.at(i);
+        if (entry.status == Running && entry.preempted)
+            candidates.push_back(i);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        const Entry& ea = m_entries.at(a);
+        const Entry& eb = m_entries.at(b);
+        if (ea.request.priority != eb.request.priority)
+            return ea.request.priority > eb.request.priority;
+        return ea.startedAt < eb.startedAt;
+    });
+
+    for (int index : candidates)
+    {
+        Entry& entry = m_entries[index];
+        if (!fits(entry.allocatedThreads, false))
+            return true;
+        if (!entry.job || !entry.job->resume())
+        {
+            // 无法恢复的任务不再阻塞后面的任务，等它自行结束
+            entry.preempted = false;
+            continue;
+        }
+        entry.suspended = false;
+        entry.preempted = false;
+        m_usedCores += entry.allocatedThreads;
+    }
+    return false;
+}
+
+bool JobQueue::fits(int threads, bool newToken) const
+{
+    const bool cores = m_usedCores == 0 || m_usedCores + threads <= m_maxCores;
+    const bool tokens = !newToken || m_licenseTokens <= 0 || m_usedTokens < m_licenseTokens;
+    return cores && tokens;
+}
+
+bool JobQueue::preemptFor(int threads)
+{
+    // 暂停的求解进程仍持有许可证，抢占只能腾出核数；许可证用完时抢占无济于事
+    if (m_licenseTokens > 0 && m_usedTokens >= m_licenseTokens)
+        return false;
+
+    // 先暂停优先级最低、最晚开始的任务；核数腾不出时一个都不暂停
+    QVector<int> candidates;
+    int freeableCores = 0;
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        const Entry& entry = m_entries.at(i);
+        if (entry.status == Running && !entry.suspended && !entry.request.urgent &&
+            entry.job && entry.job->isRunning())
+        {
+            candidates.push_back(i);
+            freeableCores += entry.allocatedThreads;
+        }
+    }
+    const int remainingCores = m_usedCores - freeableCores;
+    if (remainingCores > 0 && remainingCores + threads > m_maxCores)
+        return false;
+
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        const Entry& ea = m_entries.at(a);
+        const Entry& eb = m_entries.at(b);
+        if (ea.request.priority != eb.request.priority)
+            return ea.request.priority < eb.request.priority;
+        return ea.startedAt > eb.startedAt;
+    });
+
+    for (int index : candidates)
+    {
+        if (fits(threads))
+            break;
+        suspendEntry(m_entries[index], true);
+    }
+    return fits(threads);
+}
+
+bool JobQueue::suspendEntry(Entry& entry, bool preempted)
+{
+    if (entry.status != Running || entry.suspended || !entry.job || !entry.job->suspend())
+        return false;
+    entry.suspended = true;
+    entry.preempted = preempted;
+    m_usedCores -= entry.allocatedThreads;
+    return true;
+}
@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "SolverJob.h"
+
+struct JobRequest
+{
+    QString modelId;
+    QString name;               // 用于日志与队列显示
+    QString workingDirectory;
+    QString parameterFile;      // 运行时做快照写入运行日志
+    QString launcherScript;     // 模型的启动脚本，为空时使用默认脚本
+    int priority = 0;           // 数值越大越先执行
+    int threads = 1;            // 该任务占用的核数
+    bool useCache = true;       // false 时忽略结果缓存，强制重新计算
+    bool urgent = false;        // 紧急任务：核数不足时可暂停非紧急任务让出核数
+};
+
+// 求解任务队列：按优先级排队，并按核数与许可证数量限制同时运行的任务
+class JobQueue : public QObject
+{
+    Q_OBJECT
+public:
+    enum Status {
+        Queued = 0,
+        Running,
+        Succeeded,
+        Failed,
+        Cancelled
+    };
+
+    struct Entry {
+        quint64 id = 0;
+        JobRequest request;
+        Status status = Queued;
+        SolverJob* job = nullptr;
+        int allocatedThreads = 0;
+        bool suspended = false;     // 已暂停，占用的核数暂时归还；许可证仍由求解进程持有
+        bool preempted = false;     // 由紧急任务自动暂停，核数允许时自动恢复
+        QDateTime enqueuedAt;
+        QDateTime startedAt;
+        QDateTime finishedAt;
+        QString message;
+    };
+
+    explicit JobQueue(QObject* parent = nullptr);
+
+    void setMaxCores(int cores);
+    int maxCores() const { return m_maxCores; }
+    void setLicenseTokens(int tokens);          // 0 表示不限
+    int licenseTokens() const { return m_licenseTokens; }
+    int usedCores() const { return m_usedCores; }
+    int usedTokens() const { return m_usedTokens; }
+    int concurrencyLimit(int threadsPerJob) const;
+    void setResultCache(const QSharedPointer<ResultCache>& cache);
+    void setAutoPreempt(bool enabled);
+    bool autoPreempt() const { return m_autoPreempt; }
+
+    quint64 enqueue(const JobRequest& request);
+    void cancel(quint64 id);
+    void cancelModel(const QString& modelId);
+    void cancelAll();
+    void setPriority(quint64 id, int priority);
+    // 只能修改排队中任务的线程数
+    bool setThreads(quint64 id, int threads);
+    bool suspend(quint64 id);
+    bool resume(quint64 id);
+    bool suspendModel(const QString& modelId);
+    bool resumeModel(const QString& modelId);
+    void clearFinished();
+
+    bool isModelActive(const QString& modelId) const;
+    bool isModelQueued(const QString& modelId) const;
+    bool isModelSuspended(const QString& modelId) const;
+    SolverJob* runningJobForModel(const QString& modelId) const;
+    int activeCount() const;
+    QVector<Entry> entries() const;
+
+signals:
+    void jobStarted(quint64 id, const QString& modelId, SolverJob* job);
+    void jobFinished(quint64 id, const QString& modelId, SolverJob* job);
+    void queueChanged();
+
+private:
+    void schedule();
+    void onJobFinished(quint64 id);
+    int indexOf(quint64 id) const;
+    int effectiveThreads(const JobRequest& request) const;
+    bool hasQueuedUrgent() const;
+    // 返回是否仍有被抢占的任务等待恢复
+    bool resumePreempted();
+    // newToken 为 false 时用于恢复已持有许可证的任务，只检查核数
+    bool fits(int threads, bool newToken = true) const;
+    bool preemptFor(int threads);
+    bool suspendEntry(Entry& entry, bool preempted);
+
+    QVector<Entry> m_entries;
+    quint64 m_nextId = 1;
+    int m_maxCores = 1;
+    int m_licenseTokens = 0;
+    int m_usedCores = 0;
+    int m_usedTokens = 0;           // 已启动且未结束的任务数，含已暂停的
+    bool m_scheduling = false;
+    bool m_autoPreempt = true;
+    QSharedPointer<ResultCache> m_resultCache;
+};
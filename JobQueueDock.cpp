@@ -0,0 +1,367 @@
+﻿#include "JobQueueDock.h"
+#include "JobQueue.h"
+
+#include <QCheckBox>
+#include <QColor>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QHash>
+#include <QLabel>
+#include <QPushButton>
+#include <QSet>
+#include <QSpinBox>
+#include <QThread>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace
+{
+QString statusText(JobQueue::Status status)
+{
+    switch (status)
+    {
+    case JobQueue::Queued:
+        return JobQueueDock::tr("排队中");
+    case JobQueue::Running:
+        return JobQueueDock::tr("运行中");
+    case JobQueue::Succeeded:
+        return JobQueueDock::tr("已完成");
+    case JobQueue::Failed:
+        return JobQueueDock::tr("失败");
+    case JobQueue::Cancelled:
+        return JobQueueDock::tr("已取消");
+    }
+    return QString();
+}
+
+QString entryStatusText(const JobQueue::Entry& entry)
+{
+    if (entry.status == JobQueue::Running && entry.suspended)
+        return entry.preempted ? JobQueueDock::tr("已被抢占") : JobQueueDock::tr("已暂停");
+    if (entry.request.urgent && entry.status == JobQueue::Queued)
+        return JobQueueDock::tr("排队中（紧急）");
+    return statusText(entry.status);
+}
+
+QString elapsedText(const JobQueue::Entry& entry)
+{
+    if (!entry.startedAt.isValid())
+        return QString();
+    const QDateTime end = entry.finishedAt.isValid() ? entry.finishedAt
+                                                     : QDateTime::currentDateTime();
+    const qint64 secs = qMax<qint64>(0, entry.startedAt.secsTo(end));
+    return QStringLiteral("%1:%2:%3")
+        .arg(secs / 3600, 2, 10, QLatin1Char('0'))
+        .arg((secs / 60) % 60, 2, 10, QLatin1Char('0'))
+        .arg(secs % 60, 2, 10, QLatin1Char('0'));
+}
+}
+
+JobQueueDock::JobQueueDock(JobQueue* queue, QWidget* parent)
+    : QDockWidget(tr("任务队列"), parent)
+    , m_queue(queue)
+{
+    setObjectName(QStringLiteral("jobQueueDock"));
+
+    auto* container = new QWidget(this);
+    auto* layout = new QVBoxLayout(container);
+    layout->setContentsMargins(8, 8, 8, 8);
+    layout->setSpacing(6);
+
+    auto* settingsRow = new QHBoxLayout();
+    settingsRow->setSpacing(6);
+    settingsRow->addWidget(new QLabel(tr("最大核数："), container));
+    m_coresSpin = new QSpinBox(container);
+    m_coresSpin->setRange(1, 4096);
+    m_coresSpin->setValue(m_queue->maxCores());
+    m_coresSpin->setToolTip(tr("本机默认 %1 核").arg(QThread::idealThreadCount()));
+    settingsRow->addWidget(m_coresSpin);
+
+    settingsRow->addWidget(new QLabel(tr("许可证数："), container));
+    m_tokensSpin = new QSpinBox(container);
+    m_tokensSpin->setRange(0, 4096);
+    m_tokensSpin->setSpecialValueText(tr("不限"));
+    m_tokensSpin->setValue(m_queue->licenseTokens());
+    settingsRow->addWidget(m_tokensSpin);
+
+    settingsRow->addWidget(new QLabel(tr("每任务线程："), container));
+    m_threadsSpin = new QSpinBox(container);
+    m_threadsSpin->setRange(1, 4096);
+    m_threadsSpin->setValue(1);
+    settingsRow->addWidget(m_threadsSpin);
+
+    m_preemptCheck = new QCheckBox(tr("紧急任务自动抢占"), container);
+    m_preemptCheck->setChecked(m_queue->autoPreempt());
+    m_preemptCheck->setToolTip(tr("核数不足时暂停低优先级任务，紧急任务结束后自动恢复"));
+    settingsRow->addWidget(m_preemptCheck);
+    settingsRow->addStretch(1);
+    layout->addLayout(settingsRow);
+
+    m_capacityLabel = new QLabel(container);
+    m_capacityLabel->setStyleSheet("color:#64748b;");
+    layout->addWidget(m_capacityLabel);
+
+    m_list = new QTreeWidget(container);
+    m_list->setRootIsDecorated(false);
+    m_list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_list->setHeaderLabels(QStringList() << tr("模型") << tr("状态") << tr("优先级")
+                                          << tr("线程") << tr("入队时间") << tr("耗时"));
+    m_list->header()->setStretchLastSection(false);
+    m_list->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_list->headerItem()->setToolTip(3, tr("排队中的任务可双击修改，该模型之后入队时沿用"));
+    // 只有线程列可编辑，由双击时显式打开编辑器
+    m_list->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(m_list, 1);
+
+    auto* buttonRow = new QHBoxLayout();
+    buttonRow->setSpacing(6);
+    auto* raiseBtn = new QPushButton(tr("提高优先级"), container);
+    auto* lowerBtn = new QPushButton(tr("降低优先级"), container);
+    auto* suspendBtn = new QPushButton(tr("暂停"), container);
+    auto* resumeBtn = new QPushButton(tr("继续"), container);
+    auto* cancelBtn = new QPushButton(tr("取消所选"), container);
+    auto* clearBtn = new QPushButton(tr("清除已结束"), container);
+    buttonRow->addWidget(raiseBtn);
+    buttonRow->addWidget(lowerBtn);
+    buttonRow->addWidget(suspendBtn);
+    buttonRow->addWidget(resumeBtn);
+    buttonRow->addWidget(cancelBtn);
+    buttonRow->addStretch(1);
+    buttonRow->addWidget(clearBtn);
+    layout->addLayout(buttonRow);
+
+    setWidget(container);
+
+    connect(raiseBtn, &QPushButton::clicked, this, &JobQueueDock::raiseSelectedPriority);
+    connect(lowerBtn, &QPushButton::clicked, this, &JobQueueDock::lowerSelectedPriority);
+    connect(suspendBtn, &QPushButton::clicked, this, &JobQueueDock::suspendSelected);
+    connect(resumeBtn, &QPushButton::clicked, this, &JobQueueDock::resumeSelected);
+    connect(cancelBtn, &QPushButton::clicked, this, &JobQueueDock::cancelSelected);
+    connect(clearBtn, &QPushButton::clicked, m_queue, &JobQueue::clearFinished);
+    connect(m_queue, &JobQueue::queueChanged, this, &JobQueueDock::refresh);
+    connect(m_list, &QTreeWidget::itemChanged, this, &JobQueueDock::onItemChanged);
+    connect(m_list, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem* item, int column) {
+        if (column == 3 && (item->flags() & Qt::ItemIsEditable))
+            m_list->editItem(item, 3);
+    });
+
+    auto* elapsedTimer = new QTimer(this);
+    elapsedTimer->setInterval(1000);
+    connect(elapsedTimer, &QTimer::timeout, this, &JobQueueDock::updateElapsed);
+    elapsedTimer->start();
+
+    connect(m_coresSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, [this](int value) {
+        m_queue->setMaxCores(value);
+        updateCapacityLabel();
+        emit settingsChanged();
+    });
+    connect(m_tokensSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, [this](int value) {
+        m_queue->setLicenseTokens(value);
+        updateCapacityLabel();
+        emit settingsChanged();
+    });
+    connect(m_threadsSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, [this](int) {
+        updateCapacityLabel();
+        emit settingsChanged();
+    });
+    connect(m_preemptCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        m_queue->setAutoPreempt(checked);
+        emit settingsChanged();
+    });
+
+    refresh();
+}
+
+int JobQueueDock::threadsPerJob() const
+{
+    return m_threadsSpin->value();
+}
+
+void JobQueueDock::setThreadsPerJob(int threads)
+{
+    m_threadsSpin->setValue(threads);
+}
+
+int JobQueueDock::threadsForModel(const QString& modelId) const
+{
+    return m_modelThreads.value(modelId, threadsPerJob());
+}
+
+void JobQueueDock::setModelThreads(const QHash<QString, int>& threads)
+{
+    m_modelThreads = threads;
+}
+
+void JobQueueDock::refresh()
+{
+    // 队列参数可能在外部（启动时读取设置）被修改
+    {
+        const QSignalBlocker coresBlocker(m_coresSpin);
+        const QSignalBlocker tokensBlocker(m_tokensSpin);
+        const QSignalBlocker preemptBlocker(m_preemptCheck);
+        m_coresSpin->setValue(m_queue->maxCores());
+        m_tokensSpin->setValue(m_queue->licenseTokens());
+        m_preemptCheck->setChecked(m_queue->autoPreempt());
+    }
+
+    const QList<quint64> selected = selectedIds();
+    const QSet<quint64> selectedSet = QSet<quint64>(selected.begin(), selected.end());
+
+    // 重建列表时的 setText 不算用户修改
+    const QSignalBlocker listBlocker(m_list);
+    m_list->clear();
+    const QVector<JobQueue::Entry> entries = m_queue->entries();
+    for (const JobQueue::Entry& entry : entries)
+    {
+        auto* item = new QTreeWidgetItem(m_list);
+        if (entry.status == JobQueue::Queued)
+            item->setFlags(item->flags() | Qt::ItemIsEditable);
+        item->setText(0, entry.request.name);
+        item->setText(1, entryStatusText(entry));
+        item->setText(2, QString::number(entry.request.priority));
+        item->setText(3, QString::number(entry.status == JobQueue::Running
+                                             ? entry.allocatedThreads
+                                             : entry.request.threads));
+        item->setText(4, entry.enqueuedAt.toString("MM-dd HH:mm:ss"));
+        item->setText(5, elapsedText(entry));
+        item->setToolTip(0, entry.request.workingDirectory);
+        item->setToolTip(1, entry.message);
+        item->setData(0, Qt::UserRole, entry.id);
+        item->setData(1, Qt::UserRole, entry.request.modelId);
+        if (entry.status == JobQueue::Failed)
+            item->setForeground(1, QColor("#dc2626"));
+        else if (entry.status == JobQueue::Running && entry.suspended)
+            item->setForeground(1, QColor("#d97706"));
+        else if (entry.status == JobQueue::Running)
+            item->setForeground(1, QColor("#2563eb"));
+        if (selectedSet.contains(entry.id))
+            item->setSelected(true);
+    }
+    updateCapacityLabel();
+}
+
+void JobQueueDock::onItemChanged(QTreeWidgetItem* item, int column)
+{
+    if (column != 3)
+        return;
+    bool ok = false;
+    const int threads = item->text(3).trimmed().toInt(&ok);
+    const quint64 id = item->data(0, Qt::UserRole).toULongLong();
+    const QString modelId = item->data(1, Qt::UserRole).toString();
+    if (ok && threads >= 1 && m_queue->setThreads(id, threads))
+    {
+        if (!modelId.isEmpty())
+        {
+            if (threads == threadsPerJob())
+                m_modelThreads.remove(modelId);
+            else
+                m_modelThreads.insert(modelId, threads);
+            emit settingsChanged();
+        }
+        return;
+    }
+    // 无效输入或任务已开始时恢复为队列中的值；列表正在发出信号，稍后重建
+    QTimer::singleShot(0, this, &JobQueueDock::refresh);
+}
+
+void JobQueueDock::updateElapsed()
+{
+    if (!isVisible())
+        return;
+
+    QHash<quint64, JobQueue::Entry> running;
+    const QVector<JobQueue::Entry> entries = m_queue->entries();
+    for (const JobQueue::Entry& entry : entries)
+    {
+        if (entry.status == JobQueue::Running)
+            running.insert(entry.id, entry);
+    }
+    if (running.isEmpty())
+        return;
+
+    for (int i = 0; i < m_list->topLevelItemCount(); ++i)
+    {
+        QTreeWidgetItem* item = m_list->topLevelItem(i);
+        const auto it = running.constFind(item->data(0, Qt::UserRole).toULongLong());
+        if (it != running.constEnd())
+            item->setText(5, elapsedText(it.value()));
+    }
+}
+
+void JobQueueDock::updateCapacityLabel()
+{
+    int queued = 0;
+    int finished = 0;
+    const QVector<JobQueue::Entry> entries = m_queue->entries();
+    for (const JobQueue::Entry& entry : entries)
+    {
+        if (entry.status == JobQueue::Queued)
+            ++queued;
+        else if (entry.status != JobQueue::Running)
+            ++finished;
+    }
+
+    m_capacityLabel->setText(
+        tr("并发上限 %1 · 运行 %2 · 排队 %3 · 已结束 %4 · 占用 %5/%6 核")
+            .arg(m_queue->concurrencyLimit(threadsPerJob()))
+            .arg(m_queue->usedTokens())
+            .arg(queued)
+            .arg(finished)
+            .arg(m_queue->usedCores())
+            .arg(m_queue->maxCores()));
+}
+
+QList<quint64> JobQueueDock::selectedIds() const
+{
+    QList<quint64> ids;
+    const QList<QTreeWidgetItem*> items = m_list->selectedItems();
+    for (QTreeWidgetItem* item : items)
+        ids.append(item->data(0, Qt::UserRole).toULongLong());
+    return ids;
+}
+
+void JobQueueDock::cancelSelected()
+{
+    const QList<quint64> ids = selectedIds();
+    for (quint64 id : ids)
+        m_queue->cancel(id);
+}
+
+void JobQueueDock::suspendSelected()
+{
+    const QList<quint64> ids = selectedIds();
+    for (quint64 id : ids)
+        m_queue->suspend(id);
+}
+
+void JobQueueDock::resumeSelected()
+{
+    const QList<quint64> ids = selectedIds();
+    for (quint64 id : ids)
+        m_queue->resume(id);
+}
+
+void JobQueueDock::raiseSelectedPriority()
+{
+    adjustSelectedPriority(1);
+}
+
+void JobQueueDock::lowerSelectedPriority()
+{
+    adjustSelectedPriority(-1);
+}
+
+void JobQueueDock::adjustSelectedPriority(int delta)
+{
+    const QList<quint64> ids = selectedIds();
+    const QVector<JobQueue::Entry> entries = m_queue->entries();
+    for (const JobQueue::Entry& entry : entries)
+    {
+        if (ids.contains(entry.id) && entry.status == JobQueue::Queued)
+            m_queue->setPriority(entry.id, entry.request.priority + delta);
+    }
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <QDockWidget>
+#include <QHash>
+
+class JobQueue;
+class QCheckBox;
+class QLabel;
+class QSpinBox;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// 任务队列面板：显示排队/运行/完成的任务，并调整并发参数与优先级
+class JobQueueDock : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit JobQueueDock(JobQueue* queue, QWidget* parent = nullptr);
+
+    int threadsPerJob() const;
+    void setThreadsPerJob(int threads);
+    // 在列表中为某个模型改过的线程数，之后入队时沿用；没有改过时为每任务线程的默认值
+    int threadsForModel(const QString& modelId) const;
+    QHash<QString, int> modelThreads() const { return m_modelThreads; }
+    void setModelThreads(const QHash<QString, int>& threads);
+
+signals:
+    void settingsChanged();
+
+private slots:
+    void refresh();
+    void updateElapsed();
+    void cancelSelected();
+    void suspendSelected();
+    void resumeSelected();
+    void raiseSelectedPriority();
+    void lowerSelectedPriority();
+    void onItemChanged(QTreeWidgetItem* item, int column);
+
+private:
+    QList<quint64> selectedIds() const;
+    void adjustSelectedPriority(int delta);
+    void updateCapacityLabel();
+
+    JobQueue* m_queue = nullptr;
+    QTreeWidget* m_list = nullptr;
+    QLabel* m_capacityLabel = nullptr;
+    QSpinBox* m_coresSpin = nullptr;
+    QSpinBox* m_tokensSpin = nullptr;
+    QSpinBox* m_threadsSpin = nullptr;
+    QCheckBox* m_preemptCheck = nullptr;
+    QHash<QString, int> m_modelThreads;     // 模型 ID -> 线程数
+};
@@ -1,33 +1,18 @@
 ﻿#include "JsonPageBuilder.h"
+#include "SolverJob.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMessageBox>
+#include <QProgressBar>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonValue>
-#include <QProcess>
-#include <QRegularExpression>
-#include <QDateTime>
-#include <QTextStream>
 #include <QFileInfo>
-#include <QFileInfoList>
 #include <QStringList>
 #include <QDir>
 
-namespace
-{
-QFileInfo latestStlInfo(const QDir& dir)
-{
-    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.stl" << "*.STL",
-                                                  QDir::Files, QDir::Time | QDir::IgnoreCase);
-    if (!files.isEmpty())
-        return files.first();
-    return QFileInfo();
-}
-}
-
 static const char* kBtnQss =
     "QPushButton {"
     "  background-color: #e0e9f4;"
@@ -44,13 +29,6 @@ JsonPageBuilder::JsonPageBuilder(const QString& jsonPath, QWidget* parent)
     setWindowTitle(("广汽APP-Demo"));
     setMinimumWidth(500);
 
-    QFileInfo info(m_jsonPath);
-    if (info.exists())
-    {
-        m_datPath = info.dir().filePath(QStringLiteral("Job-2.dat"));
-        m_msgPath = info.dir().filePath(QStringLiteral("Job-2.msg"));
-    }
-
     QJsonArray sections;
     if (!loadJson(m_jsonPath, sections))
     {
@@ -124,7 +102,51 @@ void JsonPageBuilder::buildUiFromJson(const QJsonArray& sections)
     connect(m_calculateButton, &QPushButton::clicked,
             this, &JsonPageBuilder::onCalculateButtonClicked);
 
-    mainLayout->addWidget(m_calculateButton);
+    m_cancelButton = new QPushButton(("取消计算"), this);
+    m_cancelButton->setMinimumHeight(40);
+    m_cancelButton->setEnabled(false);
+    connect(m_cancelButton, &QPushButton::clicked,
+            this, &JsonPageBuilder::onCancelButtonClicked);
+
+    m_pauseButton = new QPushButton(tr("暂停"), this);
+    m_pauseButton->setMinimumHeight(40);
+    m_pauseButton->setEnabled(false);
+    m_pauseButton->setToolTip(tr("暂停求解进程，已完成的增量步保留，继续后从暂停处接着计算"));
+    connect(m_pauseButton, &QPushButton::clicked,
+            this, &JsonPageBuilder::onPauseButtonClicked);
+
+    auto* sweepButton = new QPushButton(tr("参数扫描..."), this);
+    sweepButton->setMinimumHeight(40);
+    connect(sweepButton, &QPushButton::clicked,
+            this, &JsonPageBuilder::onSweepButtonClicked);
+
+    auto* runRow = new QHBoxLayout();
+    runRow->addWidget(m_calculateButton, 2);
+    runRow->addWidget(m_pauseButton, 1);
+    runRow->addWidget(m_cancelButton, 1);
+    runRow->addWidget(sweepButton, 1);
+    mainLayout->addLayout(runRow);
+
+    m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setTextVisible(true);
+    m_progressBar->hide();
+    mainLayout->addWidget(m_progressBar);
+
+    m_problemBanner = new QLabel(this);
+    m_problemBanner->setWordWrap(true);
+    m_problemBanner->setStyleSheet("background:#fef2f2;border:1px solid #fca5a5;"
+                                   "border-radius:6px;color:#b91c1c;padding:8px;");
+    m_problemBanner->hide();
+    mainLayout->addWidget(m_problemBanner);
+
+    m_usageLabel = new QLabel(this);
+    m_usageLabel->setWordWrap(true);
+    m_usageLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_usageLabel->setStyleSheet("background:#f8fafc;border:1px solid #e2e8f0;"
+                                "border-radius:6px;color:#334155;padding:8px;");
+    m_usageLabel->hide();
+    mainLayout->addWidget(m_usageLabel);
     mainLayout->addStretch(1);
     setLayout(mainLayout);
     resize(400, 600);
@@ -231,154 +253,175 @@ QJsonValue JsonPageBuilder::strictConvert(const QString& text)
     return text;
 }
 
-QString JsonPageBuilder::readWholeFile(const QString& path)
+void JsonPageBuilder::onCalculateButtonClicked()
 {
-    QFile f(path);
-    if (!f.exists()) return QString();
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
-        return QString();
-    QTextStream ts(&f);
-    ts.setCodec("UTF-8");
-    const QString s = ts.readAll();
-    return s;
-}
+    if (m_queued || (m_job && m_job->isRunning()))
+        return;
 
-QString JsonPageBuilder::cleanText(QString s)
-{
-    // 去掉重复空格
-    s.replace(QRegularExpression("\\s+"), " ");
-    s = s.trimmed();
-    return s;
-}
+    emit logMessage(tr("开始计算，保存参数到 %1")
+                        .arg(QDir::toNativeSeparators(m_jsonPath)));
 
-QString JsonPageBuilder::extractErrorMsgFromMsg(const QString& content)
-{
-    // 匹配 ERROR: 到 ANALYSIS SUMMARY 之间的内容（非贪婪）
-    QRegularExpression re("ERROR:(.*?)(ANALYSIS SUMMARY|$)",
-                          QRegularExpression::DotMatchesEverythingOption);
-    auto it = re.globalMatch(content);
-    QString last;
-    while (it.hasNext()) {
-        auto m = it.next();
-        last = m.captured(1);
+    // 1) 先保存 JSON
+    if (!saveJson(m_jsonPath)) {
+        const QString warn = tr("保存 JSON 失败：%1")
+                                 .arg(QDir::toNativeSeparators(m_jsonPath));
+        emit logMessage(warn);
+        QMessageBox::warning(this, tr("警告"), warn);
+        return;
     }
-    return cleanText(last);
+
+    emit logMessage(tr("已保存参数，提交到计算队列"));
+
+    // 2) 由主窗口放入任务队列，开始运行后通过 attachJob 回传
+    emit calculationRequested();
 }
 
-QString JsonPageBuilder::extractErrorMsgFromDat(const QString& content)
+void JsonPageBuilder::onCancelButtonClicked()
 {
-    // 匹配 ERROR: 到 NOTE 之间的内容（非贪婪）
-    QRegularExpression re("ERROR:(.*?)(NOTE|$)",
-                          QRegularExpression::DotMatchesEverythingOption);
-    auto it = re.globalMatch(content);
-    QString last;
-    while (it.hasNext()) {
-        auto m = it.next();
-        last = m.captured(1);
+    if (m_job && m_job->isRunning())
+    {
+        emit logMessage(tr("正在取消计算..."));
+        m_job->cancel();
+    }
+    else if (m_queued)
+    {
+        emit cancelRequested();
     }
-    return cleanText(last);
 }
 
-void JsonPageBuilder::onCalculateButtonClicked()
+void JsonPageBuilder::onPauseButtonClicked()
 {
-    m_calculateButton->setEnabled(false);
-    const QString now = QDateTime::currentDateTime()
-                        .toString("yyyy-MM-dd HH:mm:ss");
-
-    QFileInfo jsonInfo(m_jsonPath);
-    QDir workingDir = jsonInfo.exists() ? jsonInfo.dir() : QDir();
-    QFileInfo previousStl = jsonInfo.exists() ? latestStlInfo(workingDir) : QFileInfo();
-
-    emit logMessage(tr("开始计算，保存参数到 %1")
-                        .arg(QDir::toNativeSeparators(m_jsonPath)));
+    if (!m_job || !m_job->isRunning())
+        return;
+    // 通过任务队列暂停，队列才能把核数让给其他任务
+    if (m_job->isSuspended())
+        emit resumeRequested();
+    else
+        emit pauseRequested();
+}
 
-    // 1) 先保存 JSON
+void JsonPageBuilder::onSweepButtonClicked()
+{
+    // 变体以磁盘上的参数文件为基准，先把界面上的修改写回
     if (!saveJson(m_jsonPath)) {
         const QString warn = tr("保存 JSON 失败：%1")
                                  .arg(QDir::toNativeSeparators(m_jsonPath));
         emit logMessage(warn);
         QMessageBox::warning(this, tr("警告"), warn);
-        m_calculateButton->setEnabled(true);
         return;
     }
+    emit sweepRequested();
+}
+
+void JsonPageBuilder::setQueued(bool queued)
+{
+    m_queued = queued;
+    updateRunButtons();
+}
 
-    emit logMessage(tr("已保存参数，开始执行计算脚本"));
-
-    // 2) 执行外部命令（Windows 下：cmd /c calculate.bat）
-    int exitCode = -1;
-    QString stderrText, stdoutText;
-    QProcess process;
-    if (jsonInfo.exists())
-        process.setWorkingDirectory(workingDir.absolutePath());
-    process.setProcessChannelMode(QProcess::MergedChannels);
-    process.start("cmd", QStringList() << "/c" << "calculate.bat");
-    const bool finished = process.waitForFinished(-1);
-    stdoutText = QString::fromLocal8Bit(process.readAllStandardOutput());
-    stderrText = QString::fromLocal8Bit(process.readAllStandardError());
-    exitCode = finished ? process.exitCode() : -1;
-
-    if (!finished) {
-        emit logMessage(tr("计算脚本执行异常：%1")
-                            .arg(process.errorString()));
+void JsonPageBuilder::setLastRunUsage(const ResourceUsage& usage)
+{
+    if (!usage.valid)
+    {
+        m_usageLabel->hide();
+        return;
     }
+    QString text = tr("上次运行：%1").arg(usage.summaryText());
+    const QString hint = usage.boundHint();
+    if (!hint.isEmpty())
+        text += QStringLiteral("\n") + hint;
+    m_usageLabel->setText(text);
+    m_usageLabel->show();
+}
 
-    if (!stdoutText.trimmed().isEmpty())
-        emit logMessage(tr("输出：%1").arg(stdoutText.trimmed()));
-    if (!stderrText.trimmed().isEmpty())
-        emit logMessage(tr("错误：%1").arg(stderrText.trimmed()));
+void JsonPageBuilder::attachJob(SolverJob* job)
+{
+    if (m_job)
+        m_job->disconnect(this);
 
-    QString message;
-    if (exitCode == 0) {
-        message = tr("计算成功，时间：%1").arg(now);
+    m_job = job;
+    m_problemBanner->hide();
+    if (job)
+    {
+        m_queued = false;
+        connect(job, &SolverJob::finished, this, &JsonPageBuilder::onJobFinished);
+        connect(job, &SolverJob::progressChanged, this, &JsonPageBuilder::onJobProgress);
+        connect(job, &SolverJob::problemDetected, this, &JsonPageBuilder::onJobProblem);
+        connect(job, &SolverJob::suspendedChanged, this, &JsonPageBuilder::updateRunButtons);
+        // 页面可能在计算中途重新打开，先显示已解析到的状态
+        if (job->isRunning())
+        {
+            m_progressBar->setRange(0, 0);
+            m_progressBar->setFormat(tr("等待求解器输出..."));
+            m_progressBar->show();
+            if (job->progress().step > 0)
+                onJobProgress(job->progress());
+        }
     }
+    updateRunButtons();
+}
 
-    // 3) 检测 .msg
-    if (QFile::exists(m_msgPath)) {
-        const QString all = readWholeFile(m_msgPath);
-        const QString err = extractErrorMsgFromMsg(all);
-        if (!err.isEmpty()) {
-            message = tr("错误信息：%1 时间：%2").arg(err, now);
-        }
+void JsonPageBuilder::onJobProgress(const SolverProgress& progress)
+{
+    if (progress.step <= 0)
+        return;
+
+    QString text = tr("分析步 %1，增量步 %2").arg(progress.step).arg(progress.increment);
+    if (progress.stepFraction >= 0.0)
+    {
+        m_progressBar->setRange(0, 100);
+        m_progressBar->setValue(qRound(progress.stepFraction * 100.0));
+        text += tr("，本步完成 %p%");
     }
-    // 4) 否则检测 .dat
-    else if (QFile::exists(m_datPath)) {
-        const QString all = readWholeFile(m_datPath);
-        QString err = extractErrorMsgFromDat(all);
-        if (!err.isEmpty()) {
-            message = tr("错误信息：%1 时间：%2").arg(err, now);
-        }
+    else
+    {
+        m_progressBar->setRange(0, 0);
     }
+    if (progress.warningCount > 0)
+        text += tr("，警告 %1 条").arg(progress.warningCount);
+    m_progressBar->setFormat(text);
+    m_progressBar->show();
+}
 
-    if (message.isEmpty()) {
-        // 兜底信息：既无错误也无成功码
-        message = tr("计算结束，退出码 %1 时间：%2")
-                      .arg(exitCode)
-                      .arg(now);
-        if (!stderrText.trimmed().isEmpty())
-            message += QStringLiteral("\n%1").arg(stderrText.trimmed());
-    }
+void JsonPageBuilder::onJobProblem(const QString& message)
+{
+    m_problemBanner->setText(tr("求解器已报告错误，本次计算很可能失败，可点击“取消计算”提前终止。\n%1")
+                                 .arg(message.left(500)));
+    m_problemBanner->show();
+}
 
-    emit logMessage(message);
-
-    QFileInfo latestStl = jsonInfo.exists() ? latestStlInfo(workingDir) : QFileInfo();
-    QString newStlPath;
-    if (latestStl.exists()) {
-        const bool isNewFile = !previousStl.exists() ||
-                               latestStl.absoluteFilePath() != previousStl.absoluteFilePath();
-        const bool isUpdated = previousStl.exists() &&
-                               latestStl.absoluteFilePath() == previousStl.absoluteFilePath() &&
-                               latestStl.lastModified() > previousStl.lastModified();
-        if (isNewFile || isUpdated)
-        {
-            newStlPath = latestStl.absoluteFilePath();
-            emit logMessage(tr("检测到新的 STL 输出：%1")
-                                .arg(QDir::toNativeSeparators(newStlPath)));
-        }
-    }
+void JsonPageBuilder::onJobFinished()
+{
+    if (!m_job)
+        return;
 
-    emit calculationFinished(newStlPath);
+    const QString message = m_job->result().message;
+    setLastRunUsage(m_job->result().usage);
+    m_job = nullptr;
+    m_progressBar->hide();
+    updateRunButtons();
 
     QMessageBox::information(this, tr("提示框"),
                              message, QMessageBox::Ok);
-    m_calculateButton->setEnabled(true);
+}
+
+void JsonPageBuilder::updateRunButtons()
+{
+    const bool running = m_job && m_job->isRunning();
+    if (m_calculateButton)
+    {
+        m_calculateButton->setEnabled(!running && !m_queued);
+        m_calculateButton->setText(m_queued ? tr("排队中...")
+                                            : running ? tr("计算中...") : tr("计算"));
+    }
+    if (m_cancelButton)
+        m_cancelButton->setEnabled(running || m_queued);
+    if (m_pauseButton)
+    {
+        const bool suspended = running && m_job->isSuspended();
+        m_pauseButton->setEnabled(running);
+        m_pauseButton->setText(suspended ? tr("继续") : tr("暂停"));
+    }
+    if (m_calculateButton && running && m_job->isSuspended())
+        m_calculateButton->setText(tr("已暂停"));
 }
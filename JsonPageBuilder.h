@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <QWidget>
+#include <QPointer>
 #include <QVector>
 #include <QPushButton>
 #include <QLabel>
@@ -8,6 +9,11 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+class QProgressBar;
+class SolverJob;
+struct ResourceUsage;
+struct SolverProgress;
+
 class JsonPageBuilder : public QWidget
 {
     Q_OBJECT
@@ -15,26 +21,41 @@ public:
     explicit JsonPageBuilder(const QString& jsonPath,
                              QWidget* parent = nullptr);
 
+    // 绑定正在运行的计算任务，页面据此切换按钮状态并在结束时提示
+    void attachJob(SolverJob* job);
+    void setQueued(bool queued);
+    // 显示最近一次运行的资源消耗；无效时隐藏
+    void setLastRunUsage(const ResourceUsage& usage);
+
+    // 读取参数文件：支持顶层数组或 {"data": [...]} 两种格式
+    static bool loadJson(const QString& path, QJsonArray& outSections);
+    static QJsonValue strictConvert(const QString& text);
+
 signals:
     void logMessage(const QString& message);
-    void calculationFinished(const QString& stlPath);
+    void calculationRequested();
+    void cancelRequested();
+    void pauseRequested();
+    void resumeRequested();
+    void sweepRequested();
 
 private slots:
     void onCalculateButtonClicked();
+    void onCancelButtonClicked();
+    void onPauseButtonClicked();
+    void onSweepButtonClicked();
+    void onJobFinished();
+    void onJobProgress(const SolverProgress& progress);
+    void onJobProblem(const QString& message);
 
 private:
     void buildUiFromJson(const QJsonArray& sections);
-    bool loadJson(const QString& path, QJsonArray& outSections);
     bool saveJson(const QString& path);
     void applyEditToJson(QJsonArray& sections,
                          const QString& title,
                          const QString& cnName,
                          const QString& valueText);
-    static QJsonValue strictConvert(const QString& text);
-    static QString readWholeFile(const QString& path);
-    static QString extractErrorMsgFromMsg(const QString& content);
-    static QString extractErrorMsgFromDat(const QString& content);
-    static QString cleanText(QString s);
+    void updateRunButtons();
 
 private:
     // 对应 Python 中的三个列表
@@ -43,8 +64,13 @@ private:
     QVector<QVector<QLineEdit*>> m_labelDataWidgets;     // 每组内的输入框（值）
 
     QPushButton* m_calculateButton = nullptr;
+    QPushButton* m_cancelButton = nullptr;
+    QPushButton* m_pauseButton = nullptr;
+    QProgressBar* m_progressBar = nullptr;
+    QLabel* m_problemBanner = nullptr;
+    QLabel* m_usageLabel = nullptr;
+    QPointer<SolverJob> m_job;
+    bool m_queued = false;
 
     QString m_jsonPath;                                   // para.json
-    QString m_datPath = QStringLiteral("Job-2.dat");
-    QString m_msgPath = QStringLiteral("Job-2.msg");
 };
@@ -2,27 +2,62 @@
 
 #include <QMainWindow>
 #include <QPointer>
+#include <QSharedPointer>
 #include <QVector>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QSet>
 #include <QPixmap>
 #include <QUrl>
 #include <QDir>
 #include <QPair>
 #include <QList>
+#include <atomic>
+#include <memory>
 #include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+#include "GeometryCache.h"
+#include "GeometryLod.h"
+#include "PersistenceWorker.h"
+#include "ProjectRegistry.h"
+#include "ProjectValidator.h"
+#include "ProjectTypes.h"
+#include "RunJournal.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
+class QAction;
+class QComboBox;
+class QFrame;
+class QLabel;
+class QSlider;
+class QTimer;
 class QTreeWidgetItem;
 class QWidget;
 class QShortcut;
 class SchemeGalleryWidget;
+class GeometryDiskCache;
+class GeometryLoader;
+class ThumbnailService;
+namespace GeometryDiff { struct Result; }
 class JsonPageBuilder;
+class JobQueue;
+class JobQueueDock;
+class ResultCache;
+class SolverJob;
+class SweepResultsDialog;
 class vtkGenericOpenGLRenderWindow;
 class vtkRenderer;
-class vtkActor;
+class vtkLookupTable;
+class vtkScalarBarActor;
+class vtkLODProp3D;
+class vtkPolyData;
+class vtkPolyDataMapper;
+class vtkProp3D;
+class vtkProperty;
 
 class MainWindow : public QMainWindow
 {
@@ -31,6 +66,9 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void closeEvent(QCloseEvent* event) override;
+
 private slots:
     void handleTreeSelectionChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous);
     void onTreeItemChanged(QTreeWidgetItem* item, int column);
@@ -46,14 +84,8 @@ private slots:
     void onAddLibraryScheme();
 
 private:
-    struct ModelRecord {
-        QString id;
-        QString name;
-        QString directory;
-        QString jsonPath;
-        QString batPath;
-        QString remarks;
-    };
+    using ModelRecord = ::ModelRecord;
+    using SchemeRecord = ::SchemeRecord;
 
     struct SchemeLibraryEntry {
         QString id;
@@ -63,19 +95,11 @@ private:
         bool deletable = false;
     };
 
-    struct SchemeRecord {
-        QString id;
-        QString name;
-        QString workingDirectory;
-        QString thumbnailPath;
-        QString remarks;
-        QVector<ModelRecord> models;
-    };
-
     enum TreeRoles {
         TypeRole = Qt::UserRole,
         IdRole,
-        SchemeRole
+        SchemeRole,
+        RunStateRole
     };
 
     enum TreeItemType {
@@ -86,6 +110,9 @@ private:
     };
 
     void setupUiHelpers();
+    void setupJobQueue();
+    void setupCatalogActions();
+    void resetResultCache();
     void setupConnections();
     void loadInitialSchemes();
     void loadApplicationState();
@@ -111,7 +138,62 @@ private:
     void updateSelectionInfo(const QString& path = QString(),
                              const QString& remark = QString());
     void appendLogMessage(const QString& message);
-    void displayStlFile(const QString& filePath);
+    void startModelCalculation(const QString& modelId);
+    int enqueueModels(const QStringList& modelIds, int priority, bool useCache = true,
+                      bool urgent = false);
+    void enqueueScheme(const QString& schemeId);
+    void enqueueSelectedModels();
+    QStringList selectedModelIds() const;
+    void runParameterSweep(const QString& modelId);
+    void showRunHistory(const QString& modelId);
+    // 最近一次运行只从运行日志末尾读取一次，之后由任务结束时更新
+    RunRecord latestRun(const ModelRecord& model);
+    // 在后台读取运行日志的最后一条，读完后更新模型节点
+    void requestLatestRun(const ModelRecord& model);
+    void updateModelItemStatus(const ModelRecord& model);
+    void updateSchemeItemStatus(const SchemeRecord& scheme);
+    // 后台路径检查的结果：更正规范化后不同的路径，标记缺失的目录，补上运行状态与缩略图
+    void applyValidationBatch(const ProjectValidator::Batch& batch);
+    void refreshModelRunStates();
+    QIcon modelIdleIcon(const QString& modelId);
+    QPixmap schemeModelThumbnail(const SchemeRecord& scheme);
+    void onThumbnailReady(const QString& modelId);
+    void onSolverJobStarted(const QString& modelId, SolverJob* job);
+    void onSolverJobFinished(const QString& modelId, SolverJob* job);
+    // 在后台加载，加载完成后再替换三维视图中的模型
+    // 结果格式由 ResultReaderRegistry 决定；带时间维度的结果只读取 timeStep 指定的一步
+    // liveFrame 为求解过程中的中间结果，不放入缓存
+    void displayResultFile(const QString& filePath, bool resetCamera = true, int timeStep = 0,
+                           bool liveFrame = false);
+    void setupResultBar();
+    // 按当前结果的字段与时间步刷新三维视图下方的控制条
+    void updateResultControls();
+    void updateTimeStepLabel(int step);
+    void applyFieldColoring();
+    void showGeometry(const QString& filePath, const GeometryCache::Key& key,
+                      const GeometryCache::Entry& entry, qint64 elapsedMs);
+    // 在后台为大模型生成交互用的简化层级
+    void requestCoarseLod(const GeometryCache::Key& key, vtkPolyData* polyData,
+                          vtkLODProp3D* lod, vtkProperty* property);
+    void addCoarseLod(vtkLODProp3D* lod, vtkPolyDataMapper* mapper, vtkProperty* property);
+    vtkSmartPointer<vtkProp3D> createGeometryProp(const GeometryCache::Key& key,
+                                                  const GeometryCache::Entry& entry);
+    QString latestResultStl(const ModelRecord& model);
+    // 多个结果按网格排列在同一渲染窗口的多个视口中，共用一个相机
+    void showComparison(const QStringList& modelIds);
+    // groups 为内容相同的视口下标，每组读取一次
+    void loadComparisonGroups(const QStringList& paths, const QVector<QVector<int>>& groups);
+    void attachComparisonGeometry(const QVector<int>& views, const GeometryCache::Key& key,
+                                  const GeometryCache::Entry& entry);
+    void leaveComparison();
+    // 第一个模型为基准，计算第二个模型每个顶点到基准表面的有符号距离并着色显示
+    void compareGeometry(const QString& referenceId, const QString& targetId);
+    void showGeometryDiff(const QString& referenceName, const QString& targetName,
+                          const GeometryDiff::Result& result);
+    void applyLodSettings();
+    void updateGeometryCacheStatus();
+    void setGeometryLoading(bool loading);
+    void showLiveFrame(const QString& modelId, const QString& filePath);
     void clearVtkScene();
     QString projectDisplayName() const;
 
@@ -160,10 +242,15 @@ private:
     QString makeUniqueModelName(const SchemeRecord& scheme, const QString& desired,
                                 const QString& excludeId = QString()) const;
     void ensureUniqueModelNames(SchemeRecord& scheme) const;
-    void ensureUniqueSchemeAndModelNames();
+    void ensureUniqueSchemeAndModelNames(QVector<SchemeRecord>& schemes) const;
     bool loadSchemesFromStorage();
-    void saveSchemesToStorage() const;
-    void persistSchemes() const;
+    void saveSchemesToStorage();
+    void persistSchemes();
+    void logPersistenceStats();
+    // catalog.sqlite 存在时代替 schemes.json；下面三项对应“工程”菜单中的目录操作
+    void migrateProjectToCatalog();
+    void exportSchemesToJson();
+    void showFailedRuns();
     QString makeUniqueWorkspaceSubdir(const QString& baseName) const;
     QString workspaceRoot() const;
 
@@ -171,9 +258,31 @@ private:
     SchemeGalleryWidget* m_galleryWidget = nullptr;
     QWidget* m_currentDetailWidget = nullptr;
     QVector<SchemeLibraryEntry> m_librarySchemes;
-    QVector<SchemeRecord> m_schemes;
+    ProjectRegistry m_registry;
+    PersistenceWorker* m_persistence = nullptr;     // 状态文件在后台合并写入
+    PersistenceWorker::Stats m_reportedPersistence;
+    ProjectValidator* m_validator = nullptr;
+    QSet<QString> m_unvalidatedSchemes;                 // 工作目录尚未规范化的方案
+    QSet<QString> m_unvalidatedModels;                  // 打开工程后尚未检查到的模型
+    QSet<QString> m_missingPaths;                       // 目录或参数文件不存在的方案与模型 ID
+    int m_correctedPaths = 0;
+    QElapsedTimer m_openTimer;
+    QAction* m_migrateCatalogAction = nullptr;
+    QAction* m_exportJsonAction = nullptr;
+    QAction* m_failedRunsAction = nullptr;
     QHash<QString, QTreeWidgetItem*> m_schemeItems;
     QHash<QString, QTreeWidgetItem*> m_modelItems;
+    JobQueue* m_jobQueue = nullptr;
+    JobQueueDock* m_jobDock = nullptr;
+    QSharedPointer<ResultCache> m_resultCache;
+    bool m_resultCacheEnabled = true;
+    int m_resultCacheLimitMb = 2048;
+    QPointer<JsonPageBuilder> m_currentBuilder;
+    QString m_currentBuilderModelId;
+    QList<QPointer<SweepResultsDialog>> m_sweepDialogs;
+    QString m_pendingLiveFrame;                       // 等待加载的中间结果
+    QHash<QString, RunRecord> m_latestRuns;             // modelId -> 运行日志中的最后一条记录
+    QSet<QString> m_loadingRuns;                        // 正在后台读取运行日志的模型
     QTreeWidgetItem* m_libraryRootItem = nullptr;
     QTreeWidgetItem* m_projectRootItem = nullptr;
     QString m_activeSchemeId;
@@ -187,7 +296,40 @@ private:
     QString m_baseWindowTitle;
     vtkSmartPointer<vtkGenericOpenGLRenderWindow> m_renderWindow;
     vtkSmartPointer<vtkRenderer> m_renderer;
-    vtkSmartPointer<vtkActor> m_currentActor;
+    vtkSmartPointer<vtkProp3D> m_currentProp;
+    LodSettings m_lodSettings;
+    // 正在简化的模型 -> 等待简化结果的 LOD 与其材质
+    QHash<QString, QVector<QPair<vtkWeakPointer<vtkLODProp3D>, vtkSmartPointer<vtkProperty>>>> m_pendingLods;
+    QSharedPointer<GeometryDiskCache> m_geometryDiskCache;
+    struct ComparisonView {
+        QString modelId;
+        vtkSmartPointer<vtkRenderer> renderer;
+    };
+    QVector<ComparisonView> m_comparisonViews;
+    QList<GeometryLoader*> m_comparisonLoaders;
+    QString m_resultPath;                               // 主视图当前显示的结果文件
+    int m_resultTimeStep = 0;
+    QHash<QString, QVector<double>> m_resultTimeSteps;  // 结果文件 -> 时间步的时间值
+    GeometryCache::Entry m_currentEntry;
+    QString m_colorField;                               // "p:名称" 或 "c:名称"，空为纯色
+    QFrame* m_resultBar = nullptr;
+    QComboBox* m_fieldCombo = nullptr;
+    QSlider* m_timeSlider = nullptr;
+    QLabel* m_timeLabel = nullptr;
+    QTimer* m_timeStepTimer = nullptr;
+    vtkSmartPointer<vtkLookupTable> m_fieldLut;
+    vtkSmartPointer<vtkScalarBarActor> m_fieldScalarBar;
+    std::shared_ptr<std::atomic_bool> m_diffCancel;     // 正在进行的形状差异计算，新请求会作废旧的
+    GeometryLoader* m_geometryLoader = nullptr;
+    ThumbnailService* m_thumbnails = nullptr;
+    bool m_pendingCameraReset = true;                   // 正在加载的模型显示后是否重置视角
+    bool m_pendingCacheInsert = true;                   // 正在加载的模型是否放入几何缓存
+    int m_geometryCacheLimitMb = 1024;
+    int m_geometryDiskCacheLimitMb = 4096;             // 工程内 .flexcache/geometry 的容量上限
+    QLabel* m_geometryCacheLabel = nullptr;
+    QLabel* m_loadingOverlay = nullptr;
+    QTimer* m_loadingOverlayTimer = nullptr;
+    int m_loggedLoadProgress = 0;                       // 已写入日志的加载进度，按 25% 一档
     QList<int> m_lastSplitterSizes;
     bool m_visualizationVisible = false;
 };
@@ -0,0 +1,98 @@
+﻿#include "ModelFiles.h"
+#include "ResultReaderRegistry.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSet>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ModelFiles
+{
+bool isSolverOutput(const QFileInfo& info)
+{
+    static const QSet<QString> outputSuffixes = {
+        QStringLiteral("stl"), QStringLiteral("msg"), QStringLiteral("dat"),
+        QStringLiteral("odb"), QStringLiteral("sta"), QStringLiteral("log"),
+        QStringLiteral("lck"), QStringLiteral("res"), QStringLiteral("prt"),
+        QStringLiteral("com"), QStringLiteral("sim"), QStringLiteral("mdl"),
+        QStringLiteral("stt"), QStringLiteral("023"), QStringLiteral("ipm"),
+        QStringLiteral("vtp"), QStringLiteral("vtu")
+    };
+    return outputSuffixes.contains(info.suffix().toLower());
+}
+
+bool isReadOnlyInput(const QFileInfo& info)
+{
+    static const QSet<QString> meshSuffixes = {
+        QStringLiteral("msh"), QStringLiteral("mesh"), QStringLiteral("nas"),
+        QStringLiteral("bdf"), QStringLiteral("cdb"), QStringLiteral("unv"),
+        QStringLiteral("obj"), QStringLiteral("step"), QStringLiteral("stp"),
+        QStringLiteral("igs"), QStringLiteral("iges"), QStringLiteral("x_t"),
+        QStringLiteral("sat")
+    };
+    return meshSuffixes.contains(info.suffix().toLower());
+}
+
+QFileInfoList inputFiles(const QString& modelDir)
+{
+    QFileInfoList files;
+    const QDir root(modelDir);
+    QDirIterator it(modelDir, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const QString relative = root.relativeFilePath(info.absoluteFilePath());
+        if (relative.startsWith(QLatin1Char('.')) || relative.contains(QStringLiteral("/.")))
+            continue;
+        if (isSolverOutput(info))
+            continue;
+        files.append(info);
+    }
+
+    std::sort(files.begin(), files.end(), [&root](const QFileInfo& a, const QFileInfo& b) {
+        return root.relativeFilePath(a.absoluteFilePath()) <
+               root.relativeFilePath(b.absoluteFilePath());
+    });
+    return files;
+}
+
+QString solverDirectory(const ModelRecord& model)
+{
+    const QFileInfo jsonInfo(model.jsonPath);
+    return jsonInfo.exists() ? jsonInfo.absolutePath() : model.directory;
+}
+
+QString latestResultFile(const QString& directory)
+{
+    QDir dir(directory);
+    const QFileInfoList files = dir.entryInfoList(ResultReaderRegistry::instance().nameFilters(),
+                                                  QDir::Files, QDir::Time | QDir::IgnoreCase);
+    if (!files.isEmpty())
+        return files.first().absoluteFilePath();
+    return QString();
+}
+
+bool linkOrCopyFile(const QString& sourcePath, const QString& targetPath)
+{
+    QFile::remove(targetPath);
+#ifdef Q_OS_WIN
+    if (::CreateHardLinkW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(targetPath).utf16()),
+                          reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(sourcePath).utf16()),
+                          nullptr))
+        return true;
+#else
+    if (::link(QFile::encodeName(sourcePath).constData(),
+               QFile::encodeName(targetPath).constData()) == 0)
+        return true;
+#endif
+    return QFile::copy(sourcePath, targetPath);
+}
+}
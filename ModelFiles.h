@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include <QFileInfo>
+#include <QFileInfoList>
+#include <QString>
+
+#include "ProjectTypes.h"
+
+// 模型目录中输入文件与求解输出文件的区分，以及文件的廉价复制
+namespace ModelFiles
+{
+// 求解器生成的结果/过程文件（STL、.msg、.dat 等），不属于模型输入
+bool isSolverOutput(const QFileInfo& info);
+
+// 网格与几何文件（.msh、.nas、.step 等）。按约定只被求解器读取、不会被原地修改，
+// 可以在模型副本之间用硬链接共享；参数文件、脚本与求解器输入卡片不在此列
+bool isReadOnlyInput(const QFileInfo& info);
+
+// 模型目录下的全部输入文件（递归，跳过隐藏目录与求解输出），按相对路径排序
+QFileInfoList inputFiles(const QString& modelDir);
+
+// 求解脚本在参数文件所在目录运行，运行日志也写在这里
+QString solverDirectory(const ModelRecord& model);
+
+// 目录中最新的结果文件，仅用于还没有运行日志的旧模型
+QString latestResultFile(const QString& directory);
+
+// 优先创建硬链接，失败（跨卷、文件系统不支持）时退回普通复制。
+// 硬链接的两端是同一份数据，只能用于双方都不会原地修改的文件
+bool linkOrCopyFile(const QString& sourcePath, const QString& targetPath);
+}
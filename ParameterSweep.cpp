@@ -0,0 +1,225 @@
+﻿#include "ParameterSweep.h"
+#include "ModelFiles.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <numeric>
+
+QVector<QVector<QJsonValue>> ParameterSweep::generate(const QVector<SweepParameter>& parameters,
+                                                      Method method,
+                                                      int sampleCount,
+                                                      quint32 seed)
+{
+    QVector<QVector<QJsonValue>> rows;
+    if (parameters.isEmpty())
+        return rows;
+
+    if (method == FullFactorial)
+    {
+        QVector<QVector<QJsonValue>> levels;
+        for (const SweepParameter& parameter : parameters)
+        {
+            levels.push_back(levelValues(parameter));
+            if (levels.last().isEmpty())
+                return rows;
+        }
+
+        // 逐位进位的计数器遍历全部组合，最后一个参数变化最快
+        QVector<int> cursor(parameters.size(), 0);
+        for (;;)
+        {
+            QVector<QJsonValue> row;
+            row.reserve(parameters.size());
+            for (int i = 0; i < parameters.size(); ++i)
+                row.push_back(levels[i][cursor[i]]);
+            rows.push_back(row);
+
+            int digit = parameters.size() - 1;
+            while (digit >= 0 && ++cursor[digit] >= levels[digit].size())
+            {
+                cursor[digit] = 0;
+                --digit;
+            }
+            if (digit < 0)
+                break;
+        }
+        return rows;
+    }
+
+    const int n = qMax(1, sampleCount);
+    QRandomGenerator rng(seed);
+    rows.resize(n);
+    for (QVector<QJsonValue>& row : rows)
+        row.resize(parameters.size());
+
+    for (int p = 0; p < parameters.size(); ++p)
+    {
+        if (method == LatinHypercube)
+        {
+            // 每个参数的 [0,1) 区间等分为 n 层，每层恰好取一个点，层的顺序随机
+            QVector<int> strata(n);
+            std::iota(strata.begin(), strata.end(), 0);
+            std::shuffle(strata.begin(), strata.end(), rng);
+            for (int i = 0; i < n; ++i)
+            {
+                const double unit = (strata[i] + rng.generateDouble()) / n;
+                rows[i][p] = sampleAt(parameters[p], unit);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < n; ++i)
+                rows[i][p] = sampleAt(parameters[p], rng.generateDouble());
+        }
+    }
+    return rows;
+}
+
+QJsonArray ParameterSweep::applyValues(const QJsonArray& sections,
+                                       const QVector<SweepParameter>& parameters,
+                                       const QVector<QJsonValue>& values)
+{
+    QJsonArray result = sections;
+    for (int p = 0; p < parameters.size() && p < values.size(); ++p)
+    {
+        const SweepParameter& parameter = parameters[p];
+        for (int i = 0; i < result.size(); ++i)
+        {
+            QJsonObject sec = result[i].toObject();
+            if (sec.value("title").toString() != parameter.section)
+                continue;
+
+            QJsonArray dataArr = sec.value("data").toArray();
+            for (int j = 0; j < dataArr.size(); ++j)
+            {
+                QJsonObject item = dataArr[j].toObject();
+                if (item.value("cn_name").toString() == parameter.name)
+                {
+                    item["value"] = values[p];
+                    dataArr[j] = item;
+                }
+            }
+            sec["data"] = dataArr;
+            result[i] = sec;
+        }
+    }
+    return result;
+}
+
+bool ParameterSweep::materialiseVariant(const QString& sourceDir,
+                                        const QString& jsonFileName,
+                                        const QJsonArray& sections,
+                                        const QString& targetDir,
+                                        QString* error)
+{
+    QDir target(targetDir);
+    if (!target.exists() && !target.mkpath(QStringLiteral(".")))
+    {
+        if (error)
+            *error = QObject::tr("无法创建目录：%1").arg(QDir::toNativeSeparators(targetDir));
+        return false;
+    }
+
+    const QDir source(sourceDir);
+    const QFileInfoList files = ModelFiles::inputFiles(sourceDir);
+    for (const QFileInfo& info : files)
+    {
+        const QString relative = source.relativeFilePath(info.absoluteFilePath());
+        if (relative == jsonFileName)
+            continue;
+
+        const QString targetPath = target.filePath(relative);
+        const QDir parent = QFileInfo(targetPath).dir();
+        if (!parent.exists())
+            parent.mkpath(QStringLiteral("."));
+        bool copied = false;
+        if (ModelFiles::isReadOnlyInput(info))
+        {
+            copied = ModelFiles::linkOrCopyFile(info.absoluteFilePath(), targetPath);
+        }
+        else
+        {
+            QFile::remove(targetPath);
+            copied = QFile::copy(info.absoluteFilePath(), targetPath);
+        }
+        if (!copied)
+        {
+            if (error)
+                *error = QObject::tr("无法复制文件：%1")
+                             .arg(QDir::toNativeSeparators(info.absoluteFilePath()));
+            return false;
+        }
+    }
+
+    QFile f(target.filePath(jsonFileName));
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        if (error)
+            *error = QObject::tr("无法写入参数文件：%1")
+                         .arg(QDir::toNativeSeparators(f.fileName()));
+        return false;
+    }
+    f.write(QJsonDocument(sections).toJson(QJsonDocument::Indented));
+    f.close();
+    return true;
+}
+
+QString ParameterSweep::valueText(const QJsonValue& value)
+{
+    if (value.isDouble())
+        return QString::number(value.toDouble(), 'g', 15);
+    if (value.isBool())
+        return value.toBool() ? QStringLiteral("1") : QStringLiteral("0");
+    return value.toString();
+}
+
+qint64 ParameterSweep::fullFactorialSize(const QVector<SweepParameter>& parameters)
+{
+    if (parameters.isEmpty())
+        return 0;
+    qint64 total = 1;
+    for (const SweepParameter& parameter : parameters)
+    {
+        total *= parameter.useList ? parameter.values.size() : qMax(1, parameter.levels);
+        if (total > (qint64(1) << 40))
+            break;
+    }
+    return total;
+}
+
+QVector<QJsonValue> ParameterSweep::levelValues(const SweepParameter& parameter)
+{
+    if (parameter.useList)
+        return parameter.values;
+
+    QVector<QJsonValue> levels;
+    const int count = qMax(1, parameter.levels);
+    if (count == 1)
+    {
+        levels.push_back(parameter.minimum);
+        return levels;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        const double t = static_cast<double>(i) / (count - 1);
+        levels.push_back(parameter.minimum + t * (parameter.maximum - parameter.minimum));
+    }
+    return levels;
+}
+
+QJsonValue ParameterSweep::sampleAt(const SweepParameter& parameter, double unit)
+{
+    if (parameter.useList)
+    {
+        if (parameter.values.isEmpty())
+            return QJsonValue();
+        const int index = qBound(0, static_cast<int>(unit * parameter.values.size()),
+                                 parameter.values.size() - 1);
+        return parameter.values[index];
+    }
+    return parameter.minimum + unit * (parameter.maximum - parameter.minimum);
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QStringList>
+#include <QVector>
+
+// 参数扫描中的一个字段，对应 JSON 中某个分组（title）下的 cn_name
+struct SweepParameter
+{
+    QString section;
+    QString name;
+    bool useList = false;       // true：取 values；false：在 [minimum, maximum] 内取值
+    QVector<QJsonValue> values;
+    double minimum = 0.0;
+    double maximum = 0.0;
+    int levels = 2;             // 全因子设计时区间的等分点数
+};
+
+class ParameterSweep
+{
+public:
+    enum Method {
+        FullFactorial = 0,
+        LatinHypercube,
+        RandomSampling
+    };
+
+    // 生成采样点：每行对应一个变体，列顺序与 parameters 一致
+    static QVector<QVector<QJsonValue>> generate(const QVector<SweepParameter>& parameters,
+                                                 Method method,
+                                                 int sampleCount,
+                                                 quint32 seed);
+
+    // 将一组取值写入 sections 的副本
+    static QJsonArray applyValues(const QJsonArray& sections,
+                                  const QVector<SweepParameter>& parameters,
+                                  const QVector<QJsonValue>& values);
+
+    // 在 targetDir 中生成变体：参数文件重新写出，只读的网格与几何文件以硬链接共享，
+    // 其余输入文件逐个复制，在变体中修改它们不会影响源模型与其他变体。只访问文件，可在工作线程中调用
+    static bool materialiseVariant(const QString& sourceDir,
+                                   const QString& jsonFileName,
+                                   const QJsonArray& sections,
+                                   const QString& targetDir,
+                                   QString* error = nullptr);
+
+    static QString valueText(const QJsonValue& value);
+    static qint64 fullFactorialSize(const QVector<SweepParameter>& parameters);
+
+private:
+    static QVector<QJsonValue> levelValues(const SweepParameter& parameter);
+    static QJsonValue sampleAt(const SweepParameter& parameter, double unit);
+};
@@ -0,0 +1,280 @@
+﻿#include "ParameterSweepDialog.h"
+#include "JsonPageBuilder.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QJsonObject>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <limits>
+
+namespace
+{
+const int SectionRole = Qt::UserRole;
+const int NameRole = Qt::UserRole + 1;
+
+// 超过该数量时提示确认，避免误操作生成大量目录
+const int kConfirmVariantCount = 100;
+const int kMaxVariantCount = 2000;
+}
+
+ParameterSweepDialog::ParameterSweepDialog(const QString& modelName,
+                                           const QJsonArray& sections,
+                                           QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("参数扫描"));
+    resize(760, 560);
+
+    auto* v = new QVBoxLayout(this);
+    v->setContentsMargins(16, 16, 16, 16);
+    v->setSpacing(12);
+
+    auto* title = new QLabel(tr("基准模型：%1").arg(modelName), this);
+    title->setStyleSheet("font-weight:600;font-size:14px;");
+    v->addWidget(title);
+
+    auto* hint = new QLabel(tr("勾选需要扫描的字段，填写区间（最小值/最大值）或取值列表"
+                               "（以逗号或分号分隔，填写后优先使用列表）。"), this);
+    hint->setWordWrap(true);
+    hint->setStyleSheet("color:#5b6475;");
+    v->addWidget(hint);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels(QStringList()
+                                       << tr("字段") << tr("当前值") << tr("最小值")
+                                       << tr("最大值") << tr("等分数") << tr("取值列表"));
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(FieldColumn, QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(ListColumn, QHeaderView::Stretch);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+
+    for (int i = 0; i < sections.size(); ++i)
+    {
+        const QJsonObject sec = sections.at(i).toObject();
+        const QString sectionTitle = sec.value("title").toString();
+        const QJsonArray dataList = sec.value("data").toArray();
+        for (int j = 0; j < dataList.size(); ++j)
+        {
+            const QJsonObject item = dataList.at(j).toObject();
+            const QString cnName = item.value("cn_name").toString();
+            const QString current = ParameterSweep::valueText(item.value("value"));
+            const int row = m_table->rowCount();
+            m_table->insertRow(row);
+
+            auto* field = new QTableWidgetItem(QStringLiteral("%1 / %2").arg(sectionTitle, cnName));
+            field->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable | Qt::ItemIsSelectable);
+            field->setCheckState(Qt::Unchecked);
+            field->setData(SectionRole, sectionTitle);
+            field->setData(NameRole, cnName);
+            m_table->setItem(row, FieldColumn, field);
+
+            auto* currentItem = new QTableWidgetItem(current);
+            currentItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+            m_table->setItem(row, CurrentColumn, currentItem);
+
+            bool numeric = false;
+            current.toDouble(&numeric);
+            const QString seedText = numeric ? current : QString();
+            m_table->setItem(row, MinimumColumn, new QTableWidgetItem(seedText));
+            m_table->setItem(row, MaximumColumn, new QTableWidgetItem(seedText));
+            m_table->setItem(row, LevelsColumn, new QTableWidgetItem(QStringLiteral("3")));
+            m_table->setItem(row, ListColumn, new QTableWidgetItem());
+        }
+    }
+    v->addWidget(m_table, 1);
+
+    auto* form = new QFormLayout();
+    form->setLabelAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+    m_methodCombo = new QComboBox(this);
+    m_methodCombo->addItem(tr("全因子"), ParameterSweep::FullFactorial);
+    m_methodCombo->addItem(tr("拉丁超立方"), ParameterSweep::LatinHypercube);
+    m_methodCombo->addItem(tr("随机采样"), ParameterSweep::RandomSampling);
+    form->addRow(tr("采样方式："), m_methodCombo);
+
+    m_sampleSpin = new QSpinBox(this);
+    m_sampleSpin->setRange(1, kMaxVariantCount);
+    m_sampleSpin->setValue(10);
+    form->addRow(tr("样本数："), m_sampleSpin);
+
+    m_seedSpin = new QSpinBox(this);
+    m_seedSpin->setRange(0, std::numeric_limits<int>::max());
+    m_seedSpin->setValue(static_cast<int>(QRandomGenerator::global()->bounded(1000000)));
+    m_seedSpin->setToolTip(tr("相同的随机种子生成相同的样本，便于复现"));
+    form->addRow(tr("随机种子："), m_seedSpin);
+
+    m_launchCheck = new QCheckBox(tr("生成后立即加入计算队列"), this);
+    m_launchCheck->setChecked(true);
+    form->addRow(QString(), m_launchCheck);
+    v->addLayout(form);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setStyleSheet("color:#1d4ed8;");
+    v->addWidget(m_summaryLabel);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    buttons->button(QDialogButtonBox::Ok)->setText(tr("生成变体"));
+    v->addWidget(buttons);
+
+    connect(buttons, &QDialogButtonBox::accepted, this, &ParameterSweepDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &ParameterSweepDialog::reject);
+    connect(m_table, &QTableWidget::itemChanged, this, &ParameterSweepDialog::updateSummary);
+    connect(m_methodCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &ParameterSweepDialog::updateSummary);
+    connect(m_sampleSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, &ParameterSweepDialog::updateSummary);
+
+    updateSummary();
+}
+
+QVector<SweepParameter> ParameterSweepDialog::parameters() const
+{
+    return m_parameters;
+}
+
+ParameterSweep::Method ParameterSweepDialog::method() const
+{
+    return static_cast<ParameterSweep::Method>(m_methodCombo->currentData().toInt());
+}
+
+int ParameterSweepDialog::sampleCount() const
+{
+    return m_sampleSpin->value();
+}
+
+quint32 ParameterSweepDialog::seed() const
+{
+    return static_cast<quint32>(m_seedSpin->value());
+}
+
+bool ParameterSweepDialog::launchImmediately() const
+{
+    return m_launchCheck->isChecked();
+}
+
+void ParameterSweepDialog::accept()
+{
+    QVector<SweepParameter> params;
+    QString error;
+    if (!collectParameters(&params, &error))
+    {
+        QMessageBox::warning(this, tr("参数扫描"), error);
+        return;
+    }
+    if (params.isEmpty())
+    {
+        QMessageBox::warning(this, tr("参数扫描"), tr("请至少勾选一个需要扫描的字段。"));
+        return;
+    }
+
+    const int count = plannedVariantCount();
+    if (count > kMaxVariantCount)
+    {
+        QMessageBox::warning(this, tr("参数扫描"),
+                             tr("将生成 %1 个变体，超过上限 %2，请减少取值数量。")
+                                 .arg(count).arg(kMaxVariantCount));
+        return;
+    }
+    if (count > kConfirmVariantCount &&
+        QMessageBox::question(this, tr("参数扫描"),
+                              tr("将生成 %1 个模型变体，确定继续吗？").arg(count))
+            != QMessageBox::Yes)
+        return;
+
+    m_parameters = params;
+    QDialog::accept();
+}
+
+void ParameterSweepDialog::updateSummary()
+{
+    const bool factorial = method() == ParameterSweep::FullFactorial;
+    m_sampleSpin->setEnabled(!factorial);
+    m_seedSpin->setEnabled(!factorial);
+
+    QVector<SweepParameter> params;
+    QString error;
+    if (!collectParameters(&params, &error))
+    {
+        m_summaryLabel->setText(error);
+        return;
+    }
+    if (params.isEmpty())
+    {
+        m_summaryLabel->setText(tr("尚未选择扫描字段"));
+        return;
+    }
+    m_summaryLabel->setText(tr("已选择 %1 个字段，将生成 %2 个变体")
+                                .arg(params.size()).arg(plannedVariantCount()));
+}
+
+bool ParameterSweepDialog::collectParameters(QVector<SweepParameter>* out, QString* error) const
+{
+    static const QRegularExpression separators(QStringLiteral("[,;，；\\s]+"));
+
+    for (int row = 0; row < m_table->rowCount(); ++row)
+    {
+        const QTableWidgetItem* field = m_table->item(row, FieldColumn);
+        if (!field || field->checkState() != Qt::Checked)
+            continue;
+
+        SweepParameter parameter;
+        parameter.section = field->data(SectionRole).toString();
+        parameter.name = field->data(NameRole).toString();
+
+        const auto cellText = [this, row](int column) {
+            const QTableWidgetItem* item = m_table->item(row, column);
+            return item ? item->text().trimmed() : QString();
+        };
+
+        const QString listText = cellText(ListColumn);
+        if (!listText.isEmpty())
+        {
+            parameter.useList = true;
+            const QStringList parts = listText.split(separators, QString::SkipEmptyParts);
+            for (const QString& part : parts)
+                parameter.values.push_back(JsonPageBuilder::strictConvert(part));
+        }
+        else
+        {
+            bool okMin = false, okMax = false, okLevels = false;
+            parameter.minimum = cellText(MinimumColumn).toDouble(&okMin);
+            parameter.maximum = cellText(MaximumColumn).toDouble(&okMax);
+            parameter.levels = cellText(LevelsColumn).toInt(&okLevels);
+            if (!okMin || !okMax)
+            {
+                *error = tr("字段“%1”的区间不是有效数字").arg(parameter.name);
+                return false;
+            }
+            if (!okLevels || parameter.levels < 1)
+            {
+                *error = tr("字段“%1”的等分数必须为正整数").arg(parameter.name);
+                return false;
+            }
+        }
+        out->push_back(parameter);
+    }
+    return true;
+}
+
+int ParameterSweepDialog::plannedVariantCount() const
+{
+    if (method() != ParameterSweep::FullFactorial)
+        return m_sampleSpin->value();
+
+    QVector<SweepParameter> params;
+    QString error;
+    if (!collectParameters(&params, &error))
+        return 0;
+    const qint64 total = ParameterSweep::fullFactorialSize(params);
+    return static_cast<int>(qMin<qint64>(total, std::numeric_limits<int>::max()));
+}
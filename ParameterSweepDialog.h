@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include "ParameterSweep.h"
+
+#include <QDialog>
+#include <QJsonArray>
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QSpinBox;
+class QTableWidget;
+
+class ParameterSweepDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ParameterSweepDialog(const QString& modelName,
+                                  const QJsonArray& sections,
+                                  QWidget* parent = nullptr);
+
+    QVector<SweepParameter> parameters() const;
+    ParameterSweep::Method method() const;
+    int sampleCount() const;
+    quint32 seed() const;
+    bool launchImmediately() const;
+
+public slots:
+    void accept() override;
+
+private slots:
+    void updateSummary();
+
+private:
+    enum Columns {
+        FieldColumn = 0,
+        CurrentColumn,
+        MinimumColumn,
+        MaximumColumn,
+        LevelsColumn,
+        ListColumn,
+        ColumnCount
+    };
+
+    bool collectParameters(QVector<SweepParameter>* out, QString* error) const;
+    int plannedVariantCount() const;
+
+    QTableWidget* m_table = nullptr;
+    QComboBox* m_methodCombo = nullptr;
+    QSpinBox* m_sampleSpin = nullptr;
+    QSpinBox* m_seedSpin = nullptr;
+    QCheckBox* m_launchCheck = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+    QVector<SweepParameter> m_parameters;
+};
@@ -0,0 +1,312 @@
+﻿#include "PersistenceWorker.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent>
+
+namespace
+{
+// 连续操作在这段时间内的提交合并为一次写入；从第一次提交开始计时，不会无限推迟
+const int kCoalesceMs = 300;
+
+bool writeDocument(const QString& filePath, const QJsonDocument& document)
+{
+    const QDir dir = QFileInfo(filePath).dir();
+    if (!dir.exists())
+        dir.mkpath(QStringLiteral("."));
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    file.write(document.toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+}
+
+PersistenceWorker::PersistenceWorker(QObject* parent)
+    : QObject(parent)
+{
+    m_pool = new QThreadPool(this);
+    m_pool->setMaxThreadCount(1);
+    // 数据库连接只能在创建它的线程中使用，写入线程不能因空闲而退出；
+    // 同样的原因，等待写完时不能调用 waitForDone，见 waitForQueue
+    m_pool->setExpiryTimeout(-1);
+    m_coalesceTimer = new QTimer(this);
+    m_coalesceTimer->setSingleShot(true);
+    m_coalesceTimer->setInterval(kCoalesceMs);
+    connect(m_coalesceTimer, &QTimer::timeout, this, &PersistenceWorker::dispatch);
+}
+
+PersistenceWorker::~PersistenceWorker()
+{
+    dispatch();
+    // 连接在写入线程中关闭，之后才能回收线程
+    QtConcurrent::run(m_pool, [this]() { m_catalog.close(); });
+    waitForQueue();
+    m_pool->waitForDone();
+}
+
+void PersistenceWorker::resetSchemes(const QString& storageFilePath,
+                                     const QString& projectRoot,
+                                     const QString& workspaceRoot,
+                                     const QVector<SchemeRecord>& schemes,
+                                     qint64 sequence)
+{
+    dispatch();
+    m_catalogMode = false;
+    QtConcurrent::run(m_pool, [this, storageFilePath, projectRoot, workspaceRoot, schemes, sequence]() {
+        m_catalogActive = false;
+        m_catalog.close();
+        m_journal.reset(storageFilePath, projectRoot, workspaceRoot, schemes, sequence);
+    });
+}
+
+void PersistenceWorker::resetCatalog(const QString& catalogPath,
+                                     const QString& projectRoot,
+                                     const QString& workspaceRoot,
+                                     const QVector<SchemeRecord>& schemes)
+{
+    dispatch();
+    m_catalogMode = true;
+    QtConcurrent::run(m_pool, [this, catalogPath, projectRoot, workspaceRoot, schemes]() {
+        m_journal.clear();
+        // 打开失败时仍处于目录模式，之后的提交记为失败而不是写入 schemes.json
+        m_catalogActive = true;
+        QString error;
+        if (!m_catalog.open(catalogPath, &error))
+        {
+            record(false, error);
+            return;
+        }
+        m_catalogProjectRoot = projectRoot;
+        m_catalogWorkspace = workspaceRoot;
+        m_catalogSaved = schemes;
+    });
+}
+
+bool PersistenceWorker::migrateToCatalog(const QString& catalogPath,
+                                         const QString& projectRoot,
+                                         const QString& workspaceRoot,
+                                         const QVector<SchemeRecord>& schemes,
+                                         const QHash<QString, QString>& modelDirectories,
+                                         QString* error)
+{
+    flush();
+    bool migrated = false;
+    QString failure;
+    QSemaphore done;
+    QtConcurrent::run(m_pool, [&]() {
+        // 先写入临时文件，完整导入后再改名；中途退出只留下临时文件，工程仍使用 schemes.json
+        const QString partialPath = catalogPath + QStringLiteral(".partial");
+        const auto removePartial = [&partialPath]() {
+            QFile::remove(partialPath);
+            QFile::remove(partialPath + QStringLiteral("-wal"));
+            QFile::remove(partialPath + QStringLiteral("-shm"));
+        };
+        removePartial();
+        m_catalog.close();
+        ProjectCatalog catalog;
+        bool ok = catalog.open(partialPath, &failure) &&
+                  catalog.replaceSchemes(schemes, SchemeStorage::storedWorkspaceRoot(workspaceRoot, projectRoot),
+                                         &failure);
+        for (auto it = modelDirectories.constBegin(); ok && it != modelDirectories.constEnd(); ++it)
+            ok = catalog.addRuns(it.key(), RunJournal::history(it.value()), &failure);
+        // 关闭最后一个连接时 WAL 合并回主文件，改名只需移动这一个文件
+        catalog.close();
+        if (ok)
+        {
+            // 打不开而被跳过的旧目录由新导入的内容代替
+            QFile::remove(catalogPath);
+            QFile::remove(catalogPath + QStringLiteral("-wal"));
+            QFile::remove(catalogPath + QStringLiteral("-shm"));
+        }
+        if (ok && !QFile::rename(partialPath, catalogPath))
+        {
+            ok = false;
+            failure = tr("无法创建 %1").arg(QDir::toNativeSeparators(catalogPath));
+        }
+        if (!ok)
+            removePartial();
+        record(ok, failure);
+        migrated = ok;
+        done.release();
+    });
+    done.acquire();
+    if (!migrated)
+    {
+        if (error)
+            *error = failure;
+        return false;
+    }
+    resetCatalog(catalogPath, projectRoot, workspaceRoot, schemes);
+    return true;
+}
+
+void PersistenceWorker::closeSchemes()
+{
+    dispatch();
+    m_catalogMode = false;
+    QtConcurrent::run(m_pool, [this]() {
+        m_catalogActive = false;
+        m_journal.clear();
+        m_catalog.close();
+    });
+}
+
+void PersistenceWorker::submitSchemes(const QString& workspaceRoot,
+                                      const QVector<SchemeRecord>& schemes,
+                                      bool compact)
+{
+    {
+        QMutexLocker locker(&m_statsMutex);
+        ++m_stats.submitted;
+        if (m_pendingSchemes.valid)
+            ++m_stats.coalesced;
+    }
+    m_pendingSchemes.compact = m_pendingSchemes.compact || compact;
+    m_pendingSchemes.valid = true;
+    m_pendingSchemes.workspaceRoot = workspaceRoot;
+    m_pendingSchemes.schemes = schemes;
+    schedule();
+}
+
+void PersistenceWorker::submitDocument(const QString& filePath, const QJsonDocument& document)
+{
+    if (filePath.isEmpty())
+        return;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        ++m_stats.submitted;
+        if (m_pendingDocuments.contains(filePath))
+            ++m_stats.coalesced;
+    }
+    m_pendingDocuments.insert(filePath, document);
+    schedule();
+}
+
+void PersistenceWorker::submitRun(const QString& modelId, const RunRecord& run)
+{
+    if (!m_catalogMode || !run.isValid())
+        return;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        ++m_stats.submitted;
+    }
+    QtConcurrent::run(m_pool, [this, modelId, run]() {
+        if (!m_catalogActive)
+            return;
+        if (!m_catalog.isOpen())
+        {
+            record(false, tr("工程目录未打开，运行记录未写入"));
+            return;
+        }
+        QString error;
+        record(m_catalog.addRuns(modelId, QVector<RunRecord>{ run }, &error), error);
+    });
+}
+
+void PersistenceWorker::flush()
+{
+    dispatch();
+    waitForQueue();
+}
+
+void PersistenceWorker::waitForQueue()
+{
+    // Qt 5 的 waitForDone 会回收写入线程，其中打开的数据库连接随之失效；
+    // 这里只等待排在后面的空任务执行完。也不能用 QFuture::waitForFinished，
+    // 尚未开始的任务会被挪到调用线程中执行
+    QSemaphore done;
+    QtConcurrent::run(m_pool, [&done]() { done.release(); });
+    done.acquire();
+}
+
+PersistenceWorker::Stats PersistenceWorker::stats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_stats;
+}
+
+QString PersistenceWorker::lastError() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_lastError;
+}
+
+void PersistenceWorker::schedule()
+{
+    if (!m_coalesceTimer->isActive())
+        m_coalesceTimer->start();
+}
+
+void PersistenceWorker::dispatch()
+{
+    m_coalesceTimer->stop();
+    if (m_pendingSchemes.valid)
+    {
+        const PendingSchemes pending = m_pendingSchemes;
+        m_pendingSchemes = PendingSchemes();
+        QtConcurrent::run(m_pool, [this, pending]() {
+            if (m_catalogActive)
+            {
+                if (!m_catalog.isOpen())
+                    record(false, tr("工程目录未打开，方案修改未写入"));
+                else
+                    record(saveCatalog(pending));
+                return;
+            }
+            // 工程已关闭时没有可写的位置，直接丢弃
+            if (!m_journal.isOpen())
+                return;
+            record(pending.compact ? m_journal.compact(pending.workspaceRoot, pending.schemes)
+                                   : m_journal.save(pending.workspaceRoot, pending.schemes));
+        });
+    }
+    for (auto it = m_pendingDocuments.constBegin(); it != m_pendingDocuments.constEnd(); ++it)
+    {
+        const QString filePath = it.key();
+        const QJsonDocument document = it.value();
+        QtConcurrent::run(m_pool, [this, filePath, document]() { record(writeDocument(filePath, document)); });
+    }
+    m_pendingDocuments.clear();
+}
+
+bool PersistenceWorker::saveCatalog(const PendingSchemes& pending)
+{
+    // 与变更日志使用同一组增量操作；目录总是完整的，不需要合并
+    QJsonArray ops = SchemeStorage::diff(m_catalogSaved, pending.schemes);
+    if (pending.workspaceRoot != m_catalogWorkspace)
+    {
+        QJsonObject op;
+        op.insert(QStringLiteral("op"), QStringLiteral("workspace"));
+        op.insert(QStringLiteral("workspaceRoot"),
+                  SchemeStorage::storedWorkspaceRoot(pending.workspaceRoot, m_catalogProjectRoot));
+        ops.prepend(op);
+    }
+    QString error;
+    if (!m_catalog.applyChanges(ops, &error))
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_lastError = error;
+        return false;
+    }
+    m_catalogSaved = pending.schemes;
+    m_catalogWorkspace = pending.workspaceRoot;
+    return true;
+}
+
+void PersistenceWorker::record(bool ok, const QString& error)
+{
+    QMutexLocker locker(&m_statsMutex);
+    if (ok)
+        ++m_stats.written;
+    else
+        ++m_stats.failed;
+    if (!error.isEmpty())
+        m_lastError = error;
+}
@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include "ProjectCatalog.h"
+#include "ProjectTypes.h"
+#include "RunJournal.h"
+#include "SchemeStorage.h"
+
+#include <QHash>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QThreadPool;
+class QTimer;
+
+// 在后台线程中写入工程与程序状态文件。GUI 线程只提交不可变的快照
+// （QVector 与 QJsonDocument 均为隐式共享，提交不产生深拷贝），
+// 短时间内对同一文件的多次提交只写最后一次。所有写入按提交顺序在同一线程中执行
+class PersistenceWorker : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats
+    {
+        qint64 submitted = 0;   // 收到的提交
+        qint64 coalesced = 0;   // 被同一文件的后续提交取代而未写入的
+        qint64 written = 0;     // 实际写入的
+        qint64 failed = 0;
+    };
+
+    explicit PersistenceWorker(QObject* parent = nullptr);
+    ~PersistenceWorker() override;
+
+    // 以刚从磁盘读取的方案列表为增量写入的基准；之前提交的内容先写入原工程
+    void resetSchemes(const QString& storageFilePath,
+                      const QString& projectRoot,
+                      const QString& workspaceRoot,
+                      const QVector<SchemeRecord>& schemes,
+                      qint64 sequence);
+    // 以 SQLite 目录代替 schemes.json；之后的方案变更在一个事务中写入目录
+    void resetCatalog(const QString& catalogPath,
+                      const QString& projectRoot,
+                      const QString& workspaceRoot,
+                      const QVector<SchemeRecord>& schemes);
+    // 把当前方案与各模型目录下的运行日志（modelId -> 模型目录）导入新建的目录，
+    // 成功后切换到目录模式。等待写入线程完成后返回
+    bool migrateToCatalog(const QString& catalogPath,
+                          const QString& projectRoot,
+                          const QString& workspaceRoot,
+                          const QVector<SchemeRecord>& schemes,
+                          const QHash<QString, QString>& modelDirectories,
+                          QString* error = nullptr);
+    void closeSchemes();
+    bool isCatalogMode() const { return m_catalogMode; }
+    // compact 为 true 时整体改写 schemes.json，否则只追加变更日志
+    void submitSchemes(const QString& workspaceRoot, const QVector<SchemeRecord>& schemes,
+                       bool compact = false);
+    // 整体替换写入一个 JSON 文件
+    void submitDocument(const QString& filePath, const QJsonDocument& document);
+    // 目录模式下记录一次运行；运行日志本身仍由求解流程写入模型目录
+    void submitRun(const QString& modelId, const RunRecord& run);
+
+    // 立即写入全部待写内容并等待完成；退出与重新读取文件前调用
+    void flush();
+    Stats stats() const;
+    QString lastError() const;
+
+private:
+    struct PendingSchemes
+    {
+        bool valid = false;
+        bool compact = false;
+        QString workspaceRoot;
+        QVector<SchemeRecord> schemes;
+    };
+
+    void schedule();
+    void dispatch();
+    void waitForQueue();
+    void record(bool ok, const QString& error = QString());
+    bool saveCatalog(const PendingSchemes& pending);
+
+    QThreadPool* m_pool = nullptr;
+    QTimer* m_coalesceTimer = nullptr;
+    PendingSchemes m_pendingSchemes;
+    QHash<QString, QJsonDocument> m_pendingDocuments;   // 文件路径 -> 最后一次提交的内容
+    bool m_catalogMode = false;
+    // 以下只在写入线程中访问
+    SchemeJournal m_journal;
+    bool m_catalogActive = false;
+    ProjectCatalog m_catalog;
+    QString m_catalogProjectRoot;
+    QString m_catalogWorkspace;
+    QVector<SchemeRecord> m_catalogSaved;               // 与目录一致的内容
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+    QString m_lastError;
+};
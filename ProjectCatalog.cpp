@@ -0,0 +1,487 @@
+﻿#include "ProjectCatalog.h"
+#include "SchemeStorage.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
+
+namespace
+{
+const char* const kDriver = "QSQLITE";
+const int kSchemaVersion = 1;
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("ProjectCatalog", text);
+}
+
+// 位置排在同一范围内已有记录之后
+const char* const kNextSchemePosition = "(SELECT IFNULL(MAX(position), -1) + 1 FROM schemes)";
+const char* const kNextModelPosition =
+    "(SELECT IFNULL(MAX(position), -1) + 1 FROM models WHERE scheme_id = :owner)";
+
+const char* const kSchema[] = {
+    "CREATE TABLE IF NOT EXISTS meta ("
+    " key TEXT PRIMARY KEY,"
+    " value TEXT)",
+    "CREATE TABLE IF NOT EXISTS schemes ("
+    " id TEXT PRIMARY KEY,"
+    " position INTEGER NOT NULL,"
+    " name TEXT NOT NULL,"
+    " working_directory TEXT NOT NULL,"
+    " thumbnail_path TEXT,"
+    " remarks TEXT)",
+    "CREATE INDEX IF NOT EXISTS schemes_directory ON schemes(working_directory)",
+    "CREATE TABLE IF NOT EXISTS models ("
+    " id TEXT PRIMARY KEY,"
+    " scheme_id TEXT NOT NULL REFERENCES schemes(id) ON DELETE CASCADE,"
+    " position INTEGER NOT NULL,"
+    " name TEXT NOT NULL,"
+    " directory TEXT NOT NULL,"
+    " json_path TEXT NOT NULL,"
+    " bat_path TEXT,"
+    " remarks TEXT)",
+    "CREATE INDEX IF NOT EXISTS models_scheme ON models(scheme_id, position)",
+    // 运行记录不随模型删除，删除的模型仍可在历史查询中看到
+    "CREATE TABLE IF NOT EXISTS runs ("
+    " model_id TEXT NOT NULL,"
+    " run_id TEXT NOT NULL,"
+    " started_at INTEGER,"
+    " finished_at INTEGER,"
+    " exit_code INTEGER,"
+    " succeeded INTEGER NOT NULL,"
+    " cancelled INTEGER NOT NULL,"
+    " from_cache INTEGER NOT NULL,"
+    " record TEXT NOT NULL,"
+    " PRIMARY KEY (model_id, run_id))",
+    "CREATE INDEX IF NOT EXISTS runs_finished ON runs(finished_at)",
+    "CREATE INDEX IF NOT EXISTS runs_status ON runs(succeeded, cancelled, finished_at)",
+};
+
+qint64 toMsecs(const QDateTime& time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : 0;
+}
+}
+
+ProjectCatalog::ProjectCatalog()
+    : m_connectionName(QStringLiteral("catalog-") + QUuid::createUuid().toString(QUuid::WithoutBraces))
+{
+}
+
+ProjectCatalog::~ProjectCatalog()
+{
+    close();
+}
+
+bool ProjectCatalog::isAvailable()
+{
+    return QSqlDatabase::isDriverAvailable(QLatin1String(kDriver));
+}
+
+QString ProjectCatalog::catalogPath(const QString& projectRoot)
+{
+    return QDir(projectRoot).filePath(QStringLiteral("catalog.sqlite"));
+}
+
+bool ProjectCatalog::exists(const QString& projectRoot)
+{
+    return !projectRoot.isEmpty() && QFileInfo::exists(catalogPath(projectRoot));
+}
+
+bool ProjectCatalog::open(const QString& filePath, QString* error)
+{
+    close();
+    if (!isAvailable())
+    {
+        if (error)
+            *error = tr("缺少 Qt SQLite 驱动");
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1String(kDriver), m_connectionName);
+    db.setDatabaseName(filePath);
+    if (!db.open())
+    {
+        if (error)
+            *error = tr("无法打开工程目录 %1：%2").arg(filePath, db.lastError().text());
+        close();
+        return false;
+    }
+
+    // WAL 下读写互不阻塞；NORMAL 在 WAL 下只在检查点同步，断电最多丢失最后几次提交
+    QSqlQuery pragma(db);
+    for (const char* statement : { "PRAGMA journal_mode=WAL", "PRAGMA synchronous=NORMAL",
+                                   "PRAGMA foreign_keys=ON", "PRAGMA busy_timeout=5000" })
+    {
+        if (!pragma.exec(QLatin1String(statement)))
+        {
+            if (error)
+                *error = pragma.lastError().text();
+            close();
+            return false;
+        }
+    }
+    if (!ensureSchema(error))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ProjectCatalog::close()
+{
+    if (!QSqlDatabase::contains(m_connectionName))
+        return;
+    {
+        QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+bool ProjectCatalog::isOpen() const
+{
+    return QSqlDatabase::contains(m_connectionName) &&
+           QSqlDatabase::database(m_connectionName, false).isOpen();
+}
+
+bool ProjectCatalog::load(QVector<SchemeRecord>* schemes, QString* workspaceRoot, QString* error) const
+{
+    const QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    QVector<SchemeRecord> loaded;
+    QHash<QString, int> index;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral("SELECT id, name, working_directory, thumbnail_path, remarks "
+                                 "FROM schemes ORDER BY position"));
+    if (!exec(query, error))
+        return false;
+    while (query.next())
+    {
+        SchemeRecord scheme;
+        scheme.id = query.value(0).toString();
+        scheme.name = query.value(1).toString();
+        scheme.workingDirectory = query.value(2).toString();
+        scheme.thumbnailPath = query.value(3).toString();
+        scheme.remarks = query.value(4).toString();
+        index.insert(scheme.id, loaded.size());
+        loaded.push_back(scheme);
+    }
+
+    query.prepare(QStringLiteral("SELECT scheme_id, id, name, directory, json_path, bat_path, remarks "
+                                 "FROM models ORDER BY scheme_id, position"));
+    if (!exec(query, error))
+        return false;
+    while (query.next())
+    {
+        const int owner = index.value(query.value(0).toString(), -1);
+        if (owner < 0)
+            continue;
+        ModelRecord model;
+        model.id = query.value(1).toString();
+        model.name = query.value(2).toString();
+        model.directory = query.value(3).toString();
+        model.jsonPath = query.value(4).toString();
+        model.batPath = query.value(5).toString();
+        model.remarks = query.value(6).toString();
+        loaded[owner].models.push_back(model);
+    }
+
+    if (workspaceRoot)
+    {
+        query.prepare(QStringLiteral("SELECT value FROM meta WHERE key = 'workspaceRoot'"));
+        if (!exec(query, error))
+            return false;
+        *workspaceRoot = query.next() ? query.value(0).toString() : QString();
+    }
+    if (schemes)
+        *schemes = loaded;
+    return true;
+}
+
+bool ProjectCatalog::replaceSchemes(const QVector<SchemeRecord>& schemes, const QString& workspaceRoot,
+                                    QString* error)
+{
+    if (!transaction(error))
+        return false;
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    bool ok = query.exec(QStringLiteral("DELETE FROM models")) && query.exec(QStringLiteral("DELETE FROM schemes"));
+    if (!ok && error)
+        *error = query.lastError().text();
+    for (int i = 0; ok && i < schemes.size(); ++i)
+    {
+        ok = putScheme(schemes.at(i), error);
+        for (int j = 0; ok && j < schemes.at(i).models.size(); ++j)
+            ok = putModel(schemes.at(i).id, schemes.at(i).models.at(j), error);
+    }
+    ok = ok && setWorkspaceRoot(workspaceRoot, error);
+    if (!ok)
+    {
+        rollback();
+        return false;
+    }
+    return commit(error);
+}
+
+bool ProjectCatalog::applyChanges(const QJsonArray& ops, QString* error)
+{
+    if (ops.isEmpty())
+        return true;
+    if (!transaction(error))
+        return false;
+
+    const QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    bool ok = true;
+    for (int i = 0; ok && i < ops.size(); ++i)
+    {
+        const QJsonObject op = ops.at(i).toObject();
+        const QString type = op.value(QStringLiteral("op")).toString();
+        if (type == QLatin1String("workspace"))
+        {
+            ok = setWorkspaceRoot(op.value(QStringLiteral("workspaceRoot")).toString(), error);
+        }
+        else if (type == QLatin1String("putScheme"))
+        {
+            SchemeRecord scheme;
+            if (SchemeStorage::schemeFromJson(op.value(QStringLiteral("scheme")).toObject(), &scheme))
+                ok = putScheme(scheme, error);
+        }
+        else if (type == QLatin1String("removeScheme"))
+        {
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral("DELETE FROM schemes WHERE id = :id"));
+            query.bindValue(QStringLiteral(":id"), op.value(QStringLiteral("id")).toString());
+            ok = exec(query, error);
+        }
+        else if (type == QLatin1String("putModel"))
+        {
+            ModelRecord model;
+            if (SchemeStorage::modelFromJson(op.value(QStringLiteral("model")).toObject(), &model))
+                ok = putModel(op.value(QStringLiteral("scheme")).toString(), model, error);
+        }
+        else if (type == QLatin1String("removeModel"))
+        {
+            QSqlQuery query(db);
+            query.prepare(QStringLiteral("DELETE FROM models WHERE id = :id"));
+            query.bindValue(QStringLiteral(":id"), op.value(QStringLiteral("id")).toString());
+            ok = exec(query, error);
+        }
+        else if (type == QLatin1String("orderSchemes"))
+        {
+            ok = setOrder(QStringLiteral("schemes"), QString(), QString(),
+                          op.value(QStringLiteral("ids")).toArray(), error);
+        }
+        else if (type == QLatin1String("orderModels"))
+        {
+            ok = setOrder(QStringLiteral("models"), QStringLiteral("scheme_id"),
+                          op.value(QStringLiteral("scheme")).toString(),
+                          op.value(QStringLiteral("ids")).toArray(), error);
+        }
+    }
+    if (!ok)
+    {
+        rollback();
+        return false;
+    }
+    return commit(error);
+}
+
+bool ProjectCatalog::setWorkspaceRoot(const QString& workspaceRoot, QString* error)
+{
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    query.prepare(QStringLiteral("INSERT INTO meta(key, value) VALUES('workspaceRoot', :value) "
+                                 "ON CONFLICT(key) DO UPDATE SET value = excluded.value"));
+    query.bindValue(QStringLiteral(":value"), workspaceRoot);
+    return exec(query, error);
+}
+
+bool ProjectCatalog::addRuns(const QString& modelId, const QVector<RunRecord>& runs, QString* error)
+{
+    if (runs.isEmpty())
+        return true;
+    if (!transaction(error))
+        return false;
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    query.prepare(QStringLiteral(
+        "INSERT OR REPLACE INTO runs(model_id, run_id, started_at, finished_at, exit_code, "
+        "succeeded, cancelled, from_cache, record) "
+        "VALUES(:model, :run, :started, :finished, :exit, :succeeded, :cancelled, :cache, :record)"));
+    for (const RunRecord& run : runs)
+    {
+        if (!run.isValid())
+            continue;
+        query.bindValue(QStringLiteral(":model"), modelId);
+        query.bindValue(QStringLiteral(":run"), run.runId);
+        query.bindValue(QStringLiteral(":started"), toMsecs(run.startedAt));
+        query.bindValue(QStringLiteral(":finished"), toMsecs(run.finishedAt));
+        query.bindValue(QStringLiteral(":exit"), run.exitCode);
+        query.bindValue(QStringLiteral(":succeeded"), run.succeeded() ? 1 : 0);
+        query.bindValue(QStringLiteral(":cancelled"), run.cancelled ? 1 : 0);
+        query.bindValue(QStringLiteral(":cache"), run.fromCache ? 1 : 0);
+        query.bindValue(QStringLiteral(":record"),
+                        QString::fromUtf8(QJsonDocument(run.toJson()).toJson(QJsonDocument::Compact)));
+        if (!exec(query, error))
+        {
+            rollback();
+            return false;
+        }
+    }
+    return commit(error);
+}
+
+QVector<ProjectCatalog::RunEntry> ProjectCatalog::failedRuns(const QDateTime& since, int limit,
+                                                             QString* error) const
+{
+    QVector<RunEntry> entries;
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    query.setForwardOnly(true);
+    query.prepare(QStringLiteral(
+        "SELECT r.model_id, m.name, s.name, r.record FROM runs r "
+        "LEFT JOIN models m ON m.id = r.model_id "
+        "LEFT JOIN schemes s ON s.id = m.scheme_id "
+        "WHERE r.succeeded = 0 AND r.cancelled = 0 AND r.finished_at >= :since "
+        "ORDER BY r.finished_at DESC LIMIT :limit"));
+    query.bindValue(QStringLiteral(":since"), toMsecs(since));
+    query.bindValue(QStringLiteral(":limit"), limit);
+    if (!exec(query, error))
+        return entries;
+    while (query.next())
+    {
+        RunEntry entry;
+        entry.modelId = query.value(0).toString();
+        entry.modelName = query.value(1).toString();
+        entry.schemeName = query.value(2).toString();
+        entry.record = RunRecord::fromJson(QJsonDocument::fromJson(query.value(3).toString().toUtf8()).object());
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+bool ProjectCatalog::ensureSchema(QString* error)
+{
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    for (const char* statement : kSchema)
+    {
+        if (!query.exec(QLatin1String(statement)))
+        {
+            if (error)
+                *error = query.lastError().text();
+            return false;
+        }
+    }
+    query.prepare(QStringLiteral("INSERT OR IGNORE INTO meta(key, value) VALUES('schemaVersion', :version)"));
+    query.bindValue(QStringLiteral(":version"), kSchemaVersion);
+    return exec(query, error);
+}
+
+bool ProjectCatalog::transaction(QString* error)
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    if (db.transaction())
+        return true;
+    if (error)
+        *error = db.lastError().text();
+    return false;
+}
+
+bool ProjectCatalog::commit(QString* error)
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    if (db.commit())
+        return true;
+    if (error)
+        *error = db.lastError().text();
+    db.rollback();
+    return false;
+}
+
+void ProjectCatalog::rollback()
+{
+    QSqlDatabase::database(m_connectionName, false).rollback();
+}
+
+bool ProjectCatalog::putScheme(const SchemeRecord& scheme, QString* error)
+{
+    // 已有的方案保留原位置与模型；ON CONFLICT 不会像 REPLACE 那样先删除再插入而级联删除模型
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    query.prepare(QStringLiteral(
+        "INSERT INTO schemes(id, position, name, working_directory, thumbnail_path, remarks) "
+        "VALUES(:id, %1, :name, :directory, :thumbnail, :remarks) "
+        "ON CONFLICT(id) DO UPDATE SET name = excluded.name, "
+        "working_directory = excluded.working_directory, "
+        "thumbnail_path = excluded.thumbnail_path, remarks = excluded.remarks")
+                      .arg(QLatin1String(kNextSchemePosition)));
+    query.bindValue(QStringLiteral(":id"), scheme.id);
+    query.bindValue(QStringLiteral(":name"), scheme.name);
+    query.bindValue(QStringLiteral(":directory"), scheme.workingDirectory);
+    query.bindValue(QStringLiteral(":thumbnail"), scheme.thumbnailPath);
+    query.bindValue(QStringLiteral(":remarks"), scheme.remarks);
+    return exec(query, error);
+}
+
+bool ProjectCatalog::putModel(const QString& schemeId, const ModelRecord& model, QString* error)
+{
+    // 移到其他方案的模型排在目标方案的最后，与变更日志的重放规则一致
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    query.prepare(QStringLiteral(
+        "INSERT INTO models(id, scheme_id, position, name, directory, json_path, bat_path, remarks) "
+        "VALUES(:id, :scheme, %1, :name, :directory, :json, :bat, :remarks) "
+        "ON CONFLICT(id) DO UPDATE SET "
+        "position = CASE WHEN scheme_id = excluded.scheme_id THEN position ELSE excluded.position END, "
+        "scheme_id = excluded.scheme_id, name = excluded.name, directory = excluded.directory, "
+        "json_path = excluded.json_path, bat_path = excluded.bat_path, remarks = excluded.remarks")
+                      .arg(QLatin1String(kNextModelPosition)));
+    query.bindValue(QStringLiteral(":id"), model.id);
+    query.bindValue(QStringLiteral(":scheme"), schemeId);
+    query.bindValue(QStringLiteral(":owner"), schemeId);
+    query.bindValue(QStringLiteral(":name"), model.name);
+    query.bindValue(QStringLiteral(":directory"), model.directory);
+    query.bindValue(QStringLiteral(":json"), model.jsonPath);
+    query.bindValue(QStringLiteral(":bat"), model.batPath);
+    query.bindValue(QStringLiteral(":remarks"), model.remarks);
+    return exec(query, error);
+}
+
+bool ProjectCatalog::setOrder(const QString& table, const QString& scopeColumn, const QString& scopeId,
+                              const QJsonArray& ids, QString* error)
+{
+    // 列表中没有的记录排在最后，保持原有相对顺序
+    QSqlQuery query(QSqlDatabase::database(m_connectionName, false));
+    QString tail = QStringLiteral("UPDATE %1 SET position = position + :offset").arg(table);
+    if (!scopeColumn.isEmpty())
+        tail += QStringLiteral(" WHERE %1 = :scope").arg(scopeColumn);
+    query.prepare(tail);
+    query.bindValue(QStringLiteral(":offset"), ids.size() + 1);
+    if (!scopeColumn.isEmpty())
+        query.bindValue(QStringLiteral(":scope"), scopeId);
+    if (!exec(query, error))
+        return false;
+
+    query.prepare(QStringLiteral("UPDATE %1 SET position = :position WHERE id = :id").arg(table));
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        query.bindValue(QStringLiteral(":position"), i);
+        query.bindValue(QStringLiteral(":id"), ids.at(i).toString());
+        if (!exec(query, error))
+            return false;
+    }
+    return true;
+}
+
+bool ProjectCatalog::exec(QSqlQuery& query, QString* error) const
+{
+    if (query.exec())
+        return true;
+    if (error)
+        *error = query.lastError().text();
+    return false;
+}
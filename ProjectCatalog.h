@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "ProjectTypes.h"
+#include "RunJournal.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+
+class QSqlQuery;
+
+// 可选的 SQLite 工程目录 <工程>/catalog.sqlite。存在时代替 schemes.json 保存方案与模型，
+// 另外收录全部运行记录，按时间与状态查询时不必读取每个模型目录下的运行日志。
+// 使用 WAL 模式，批量修改在一个事务中完成；界面线程的查询与后台写入可以同时进行。
+// 每个实例持有自己的数据库连接，只能在打开它的线程中使用
+class ProjectCatalog
+{
+public:
+    struct RunEntry
+    {
+        QString modelId;
+        QString modelName;
+        QString schemeName;
+        RunRecord record;
+    };
+
+    ProjectCatalog();
+    ~ProjectCatalog();
+
+    static bool isAvailable();
+    static QString catalogPath(const QString& projectRoot);
+    static bool exists(const QString& projectRoot);
+
+    bool open(const QString& filePath, QString* error = nullptr);
+    void close();
+    bool isOpen() const;
+
+    // workspaceRoot 为文件中记录的形式，需经 SchemeStorage::resolveWorkspaceRoot 解析
+    bool load(QVector<SchemeRecord>* schemes, QString* workspaceRoot, QString* error = nullptr) const;
+    // 整体替换方案与模型，用于从 schemes.json 迁移
+    bool replaceSchemes(const QVector<SchemeRecord>& schemes, const QString& workspaceRoot,
+                        QString* error = nullptr);
+    // 在一个事务中应用 SchemeStorage::diff 给出的变更，也接受变更日志中的 workspace 操作
+    bool applyChanges(const QJsonArray& ops, QString* error = nullptr);
+    bool setWorkspaceRoot(const QString& workspaceRoot, QString* error = nullptr);
+
+    // 同一模型同一 runId 的记录会被覆盖
+    bool addRuns(const QString& modelId, const QVector<RunRecord>& runs, QString* error = nullptr);
+    // since 之后结束且未成功（不含取消）的运行，最新的在前
+    QVector<RunEntry> failedRuns(const QDateTime& since, int limit = 1000, QString* error = nullptr) const;
+
+private:
+    bool ensureSchema(QString* error);
+    bool transaction(QString* error);
+    bool commit(QString* error);
+    void rollback();
+    bool putScheme(const SchemeRecord& scheme, QString* error);
+    bool putModel(const QString& schemeId, const ModelRecord& model, QString* error);
+    bool setOrder(const QString& table, const QString& scopeColumn, const QString& scopeId,
+                  const QJsonArray& ids, QString* error);
+    bool exec(QSqlQuery& query, QString* error) const;
+
+    QString m_connectionName;
+};
@@ -0,0 +1,216 @@
+﻿#include "ProjectRegistry.h"
+
+#include <QDir>
+
+namespace
+{
+// 入库的工作目录都已规范化，这里只做字符串整理，不访问文件系统
+QString directoryKey(const QString& workingDirectory)
+{
+    return QDir::cleanPath(workingDirectory);
+}
+}
+
+void ProjectRegistry::reset(const QVector<SchemeRecord>& schemes)
+{
+    m_schemes = schemes;
+    m_schemeIndex.clear();
+    m_directoryIndex.clear();
+    m_modelIndex.clear();
+    m_schemeIndex.reserve(m_schemes.size());
+    m_directoryIndex.reserve(m_schemes.size());
+    reindexFrom(0);
+}
+
+void ProjectRegistry::clear()
+{
+    reset(QVector<SchemeRecord>());
+}
+
+SchemeRecord* ProjectRegistry::scheme(const QString& id)
+{
+    const auto it = m_schemeIndex.constFind(id);
+    return it == m_schemeIndex.constEnd() ? nullptr : &m_schemes[it.value()];
+}
+
+const SchemeRecord* ProjectRegistry::scheme(const QString& id) const
+{
+    const auto it = m_schemeIndex.constFind(id);
+    return it == m_schemeIndex.constEnd() ? nullptr : &m_schemes.at(it.value());
+}
+
+SchemeRecord* ProjectRegistry::schemeByWorkingDirectory(const QString& canonicalPath)
+{
+    const auto it = m_directoryIndex.constFind(directoryKey(canonicalPath));
+    return it == m_directoryIndex.constEnd() ? nullptr : &m_schemes[it.value()];
+}
+
+ModelRecord* ProjectRegistry::model(const QString& id, SchemeRecord** owner)
+{
+    const auto it = m_modelIndex.constFind(id);
+    if (it == m_modelIndex.constEnd())
+    {
+        if (owner)
+            *owner = nullptr;
+        return nullptr;
+    }
+    SchemeRecord& scheme = m_schemes[it->scheme];
+    if (owner)
+        *owner = &scheme;
+    return &scheme.models[it->model];
+}
+
+const ModelRecord* ProjectRegistry::model(const QString& id, const SchemeRecord** owner) const
+{
+    const auto it = m_modelIndex.constFind(id);
+    if (it == m_modelIndex.constEnd())
+    {
+        if (owner)
+            *owner = nullptr;
+        return nullptr;
+    }
+    const SchemeRecord& scheme = m_schemes.at(it->scheme);
+    if (owner)
+        *owner = &scheme;
+    return &scheme.models.at(it->model);
+}
+
+SchemeRecord* ProjectRegistry::addScheme(const SchemeRecord& scheme)
+{
+    m_schemes.push_back(scheme);
+    reindexFrom(m_schemes.size() - 1);
+    return &m_schemes.last();
+}
+
+bool ProjectRegistry::removeScheme(const QString& id)
+{
+    const auto it = m_schemeIndex.constFind(id);
+    if (it == m_schemeIndex.constEnd())
+        return false;
+    const int index = it.value();
+    const SchemeRecord& removed = m_schemes.at(index);
+    for (const ModelRecord& model : removed.models)
+    {
+        const auto found = m_modelIndex.constFind(model.id);
+        if (found != m_modelIndex.constEnd() && found->scheme == index)
+            m_modelIndex.remove(model.id);
+    }
+    const QString directory = directoryKey(removed.workingDirectory);
+    if (m_directoryIndex.value(directory, -1) == index)
+        m_directoryIndex.remove(directory);
+    m_schemeIndex.remove(id);
+    m_schemes.removeAt(index);
+    // 后面的方案整体前移一位
+    reindexFrom(index);
+    return true;
+}
+
+ModelRecord* ProjectRegistry::addModel(const QString& schemeId, const ModelRecord& model)
+{
+    const auto it = m_schemeIndex.constFind(schemeId);
+    if (it == m_schemeIndex.constEnd())
+        return nullptr;
+    SchemeRecord& scheme = m_schemes[it.value()];
+    scheme.models.push_back(model);
+    indexModels(it.value(), scheme.models.size() - 1);
+    return &scheme.models.last();
+}
+
+bool ProjectRegistry::removeModel(const QString& id)
+{
+    const auto it = m_modelIndex.constFind(id);
+    if (it == m_modelIndex.constEnd())
+        return false;
+    const ModelLocation location = it.value();
+    m_modelIndex.remove(id);
+    m_schemes[location.scheme].models.removeAt(location.model);
+    indexModels(location.scheme, location.model);
+    return true;
+}
+
+bool ProjectRegistry::setModels(const QString& schemeId, const QVector<ModelRecord>& models)
+{
+    const auto it = m_schemeIndex.constFind(schemeId);
+    if (it == m_schemeIndex.constEnd())
+        return false;
+    const int index = it.value();
+    SchemeRecord& scheme = m_schemes[index];
+    for (const ModelRecord& model : scheme.models)
+    {
+        const auto found = m_modelIndex.constFind(model.id);
+        if (found != m_modelIndex.constEnd() && found->scheme == index)
+            m_modelIndex.remove(model.id);
+    }
+    scheme.models = models;
+    indexModels(index, 0);
+    return true;
+}
+
+bool ProjectRegistry::moveScheme(const QString& id, int index)
+{
+    const auto it = m_schemeIndex.constFind(id);
+    if (it == m_schemeIndex.constEnd() || index < 0 || index >= m_schemes.size())
+        return false;
+    const int from = it.value();
+    if (from == index)
+        return true;
+    const int first = qMin(from, index);
+    const int last = qMax(from, index);
+    unindex(first, last);
+    m_schemes.move(from, index);
+    reindexFrom(first, last);
+    return true;
+}
+
+void ProjectRegistry::reindexFrom(int first, int last)
+{
+    if (last < 0 || last >= m_schemes.size())
+        last = m_schemes.size() - 1;
+    // 重复的 ID 或目录以靠前的记录为准，与原先按顺序查找的结果一致
+    for (int i = first; i <= last; ++i)
+    {
+        const SchemeRecord& scheme = m_schemes.at(i);
+        const int existing = m_schemeIndex.value(scheme.id, -1);
+        if (existing < 0 || existing > i)
+            m_schemeIndex.insert(scheme.id, i);
+        const QString directory = directoryKey(scheme.workingDirectory);
+        const int owner = m_directoryIndex.value(directory, -1);
+        if (owner < 0 || owner > i)
+            m_directoryIndex.insert(directory, i);
+        indexModels(i, 0);
+    }
+}
+
+void ProjectRegistry::unindex(int first, int last)
+{
+    const auto inRange = [first, last](int index) { return index >= first && index <= last; };
+    for (int i = first; i <= last; ++i)
+    {
+        const SchemeRecord& scheme = m_schemes.at(i);
+        if (inRange(m_schemeIndex.value(scheme.id, -1)))
+            m_schemeIndex.remove(scheme.id);
+        const QString directory = directoryKey(scheme.workingDirectory);
+        if (inRange(m_directoryIndex.value(directory, -1)))
+            m_directoryIndex.remove(directory);
+        for (const ModelRecord& model : scheme.models)
+        {
+            const auto found = m_modelIndex.constFind(model.id);
+            if (found != m_modelIndex.constEnd() && inRange(found->scheme))
+                m_modelIndex.remove(model.id);
+        }
+    }
+}
+
+void ProjectRegistry::indexModels(int schemeIndex, int firstModel)
+{
+    const QVector<ModelRecord>& models = m_schemes.at(schemeIndex).models;
+    for (int j = firstModel; j < models.size(); ++j)
+    {
+        const auto it = m_modelIndex.constFind(models.at(j).id);
+        const bool earlier = it != m_modelIndex.constEnd() &&
+                             (it->scheme < schemeIndex ||
+                              (it->scheme == schemeIndex && it->model < firstModel));
+        if (!earlier)
+            m_modelIndex.insert(models.at(j).id, ModelLocation{ schemeIndex, j });
+    }
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include "ProjectTypes.h"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// 工程中全部方案与模型的唯一持有者，按 ID 与方案工作目录维护哈希索引，
+// 查找不随方案与模型数量增长。索引在每次增删时同步更新。
+// 通过指针修改名称、备注等字段是安全的；id 与 workingDirectory 参与索引，
+// 模型列表只能通过本类的接口增删。增删方案后此前返回的指针全部失效，
+// 增删模型后该方案下的模型指针失效
+class ProjectRegistry
+{
+public:
+    void reset(const QVector<SchemeRecord>& schemes);
+    void clear();
+
+    const QVector<SchemeRecord>& schemes() const { return m_schemes; }
+    int schemeCount() const { return m_schemes.size(); }
+    int modelCount() const { return m_modelIndex.size(); }
+
+    SchemeRecord* scheme(const QString& id);
+    const SchemeRecord* scheme(const QString& id) const;
+    // canonicalPath 须为规范化后的绝对路径
+    SchemeRecord* schemeByWorkingDirectory(const QString& canonicalPath);
+    ModelRecord* model(const QString& id, SchemeRecord** owner = nullptr);
+    const ModelRecord* model(const QString& id, const SchemeRecord** owner = nullptr) const;
+
+    SchemeRecord* addScheme(const SchemeRecord& scheme);
+    bool removeScheme(const QString& id);
+    ModelRecord* addModel(const QString& schemeId, const ModelRecord& model);
+    bool removeModel(const QString& id);
+    // 替换方案的全部模型
+    bool setModels(const QString& schemeId, const QVector<ModelRecord>& models);
+    // 把方案移到 index 处，只重建两个位置之间的索引
+    bool moveScheme(const QString& id, int index);
+
+private:
+    struct ModelLocation
+    {
+        int scheme;
+        int model;
+    };
+
+    // 从 first 开始重建方案位置及其模型位置，用于删除后的下标平移；last 为负时直到末尾
+    void reindexFrom(int first, int last = -1);
+    // 去掉指向 [first, last] 中方案及其模型的索引项
+    void unindex(int first, int last);
+    void indexModels(int schemeIndex, int firstModel);
+
+    QVector<SchemeRecord> m_schemes;
+    QHash<QString, int> m_schemeIndex;          // 方案 ID -> 下标
+    QHash<QString, int> m_directoryIndex;       // 规范化工作目录 -> 下标
+    QHash<QString, ModelLocation> m_modelIndex; // 模型 ID -> 方案与模型下标
+};
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <QString>
+#include <QVector>
+
+// 工程中的模型与方案记录，界面与无界面批处理共用
+struct ModelRecord {
+    QString id;
+    QString name;
+    QString directory;
+    QString jsonPath;
+    QString batPath;
+    QString remarks;
+};
+
+inline bool operator==(const ModelRecord& a, const ModelRecord& b)
+{
+    return a.id == b.id && a.name == b.name && a.directory == b.directory &&
+           a.jsonPath == b.jsonPath && a.batPath == b.batPath && a.remarks == b.remarks;
+}
+
+struct SchemeRecord {
+    QString id;
+    QString name;
+    QString workingDirectory;
+    QString thumbnailPath;
+    QString remarks;
+    QVector<ModelRecord> models;
+};
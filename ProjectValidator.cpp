@@ -0,0 +1,121 @@
+﻿#include "ProjectValidator.h"
+#include "ModelFiles.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+namespace
+{
+// 每批的模型数；太小时界面线程处理回调的次数过多，太大时标记出现得晚
+const int kBatchModels = 64;
+// 检查几乎只在等待文件系统，线程数可以多于核数
+const int kMaxThreads = 8;
+
+QString canonicalDirectory(const QString& path)
+{
+    const QString canonical = QDir(path).canonicalPath();
+    return canonical.isEmpty() ? QString() : QDir::cleanPath(canonical);
+}
+}
+
+ProjectValidator::ProjectValidator(QObject* parent)
+    : QObject(parent)
+{
+    m_pool = new QThreadPool(this);
+    m_pool->setMaxThreadCount(kMaxThreads);
+}
+
+ProjectValidator::~ProjectValidator()
+{
+    cancel();
+    m_pool->waitForDone();
+}
+
+void ProjectValidator::start(const QVector<SchemeRecord>& schemes)
+{
+    cancel();
+    const int generation = m_generation.load();
+    m_schemeCount = schemes.size();
+    m_modelCount = 0;
+    m_timer.start();
+
+    // 方案目录跟随它的第一批模型一起检查；没有模型的方案单独凑批
+    QVector<SchemeRecord> batchSchemes;
+    QVector<ModelRecord> batchModels;
+    auto submit = [this, generation, &batchSchemes, &batchModels]() {
+        if (batchSchemes.isEmpty() && batchModels.isEmpty())
+            return;
+        ++m_pendingBatches;
+        QtConcurrent::run(m_pool, [this, generation, batchSchemes, batchModels]() {
+            // 已被放弃的检查不再访问文件系统
+            const Batch batch = m_generation.load() == generation ? validate(batchSchemes, batchModels)
+                                                                  : Batch();
+            QMetaObject::invokeMethod(this, [this, generation, batch]() { onBatchDone(generation, batch); },
+                                      Qt::QueuedConnection);
+        });
+        batchSchemes.clear();
+        batchModels.clear();
+    };
+    for (const SchemeRecord& scheme : schemes)
+    {
+        batchSchemes.push_back(scheme);
+        batchSchemes.last().models.clear();
+        for (const ModelRecord& model : scheme.models)
+        {
+            batchModels.push_back(model);
+            if (batchModels.size() >= kBatchModels)
+                submit();
+        }
+        m_modelCount += scheme.models.size();
+        if (batchSchemes.size() >= kBatchModels)
+            submit();
+    }
+    submit();
+
+    if (m_pendingBatches == 0)
+        emit finished(m_schemeCount, m_modelCount, m_timer.elapsed());
+}
+
+void ProjectValidator::cancel()
+{
+    ++m_generation;
+    m_pendingBatches = 0;
+}
+
+ProjectValidator::Batch ProjectValidator::validate(const QVector<SchemeRecord>& schemes,
+                                                   const QVector<ModelRecord>& models)
+{
+    Batch batch;
+    batch.schemes.reserve(schemes.size());
+    for (const SchemeRecord& scheme : schemes)
+        batch.schemes.push_back({ scheme.id, canonicalDirectory(scheme.workingDirectory) });
+
+    batch.models.reserve(models.size());
+    for (const ModelRecord& model : models)
+    {
+        ModelState state;
+        state.modelId = model.id;
+        state.canonicalDirectory = canonicalDirectory(model.directory);
+        state.jsonExists = QFileInfo::exists(model.jsonPath);
+        if (!state.canonicalDirectory.isEmpty())
+        {
+            const QString runDir = ModelFiles::solverDirectory(model);
+            state.latestRun = RunJournal::latest(runDir);
+            state.resultFile = state.latestRun.isValid() ? state.latestRun.stlPath(runDir)
+                                                         : ModelFiles::latestResultFile(model.directory);
+        }
+        batch.models.push_back(state);
+    }
+    return batch;
+}
+
+void ProjectValidator::onBatchDone(int generation, const Batch& batch)
+{
+    if (generation != m_generation.load())
+        return;
+    emit batchValidated(batch);
+    if (--m_pendingBatches == 0)
+        emit finished(m_schemeCount, m_modelCount, m_timer.elapsed());
+}
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include "ProjectTypes.h"
+#include "RunJournal.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+class QThreadPool;
+
+// 打开工程后在后台检查方案与模型的路径：规范化目录、确认目录与参数文件存在，
+// 并顺带读取每个模型运行日志的最后一条。模型按批分给多个线程，
+// 网络盘上的延迟可以互相重叠；每批完成后立即交回界面线程
+class ProjectValidator : public QObject
+{
+    Q_OBJECT
+public:
+    struct SchemeState
+    {
+        QString schemeId;
+        QString canonicalDirectory;     // 目录不存在时为空
+    };
+
+    struct ModelState
+    {
+        QString modelId;
+        QString canonicalDirectory;     // 目录不存在时为空
+        bool jsonExists = false;
+        RunRecord latestRun;
+        QString resultFile;             // 最新结果文件，用于生成缩略图
+    };
+
+    struct Batch
+    {
+        QVector<SchemeState> schemes;
+        QVector<ModelState> models;
+    };
+
+    explicit ProjectValidator(QObject* parent = nullptr);
+    ~ProjectValidator() override;
+
+    // 放弃上一次未完成的检查
+    void start(const QVector<SchemeRecord>& schemes);
+    void cancel();
+
+signals:
+    void batchValidated(const ProjectValidator::Batch& batch);
+    void finished(int schemeCount, int modelCount, qint64 elapsedMs);
+
+private:
+    static Batch validate(const QVector<SchemeRecord>& schemes, const QVector<ModelRecord>& models);
+    void onBatchDone(int generation, const Batch& batch);
+
+    QThreadPool* m_pool = nullptr;
+    std::atomic<int> m_generation{ 0 };
+    int m_pendingBatches = 0;
+    int m_schemeCount = 0;
+    int m_modelCount = 0;
+    QElapsedTimer m_timer;
+};
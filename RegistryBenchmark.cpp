@@ -0,0 +1,147 @@
+﻿#include "RegistryBenchmark.h"
+#include "ProjectRegistry.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <random>
+
+namespace
+{
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("RegistryBenchmark", text);
+}
+
+const int kModelsPerScheme = 30;
+const int kIndexedQueries = 200000;
+// 逐个遍历在十万模型时每次需要数百微秒，只测少量次数
+const int kLinearQueries = 200;
+
+QVector<SchemeRecord> makeSchemes(int modelCount)
+{
+    QVector<SchemeRecord> schemes;
+    schemes.reserve(modelCount / kModelsPerScheme + 1);
+    for (int i = 0; i < modelCount; ++i)
+    {
+        if (i % kModelsPerScheme == 0)
+        {
+            SchemeRecord scheme;
+            scheme.id = QStringLiteral("scheme-%1").arg(schemes.size());
+            scheme.name = scheme.id;
+            scheme.workingDirectory = QStringLiteral("C:/bench/%1").arg(scheme.id);
+            schemes.push_back(scheme);
+        }
+        ModelRecord model;
+        model.id = QStringLiteral("model-%1").arg(i);
+        model.name = model.id;
+        model.directory = QStringLiteral("%1/%2").arg(schemes.last().workingDirectory, model.id);
+        schemes.last().models.push_back(model);
+    }
+    return schemes;
+}
+
+// 与原先 MainWindow::modelById 相同的双重循环，作为对照
+const ModelRecord* linearModelById(const QVector<SchemeRecord>& schemes, const QString& id)
+{
+    for (const SchemeRecord& scheme : schemes)
+    {
+        for (const ModelRecord& model : scheme.models)
+        {
+            if (model.id == id)
+                return &model;
+        }
+    }
+    return nullptr;
+}
+
+double nanosecondsPerQuery(const QElapsedTimer& timer, int queries)
+{
+    return double(timer.nsecsElapsed()) / qMax(1, queries);
+}
+}
+
+namespace RegistryBenchmark
+{
+int measureLookups(int maxModels, QTextStream& out)
+{
+    maxModels = qBound(1000, maxModels, 10000000);
+    out << tr("方案与模型查找：每个方案 %1 个模型，索引查找 %2 次，遍历查找 %3 次")
+               .arg(kModelsPerScheme)
+               .arg(kIndexedQueries)
+               .arg(kLinearQueries)
+        << '\n';
+    out << tr("  %1 %2 %3 %4 %5 %6")
+               .arg(tr("模型数"), 8)
+               .arg(tr("建立索引 ms"), 12)
+               .arg(tr("按模型 ID ns"), 14)
+               .arg(tr("按方案 ID ns"), 14)
+               .arg(tr("按目录 ns"), 12)
+               .arg(tr("遍历 ns"), 12)
+        << '\n';
+    out.flush();
+
+    int failures = 0;
+    std::mt19937 random(20240601);
+    for (int modelCount = 1000; modelCount <= maxModels; modelCount *= 10)
+    {
+        const QVector<SchemeRecord> schemes = makeSchemes(modelCount);
+        // 查询用的键预先生成，不计入查找耗时
+        std::uniform_int_distribution<int> pickModel(0, modelCount - 1);
+        std::uniform_int_distribution<int> pickScheme(0, schemes.size() - 1);
+        QVector<QString> modelIds;
+        QVector<QString> schemeIds;
+        QVector<QString> directories;
+        modelIds.reserve(kIndexedQueries);
+        schemeIds.reserve(kIndexedQueries);
+        directories.reserve(kIndexedQueries);
+        for (int i = 0; i < kIndexedQueries; ++i)
+        {
+            modelIds << QStringLiteral("model-%1").arg(pickModel(random));
+            const SchemeRecord& scheme = schemes.at(pickScheme(random));
+            schemeIds << scheme.id;
+            directories << scheme.workingDirectory;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        ProjectRegistry registry;
+        registry.reset(schemes);
+        const qint64 buildMs = timer.elapsed();
+
+        timer.restart();
+        for (const QString& id : modelIds)
+            failures += registry.model(id) ? 0 : 1;
+        const double byModel = nanosecondsPerQuery(timer, modelIds.size());
+
+        timer.restart();
+        for (const QString& id : schemeIds)
+            failures += registry.scheme(id) ? 0 : 1;
+        const double byScheme = nanosecondsPerQuery(timer, schemeIds.size());
+
+        timer.restart();
+        for (const QString& directory : directories)
+            failures += registry.schemeByWorkingDirectory(directory) ? 0 : 1;
+        const double byDirectory = nanosecondsPerQuery(timer, directories.size());
+
+        timer.restart();
+        for (int i = 0; i < kLinearQueries; ++i)
+            failures += linearModelById(schemes, modelIds.at(i)) ? 0 : 1;
+        const double linear = nanosecondsPerQuery(timer, kLinearQueries);
+
+        out << QStringLiteral("  %1 %2 %3 %4 %5 %6")
+                   .arg(modelCount, 8)
+                   .arg(buildMs, 12)
+                   .arg(byModel, 14, 'f', 0)
+                   .arg(byScheme, 14, 'f', 0)
+                   .arg(byDirectory, 12, 'f', 0)
+                   .arg(linear, 12, 'f', 0)
+            << '\n';
+        out.flush();
+    }
+    if (failures > 0)
+        out << tr("  有 %1 次查找没有找到应有的记录").arg(failures) << '\n';
+    return failures == 0 ? 0 : 1;
+}
+}
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+class QTextStream;
+
+// 命令行下的方案与模型查找基准测试
+namespace RegistryBenchmark
+{
+// 按 1000、10000 …… 直到 maxModels 个模型生成内存中的工程（每个方案 30 个模型），
+// 分别测量 ProjectRegistry 按 ID、按工作目录查找与逐个遍历查找的平均耗时。
+// 有查找结果错误时返回非零
+int measureLookups(int maxModels, QTextStream& out);
+}
@@ -0,0 +1,655 @@
+﻿#include "ResourceMonitor.h"
+
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QLocale>
+#include <QSet>
+#include <QTimer>
+#include <QtConcurrent>
+
+#ifdef Q_OS_LINUX
+#include <QDir>
+#include <QFile>
+
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#endif
+
+namespace
+{
+const int kSampleIntervalMs = 1000;
+
+// 同时在采样的监视器；RUSAGE_CHILDREN 是整个进程的累计值，只有单任务运行时才能归属
+QSet<ResourceMonitor*>& activeMonitors()
+{
+    static QSet<ResourceMonitor*> monitors;
+    return monitors;
+}
+
+// 全部监视器共用的采样定时器，第一次启动监视时创建
+QTimer*& sharedSampler()
+{
+    static QTimer* timer = nullptr;
+    return timer;
+}
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("ResourceMonitor", text);
+}
+
+void insertIfKnown(QJsonObject& obj, const QString& key, qint64 value)
+{
+    if (value >= 0)
+        obj.insert(key, double(value));
+}
+
+qint64 readOptional(const QJsonObject& obj, const QString& key)
+{
+    const QJsonValue value = obj.value(key);
+    return value.isDouble() ? qint64(value.toDouble()) : -1;
+}
+
+#ifdef Q_OS_LINUX
+struct ProcStat
+{
+    qint64 ppid = 0;
+    qint64 pgrp = 0;
+    qint64 utimeTicks = 0;
+    qint64 stimeTicks = 0;
+    QByteArray startTime;
+    qint64 rssPages = 0;
+};
+
+QByteArray readProcFile(const QString& path)
+{
+    // /proc 文件的 size() 为 0，只能一直读到结束
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+bool parseProcStat(const QByteArray& data, ProcStat* stat)
+{
+    // 进程名可能包含空格和括号，字段从最后一个 ')' 之后开始计数（第 3 个字段起）
+    const int close = data.lastIndexOf(')');
+    if (close < 0)
+        return false;
+    const QList<QByteArray> fields = data.mid(close + 2).split(' ');
+    if (fields.size() < 22)
+        return false;
+    stat->ppid = fields.at(1).toLongLong();
+    stat->pgrp = fields.at(2).toLongLong();
+    stat->utimeTicks = fields.at(11).toLongLong();
+    stat->stimeTicks = fields.at(12).toLongLong();
+    stat->startTime = fields.at(19);
+    stat->rssPages = fields.at(21).toLongLong();
+    return true;
+}
+
+qint64 fieldValue(const QByteArray& data, const QByteArray& name)
+{
+    // 字段位于行首，"voluntary_ctxt_switches" 不能匹配到 "nonvoluntary_ctxt_switches"
+    int pos = 0;
+    if (!data.startsWith(name))
+    {
+        pos = data.indexOf('\n' + name);
+        if (pos < 0)
+            return -1;
+        ++pos;
+    }
+    const int begin = pos + name.size();
+    const int end = data.indexOf('\n', begin);
+    QByteArray value = data.mid(begin, end < 0 ? -1 : end - begin).trimmed();
+    const int space = value.indexOf(' ');
+    if (space > 0)
+        value.truncate(space);
+    bool ok = false;
+    const qint64 result = value.toLongLong(&ok);
+    return ok ? result : -1;
+}
+
+int openCounter(qint64 pid, quint64 config)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.inherit = 1;           // 之后创建的子进程退出时计数并入父进程
+    attr.exclude_kernel = 1;    // perf_event_paranoid=2 时仍允许统计用户态
+    attr.exclude_hv = 1;
+    return int(::syscall(__NR_perf_event_open, &attr, pid_t(pid), -1, -1, 0));
+}
+
+qint64 readCounter(int fd)
+{
+    if (fd < 0)
+        return -1;
+    quint64 value = 0;
+    if (::read(fd, &value, sizeof(value)) != ssize_t(sizeof(value)))
+        return -1;
+    return qint64(value);
+}
+#endif
+
+qint64 physicalMemoryBytes()
+{
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (::GlobalMemoryStatusEx(&status))
+        return qint64(status.ullTotalPhys);
+    return 0;
+#elif defined(Q_OS_LINUX)
+    return qint64(::sysconf(_SC_PHYS_PAGES)) * qint64(::sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+#ifdef Q_OS_UNIX
+double timevalSeconds(const timeval& tv)
+{
+    return double(tv.tv_sec) + double(tv.tv_usec) / 1e6;
+}
+#endif
+
+#ifdef Q_OS_WIN
+double fileTimeSeconds(const FILETIME& ft)
+{
+    ULARGE_INTEGER value;
+    value.LowPart = ft.dwLowDateTime;
+    value.HighPart = ft.dwHighDateTime;
+    return double(value.QuadPart) / 1e7;    // 100ns 为单位
+}
+#endif
+}
+
+double ResourceUsage::averageCores() const
+{
+    if (wallMs <= 0)
+        return 0.0;
+    return (userSeconds + systemSeconds) * 1000.0 / double(wallMs);
+}
+
+QString ResourceUsage::summaryText() const
+{
+    if (!valid)
+        return QString();
+
+    const QLocale locale;
+    QStringList parts;
+    parts << tr("耗时 %1 s").arg(double(wallMs) / 1000.0, 0, 'f', 1);
+    parts << tr("CPU 用户态 %1 s / 内核态 %2 s（平均 %3 核）")
+                 .arg(userSeconds, 0, 'f', 1)
+                 .arg(systemSeconds, 0, 'f', 1)
+                 .arg(averageCores(), 0, 'f', 2);
+    parts << tr("峰值内存 %1").arg(locale.formattedDataSize(peakRssBytes));
+    if (readBytes >= 0 || writeBytes >= 0)
+        parts << tr("读 %1 / 写 %2")
+                     .arg(locale.formattedDataSize(qMax<qint64>(readBytes, 0)),
+                          locale.formattedDataSize(qMax<qint64>(writeBytes, 0)));
+    if (voluntarySwitches >= 0)
+        parts << tr("上下文切换 %1 主动 / %2 被动")
+                     .arg(voluntarySwitches)
+                     .arg(involuntarySwitches);
+    if (instructions > 0 && cycles > 0)
+        parts << tr("IPC %1").arg(double(instructions) / double(cycles), 0, 'f', 2);
+    return parts.join(QStringLiteral("；"));
+}
+
+QString ResourceUsage::boundHint() const
+{
+    if (!valid || wallMs < 1000)
+        return QString();
+
+    const qint64 physical = physicalMemoryBytes();
+    if (physical > 0 && peakRssBytes > physical / 2)
+        return tr("内存占用超过本机物理内存的一半，并行运行多个此类模型可能导致换页");
+
+    const double cores = averageCores();
+    const qint64 ioBytes = qMax<qint64>(readBytes, 0) + qMax<qint64>(writeBytes, 0);
+    const double cpuSeconds = userSeconds + systemSeconds;
+    if (cores < 0.5 && (ioBytes > 1024LL * 1024 * 1024 ||
+                        (cpuSeconds > 0.0 && systemSeconds / cpuSeconds > 0.3)))
+        return tr("CPU 大部分时间处于等待，读写量较大，可能受磁盘 I/O 限制");
+    if (cores >= 0.8)
+        return tr("以计算为主，增加线程数或并行任务数更有效");
+    return QString();
+}
+
+QJsonObject ResourceUsage::toJson() const
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("wallMs"), double(wallMs));
+    obj.insert(QStringLiteral("userSeconds"), userSeconds);
+    obj.insert(QStringLiteral("systemSeconds"), systemSeconds);
+    obj.insert(QStringLiteral("peakRssBytes"), double(peakRssBytes));
+    obj.insert(QStringLiteral("processCount"), processCount);
+    insertIfKnown(obj, QStringLiteral("readBytes"), readBytes);
+    insertIfKnown(obj, QStringLiteral("writeBytes"), writeBytes);
+    insertIfKnown(obj, QStringLiteral("voluntarySwitches"), voluntarySwitches);
+    insertIfKnown(obj, QStringLiteral("involuntarySwitches"), involuntarySwitches);
+    insertIfKnown(obj, QStringLiteral("instructions"), instructions);
+    insertIfKnown(obj, QStringLiteral("cycles"), cycles);
+    return obj;
+}
+
+ResourceUsage ResourceUsage::fromJson(const QJsonObject& obj)
+{
+    ResourceUsage usage;
+    if (!obj.contains(QStringLiteral("wallMs")))
+        return usage;
+    usage.valid = true;
+    usage.wallMs = qint64(obj.value(QStringLiteral("wallMs")).toDouble());
+    usage.userSeconds = obj.value(QStringLiteral("userSeconds")).toDouble();
+    usage.systemSeconds = obj.value(QStringLiteral("systemSeconds")).toDouble();
+    usage.peakRssBytes = qint64(obj.value(QStringLiteral("peakRssBytes")).toDouble());
+    usage.processCount = obj.value(QStringLiteral("processCount")).toInt();
+    usage.readBytes = readOptional(obj, QStringLiteral("readBytes"));
+    usage.writeBytes = readOptional(obj, QStringLiteral("writeBytes"));
+    usage.voluntarySwitches = readOptional(obj, QStringLiteral("voluntarySwitches"));
+    usage.involuntarySwitches = readOptional(obj, QStringLiteral("involuntarySwitches"));
+    usage.instructions = readOptional(obj, QStringLiteral("instructions"));
+    usage.cycles = readOptional(obj, QStringLiteral("cycles"));
+    return usage;
+}
+
+struct ResourceMonitor::ProcessReading
+{
+    qint64 pid = 0;
+    QString key;            // pid + 启动时间；Windows 上由界面线程打开进程后得到
+    ProcessSample sample;   // 仅 Linux：扫描时已读出的计数
+};
+
+ResourceMonitor::ResourceMonitor(QObject* parent)
+    : QObject(parent)
+{
+}
+
+ResourceMonitor::~ResourceMonitor()
+{
+    activeMonitors().remove(this);
+    closeHardwareCounters();
+    closeHandles();
+}
+
+void ResourceMonitor::start(qint64 pid)
+{
+    if (pid <= 0)
+        return;
+
+    closeHardwareCounters();
+    closeHandles();
+    m_processes.clear();
+    m_usage = ResourceUsage();
+    m_pid = pid;
+    m_clock.start();
+
+#ifdef Q_OS_UNIX
+    m_exclusive = activeMonitors().isEmpty();
+    for (ResourceMonitor* other : activeMonitors())
+        other->m_exclusive = false;
+
+    rusage ru;
+    if (::getrusage(RUSAGE_CHILDREN, &ru) == 0)
+    {
+        m_childUserStart = timevalSeconds(ru.ru_utime);
+        m_childSystemStart = timevalSeconds(ru.ru_stime);
+        m_childMaxRssStart = ru.ru_maxrss;
+        m_childInBlockStart = ru.ru_inblock;
+        m_childOutBlockStart = ru.ru_oublock;
+        m_childNvcswStart = ru.ru_nvcsw;
+        m_childNivcswStart = ru.ru_nivcsw;
+    }
+#endif
+    activeMonitors().insert(this);
+
+    openHardwareCounters();
+    QTimer*& sampler = sharedSampler();
+    if (!sampler)
+    {
+        sampler = new QTimer(QCoreApplication::instance());
+        sampler->setInterval(kSampleIntervalMs);
+        QObject::connect(sampler, &QTimer::timeout, &ResourceMonitor::sampleActive);
+    }
+    if (!sampler->isActive())
+    {
+        sampler->start();
+        sampleActive();
+    }
+}
+
+void ResourceMonitor::stop()
+{
+    if (m_pid <= 0)
+        return;
+
+    // Windows 上通过保留的句柄读取已退出进程的最终计数；Linux 沿用最近一个周期的采样，由下面的 rusage 补齐
+    applyReadings(QVector<ProcessReading>());
+    activeMonitors().remove(this);
+
+    m_usage.valid = true;
+    m_usage.wallMs = m_clock.elapsed();
+    accumulate();
+
+#ifdef Q_OS_UNIX
+    // 已被回收的子进程在 /proc 中消失，最后一个采样周期的消耗由 rusage 补齐
+    rusage ru;
+    if (m_exclusive && ::getrusage(RUSAGE_CHILDREN, &ru) == 0)
+    {
+        m_usage.userSeconds = qMax(m_usage.userSeconds, timevalSeconds(ru.ru_utime) - m_childUserStart);
+        m_usage.systemSeconds = qMax(m_usage.systemSeconds, timevalSeconds(ru.ru_stime) - m_childSystemStart);
+        // ru_maxrss 是历史上最大子进程的值（KB），只有本次运行刷新了它才可归属
+        if (ru.ru_maxrss > m_childMaxRssStart)
+            m_usage.peakRssBytes = qMax<qint64>(m_usage.peakRssBytes, qint64(ru.ru_maxrss) * 1024);
+        m_usage.voluntarySwitches = qMax<qint64>(m_usage.voluntarySwitches, ru.ru_nvcsw - m_childNvcswStart);
+        m_usage.involuntarySwitches = qMax<qint64>(m_usage.involuntarySwitches, ru.ru_nivcsw - m_childNivcswStart);
+        if (m_usage.readBytes < 0)
+            m_usage.readBytes = (ru.ru_inblock - m_childInBlockStart) * 512;
+        if (m_usage.writeBytes < 0)
+            m_usage.writeBytes = (ru.ru_oublock - m_childOutBlockStart) * 512;
+    }
+#endif
+#ifdef Q_OS_LINUX
+    m_usage.instructions = readCounter(m_instructionsFd);
+    m_usage.cycles = readCounter(m_cyclesFd);
+#endif
+
+    closeHardwareCounters();
+    closeHandles();
+    m_pid = 0;
+}
+
+void ResourceMonitor::accumulate()
+{
+    // 每个进程保留最后一次采样值，已退出的进程同样计入
+    ResourceUsage& u = m_usage;
+    u.userSeconds = 0.0;
+    u.systemSeconds = 0.0;
+    u.processCount = m_processes.size();
+    qint64 peakSingle = 0;
+    for (const ProcessSample& p : qAsConst(m_processes))
+    {
+        u.userSeconds += p.userSeconds;
+        u.systemSeconds += p.systemSeconds;
+        peakSingle = qMax(peakSingle, p.peakRssBytes);
+        if (p.readBytes >= 0)
+            u.readBytes = qMax<qint64>(u.readBytes, 0) + p.readBytes;
+        if (p.writeBytes >= 0)
+            u.writeBytes = qMax<qint64>(u.writeBytes, 0) + p.writeBytes;
+        if (p.voluntarySwitches >= 0)
+            u.voluntarySwitches = qMax<qint64>(u.voluntarySwitches, 0) + p.voluntarySwitches;
+        if (p.involuntarySwitches >= 0)
+            u.involuntarySwitches = qMax<qint64>(u.involuntarySwitches, 0) + p.involuntarySwitches;
+    }
+    u.peakRssBytes = qMax(u.peakRssBytes, peakSingle);
+}
+
+void ResourceMonitor::sampleActive()
+{
+    using Trees = QHash<qint64, QVector<ProcessReading>>;
+    static bool scanning = false;
+    if (activeMonitors().isEmpty())
+    {
+        if (sharedSampler())
+            sharedSampler()->stop();
+        return;
+    }
+    // 上一次扫描还没结束时跳过本周期
+    if (scanning)
+        return;
+
+    QVector<qint64> roots;
+    for (ResourceMonitor* monitor : qAsConst(activeMonitors()))
+        roots.append(monitor->m_pid);
+    scanning = true;
+    auto* watcher = new QFutureWatcher<Trees>();
+    QObject::connect(watcher, &QFutureWatcher<Trees>::finished, watcher, [watcher]() {
+        const Trees trees = watcher->result();
+        watcher->deleteLater();
+        scanning = false;
+        // 期间停止的监视器已不在集合中；重新启动的监视器按新的根进程号匹配
+        for (ResourceMonitor* monitor : qAsConst(activeMonitors()))
+        {
+            const auto it = trees.constFind(monitor->m_pid);
+            if (it != trees.constEnd())
+                monitor->applyReadings(it.value());
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([roots]() { return scanProcessTrees(roots); }));
+}
+
+QHash<qint64, QVector<ResourceMonitor::ProcessReading>> ResourceMonitor::scanProcessTrees(const QVector<qint64>& roots)
+{
+    QHash<qint64, QVector<ProcessReading>> trees;
+#if defined(Q_OS_LINUX)
+    static const long ticksPerSecond = ::sysconf(_SC_CLK_TCK);
+    static const long pageSize = ::sysconf(_SC_PAGESIZE);
+
+    // 先读全部进程的 stat，按父进程号与进程组建立索引，结果与 /proc 的枚举顺序无关
+    QHash<qint64, ProcStat> stats;
+    QHash<qint64, QVector<qint64>> children;
+    QHash<qint64, QVector<qint64>> groups;
+    const QStringList entries = QDir(QStringLiteral("/proc")).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries)
+    {
+        bool ok = false;
+        const qint64 pid = entry.toLongLong(&ok);
+        if (!ok)
+            continue;
+        ProcStat stat;
+        if (!parseProcStat(readProcFile(QStringLiteral("/proc/") + entry + QStringLiteral("/stat")), &stat))
+            continue;
+        stats.insert(pid, stat);
+        children[stat.ppid].append(pid);
+        groups[stat.pgrp].append(pid);
+    }
+
+    for (qint64 root : roots)
+    {
+        // 进程组内的进程，以及脱离进程组但仍是其后代的进程
+        QVector<qint64> members = groups.value(root);
+        if (!members.contains(root))
+            members.prepend(root);
+        QSet<qint64> seen;
+        for (qint64 pid : qAsConst(members))
+            seen.insert(pid);
+        for (int i = 0; i < members.size(); ++i)
+        {
+            for (qint64 child : children.value(members.at(i)))
+            {
+                if (!seen.contains(child))
+                {
+                    seen.insert(child);
+                    members.append(child);
+                }
+            }
+        }
+
+        QVector<ProcessReading>& readings = trees[root];
+        for (qint64 pid : qAsConst(members))
+        {
+            const auto it = stats.constFind(pid);
+            if (it == stats.constEnd())
+                continue;
+            const ProcStat& stat = it.value();
+            ProcessReading reading;
+            reading.pid = pid;
+            reading.key = QString::number(pid) + QLatin1Char(':') + QString::fromLatin1(stat.startTime);
+            ProcessSample& p = reading.sample;
+            p.alive = true;
+            p.userSeconds = double(stat.utimeTicks) / double(ticksPerSecond);
+            p.systemSeconds = double(stat.stimeTicks) / double(ticksPerSecond);
+            p.rssBytes = stat.rssPages * pageSize;
+
+            const QString base = QStringLiteral("/proc/") + QString::number(pid);
+            const QByteArray status = readProcFile(base + QStringLiteral("/status"));
+            const qint64 hwmKb = fieldValue(status, "VmHWM:");
+            p.peakRssBytes = hwmKb >= 0 ? hwmKb * 1024 : p.rssBytes;
+            p.voluntarySwitches = fieldValue(status, "voluntary_ctxt_switches:");
+            p.involuntarySwitches = fieldValue(status, "nonvoluntary_ctxt_switches:");
+
+            const QByteArray io = readProcFile(base + QStringLiteral("/io"));
+            if (!io.isEmpty())
+            {
+                p.readBytes = fieldValue(io, "read_bytes:");
+                p.writeBytes = fieldValue(io, "write_bytes:");
+            }
+            readings.append(reading);
+        }
+    }
+#elif defined(Q_OS_WIN)
+    HANDLE snapshot = ::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE)
+        return trees;
+    // 子进程的父进程号不会改变，从根进程向下逐层收集；计数由界面线程通过进程句柄读取
+    QHash<DWORD, QVector<DWORD>> children;
+    PROCESSENTRY32W entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = ::Process32FirstW(snapshot, &entry); ok; ok = ::Process32NextW(snapshot, &entry))
+        children[entry.th32ParentProcessID].append(entry.th32ProcessID);
+    ::CloseHandle(snapshot);
+
+    for (qint64 root : roots)
+    {
+        QVector<ProcessReading>& readings = trees[root];
+        QVector<DWORD> pending(1, DWORD(root));
+        QSet<DWORD> visited;
+        while (!pending.isEmpty())
+        {
+            const DWORD pid = pending.takeLast();
+            if (visited.contains(pid))
+                continue;
+            visited.insert(pid);
+            pending += children.value(pid);
+            ProcessReading reading;
+            reading.pid = pid;
+            readings.append(reading);
+        }
+    }
+#else
+    Q_UNUSED(roots);
+#endif
+    return trees;
+}
+
+void ResourceMonitor::applyReadings(const QVector<ProcessReading>& readings)
+{
+    if (m_pid <= 0)
+        return;
+
+    qint64 treeRss = 0;
+    for (ProcessSample& p : m_processes)
+        p.alive = false;
+
+#if defined(Q_OS_WIN)
+    for (const ProcessReading& reading : readings)
+    {
+        const DWORD pid = DWORD(reading.pid);
+        HANDLE handle = ::OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+        if (!handle)
+            continue;
+        FILETIME created, exited, kernel, user;
+        if (!::GetProcessTimes(handle, &created, &exited, &kernel, &user))
+        {
+            ::CloseHandle(handle);
+            continue;
+        }
+        const QString key = QStringLiteral("%1:%2").arg(pid).arg(fileTimeSeconds(created), 0, 'f', 7);
+        ProcessSample& p = m_processes[key];
+        if (p.handle)
+            ::CloseHandle(handle);
+        else
+            p.handle = handle;
+        p.alive = true;
+    }
+
+    for (ProcessSample& p : m_processes)
+    {
+        // 已退出的进程通过保留的句柄读取最终值
+        if (!p.handle)
+            continue;
+        HANDLE handle = static_cast<HANDLE>(p.handle);
+        FILETIME created, exited, kernel, user;
+        if (::GetProcessTimes(handle, &created, &exited, &kernel, &user))
+        {
+            p.userSeconds = fileTimeSeconds(user);
+            p.systemSeconds = fileTimeSeconds(kernel);
+        }
+        PROCESS_MEMORY_COUNTERS memory;
+        if (::GetProcessMemoryInfo(handle, &memory, sizeof(memory)))
+        {
+            p.rssBytes = p.alive ? qint64(memory.WorkingSetSize) : 0;
+            p.peakRssBytes = qMax(p.peakRssBytes, qint64(memory.PeakWorkingSetSize));
+        }
+        IO_COUNTERS io;
+        if (::GetProcessIoCounters(handle, &io))
+        {
+            p.readBytes = qint64(io.ReadTransferCount);
+            p.writeBytes = qint64(io.WriteTransferCount);
+        }
+        treeRss += p.rssBytes;
+    }
+#else
+    for (const ProcessReading& reading : readings)
+    {
+        ProcessSample& p = m_processes[reading.key];
+        const qint64 peak = qMax(p.peakRssBytes, reading.sample.peakRssBytes);
+        p = reading.sample;
+        p.peakRssBytes = peak;
+        treeRss += p.rssBytes;
+    }
+#endif
+
+    m_usage.peakRssBytes = qMax(m_usage.peakRssBytes, treeRss);
+}
+
+void ResourceMonitor::openHardwareCounters()
+{
+#ifdef Q_OS_LINUX
+    // 计数器在脚本启动后才附加，之后派生的求解进程通过 inherit 计入；
+    // 内核或容器不允许时静默跳过
+    m_instructionsFd = openCounter(m_pid, PERF_COUNT_HW_INSTRUCTIONS);
+    m_cyclesFd = openCounter(m_pid, PERF_COUNT_HW_CPU_CYCLES);
+#endif
+}
+
+void ResourceMonitor::closeHardwareCounters()
+{
+#ifdef Q_OS_UNIX
+    if (m_instructionsFd >= 0)
+        ::close(m_instructionsFd);
+    if (m_cyclesFd >= 0)
+        ::close(m_cyclesFd);
+    m_instructionsFd = -1;
+    m_cyclesFd = -1;
+#endif
+}
+
+void ResourceMonitor::closeHandles()
+{
+#ifdef Q_OS_WIN
+    for (ProcessSample& p : m_processes)
+    {
+        if (p.handle)
+            ::CloseHandle(static_cast<HANDLE>(p.handle));
+        p.handle = nullptr;
+    }
+#endif
+}
@@ -0,0 +1,99 @@
+﻿#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+// 一次求解运行（脚本及其全部子进程）的资源消耗，-1 表示当前平台无法获取
+struct ResourceUsage
+{
+    bool valid = false;
+    qint64 wallMs = 0;
+    double userSeconds = 0.0;
+    double systemSeconds = 0.0;
+    qint64 peakRssBytes = 0;            // 进程树同时驻留内存的峰值
+    qint64 readBytes = -1;
+    qint64 writeBytes = -1;
+    qint64 voluntarySwitches = -1;
+    qint64 involuntarySwitches = -1;
+    qint64 instructions = -1;           // 硬件计数器，仅 Linux 且内核允许时可用
+    qint64 cycles = -1;
+    int processCount = 0;
+
+    // 平均占用的 CPU 核数：(用户态 + 内核态) / 墙钟时间
+    double averageCores() const;
+    QString summaryText() const;
+    // 粗略判断瓶颈：内存、I/O 或 CPU，无法判断时返回空
+    QString boundHint() const;
+    QJsonObject toJson() const;
+    static ResourceUsage fromJson(const QJsonObject& obj);
+};
+
+// 定时采样求解进程树：Linux 读取 /proc 并结合 rusage 与 perf_event_open，
+// Windows 通过 Toolhelp32 枚举子进程并读取进程时间、内存与 I/O 计数。
+// 同时运行的全部监视器共用一个采样周期，每个周期只在工作线程中枚举一次进程表，
+// 按父进程号建立进程树后分给各个监视器
+class ResourceMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResourceMonitor(QObject* parent = nullptr);
+    ~ResourceMonitor() override;
+
+    // 进程启动后调用；pid 在 Unix 上同时是脚本所在进程组的组号
+    void start(qint64 pid);
+    // 进程结束后调用，汇总最终结果
+    void stop();
+
+    bool isRunning() const { return m_pid > 0; }
+    const ResourceUsage& usage() const { return m_usage; }
+
+private:
+    struct ProcessSample
+    {
+        double userSeconds = 0.0;
+        double systemSeconds = 0.0;
+        qint64 rssBytes = 0;
+        qint64 peakRssBytes = 0;
+        qint64 readBytes = -1;
+        qint64 writeBytes = -1;
+        qint64 voluntarySwitches = -1;
+        qint64 involuntarySwitches = -1;
+        bool alive = false;
+#ifdef Q_OS_WIN
+        void* handle = nullptr;         // 保持句柄，进程退出后仍可读取最终计数
+#endif
+    };
+
+    // 一次扫描中属于某个进程树的一个进程
+    struct ProcessReading;
+
+    static void sampleActive();
+    static QHash<qint64, QVector<ProcessReading>> scanProcessTrees(const QVector<qint64>& roots);
+    void applyReadings(const QVector<ProcessReading>& readings);
+    void accumulate();
+    void openHardwareCounters();
+    void closeHardwareCounters();
+    void closeHandles();
+
+    QElapsedTimer m_clock;
+    qint64 m_pid = 0;
+    QHash<QString, ProcessSample> m_processes;  // 以 pid + 启动时间为键，避免 pid 复用
+    ResourceUsage m_usage;
+
+#ifdef Q_OS_UNIX
+    int m_instructionsFd = -1;
+    int m_cyclesFd = -1;
+    bool m_exclusive = true;            // 运行期间没有其他任务，可以使用 RUSAGE_CHILDREN 的差值
+    double m_childUserStart = 0.0;
+    double m_childSystemStart = 0.0;
+    long m_childMaxRssStart = 0;
+    qint64 m_childInBlockStart = 0;
+    qint64 m_childOutBlockStart = 0;
+    qint64 m_childNvcswStart = 0;
+    qint64 m_childNivcswStart = 0;
+#endif
+};
@@ -0,0 +1,379 @@
+﻿#include "ResultCache.h"
+#include "ModelFiles.h"
+#include "ResultReaderRegistry.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QUuid>
+#include <QVector>
+#include <algorithm>
+
+namespace
+{
+// 缓存格式或键的组成发生变化时递增，旧条目自然失效
+const char kKeyVersion[] = "flexsim-result-cache-v1";
+const char kEntryFileName[] = "entry.json";
+
+qint64 directorySize(const QString& path)
+{
+    qint64 total = 0;
+    const QFileInfoList files = QDir(path).entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
+    for (const QFileInfo& info : files)
+        total += info.size();
+    return total;
+}
+
+bool copyReplacing(const QString& source, const QString& target)
+{
+    QFile::remove(target);
+    if (!QFile::copy(source, target))
+        return false;
+    // 复制后的文件以当前时间为修改时间，保证“最新 STL”判断能选中它
+    QFile file(target);
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+}
+
+ResultCache::ResultCache(const QString& rootPath, qint64 maxBytes)
+    : m_rootPath(QDir::cleanPath(rootPath))
+    , m_maxBytes(qMax<qint64>(0, maxBytes))
+{
+}
+
+void ResultCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = qMax<qint64>(0, maxBytes);
+    if (m_indexLoaded)
+        evictLocked();
+}
+
+qint64 ResultCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxBytes;
+}
+
+qint64 ResultCache::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalBytes;
+}
+
+QString ResultCache::computeKey(const QString& workingDirectory,
+                                const QString& program,
+                                const QStringList& arguments)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray(kKeyVersion));
+    hash.addData(program.toUtf8());
+    for (const QString& argument : arguments)
+    {
+        hash.addData("\0", 1);
+        hash.addData(argument.toUtf8());
+    }
+
+    const QDir root(workingDirectory);
+    const QFileInfoList inputs = ModelFiles::inputFiles(workingDirectory);
+    for (const QFileInfo& info : inputs)
+    {
+        hash.addData("\n", 1);
+        hash.addData(root.relativeFilePath(info.absoluteFilePath()).toUtf8());
+        hash.addData("\0", 1);
+        hash.addData(fileDigest(info));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ResultCache::restore(const QString& key, const QString& workingDirectory,
+                          ResultCacheEntry* entry)
+{
+    const QDir source(entryPath(key));
+    QStringList files;
+    {
+        QMutexLocker locker(&m_mutex);
+        ensureIndexLoaded();
+
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+            return false;
+        for (const QString& name : it->files)
+        {
+            if (!QFileInfo::exists(source.filePath(name)))
+            {
+                // 条目已被外部破坏，视为未命中并清理
+                if (m_pinned.contains(key))
+                    return false;
+                m_totalBytes -= it->bytes;
+                QDir(entryPath(key)).removeRecursively();
+                m_entries.erase(it);
+                return false;
+            }
+        }
+        files = it->files;
+        ++m_pinned[key];
+    }
+
+    // 产物可能有数 GB，复制时不持有锁；条目已固定，其他线程不会删除这些文件
+    const QDir target(workingDirectory);
+    bool copied = true;
+    for (const QString& name : files)
+    {
+        if (!copyReplacing(source.filePath(name), target.filePath(name)))
+        {
+            copied = false;
+            break;
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (--m_pinned[key] == 0)
+        m_pinned.remove(key);
+    auto it = m_entries.find(key);
+    if (copied && it != m_entries.end())
+    {
+        it->lastUsed = QDateTime::currentDateTime();
+        writeEntryFile(source.absolutePath(), *it);
+        if (entry)
+            *entry = *it;
+    }
+    // 复制期间推迟的淘汰在这里补上
+    evictLocked();
+    return copied && it != m_entries.end();
+}
+
+bool ResultCache::store(const ResultCacheEntry& entry, const QStringList& artifacts)
+{
+    if (entry.key.isEmpty())
+        return false;
+
+    // 先写入临时目录再整体改名，其他线程不会看到写了一半的条目
+    const QString staging = QDir(m_rootPath).filePath(
+        QStringLiteral(".staging-%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    if (!QDir().mkpath(staging))
+        return false;
+
+    ResultCacheEntry stored = entry;
+    stored.files.clear();
+    stored.stlFile.clear();
+    for (const QString& path : artifacts)
+    {
+        const QFileInfo info(path);
+        if (!info.isFile() || stored.files.contains(info.fileName()))
+            continue;
+        if (!QFile::copy(info.absoluteFilePath(), QDir(staging).filePath(info.fileName())))
+        {
+            QDir(staging).removeRecursively();
+            return false;
+        }
+        stored.files << info.fileName();
+    }
+    stored.stlFile = ResultReaderRegistry::instance().preferredResult(stored.files);
+    stored.bytes = directorySize(staging);
+    stored.createdAt = QDateTime::currentDateTime();
+    stored.lastUsed = stored.createdAt;
+    if (!writeEntryFile(staging, stored))
+    {
+        QDir(staging).removeRecursively();
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    ensureIndexLoaded();
+    if (m_maxBytes > 0 && stored.bytes > m_maxBytes)
+    {
+        QDir(staging).removeRecursively();
+        return false;
+    }
+
+    const QString finalPath = entryPath(stored.key);
+    if (m_pinned.contains(stored.key))
+    {
+        // 相同的键对应相同的输入，正在被复制的旧条目同样有效
+        QDir(staging).removeRecursively();
+        return false;
+    }
+    auto existing = m_entries.find(stored.key);
+    if (existing != m_entries.end())
+    {
+        m_totalBytes -= existing->bytes;
+        m_entries.erase(existing);
+    }
+    QDir(finalPath).removeRecursively();
+    if (!QDir().rename(staging, finalPath))
+    {
+        QDir(staging).removeRecursively();
+        return false;
+    }
+
+    m_entries.insert(stored.key, stored);
+    m_totalBytes += stored.bytes;
+    evictLocked();
+    return true;
+}
+
+void ResultCache::ensureIndexLoaded()
+{
+    if (m_indexLoaded)
+        return;
+    m_indexLoaded = true;
+
+    QDir root(m_rootPath);
+    if (!root.exists())
+        return;
+
+    const QFileInfoList dirs = root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+    for (const QFileInfo& info : dirs)
+    {
+        if (info.fileName().startsWith(QLatin1Char('.')))
+        {
+            // 上次进程中断留下的临时目录
+            QDir(info.absoluteFilePath()).removeRecursively();
+            continue;
+        }
+
+        ResultCacheEntry entry;
+        if (!readEntryFile(info.absoluteFilePath(), &entry) || entry.key != info.fileName())
+        {
+            QDir(info.absoluteFilePath()).removeRecursively();
+            continue;
+        }
+        entry.bytes = directorySize(info.absoluteFilePath());
+        m_totalBytes += entry.bytes;
+        m_entries.insert(entry.key, entry);
+    }
+    evictLocked();
+}
+
+void ResultCache::evictLocked()
+{
+    if (m_maxBytes <= 0 || m_totalBytes <= m_maxBytes)
+        return;
+
+    QVector<const ResultCacheEntry*> order;
+    order.reserve(m_entries.size());
+    for (const ResultCacheEntry& entry : m_entries)
+        order.push_back(&entry);
+    std::sort(order.begin(), order.end(), [](const ResultCacheEntry* a, const ResultCacheEntry* b) {
+        return a->lastUsed < b->lastUsed;
+    });
+
+    QStringList victims;
+    qint64 total = m_totalBytes;
+    for (const ResultCacheEntry* entry : order)
+    {
+        if (total <= m_maxBytes)
+            break;
+        if (m_pinned.contains(entry->key))
+            continue;
+        total -= entry->bytes;
+        victims << entry->key;
+    }
+    for (const QString& key : victims)
+    {
+        m_totalBytes -= m_entries.value(key).bytes;
+        m_entries.remove(key);
+        QDir(entryPath(key)).removeRecursively();
+    }
+}
+
+QByteArray ResultCache::fileDigest(const QFileInfo& info)
+{
+    const QString path = info.absoluteFilePath();
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_digests.constFind(path);
+        if (it != m_digests.constEnd() && it->size == info.size() &&
+            it->modified == info.lastModified())
+            return it->digest;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QByteArray digest;
+    if (info.suffix().compare(QStringLiteral("json"), Qt::CaseInsensitive) == 0)
+    {
+        // 参数文件按解析后的内容计算，缩进、换行与键顺序不影响命中
+        const QByteArray raw = file.readAll();
+        QJsonParseError err{};
+        const QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
+        const QByteArray normalised = err.error == QJsonParseError::NoError
+                                          ? doc.toJson(QJsonDocument::Compact)
+                                          : raw;
+        digest = QCryptographicHash::hash(normalised, QCryptographicHash::Sha256);
+    }
+    else
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(&file);
+        digest = hash.result();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    FileDigest& cached = m_digests[path];
+    cached.size = info.size();
+    cached.modified = info.lastModified();
+    cached.digest = digest;
+    return digest;
+}
+
+QString ResultCache::entryPath(const QString& key) const
+{
+    return QDir(m_rootPath).filePath(key);
+}
+
+bool ResultCache::writeEntryFile(const QString& dirPath, const ResultCacheEntry& entry)
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("key"), entry.key);
+    obj.insert(QStringLiteral("exitCode"), entry.exitCode);
+    obj.insert(QStringLiteral("errorMessage"), entry.errorMessage);
+    obj.insert(QStringLiteral("message"), entry.message);
+    obj.insert(QStringLiteral("stl"), entry.stlFile);
+    obj.insert(QStringLiteral("files"), QJsonArray::fromStringList(entry.files));
+    obj.insert(QStringLiteral("createdAt"), entry.createdAt.toString(Qt::ISODate));
+    obj.insert(QStringLiteral("lastUsed"), entry.lastUsed.toString(Qt::ISODate));
+
+    QSaveFile file(QDir(dirPath).filePath(QLatin1String(kEntryFileName)));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+bool ResultCache::readEntryFile(const QString& dirPath, ResultCacheEntry* entry)
+{
+    QFile file(QDir(dirPath).filePath(QLatin1String(kEntryFileName)));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonParseError err{};
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject())
+        return false;
+
+    const QJsonObject obj = doc.object();
+    entry->key = obj.value(QStringLiteral("key")).toString();
+    entry->exitCode = obj.value(QStringLiteral("exitCode")).toInt();
+    entry->errorMessage = obj.value(QStringLiteral("errorMessage")).toString();
+    entry->message = obj.value(QStringLiteral("message")).toString();
+    entry->stlFile = obj.value(QStringLiteral("stl")).toString();
+    for (const QJsonValue& value : obj.value(QStringLiteral("files")).toArray())
+        entry->files << value.toString();
+    entry->createdAt = QDateTime::fromString(obj.value(QStringLiteral("createdAt")).toString(),
+                                             Qt::ISODate);
+    entry->lastUsed = QDateTime::fromString(obj.value(QStringLiteral("lastUsed")).toString(),
+                                            Qt::ISODate);
+    return !entry->key.isEmpty();
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class QFileInfo;
+
+struct ResultCacheEntry
+{
+    QString key;
+    int exitCode = 0;
+    QString errorMessage;
+    QString message;
+    QString stlFile;            // 条目目录中要显示的结果文件名（可为空）
+    QStringList files;          // 条目中保存的全部产物文件名
+    qint64 bytes = 0;
+    QDateTime createdAt;
+    QDateTime lastUsed;
+};
+
+// 按输入内容寻址的计算结果缓存：<工程>/.flexcache/results/<key>/
+// 键由规范化后的参数 JSON、启动命令与模型目录中的其余输入文件共同决定。
+// 所有接口均可在工作线程中调用。
+class ResultCache
+{
+public:
+    explicit ResultCache(const QString& rootPath, qint64 maxBytes);
+
+    QString rootPath() const { return m_rootPath; }
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 totalBytes() const;
+
+    QString computeKey(const QString& workingDirectory,
+                       const QString& program,
+                       const QStringList& arguments);
+
+    // 命中时把产物复制回 workingDirectory，并刷新该条目的最近使用时间
+    bool restore(const QString& key, const QString& workingDirectory, ResultCacheEntry* entry);
+
+    // artifacts 为需要保存的产物绝对路径；超出容量时按最近使用时间淘汰旧条目
+    bool store(const ResultCacheEntry& entry, const QStringList& artifacts);
+
+private:
+    struct FileDigest {
+        qint64 size = -1;
+        QDateTime modified;
+        QByteArray digest;
+    };
+
+    void ensureIndexLoaded();
+    void evictLocked();
+    QByteArray fileDigest(const QFileInfo& info);
+    QString entryPath(const QString& key) const;
+    static bool writeEntryFile(const QString& dirPath, const ResultCacheEntry& entry);
+    static bool readEntryFile(const QString& dirPath, ResultCacheEntry* entry);
+
+    const QString m_rootPath;
+    mutable QMutex m_mutex;
+    qint64 m_maxBytes = 0;
+    qint64 m_totalBytes = 0;
+    bool m_indexLoaded = false;
+    QHash<QString, ResultCacheEntry> m_entries;
+    QHash<QString, int> m_pinned;           // 正在复制回工作目录的条目，不被淘汰或替换
+    QHash<QString, FileDigest> m_digests;   // 绝对路径 -> 内容摘要，按大小与修改时间失效
+};
@@ -0,0 +1,303 @@
+﻿#include "ResultReaderRegistry.h"
+#include "FastStlReader.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+
+#include <vtkCGNSReader.h>
+#include <vtkCompositeDataGeometryFilter.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataSetSurfaceFilter.h>
+#include <vtkExodusIIReader.h>
+#include <vtkInformation.h>
+#include <vtkPLYReader.h>
+#include <vtkSTLReader.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkXMLGenericDataObjectReader.h>
+
+namespace
+{
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("ResultReaderRegistry", text);
+}
+
+QByteArray nativePath(const QString& filePath)
+{
+    return QFile::encodeName(QFileInfo(filePath).absoluteFilePath());
+}
+
+// 体网格与多块数据只保留外表面，字段随表面一并保留
+vtkSmartPointer<vtkPolyData> toSurface(vtkDataObject* data)
+{
+    if (!data)
+        return nullptr;
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    if (auto* polyData = vtkPolyData::SafeDownCast(data))
+    {
+        output->ShallowCopy(polyData);
+    }
+    else if (vtkCompositeDataSet::SafeDownCast(data))
+    {
+        auto filter = vtkSmartPointer<vtkCompositeDataGeometryFilter>::New();
+        filter->SetInputData(data);
+        filter->Update();
+        output->ShallowCopy(filter->GetOutput());
+    }
+    else if (vtkDataSet::SafeDownCast(data))
+    {
+        auto filter = vtkSmartPointer<vtkDataSetSurfaceFilter>::New();
+        filter->SetInputData(data);
+        filter->Update();
+        output->ShallowCopy(filter->GetOutput());
+    }
+    else
+    {
+        return nullptr;
+    }
+    return output->GetNumberOfCells() > 0 ? output : nullptr;
+}
+
+// 读取器执行 UpdateInformation 后由管线给出的时间值
+QVector<double> pipelineTimeSteps(vtkAlgorithm* reader)
+{
+    QVector<double> steps;
+    vtkInformation* info = reader->GetOutputInformation(0);
+    if (!info || !info->Has(vtkStreamingDemandDrivenPipeline::TIME_STEPS()))
+        return steps;
+    const int count = info->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    const double* values = info->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    for (int i = 0; i < count; ++i)
+        steps.append(values[i]);
+    return steps;
+}
+
+// 只请求一个时间步，其余时间步不读取
+void updateTimeStep(vtkAlgorithm* reader, int timeStep)
+{
+    reader->UpdateInformation();
+    const QVector<double> steps = pipelineTimeSteps(reader);
+    if (steps.isEmpty())
+        reader->Update();
+    else
+        reader->UpdateTimeStep(steps.at(qBound(0, timeStep, steps.size() - 1)));
+}
+
+bool isCancelled(const std::atomic_bool* cancel)
+{
+    return cancel && cancel->load();
+}
+
+class StlResultReader : public ResultReader
+{
+public:
+    QString name() const override { return QStringLiteral("STL"); }
+    QStringList suffixes() const override { return QStringList() << QStringLiteral("stl"); }
+
+    vtkSmartPointer<vtkPolyData> read(const QString& filePath, int, const std::atomic_bool* cancel,
+                                      std::atomic_int* progress, QString* error) const override
+    {
+        QString fastError;
+        vtkSmartPointer<vtkPolyData> polyData = FastStlReader::read(filePath, &fastError, cancel,
+                                                                    nullptr, progress);
+        if (polyData || isCancelled(cancel))
+            return polyData;
+
+        // 少见的非标准写法交给 vtkSTLReader 再试一次。
+        // VTK 9.2 的 vtkSTLReader 读取期间不检查中止标记，由调用方在读完后丢弃
+        auto reader = vtkSmartPointer<vtkSTLReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->Update();
+        polyData = toSurface(reader->GetOutput());
+        if (!polyData && error)
+            *error = tr("无法读取 STL 文件：%1（%2）").arg(filePath, fastError);
+        return polyData;
+    }
+};
+
+// .vtp/.vtu/.vts/.vtr/.vti/.vtm，由 vtkXMLGenericDataObjectReader 按文件内容选择具体读取器
+class XmlResultReader : public ResultReader
+{
+public:
+    QString name() const override { return QStringLiteral("VTK XML"); }
+    QStringList suffixes() const override
+    {
+        return QStringList() << QStringLiteral("vtp") << QStringLiteral("vtu") << QStringLiteral("vts")
+                             << QStringLiteral("vtr") << QStringLiteral("vti") << QStringLiteral("vtm");
+    }
+
+    vtkSmartPointer<vtkPolyData> read(const QString& filePath, int, const std::atomic_bool*,
+                                      std::atomic_int*, QString* error) const override
+    {
+        auto reader = vtkSmartPointer<vtkXMLGenericDataObjectReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->Update();
+        const vtkSmartPointer<vtkPolyData> polyData = toSurface(reader->GetOutputDataObject(0));
+        if (!polyData && error)
+            *error = tr("无法读取 VTK 文件：%1").arg(filePath);
+        return polyData;
+    }
+};
+
+class PlyResultReader : public ResultReader
+{
+public:
+    QString name() const override { return QStringLiteral("PLY"); }
+    QStringList suffixes() const override { return QStringList() << QStringLiteral("ply"); }
+
+    vtkSmartPointer<vtkPolyData> read(const QString& filePath, int, const std::atomic_bool*,
+                                      std::atomic_int*, QString* error) const override
+    {
+        auto reader = vtkSmartPointer<vtkPLYReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->Update();
+        const vtkSmartPointer<vtkPolyData> polyData = toSurface(reader->GetOutput());
+        if (!polyData && error)
+            *error = tr("无法读取 PLY 文件：%1").arg(filePath);
+        return polyData;
+    }
+};
+
+class ExodusResultReader : public ResultReader
+{
+public:
+    QString name() const override { return QStringLiteral("Exodus II"); }
+    QStringList suffixes() const override
+    {
+        return QStringList() << QStringLiteral("e") << QStringLiteral("exo") << QStringLiteral("ex2")
+                             << QStringLiteral("exii");
+    }
+
+    bool readInfo(const QString& filePath, Info* info, QString* error) const override
+    {
+        auto reader = vtkSmartPointer<vtkExodusIIReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->UpdateInformation();
+        if (reader->GetErrorCode() != 0)
+        {
+            if (error)
+                *error = tr("无法读取 Exodus 文件：%1").arg(filePath);
+            return false;
+        }
+        info->timeSteps = pipelineTimeSteps(reader);
+        return true;
+    }
+
+    vtkSmartPointer<vtkPolyData> read(const QString& filePath, int timeStep, const std::atomic_bool*,
+                                      std::atomic_int*, QString* error) const override
+    {
+        auto reader = vtkSmartPointer<vtkExodusIIReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->UpdateInformation();
+        // 默认不加载任何结果变量
+        reader->SetAllArrayStatus(vtkExodusIIReader::NODAL, 1);
+        reader->SetAllArrayStatus(vtkExodusIIReader::ELEM_BLOCK, 1);
+        updateTimeStep(reader, timeStep);
+        const vtkSmartPointer<vtkPolyData> polyData = toSurface(reader->GetOutputDataObject(0));
+        if (!polyData && error)
+            *error = tr("无法读取 Exodus 文件：%1").arg(filePath);
+        return polyData;
+    }
+};
+
+class CgnsResultReader : public ResultReader
+{
+public:
+    QString name() const override { return QStringLiteral("CGNS"); }
+    QStringList suffixes() const override { return QStringList() << QStringLiteral("cgns"); }
+
+    bool readInfo(const QString& filePath, Info* info, QString* error) const override
+    {
+        auto reader = vtkSmartPointer<vtkCGNSReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->UpdateInformation();
+        if (reader->GetErrorCode() != 0)
+        {
+            if (error)
+                *error = tr("无法读取 CGNS 文件：%1").arg(filePath);
+            return false;
+        }
+        info->timeSteps = pipelineTimeSteps(reader);
+        return true;
+    }
+
+    vtkSmartPointer<vtkPolyData> read(const QString& filePath, int timeStep, const std::atomic_bool*,
+                                      std::atomic_int*, QString* error) const override
+    {
+        auto reader = vtkSmartPointer<vtkCGNSReader>::New();
+        reader->SetFileName(nativePath(filePath).constData());
+        reader->UpdateInformation();
+        reader->EnableAllPointArrays();
+        reader->EnableAllCellArrays();
+        updateTimeStep(reader, timeStep);
+        const vtkSmartPointer<vtkPolyData> polyData = toSurface(reader->GetOutputDataObject(0));
+        if (!polyData && error)
+            *error = tr("无法读取 CGNS 文件：%1").arg(filePath);
+        return polyData;
+    }
+};
+}
+
+bool ResultReader::readInfo(const QString&, Info* info, QString*) const
+{
+    info->timeSteps.clear();
+    return true;
+}
+
+ResultReaderRegistry& ResultReaderRegistry::instance()
+{
+    static ResultReaderRegistry registry;
+    return registry;
+}
+
+ResultReaderRegistry::ResultReaderRegistry()
+{
+    registerReader(std::make_shared<StlResultReader>());
+    registerReader(std::make_shared<XmlResultReader>());
+    registerReader(std::make_shared<PlyResultReader>());
+    registerReader(std::make_shared<ExodusResultReader>());
+    registerReader(std::make_shared<CgnsResultReader>());
+}
+
+void ResultReaderRegistry::registerReader(const std::shared_ptr<ResultReader>& reader)
+{
+    if (!reader)
+        return;
+    QMutexLocker locker(&m_mutex);
+    m_readers.append(reader);
+    for (const QString& suffix : reader->suffixes())
+        m_bySuffix.insert(suffix.toLower(), reader);
+}
+
+std::shared_ptr<ResultReader> ResultReaderRegistry::readerFor(const QString& filePath) const
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    QMutexLocker locker(&m_mutex);
+    return m_bySuffix.value(suffix);
+}
+
+QStringList ResultReaderRegistry::nameFilters() const
+{
+    QStringList filters;
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_bySuffix.constBegin(); it != m_bySuffix.constEnd(); ++it)
+        filters << QStringLiteral("*.") + it.key();
+    filters.sort();
+    return filters;
+}
+
+QString ResultReaderRegistry::preferredResult(const QStringList& fileNames) const
+{
+    QMutexLocker locker(&m_mutex);
+    for (const std::shared_ptr<ResultReader>& reader : m_readers)
+    {
+        for (const QString& name : fileNames)
+        {
+            const QString suffix = QFileInfo(name).suffix().toLower();
+            if (m_bySuffix.value(suffix) == reader)
+                return name;
+        }
+    }
+    return QString();
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+// 一种结果格式的读取插件。读取结果统一转换为带点与单元字段的表面 vtkPolyData，
+// 带时间维度的格式只读取请求的那一个时间步。实现不保存状态，可在多个线程中同时调用
+class ResultReader
+{
+public:
+    struct Info
+    {
+        QVector<double> timeSteps;      // 为空表示没有时间维度
+    };
+
+    virtual ~ResultReader() = default;
+
+    virtual QString name() const = 0;
+    // 小写扩展名，不含点
+    virtual QStringList suffixes() const = 0;
+    // 只读取元数据，不读取网格
+    virtual bool readInfo(const QString& filePath, Info* info, QString* error) const;
+    // cancel 与 progress 可为空；不支持中途取消的格式读完后再检查
+    virtual vtkSmartPointer<vtkPolyData> read(const QString& filePath, int timeStep,
+                                              const std::atomic_bool* cancel,
+                                              std::atomic_int* progress,
+                                              QString* error) const = 0;
+};
+
+// 按扩展名选择读取插件。内置 STL、VTK XML、PLY、Exodus II 与 CGNS，
+// 其余格式可在启动时通过 registerReader 补充，后注册的插件覆盖同名扩展名
+class ResultReaderRegistry
+{
+public:
+    static ResultReaderRegistry& instance();
+
+    void registerReader(const std::shared_ptr<ResultReader>& reader);
+    std::shared_ptr<ResultReader> readerFor(const QString& filePath) const;
+    bool canRead(const QString& filePath) const { return readerFor(filePath) != nullptr; }
+
+    // 用于 QDir::entryList 的过滤条件，如 "*.stl"
+    QStringList nameFilters() const;
+    // 从一组输出文件中挑选要显示的结果：按插件注册顺序，内置的 STL 最先
+    QString preferredResult(const QStringList& fileNames) const;
+
+private:
+    ResultReaderRegistry();
+
+    mutable QMutex m_mutex;
+    QVector<std::shared_ptr<ResultReader>> m_readers;
+    QHash<QString, std::shared_ptr<ResultReader>> m_bySuffix;
+};
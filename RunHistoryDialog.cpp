@@ -0,0 +1,169 @@
+﻿#include "RunHistoryDialog.h"
+
+#include <QColor>
+#include <QDialogButtonBox>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLabel>
+#include <QLocale>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace
+{
+enum Column {
+    StartedColumn = 0,
+    StatusColumn,
+    ExitCodeColumn,
+    ElapsedColumn,
+    MemoryColumn,
+    ErrorColumn,
+    ColumnCount
+};
+
+QTableWidgetItem* makeItem(const QString& text)
+{
+    auto* item = new QTableWidgetItem(text);
+    item->setToolTip(text);
+    return item;
+}
+}
+
+RunHistoryDialog::RunHistoryDialog(const QString& modelName,
+                                   const QString& modelDir,
+                                   QWidget* parent)
+    : QDialog(parent)
+    , m_modelDir(modelDir)
+{
+    setWindowTitle(tr("运行历史 - %1").arg(modelName));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(900, 560);
+
+    auto* v = new QVBoxLayout(this);
+    v->setContentsMargins(12, 12, 12, 12);
+    v->setSpacing(8);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setStyleSheet("font-weight:600;");
+    v->addWidget(m_summaryLabel);
+
+    auto* splitter = new QSplitter(Qt::Vertical, this);
+    m_table = new QTableWidget(0, ColumnCount, splitter);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("开始时间") << tr("状态") << tr("退出码")
+                                                     << tr("耗时(秒)") << tr("峰值内存") << tr("错误信息"));
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    connect(m_table, &QTableWidget::itemSelectionChanged,
+            this, &RunHistoryDialog::onCurrentRowChanged);
+
+    m_details = new QPlainTextEdit(splitter);
+    m_details->setReadOnly(true);
+    m_details->setLineWrapMode(QPlainTextEdit::NoWrap);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 2);
+    v->addWidget(splitter, 1);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_showButton = buttons->addButton(tr("显示该次结果"), QDialogButtonBox::ActionRole);
+    m_showButton->setEnabled(false);
+    connect(m_showButton, &QPushButton::clicked, this, [this]() {
+        const int index = currentIndex();
+        if (index >= 0)
+            emit showStlRequested(m_records.at(index).stlPath(m_modelDir));
+    });
+    auto* refreshButton = buttons->addButton(tr("刷新"), QDialogButtonBox::ActionRole);
+    connect(refreshButton, &QPushButton::clicked, this, &RunHistoryDialog::reload);
+    connect(buttons, &QDialogButtonBox::rejected, this, &RunHistoryDialog::close);
+    v->addWidget(buttons);
+
+    reload();
+}
+
+void RunHistoryDialog::reload()
+{
+    m_records = RunJournal::history(m_modelDir);
+
+    const QLocale locale;
+    int succeeded = 0;
+    m_table->setRowCount(0);
+    m_table->setRowCount(m_records.size());
+    for (int row = 0; row < m_records.size(); ++row)
+    {
+        const RunRecord& record = m_records.at(row);
+        succeeded += record.succeeded() ? 1 : 0;
+
+        m_table->setItem(row, StartedColumn,
+                         makeItem(record.startedAt.toString("yyyy-MM-dd HH:mm:ss")));
+        auto* status = makeItem(record.statusText());
+        if (record.cancelled)
+            status->setForeground(QColor("#64748b"));
+        else
+            status->setForeground(record.succeeded() ? QColor("#15803d") : QColor("#b91c1c"));
+        m_table->setItem(row, StatusColumn, status);
+        m_table->setItem(row, ExitCodeColumn, makeItem(QString::number(record.exitCode)));
+        m_table->setItem(row, ElapsedColumn,
+                         makeItem(QString::number(record.startedAt.msecsTo(record.finishedAt) / 1000.0, 'f', 1)));
+        m_table->setItem(row, MemoryColumn,
+                         makeItem(record.usage.valid ? locale.formattedDataSize(record.usage.peakRssBytes)
+                                                     : QString()));
+        m_table->setItem(row, ErrorColumn, makeItem(record.errorMessage));
+    }
+    m_table->resizeColumnsToContents();
+    m_summaryLabel->setText(tr("共 %1 次运行，成功 %2 次").arg(m_records.size()).arg(succeeded));
+
+    if (!m_records.isEmpty())
+        m_table->selectRow(0);
+    else
+        onCurrentRowChanged();
+}
+
+int RunHistoryDialog::currentIndex() const
+{
+    const QList<QTableWidgetItem*> selected = m_table->selectedItems();
+    if (selected.isEmpty())
+        return -1;
+    const int row = selected.first()->row();
+    return row < m_records.size() ? row : -1;
+}
+
+void RunHistoryDialog::onCurrentRowChanged()
+{
+    const int index = currentIndex();
+    if (index < 0)
+    {
+        m_details->clear();
+        m_showButton->setEnabled(false);
+        return;
+    }
+
+    const RunRecord& record = m_records.at(index);
+    const QString stl = record.stlPath(m_modelDir);
+    m_showButton->setEnabled(!stl.isEmpty() && QFileInfo::exists(stl));
+
+    QStringList lines;
+    lines << tr("结论：%1").arg(record.message);
+    if (!record.errorMessage.isEmpty())
+        lines << tr("错误信息：%1").arg(record.errorMessage);
+    if (record.usage.valid)
+        lines << tr("资源：%1").arg(record.usage.summaryText());
+    if (record.fromCache)
+        lines << tr("结果缓存：%1").arg(record.cacheKey);
+    lines << tr("产物：%1").arg(record.artifacts.isEmpty() ? tr("无")
+                                                          : record.artifacts.join(QStringLiteral(", ")));
+    lines << QString() << tr("参数快照：");
+    if (record.parameters.isArray())
+        lines << QString::fromUtf8(QJsonDocument(record.parameters.toArray()).toJson(QJsonDocument::Indented));
+    else if (record.parameters.isObject())
+        lines << QString::fromUtf8(QJsonDocument(record.parameters.toObject()).toJson(QJsonDocument::Indented));
+    else
+        lines << tr("（无）");
+    m_details->setPlainText(lines.join(QLatin1Char('\n')));
+}
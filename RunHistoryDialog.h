@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include <QDialog>
+#include <QVector>
+
+#include "RunJournal.h"
+
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+class QTableWidget;
+
+// 浏览模型的运行日志：只读取 .flexsim/runs.jsonl，不扫描模型目录
+class RunHistoryDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    RunHistoryDialog(const QString& modelName,
+                     const QString& modelDir,
+                     QWidget* parent = nullptr);
+
+    void reload();
+
+signals:
+    // 在三维视图中显示某次运行的 STL
+    void showStlRequested(const QString& stlPath);
+
+private:
+    void onCurrentRowChanged();
+    int currentIndex() const;
+
+    QString m_modelDir;
+    QVector<RunRecord> m_records;
+    QTableWidget* m_table = nullptr;
+    QPlainTextEdit* m_details = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+    QPushButton* m_showButton = nullptr;
+};
@@ -0,0 +1,175 @@
+﻿#include "RunJournal.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+
+namespace
+{
+const qint64 kTailChunk = 16 * 1024;
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("RunJournal", text);
+}
+
+bool parseLine(const QByteArray& line, RunRecord* record)
+{
+    const QByteArray trimmed = line.trimmed();
+    if (trimmed.isEmpty())
+        return false;
+    QJsonParseError err{};
+    const QJsonDocument doc = QJsonDocument::fromJson(trimmed, &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject())
+        return false;
+    *record = RunRecord::fromJson(doc.object());
+    return record->isValid();
+}
+}
+
+QString RunRecord::statusText() const
+{
+    if (cancelled)
+        return tr("已取消");
+    if (succeeded())
+        return fromCache ? tr("成功（缓存）") : tr("成功");
+    return tr("失败");
+}
+
+QString RunRecord::stlPath(const QString& modelDir) const
+{
+    if (stlFile.isEmpty())
+        return QString();
+    return QDir::cleanPath(QDir(modelDir).filePath(stlFile));
+}
+
+QJsonObject RunRecord::toJson() const
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("runId"), runId);
+    obj.insert(QStringLiteral("startedAt"), startedAt.toString(Qt::ISODateWithMs));
+    obj.insert(QStringLiteral("finishedAt"), finishedAt.toString(Qt::ISODateWithMs));
+    obj.insert(QStringLiteral("exitCode"), exitCode);
+    obj.insert(QStringLiteral("cancelled"), cancelled);
+    obj.insert(QStringLiteral("crashed"), crashed);
+    obj.insert(QStringLiteral("fromCache"), fromCache);
+    if (!cacheKey.isEmpty())
+        obj.insert(QStringLiteral("cacheKey"), cacheKey);
+    obj.insert(QStringLiteral("errorMessage"), errorMessage);
+    obj.insert(QStringLiteral("message"), message);
+    obj.insert(QStringLiteral("stl"), stlFile);
+    obj.insert(QStringLiteral("artifacts"), QJsonArray::fromStringList(artifacts));
+    obj.insert(QStringLiteral("parameters"), parameters);
+    if (usage.valid)
+        obj.insert(QStringLiteral("resources"), usage.toJson());
+    if (suspendedMs > 0)
+        obj.insert(QStringLiteral("suspendedMs"), double(suspendedMs));
+    return obj;
+}
+
+RunRecord RunRecord::fromJson(const QJsonObject& obj)
+{
+    RunRecord record;
+    record.runId = obj.value(QStringLiteral("runId")).toString();
+    record.startedAt = QDateTime::fromString(obj.value(QStringLiteral("startedAt")).toString(), Qt::ISODateWithMs);
+    record.finishedAt = QDateTime::fromString(obj.value(QStringLiteral("finishedAt")).toString(), Qt::ISODateWithMs);
+    record.exitCode = obj.value(QStringLiteral("exitCode")).toInt(-1);
+    record.cancelled = obj.value(QStringLiteral("cancelled")).toBool();
+    record.crashed = obj.value(QStringLiteral("crashed")).toBool();
+    record.fromCache = obj.value(QStringLiteral("fromCache")).toBool();
+    record.cacheKey = obj.value(QStringLiteral("cacheKey")).toString();
+    record.errorMessage = obj.value(QStringLiteral("errorMessage")).toString();
+    record.message = obj.value(QStringLiteral("message")).toString();
+    record.stlFile = obj.value(QStringLiteral("stl")).toString();
+    for (const QJsonValue& value : obj.value(QStringLiteral("artifacts")).toArray())
+        record.artifacts << value.toString();
+    record.parameters = obj.value(QStringLiteral("parameters"));
+    record.usage = ResourceUsage::fromJson(obj.value(QStringLiteral("resources")).toObject());
+    record.suspendedMs = qint64(obj.value(QStringLiteral("suspendedMs")).toDouble());
+    return record;
+}
+
+namespace RunJournal
+{
+QString journalPath(const QString& modelDir)
+{
+    return QDir(modelDir).filePath(QStringLiteral(".flexsim/runs.jsonl"));
+}
+
+bool append(const QString& modelDir, const RunRecord& record)
+{
+    if (modelDir.isEmpty() || !record.isValid())
+        return false;
+
+    QDir dir(modelDir);
+    if (!dir.mkpath(QStringLiteral(".flexsim")))
+        return false;
+
+    // 一条记录一次写入；进程中途退出最多留下一行不完整内容，读取时会跳过。
+    // 上次留下的残行没有换行符，先补上，否则这条记录会接在残行后面一起无法解析
+    QByteArray line = QJsonDocument(record.toJson()).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    QFile file(journalPath(modelDir));
+    if (!file.open(QIODevice::ReadWrite))
+        return false;
+    const qint64 size = file.size();
+    if (size > 0 && file.seek(size - 1) && file.read(1) != QByteArray(1, '\n'))
+        line.prepend('\n');
+    const bool ok = file.seek(size) && file.write(line) == line.size();
+    file.close();
+    return ok;
+}
+
+RunRecord latest(const QString& modelDir)
+{
+    QFile file(journalPath(modelDir));
+    if (!file.open(QIODevice::ReadOnly))
+        return RunRecord();
+
+    const qint64 size = file.size();
+    qint64 chunk = kTailChunk;
+    for (;;)
+    {
+        const qint64 start = qMax<qint64>(0, size - chunk);
+        if (!file.seek(start))
+            return RunRecord();
+        const QByteArray data = file.read(size - start);
+        QList<QByteArray> lines = data.split('\n');
+        // 从文件中间开始读时第一行可能不完整
+        if (start > 0 && !lines.isEmpty())
+            lines.removeFirst();
+        for (int i = lines.size() - 1; i >= 0; --i)
+        {
+            RunRecord record;
+            if (parseLine(lines.at(i), &record))
+                return record;
+        }
+        if (start == 0)
+            return RunRecord();
+        chunk *= 4;
+    }
+}
+
+QVector<RunRecord> history(const QString& modelDir, int maxRecords)
+{
+    QVector<RunRecord> records;
+    QFile file(journalPath(modelDir));
+    if (!file.open(QIODevice::ReadOnly))
+        return records;
+
+    while (!file.atEnd())
+    {
+        RunRecord record;
+        if (parseLine(file.readLine(), &record))
+            records.append(record);
+    }
+    std::reverse(records.begin(), records.end());
+    if (maxRecords >= 0 && records.size() > maxRecords)
+        records.resize(maxRecords);
+    return records;
+}
+}
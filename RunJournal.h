@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "ResourceMonitor.h"
+
+// 一次计算的完整记录；产物路径相对于模型目录保存，工程整体移动后仍然有效
+struct RunRecord
+{
+    QString runId;
+    QDateTime startedAt;
+    QDateTime finishedAt;
+    int exitCode = -1;
+    bool cancelled = false;
+    bool crashed = false;
+    bool fromCache = false;
+    QString cacheKey;
+    QString errorMessage;
+    QString message;
+    QString stlFile;            // 本次生成的结果文件（STL 或其他已注册格式），空表示没有
+    QStringList artifacts;      // 本次新建或改写的全部求解输出
+    QJsonValue parameters;      // 启动时参数文件的快照
+    ResourceUsage usage;
+    qint64 suspendedMs = 0;     // 被暂停或抢占的时长
+
+    bool isValid() const { return !runId.isEmpty(); }
+    bool succeeded() const { return !cancelled && !crashed && exitCode == 0 && errorMessage.isEmpty(); }
+    QString statusText() const;
+    QString stlPath(const QString& modelDir) const;
+
+    QJsonObject toJson() const;
+    static RunRecord fromJson(const QJsonObject& obj);
+};
+
+// 每个模型目录下的只追加运行日志：.flexsim/runs.jsonl，每行一条记录
+namespace RunJournal
+{
+QString journalPath(const QString& modelDir);
+bool append(const QString& modelDir, const RunRecord& record);
+// 只读取文件末尾，耗时与历史长度无关
+RunRecord latest(const QString& modelDir);
+// 全部历史，最新的在前；maxRecords < 0 表示不限
+QVector<RunRecord> history(const QString& modelDir, int maxRecords = -1);
+}
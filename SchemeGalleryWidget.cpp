@@ -107,6 +107,15 @@ void SchemeGalleryWidget::removeSchemeById(const QString& id) {
     relayoutCards();
 }
 
+void SchemeGalleryWidget::setSchemeThumbnail(const QString& id, const QPixmap& thumb) {
+    for (const QPointer<SchemeCardWidget>& card : m_cards) {
+        if (card && card->id() == id) {
+            card->setThumbnail(thumb);
+            break;
+        }
+    }
+}
+
 void SchemeGalleryWidget::resizeEvent(QResizeEvent* e) {
     QWidget::resizeEvent(e);
     relayoutCards();
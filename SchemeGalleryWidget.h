@@ -34,6 +34,8 @@ public:
                    const QPixmap& thumb = QPixmap(),
                    const CardOptions& options = CardOptions());
     void removeSchemeById(const QString& id);
+    // 只替换一张卡片的图片，不重建画廊
+    void setSchemeThumbnail(const QString& id, const QPixmap& thumb);
 
 signals:
     void schemeOpenRequested(const QString& id);
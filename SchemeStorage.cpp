@@ -0,0 +1,672 @@
+﻿#include "SchemeStorage.h"
+#include "ProjectRegistry.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QUuid>
+
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+// 变更日志超过任一阈值时合并进快照
+const qint64 kCompactJournalBytes = 4 * 1024 * 1024;
+const int kCompactJournalEntries = 2000;
+
+QString canonicalPathForDir(const QDir& dir)
+{
+    QString canonical = dir.canonicalPath();
+    if (canonical.isEmpty())
+        canonical = dir.absolutePath();
+    return QDir::cleanPath(canonical);
+}
+
+// 只整理字符串，不访问文件系统。记录中的路径在创建时已规范化，
+// 打开工程时由后台检查改正失效的部分
+QString storedPath(const QString& path)
+{
+    return QDir::cleanPath(QDir(path).absolutePath());
+}
+
+// 方案本身的字段，不含模型
+QJsonObject schemeToJson(const SchemeRecord& scheme)
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("id"), scheme.id);
+    obj.insert(QStringLiteral("name"), scheme.name);
+    obj.insert(QStringLiteral("workingDirectory"), scheme.workingDirectory);
+    obj.insert(QStringLiteral("thumbnailPath"), scheme.thumbnailPath);
+    obj.insert(QStringLiteral("remarks"), scheme.remarks);
+    return obj;
+}
+
+QJsonObject modelToJson(const ModelRecord& model)
+{
+    QJsonObject mo;
+    mo.insert(QStringLiteral("id"), model.id);
+    mo.insert(QStringLiteral("name"), model.name);
+    mo.insert(QStringLiteral("directory"), model.directory);
+    mo.insert(QStringLiteral("jsonPath"), model.jsonPath);
+    mo.insert(QStringLiteral("batPath"), model.batPath);
+    mo.insert(QStringLiteral("remarks"), model.remarks);
+    return mo;
+}
+
+
+
+bool sameSchemeFields(const SchemeRecord& a, const SchemeRecord& b)
+{
+    return a.name == b.name && a.workingDirectory == b.workingDirectory &&
+           a.thumbnailPath == b.thumbnailPath && a.remarks == b.remarks;
+}
+
+QJsonArray idArray(const QStringList& ids)
+{
+    return QJsonArray::fromStringList(ids);
+}
+
+QStringList schemeIds(const QVector<SchemeRecord>& schemes)
+{
+    QStringList ids;
+    ids.reserve(schemes.size());
+    for (const SchemeRecord& scheme : schemes)
+        ids << scheme.id;
+    return ids;
+}
+
+QStringList modelIds(const QVector<ModelRecord>& models)
+{
+    QStringList ids;
+    ids.reserve(models.size());
+    for (const ModelRecord& model : models)
+        ids << model.id;
+    return ids;
+}
+
+// 按 ids 的顺序重排，ids 中没有的记录保持原有相对顺序排在最后
+template <typename Record>
+QVector<Record> reordered(const QVector<Record>& records, const QJsonArray& ids)
+{
+    QHash<QString, int> position;
+    for (int i = 0; i < ids.size(); ++i)
+        position.insert(ids.at(i).toString(), i);
+    QVector<Record> result = records;
+    std::stable_sort(result.begin(), result.end(), [&position](const Record& a, const Record& b) {
+        return position.value(a.id, INT_MAX) < position.value(b.id, INT_MAX);
+    });
+    return result;
+}
+
+void applyOperation(const QJsonObject& op, ProjectRegistry& registry, QString* workspaceRoot)
+{
+    const QString type = op.value(QStringLiteral("op")).toString();
+    if (type == QLatin1String("workspace"))
+    {
+        if (workspaceRoot)
+            *workspaceRoot = op.value(QStringLiteral("workspaceRoot")).toString();
+    }
+    else if (type == QLatin1String("putScheme"))
+    {
+        SchemeRecord scheme;
+        if (!SchemeStorage::schemeFromJson(op.value(QStringLiteral("scheme")).toObject(), &scheme))
+            return;
+        SchemeRecord* existing = registry.scheme(scheme.id);
+        if (!existing)
+        {
+            registry.addScheme(scheme);
+        }
+        else if (existing->workingDirectory == scheme.workingDirectory)
+        {
+            existing->name = scheme.name;
+            existing->thumbnailPath = scheme.thumbnailPath;
+            existing->remarks = scheme.remarks;
+        }
+        else
+        {
+            // 工作目录参与索引，整体重建
+            QVector<SchemeRecord> schemes = registry.schemes();
+            for (SchemeRecord& record : schemes)
+            {
+                if (record.id == scheme.id)
+                {
+                    scheme.models = record.models;
+                    record = scheme;
+                    break;
+                }
+            }
+            registry.reset(schemes);
+        }
+    }
+    else if (type == QLatin1String("removeScheme"))
+    {
+        registry.removeScheme(op.value(QStringLiteral("id")).toString());
+    }
+    else if (type == QLatin1String("putModel"))
+    {
+        const QString schemeId = op.value(QStringLiteral("scheme")).toString();
+        ModelRecord model;
+        if (!registry.scheme(schemeId) ||
+            !SchemeStorage::modelFromJson(op.value(QStringLiteral("model")).toObject(), &model))
+            return;
+        SchemeRecord* owner = nullptr;
+        if (ModelRecord* existing = registry.model(model.id, &owner))
+        {
+            if (owner->id == schemeId)
+            {
+                *existing = model;
+                return;
+            }
+            registry.removeModel(model.id);
+        }
+        registry.addModel(schemeId, model);
+    }
+    else if (type == QLatin1String("removeModel"))
+    {
+        registry.removeModel(op.value(QStringLiteral("id")).toString());
+    }
+    else if (type == QLatin1String("orderSchemes"))
+    {
+        registry.reset(reordered(registry.schemes(), op.value(QStringLiteral("ids")).toArray()));
+    }
+    else if (type == QLatin1String("orderModels"))
+    {
+        const SchemeRecord* scheme = registry.scheme(op.value(QStringLiteral("scheme")).toString());
+        if (scheme)
+            registry.setModels(scheme->id, reordered(scheme->models, op.value(QStringLiteral("ids")).toArray()));
+    }
+}
+
+// 解析一行完整的变更日志，返回其序号；不完整或无法解析时返回 -1
+qint64 journalEntry(const QByteArray& rawLine, QJsonObject* entry)
+{
+    if (!rawLine.endsWith('\n'))
+        return -1;
+    QJsonParseError err{};
+    const QJsonDocument doc = QJsonDocument::fromJson(rawLine.trimmed(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject())
+        return -1;
+    if (entry)
+        *entry = doc.object();
+    return qint64(doc.object().value(QStringLiteral("seq")).toDouble());
+}
+
+// 逐行重放变更日志；序号不大于 sequence 的行已包含在快照中。
+// 遇到不完整的行（进程中途退出）或序号不连续时停止：之后的变更建立在缺失的状态上，
+// 不能再应用。返回说明原因的警告，写入方在 SchemeJournal::reset 中截掉这部分
+QString replayJournal(const QString& path, ProjectRegistry& registry, QString* workspaceRoot, qint64* sequence)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    while (!file.atEnd())
+    {
+        const QByteArray line = file.readLine();
+        if (line.trimmed().isEmpty())
+            continue;
+        QJsonObject entry;
+        const qint64 seq = journalEntry(line, &entry);
+        if (seq < 0)
+        {
+            return file.atEnd() ? QCoreApplication::translate("SchemeStorage", "变更日志末尾不完整，已忽略")
+                                : QCoreApplication::translate("SchemeStorage", "变更日志第 %1 条之后无法解析，其后的修改未应用")
+                                      .arg(*sequence);
+        }
+        if (seq <= *sequence)
+            continue;
+        if (seq != *sequence + 1)
+        {
+            return QCoreApplication::translate("SchemeStorage", "变更日志缺少第 %1 条，其后的修改未应用")
+                .arg(*sequence + 1);
+        }
+        for (const QJsonValue& op : entry.value(QStringLiteral("ops")).toArray())
+            applyOperation(op.toObject(), registry, workspaceRoot);
+        *sequence = seq;
+    }
+    return QString();
+}
+
+// 截掉 sequence 之后的内容，使追加的新行紧接在最后一条已应用的变更之后，
+// 不会接在残缺的行尾，也不会排在无法重放的记录后面。返回截断后的长度
+qint64 trimJournal(const QString& path, qint64 sequence)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite))
+        return QFileInfo(path).size();
+    qint64 keep = 0;
+    while (!file.atEnd())
+    {
+        const QByteArray line = file.readLine();
+        if (!line.trimmed().isEmpty())
+        {
+            const qint64 seq = journalEntry(line, nullptr);
+            if (seq < 0 || seq > sequence)
+                break;
+        }
+        keep = file.pos();
+    }
+    if (keep < file.size())
+        file.resize(keep);
+    return keep;
+}
+}
+
+namespace SchemeStorage
+{
+QString resolveWorkspaceRoot(const QString& storedRoot, const QString& projectRoot)
+{
+    QString resolved;
+    QDir rootDir(storedRoot);
+    if (rootDir.isAbsolute())
+    {
+        resolved = canonicalPathForDir(rootDir);
+        if (resolved.isEmpty())
+            resolved = QDir::cleanPath(storedRoot);
+    }
+    else if (!projectRoot.isEmpty())
+    {
+        QDir projectDir(projectRoot);
+        const QString absolute = projectDir.filePath(storedRoot);
+        resolved = canonicalPathForDir(QDir(absolute));
+        if (resolved.isEmpty())
+            resolved = QDir::cleanPath(absolute);
+    }
+    else
+    {
+        resolved = canonicalPathForDir(QDir(storedRoot));
+        if (resolved.isEmpty())
+            resolved = QDir::cleanPath(storedRoot);
+    }
+    return resolved;
+}
+
+QString storedWorkspaceRoot(const QString& workspaceRoot, const QString& projectRoot)
+{
+    if (!projectRoot.isEmpty())
+    {
+        QDir projectDir(projectRoot);
+        const QString relative = projectDir.relativeFilePath(workspaceRoot);
+        if (!relative.startsWith(QStringLiteral("..")) && !relative.startsWith(QLatin1Char('/')))
+            return relative;
+    }
+    return workspaceRoot;
+}
+
+bool schemeFromJson(const QJsonObject& obj, SchemeRecord* scheme)
+{
+    scheme->id = obj.value(QStringLiteral("id")).toString();
+    if (scheme->id.isEmpty())
+        scheme->id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    scheme->name = obj.value(QStringLiteral("name")).toString();
+    scheme->workingDirectory = storedPath(obj.value(QStringLiteral("workingDirectory")).toString());
+    if (scheme->workingDirectory.isEmpty())
+        return false;
+    const QString storedThumb = obj.value(QStringLiteral("thumbnailPath")).toString().trimmed();
+    scheme->thumbnailPath = storedThumb.isEmpty()
+                                ? QString()
+                                : QDir::cleanPath(QFileInfo(storedThumb).absoluteFilePath());
+    scheme->remarks = obj.value(QStringLiteral("remarks")).toString();
+    return true;
+}
+
+bool modelFromJson(const QJsonObject& mo, ModelRecord* model)
+{
+    model->id = mo.value(QStringLiteral("id")).toString();
+    if (model->id.isEmpty())
+        model->id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    model->name = mo.value(QStringLiteral("name")).toString();
+    model->directory = storedPath(mo.value(QStringLiteral("directory")).toString());
+    model->jsonPath = QDir::cleanPath(mo.value(QStringLiteral("jsonPath")).toString());
+    model->batPath = QDir::cleanPath(mo.value(QStringLiteral("batPath")).toString());
+    model->remarks = mo.value(QStringLiteral("remarks")).toString();
+    return !model->directory.isEmpty() && !model->jsonPath.isEmpty();
+}
+
+// 计算 saved 到 current 的变更。模型列表仍与 saved 共享数据的方案直接跳过，
+// 只有列表变化过的方案才逐个比较模型
+QJsonArray diff(const QVector<SchemeRecord>& saved, const QVector<SchemeRecord>& current)
+{
+    QJsonArray ops;
+    QHash<QString, int> savedIndex;
+    savedIndex.reserve(saved.size());
+    for (int i = 0; i < saved.size(); ++i)
+        savedIndex.insert(saved.at(i).id, i);
+    QSet<QString> currentIds;
+    currentIds.reserve(current.size());
+
+    QVector<int> changedCurrent;
+    QSet<int> changedSaved;
+    for (int i = 0; i < current.size(); ++i)
+    {
+        const SchemeRecord& scheme = current.at(i);
+        currentIds.insert(scheme.id);
+        const int previous = savedIndex.value(scheme.id, -1);
+        if (previous < 0 || !sameSchemeFields(scheme, saved.at(previous)))
+        {
+            QJsonObject op;
+            op.insert(QStringLiteral("op"), QStringLiteral("putScheme"));
+            op.insert(QStringLiteral("scheme"), schemeToJson(scheme));
+            ops.append(op);
+        }
+        if (previous < 0)
+        {
+            if (!scheme.models.isEmpty())
+                changedCurrent << i;
+        }
+        else if (!(scheme.models == saved.at(previous).models))
+        {
+            changedCurrent << i;
+            changedSaved.insert(previous);
+        }
+    }
+    for (int i = 0; i < saved.size(); ++i)
+    {
+        if (!currentIds.contains(saved.at(i).id))
+            changedSaved.insert(i);
+    }
+
+    // 只索引列表有变化的方案；模型在方案之间移动时两边都会出现在这里
+    struct Location
+    {
+        int scheme;
+        int model;
+    };
+    QHash<QString, Location> savedModels;
+    for (int s : changedSaved)
+    {
+        const QVector<ModelRecord>& models = saved.at(s).models;
+        for (int j = 0; j < models.size(); ++j)
+            savedModels.insert(models.at(j).id, Location{ s, j });
+    }
+
+    QSet<QString> currentModels;
+    for (int i : changedCurrent)
+    {
+        const SchemeRecord& scheme = current.at(i);
+        QStringList expectedOrder;
+        QStringList appended;
+        const int previous = savedIndex.value(scheme.id, -1);
+        for (const ModelRecord& model : scheme.models)
+        {
+            currentModels.insert(model.id);
+            const auto it = savedModels.constFind(model.id);
+            const bool sameOwner = it != savedModels.constEnd() && it->scheme == previous;
+            if (sameOwner && saved.at(it->scheme).models.at(it->model) == model)
+                continue;
+            QJsonObject op;
+            op.insert(QStringLiteral("op"), QStringLiteral("putModel"));
+            op.insert(QStringLiteral("scheme"), scheme.id);
+            op.insert(QStringLiteral("model"), modelToJson(model));
+            ops.append(op);
+            if (!sameOwner)
+                appended << model.id;
+        }
+
+        // 重放后的顺序：原有模型保持原位，新加入的追加在后。与实际顺序不同时记录一次排序
+        const QStringList actualOrder = modelIds(scheme.models);
+        if (previous >= 0)
+        {
+            const QSet<QString> kept(actualOrder.begin(), actualOrder.end());
+            for (const ModelRecord& model : saved.at(previous).models)
+            {
+                if (kept.contains(model.id))
+                    expectedOrder << model.id;
+            }
+        }
+        expectedOrder << appended;
+        if (expectedOrder != actualOrder)
+        {
+            QJsonObject op;
+            op.insert(QStringLiteral("op"), QStringLiteral("orderModels"));
+            op.insert(QStringLiteral("scheme"), scheme.id);
+            op.insert(QStringLiteral("ids"), idArray(actualOrder));
+            ops.append(op);
+        }
+    }
+
+    for (auto it = savedModels.constBegin(); it != savedModels.constEnd(); ++it)
+    {
+        // 所在方案整体删除时随 removeScheme 一起删除
+        if (currentModels.contains(it.key()) || !currentIds.contains(saved.at(it->scheme).id))
+            continue;
+        QJsonObject op;
+        op.insert(QStringLiteral("op"), QStringLiteral("removeModel"));
+        op.insert(QStringLiteral("id"), it.key());
+        ops.append(op);
+    }
+
+    QStringList expectedSchemes;
+    for (const SchemeRecord& scheme : saved)
+    {
+        if (currentIds.contains(scheme.id))
+            expectedSchemes << scheme.id;
+        else
+        {
+            QJsonObject op;
+            op.insert(QStringLiteral("op"), QStringLiteral("removeScheme"));
+            op.insert(QStringLiteral("id"), scheme.id);
+            ops.append(op);
+        }
+    }
+    for (const SchemeRecord& scheme : current)
+    {
+        if (!savedIndex.contains(scheme.id))
+            expectedSchemes << scheme.id;
+    }
+    const QStringList actualSchemes = schemeIds(current);
+    if (expectedSchemes != actualSchemes)
+    {
+        QJsonObject op;
+        op.insert(QStringLiteral("op"), QStringLiteral("orderSchemes"));
+        op.insert(QStringLiteral("ids"), idArray(actualSchemes));
+        ops.append(op);
+    }
+    return ops;
+}
+
+QString journalPath(const QString& storageFilePath)
+{
+    const QFileInfo info(storageFilePath);
+    return info.dir().filePath(info.completeBaseName() + QStringLiteral(".journal.jsonl"));
+}
+
+bool load(const QString& storageFilePath,
+          const QString& projectRoot,
+          QVector<SchemeRecord>* schemes,
+          QString* workspaceRoot,
+          qint64* sequence,
+          QString* warning)
+{
+    if (storageFilePath.isEmpty())
+        return false;
+
+    QFile file(storageFilePath);
+    if (!file.exists())
+        return false;
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    const QByteArray data = file.readAll();
+    file.close();
+
+    QJsonParseError err{};
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject())
+        return false;
+
+    const QJsonObject root = doc.object();
+    QString storedRoot = root.value(QStringLiteral("workspaceRoot")).toString().trimmed();
+
+    QVector<SchemeRecord> loaded;
+    const QJsonArray schemeArray = root.value(QStringLiteral("schemes")).toArray();
+    for (const QJsonValue& value : schemeArray)
+    {
+        const QJsonObject obj = value.toObject();
+        SchemeRecord scheme;
+        if (!schemeFromJson(obj, &scheme))
+            continue;
+
+        const QJsonArray modelArray = obj.value(QStringLiteral("models")).toArray();
+        for (const QJsonValue& mv : modelArray)
+        {
+            ModelRecord model;
+            if (modelFromJson(mv.toObject(), &model))
+                scheme.models.push_back(model);
+        }
+        loaded.push_back(scheme);
+    }
+
+    qint64 applied = qint64(root.value(QStringLiteral("journalSeq")).toDouble());
+    const QString journal = journalPath(storageFilePath);
+    if (QFileInfo::exists(journal))
+    {
+        ProjectRegistry registry;
+        registry.reset(loaded);
+        const QString journalWarning = replayJournal(journal, registry, &storedRoot, &applied);
+        if (warning)
+            *warning = journalWarning;
+        loaded = registry.schemes();
+    }
+
+    storedRoot = storedRoot.trimmed();
+    if (!storedRoot.isEmpty() && workspaceRoot)
+        *workspaceRoot = resolveWorkspaceRoot(storedRoot, projectRoot);
+    if (schemes)
+        *schemes = loaded;
+    if (sequence)
+        *sequence = applied;
+    return true;
+}
+
+bool save(const QString& storageFilePath,
+          const QString& projectRoot,
+          const QString& workspaceRoot,
+          const QVector<SchemeRecord>& schemes,
+          qint64 sequence)
+{
+    if (storageFilePath.isEmpty())
+        return false;
+
+    QFileInfo info(storageFilePath);
+    QDir dir = info.dir();
+    if (!dir.exists())
+        dir.mkpath(QStringLiteral("."));
+
+    QJsonArray schemeArray;
+    for (const SchemeRecord& scheme : schemes)
+    {
+        QJsonObject obj = schemeToJson(scheme);
+        QJsonArray modelArray;
+        for (const ModelRecord& model : scheme.models)
+            modelArray.append(modelToJson(model));
+        obj.insert(QStringLiteral("models"), modelArray);
+        schemeArray.append(obj);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("workspaceRoot"), storedWorkspaceRoot(workspaceRoot, projectRoot));
+    root.insert(QStringLiteral("journalSeq"), double(sequence));
+    root.insert(QStringLiteral("schemes"), schemeArray);
+
+    // 先写临时文件再替换，写到一半退出不会损坏原有快照
+    QSaveFile file(storageFilePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit())
+        return false;
+    QFile::remove(journalPath(storageFilePath));
+    return true;
+}
+}
+
+void SchemeJournal::reset(const QString& storageFilePath,
+                          const QString& projectRoot,
+                          const QString& workspaceRoot,
+                          const QVector<SchemeRecord>& schemes,
+                          qint64 sequence)
+{
+    m_storageFilePath = storageFilePath;
+    m_projectRoot = projectRoot;
+    m_workspaceRoot = workspaceRoot;
+    m_saved = schemes;
+    m_sequence = sequence;
+    const QString journal = SchemeStorage::journalPath(storageFilePath);
+    m_journalBytes = QFileInfo::exists(journal) ? trimJournal(journal, sequence) : 0;
+    // 行数只用于触发合并，按平均行长估算即可
+    m_journalEntries = int(m_journalBytes / 256);
+}
+
+void SchemeJournal::clear()
+{
+    m_storageFilePath.clear();
+    m_projectRoot.clear();
+    m_workspaceRoot.clear();
+    m_saved.clear();
+    m_sequence = 0;
+    m_journalBytes = 0;
+    m_journalEntries = 0;
+}
+
+bool SchemeJournal::save(const QString& workspaceRoot, const QVector<SchemeRecord>& schemes)
+{
+    if (!isOpen())
+        return false;
+    if (m_journalBytes >= kCompactJournalBytes || m_journalEntries >= kCompactJournalEntries ||
+        !QFileInfo::exists(m_storageFilePath))
+        return compact(workspaceRoot, schemes);
+
+    QJsonArray ops = SchemeStorage::diff(m_saved, schemes);
+    if (workspaceRoot != m_workspaceRoot)
+    {
+        QJsonObject op;
+        op.insert(QStringLiteral("op"), QStringLiteral("workspace"));
+        op.insert(QStringLiteral("workspaceRoot"), SchemeStorage::storedWorkspaceRoot(workspaceRoot, m_projectRoot));
+        ops.prepend(op);
+    }
+    if (ops.isEmpty())
+        return true;
+
+    QJsonObject entry;
+    entry.insert(QStringLiteral("seq"), double(m_sequence + 1));
+    entry.insert(QStringLiteral("ops"), ops);
+    QByteArray line = QJsonDocument(entry).toJson(QJsonDocument::Compact);
+    line.append('\n');
+
+    // 一次保存写成一行；追加失败时退回整体改写
+    QFile file(SchemeStorage::journalPath(m_storageFilePath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(line) != line.size() ||
+        !file.flush())
+    {
+        file.close();
+        return compact(workspaceRoot, schemes);
+    }
+    file.close();
+
+    ++m_sequence;
+    m_journalBytes += line.size();
+    ++m_journalEntries;
+    m_saved = schemes;
+    m_workspaceRoot = workspaceRoot;
+    return true;
+}
+
+bool SchemeJournal::compact(const QString& workspaceRoot, const QVector<SchemeRecord>& schemes)
+{
+    if (!isOpen())
+        return false;
+    if (!SchemeStorage::save(m_storageFilePath, m_projectRoot, workspaceRoot, schemes, m_sequence))
+        return false;
+    m_journalBytes = 0;
+    m_journalEntries = 0;
+    m_saved = schemes;
+    m_workspaceRoot = workspaceRoot;
+    return true;
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include "ProjectTypes.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+// 工程目录下 schemes.json 的读写。schemes.json 是快照，之后的修改以增量形式
+// 追加到同目录的 schemes.journal.jsonl，读取时先读快照再按顺序重放变更日志
+namespace SchemeStorage
+{
+QString journalPath(const QString& storageFilePath);
+
+// 文件中记录的工作区：位于工程内时保存为相对路径
+QString storedWorkspaceRoot(const QString& workspaceRoot, const QString& projectRoot);
+QString resolveWorkspaceRoot(const QString& storedRoot, const QString& projectRoot);
+
+// 单条方案（不含模型）与模型的解析。路径只做字符串整理，不访问文件系统
+bool schemeFromJson(const QJsonObject& obj, SchemeRecord* scheme);
+bool modelFromJson(const QJsonObject& obj, ModelRecord* model);
+
+// saved 到 current 的变更操作（putScheme、removeScheme、putModel、removeModel、
+// orderSchemes、orderModels），变更日志与数据库目录共用
+QJsonArray diff(const QVector<SchemeRecord>& saved, const QVector<SchemeRecord>& current);
+
+// workspaceRoot 仅在文件中记录了工作区时被改写；相对路径按 projectRoot 解析。
+// sequence 返回已应用的最后一条变更日志的序号；变更日志残缺而未能全部应用时，
+// warning 中给出说明，仍返回 true
+bool load(const QString& storageFilePath,
+          const QString& projectRoot,
+          QVector<SchemeRecord>* schemes,
+          QString* workspaceRoot,
+          qint64* sequence = nullptr,
+          QString* warning = nullptr);
+
+// 通过 QSaveFile 整体改写快照并清空变更日志；快照中记录 sequence，
+// 改写后未能删除的旧日志在读取时会被跳过
+bool save(const QString& storageFilePath,
+          const QString& projectRoot,
+          const QString& workspaceRoot,
+          const QVector<SchemeRecord>& schemes,
+          qint64 sequence = 0);
+}
+
+// 记住上次写入磁盘的内容，保存时只把差异作为一行追加到变更日志。
+// 改名只追加几十字节；日志超过阈值时合并进快照
+class SchemeJournal
+{
+public:
+    // 以刚从磁盘读取的内容为基准；变更日志中 sequence 之后未能应用的部分被截掉
+    void reset(const QString& storageFilePath,
+               const QString& projectRoot,
+               const QString& workspaceRoot,
+               const QVector<SchemeRecord>& schemes,
+               qint64 sequence);
+    void clear();
+    bool isOpen() const { return !m_storageFilePath.isEmpty(); }
+
+    bool save(const QString& workspaceRoot, const QVector<SchemeRecord>& schemes);
+    bool compact(const QString& workspaceRoot, const QVector<SchemeRecord>& schemes);
+
+private:
+    QString m_storageFilePath;
+    QString m_projectRoot;
+    QString m_workspaceRoot;
+    QVector<SchemeRecord> m_saved;      // 与磁盘一致的内容，隐式共享，复制不产生深拷贝
+    qint64 m_sequence = 0;
+    qint64 m_journalBytes = 0;
+    int m_journalEntries = 0;
+};
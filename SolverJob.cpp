@@ -0,0 +1,719 @@
+﻿#include "SolverJob.h"
+#include "ArtifactWatcher.h"
+#include "ModelFiles.h"
+#include "ResultCache.h"
+#include "ResultReaderRegistry.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileInfoList>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalBlocker>
+#include <QTextCodec>
+#include <QTimer>
+#include <QUuid>
+#include <QtConcurrent>
+
+#ifdef Q_OS_WIN
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <qt_windows.h>
+#include <tlhelp32.h>
+#endif
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+const int kFlushIntervalMs = 200;
+const int kMaxChunkBytes = 16 * 1024;
+const int kMaxPendingBytes = 256 * 1024;
+const int kMaxTailBytes = 8 * 1024;
+const int kLogPollIntervalMs = 1000;
+
+class SolverProcess : public QProcess
+{
+public:
+    explicit SolverProcess(QObject* parent = nullptr)
+        : QProcess(parent)
+    {
+#if defined(Q_OS_UNIX) && QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        setChildProcessModifier([]() { ::setpgid(0, 0); });
+#endif
+    }
+
+protected:
+#if defined(Q_OS_UNIX) && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    void setupChildProcess() override
+    {
+        // 让脚本及其子进程处于独立的进程组，便于整体终止
+        ::setpgid(0, 0);
+    }
+#endif
+};
+
+struct CacheLookup
+{
+    QString key;
+    bool hit = false;
+    ResultCacheEntry entry;
+};
+
+// 监视事件丢失时的补救：修改时间不早于启动时刻的求解输出，按修改时间从新到旧
+QStringList outputsModifiedSince(const QString& directory, const QDateTime& since)
+{
+    const QFileInfoList files = QDir(directory).entryInfoList(QDir::Files, QDir::Time);
+    QStringList names;
+    for (const QFileInfo& info : files)
+    {
+        if (ModelFiles::isSolverOutput(info) && info.lastModified() >= since)
+            names << info.fileName();
+    }
+    return names;
+}
+
+QJsonValue readParameterSnapshot(const QString& path)
+{
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return QJsonValue();
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isArray())
+        return doc.array();
+    if (doc.isObject())
+        return doc.object();
+    return QJsonValue();
+}
+
+#ifdef Q_OS_WIN
+using NtProcessCall = LONG(NTAPI*)(HANDLE);
+
+// ntdll 导出的整进程挂起与恢复，一次调用作用于进程的全部线程，不会漏掉刚创建的线程
+NtProcessCall ntProcessCall(const char* name)
+{
+    const HMODULE ntdll = ::GetModuleHandleW(L"ntdll.dll");
+    return ntdll ? reinterpret_cast<NtProcessCall>(::GetProcAddress(ntdll, name)) : nullptr;
+}
+
+// 沿父进程号收集进程树，父进程排在子进程之前
+QVector<DWORD> processTree(DWORD root)
+{
+    QVector<DWORD> tree;
+    HANDLE snapshot = ::CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE)
+        return tree;
+    QHash<DWORD, QVector<DWORD>> children;
+    PROCESSENTRY32W process;
+    process.dwSize = sizeof(process);
+    for (BOOL ok = ::Process32FirstW(snapshot, &process); ok; ok = ::Process32NextW(snapshot, &process))
+        children[process.th32ParentProcessID].append(process.th32ProcessID);
+    ::CloseHandle(snapshot);
+
+    QSet<DWORD> seen;
+    tree.append(root);
+    seen.insert(root);
+    for (int i = 0; i < tree.size(); ++i)
+    {
+        for (DWORD child : children.value(tree.at(i)))
+        {
+            if (!seen.contains(child))
+            {
+                seen.insert(child);
+                tree.append(child);
+            }
+        }
+    }
+    return tree;
+}
+#endif
+
+// 暂停或恢复脚本及其全部子进程，已经完成的增量步不会丢失
+bool setProcessTreeSuspended(qint64 pid, bool suspended)
+{
+    if (pid <= 0)
+        return false;
+#ifdef Q_OS_WIN
+    // Windows 没有进程组信号：按进程树逐个挂起整个进程。挂起前派生的子进程可能不在第一次的快照里，
+    // 挂起后重新收集，直到没有新的成员
+    static const NtProcessCall suspendProcess = ntProcessCall("NtSuspendProcess");
+    static const NtProcessCall resumeProcess = ntProcessCall("NtResumeProcess");
+    if (!suspendProcess || !resumeProcess)
+        return false;
+
+    QSet<DWORD> handled;
+    bool any = false;
+    for (int round = 0; round < 8; ++round)
+    {
+        bool added = false;
+        for (DWORD id : processTree(DWORD(pid)))
+        {
+            if (handled.contains(id))
+                continue;
+            handled.insert(id);
+            added = true;
+            HANDLE handle = ::OpenProcess(PROCESS_SUSPEND_RESUME, FALSE, id);
+            if (!handle)
+                continue;
+            const LONG status = suspended ? suspendProcess(handle) : resumeProcess(handle);
+            any = any || status >= 0;
+            ::CloseHandle(handle);
+        }
+        // 恢复时整个进程树都是挂起的，不会再派生新进程
+        if (!added || !suspended)
+            break;
+    }
+    return any;
+#else
+    return ::kill(-static_cast<pid_t>(pid), suspended ? SIGSTOP : SIGCONT) == 0;
+#endif
+}
+
+void killProcessTree(qint64 pid)
+{
+    if (pid <= 0)
+        return;
+#ifdef Q_OS_WIN
+    // cmd 启动的求解器是独立进程，必须在父进程退出前按进程树终止。
+    // 直接结束快照中的每个进程，父进程在前，不再派生新进程；不启动 taskkill 也不等待，界面线程不会卡住
+    for (DWORD id : processTree(DWORD(pid)))
+    {
+        HANDLE handle = ::OpenProcess(PROCESS_TERMINATE, FALSE, id);
+        if (!handle)
+            continue;
+        ::TerminateProcess(handle, 1);
+        ::CloseHandle(handle);
+    }
+#else
+    ::kill(-static_cast<pid_t>(pid), SIGKILL);
+#endif
+}
+}
+
+SolverJob::SolverJob(const QString& workingDirectory, QObject* parent)
+    : QObject(parent)
+    , m_workingDirectory(workingDirectory)
+#ifdef Q_OS_WIN
+    , m_program(QStringLiteral("cmd"))
+    , m_arguments(QStringList() << QStringLiteral("/c") << QStringLiteral("calculate.bat"))
+#else
+    // 计算节点上没有 cmd，约定使用同目录下的 calculate.sh
+    , m_program(QStringLiteral("sh"))
+    , m_arguments(QStringList() << QStringLiteral("calculate.sh"))
+#endif
+{
+    QDir dir(m_workingDirectory);
+    m_datPath = dir.filePath(QStringLiteral("Job-2.dat"));
+    m_msgPath = dir.filePath(QStringLiteral("Job-2.msg"));
+
+    m_process = new SolverProcess(this);
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_process, &QProcess::readyReadStandardOutput,
+            this, &SolverJob::onReadyRead);
+    connect(m_process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, &SolverJob::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred,
+            this, &SolverJob::onProcessError);
+
+    m_artifactWatcher = new ArtifactWatcher(this);
+    connect(m_artifactWatcher, &ArtifactWatcher::fileClosed, this, [this](const QString& path) {
+        if (m_state == Running && ModelFiles::isSolverOutput(QFileInfo(path)))
+            emit artifactUpdated(path);
+    });
+
+    m_monitor = new ResourceMonitor(this);
+    connect(m_process, &QProcess::started, this, [this]() {
+        m_monitor->start(m_process->processId());
+    });
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout,
+            this, &SolverJob::flushPendingOutput);
+
+    m_logTimer = new QTimer(this);
+    m_logTimer->setInterval(kLogPollIntervalMs);
+    connect(m_logTimer, &QTimer::timeout,
+            this, &SolverJob::pollLogs);
+}
+
+SolverJob::~SolverJob()
+{
+    if (m_state == Running)
+    {
+        // 析构时不再对外发出 finished，只保证不留下孤儿求解进程
+        m_state = Finished;
+        m_process->disconnect(this);
+        killProcessTree(m_process->processId());
+        m_process->kill();
+        m_process->waitForFinished(3000);
+    }
+}
+
+void SolverJob::setLauncherScript(const QString& scriptPath)
+{
+    if (scriptPath.isEmpty())
+        return;
+    const QString suffix = QFileInfo(scriptPath).suffix().toLower();
+    // 工作目录内的脚本用相对路径，参数参与结果缓存键，不同目录下的相同模型仍能命中
+    const QString script = QDir(m_workingDirectory).relativeFilePath(scriptPath);
+#ifdef Q_OS_WIN
+    if (suffix != QLatin1String("bat") && suffix != QLatin1String("cmd"))
+        return;
+    m_arguments = QStringList() << QStringLiteral("/c") << QDir::toNativeSeparators(script);
+#else
+    if (suffix != QLatin1String("sh"))
+        return;
+    m_arguments = QStringList() << script;
+#endif
+}
+
+void SolverJob::setThreadCount(int threads)
+{
+    // 求解器通过环境变量获知可用核数，与调度器分配的核数保持一致
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    const QString value = QString::number(qMax(1, threads));
+    env.insert(QStringLiteral("OMP_NUM_THREADS"), value);
+    env.insert(QStringLiteral("FLEXSIM_NUM_THREADS"), value);
+    m_process->setProcessEnvironment(env);
+}
+
+void SolverJob::setParameterFile(const QString& path)
+{
+    m_parameterFile = path;
+}
+
+void SolverJob::setResultCache(const QSharedPointer<ResultCache>& cache)
+{
+    m_cache = cache;
+}
+
+void SolverJob::start()
+{
+    if (m_state == Running)
+        return;
+
+    m_state = Running;
+    m_cancelRequested = false;
+    m_result = SolverRunResult();
+    m_result.startedAt = QDateTime::currentDateTime();
+    m_pending.clear();
+    m_tail.clear();
+    m_droppedBytes = 0;
+    m_cacheKey.clear();
+    m_progress = SolverProgress();
+    m_problemReported = false;
+    m_msgTail.reset();
+    m_datTail.reset();
+    m_decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
+    m_runRecord = RunRecord();
+    m_suspended = false;
+    m_parameterSnapshot = readParameterSnapshot(m_parameterFile);
+    emit started();
+
+    if (m_cache)
+        beginCacheLookup();
+    else
+        launchProcess();
+}
+
+void SolverJob::beginCacheLookup()
+{
+    // 计算摘要需要读取全部输入文件，放到工作线程中进行
+    const QSharedPointer<ResultCache> cache = m_cache;
+    const QString directory = m_workingDirectory;
+    const QString program = m_program;
+    const QStringList arguments = m_arguments;
+
+    auto* watcher = new QFutureWatcher<CacheLookup>(this);
+    connect(watcher, &QFutureWatcher<CacheLookup>::finished, this, [this, watcher]() {
+        const CacheLookup lookup = watcher->result();
+        watcher->deleteLater();
+        onCacheLookupFinished(lookup.key, lookup.hit, lookup.entry);
+    });
+    watcher->setFuture(QtConcurrent::run([cache, directory, program, arguments]() {
+        CacheLookup lookup;
+        lookup.key = cache->computeKey(directory, program, arguments);
+        lookup.hit = cache->restore(lookup.key, directory, &lookup.entry);
+        return lookup;
+    }));
+}
+
+void SolverJob::onCacheLookupFinished(const QString& key, bool hit, const ResultCacheEntry& entry)
+{
+    if (m_state != Running)
+        return;
+
+    m_cacheKey = key;
+    if (m_cancelRequested)
+    {
+        finalize(-1, false);
+        return;
+    }
+    if (!hit)
+    {
+        launchProcess();
+        return;
+    }
+
+    m_flushTimer->stop();
+    m_result.fromCache = true;
+    m_result.cacheKey = key;
+    m_result.exitCode = entry.exitCode;
+    m_result.errorMessage = entry.errorMessage;
+    m_result.stlPath = entry.stlFile.isEmpty()
+                           ? QString()
+                           : QDir(m_workingDirectory).filePath(entry.stlFile);
+    m_result.message = tr("%1（结果来自缓存）").arg(entry.message);
+    m_result.finishedAt = QDateTime::currentDateTime();
+    recordRun(entry.files);
+    m_state = Finished;
+    emit finished();
+}
+
+void SolverJob::launchProcess()
+{
+    m_launchedAt = QDateTime::currentDateTime();
+    m_artifactWatcher->start(m_workingDirectory);
+    m_msgTail.reset(new SolverLogTail(m_msgPath, SolverLogTail::MsgFile));
+    m_datTail.reset(new SolverLogTail(m_datPath, SolverLogTail::DatFile));
+    m_msgTail->markBaseline();
+    m_datTail->markBaseline();
+
+    m_process->setWorkingDirectory(m_workingDirectory);
+    m_flushTimer->start();
+    m_logTimer->start();
+    m_process->start(m_program, m_arguments);
+}
+
+void SolverJob::pollLogs()
+{
+    if (!m_msgTail || !m_datTail)
+        return;
+
+    const bool msgChanged = m_msgTail->poll();
+    const bool datChanged = m_datTail->poll();
+    if (!msgChanged && !datChanged)
+        return;
+
+    // .msg 记录增量步尝试，.dat 记录分析步完成比例，两者互为补充
+    const SolverLogTail* primary = m_msgTail->isActive() ? m_msgTail.data() : m_datTail.data();
+    const SolverLogTail* secondary = primary == m_msgTail.data() ? m_datTail.data() : nullptr;
+    SolverProgress progress = primary->progress();
+    if (secondary && secondary->isActive())
+    {
+        const SolverProgress& other = secondary->progress();
+        if (other.step > progress.step)
+        {
+            progress.step = other.step;
+            progress.increment = other.increment;
+            progress.stepFraction = other.stepFraction;
+        }
+        else if (other.step == progress.step)
+        {
+            progress.increment = qMax(progress.increment, other.increment);
+            progress.stepFraction = qMax(progress.stepFraction, other.stepFraction);
+        }
+        progress.totalTime = qMax(progress.totalTime, other.totalTime);
+        progress.completed = progress.completed || other.completed;
+    }
+    m_progress = progress;
+    emit progressChanged(m_progress);
+
+    if (!m_problemReported && (m_msgTail->hasError() || m_datTail->hasError()))
+    {
+        const QString message = currentErrorMessage();
+        if (!message.isEmpty())
+        {
+            m_problemReported = true;
+            emit problemDetected(message);
+        }
+    }
+}
+
+QString SolverJob::currentErrorMessage() const
+{
+    // 先检测 .msg，否则检测 .dat；本次运行未改写的旧文件不参与判断
+    if (m_msgTail && m_msgTail->isActive())
+        return m_msgTail->errorMessage();
+    if (m_datTail && m_datTail->isActive())
+        return m_datTail->errorMessage();
+    return QString();
+}
+
+void SolverJob::storeInCache()
+{
+    // 只缓存正常结束的运行；被取消或崩溃的结果不可复现
+    if (!m_cache || m_cacheKey.isEmpty() || m_result.cancelled || m_result.crashed ||
+        m_result.exitCode != 0)
+        return;
+
+    ResultCacheEntry entry;
+    entry.key = m_cacheKey;
+    entry.exitCode = m_result.exitCode;
+    entry.errorMessage = m_result.errorMessage;
+    entry.message = m_result.message;
+
+    QStringList artifacts;
+    if (!m_result.stlPath.isEmpty())
+        artifacts << m_result.stlPath;
+    artifacts << m_msgPath << m_datPath;
+
+    const QSharedPointer<ResultCache> cache = m_cache;
+    QtConcurrent::run([cache, entry, artifacts]() {
+        cache->store(entry, artifacts);
+    });
+}
+
+QStringList SolverJob::collectArtifacts()
+{
+    {
+        // 结束时补读的事件不再作为中间结果转发
+        const QSignalBlocker blocker(m_artifactWatcher);
+        m_artifactWatcher->finish();
+    }
+
+    const QDir dir(m_workingDirectory);
+    QStringList artifacts;
+    const QStringList closed = m_artifactWatcher->closedFiles();
+    for (auto it = closed.crbegin(); it != closed.crend(); ++it)
+    {
+        const QFileInfo info(dir.filePath(*it));
+        if (info.exists() && ModelFiles::isSolverOutput(info))
+            artifacts << *it;
+    }
+    if (m_artifactWatcher->hasOverflowed())
+    {
+        // 文件系统时间精度可能只有 2 秒
+        const QStringList rescued = outputsModifiedSince(m_workingDirectory, m_launchedAt.addSecs(-2));
+        for (const QString& name : rescued)
+        {
+            if (!artifacts.contains(name))
+                artifacts << name;
+        }
+    }
+    return artifacts;
+}
+
+void SolverJob::recordRun(const QStringList& artifacts)
+{
+    RunRecord& record = m_runRecord;
+    record.runId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    record.startedAt = m_result.startedAt;
+    record.finishedAt = m_result.finishedAt;
+    record.exitCode = m_result.exitCode;
+    record.cancelled = m_result.cancelled;
+    record.crashed = m_result.crashed;
+    record.fromCache = m_result.fromCache;
+    record.cacheKey = m_result.cacheKey;
+    record.errorMessage = m_result.errorMessage;
+    record.message = m_result.message;
+    record.stlFile = m_result.stlPath.isEmpty()
+                         ? QString()
+                         : QDir(m_workingDirectory).relativeFilePath(m_result.stlPath);
+    record.artifacts = artifacts;
+    record.parameters = m_parameterSnapshot;
+    record.usage = m_result.usage;
+    record.suspendedMs = m_result.suspendedMs;
+    if (!RunJournal::append(m_workingDirectory, record))
+        emit outputReceived(tr("无法写入运行记录：%1")
+                                .arg(QDir::toNativeSeparators(RunJournal::journalPath(m_workingDirectory))));
+}
+
+bool SolverJob::suspend()
+{
+    if (m_state != Running || m_suspended || m_process->state() != QProcess::Running)
+        return false;
+    if (!setProcessTreeSuspended(m_process->processId(), true))
+        return false;
+    m_suspended = true;
+    m_suspendedAt.start();
+    emit suspendedChanged(true);
+    return true;
+}
+
+bool SolverJob::resume()
+{
+    if (!m_suspended)
+        return false;
+    setProcessTreeSuspended(m_process->processId(), false);
+    m_suspended = false;
+    m_result.suspendedMs += m_suspendedAt.elapsed();
+    emit suspendedChanged(false);
+    return true;
+}
+
+void SolverJob::cancel()
+{
+    if (m_state != Running)
+        return;
+
+    m_cancelRequested = true;
+    // 被暂停的进程收不到普通的终止请求，先恢复再结束
+    if (m_suspended)
+        resume();
+    killProcessTree(m_process->processId());
+    m_process->kill();
+}
+
+void SolverJob::onReadyRead()
+{
+    const QByteArray data = m_process->readAllStandardOutput();
+    if (data.isEmpty())
+        return;
+
+    m_tail.append(data);
+    if (m_tail.size() > kMaxTailBytes)
+        m_tail.remove(0, m_tail.size() - kMaxTailBytes);
+
+    m_pending.append(data);
+    if (m_pending.size() > kMaxPendingBytes)
+    {
+        const int overflow = m_pending.size() - kMaxPendingBytes;
+        m_pending.remove(0, overflow);
+        m_droppedBytes += overflow;
+        // 丢弃后解码器可能停在多字节字符中间，重新开始
+        m_decoder.reset(QTextCodec::codecForLocale()->makeDecoder());
+    }
+}
+
+void SolverJob::flushPendingOutput()
+{
+    emitPending(kMaxChunkBytes);
+}
+
+void SolverJob::emitPending(int maxBytes)
+{
+    if (m_droppedBytes > 0)
+    {
+        emit outputReceived(tr("（输出过快，已省略 %1 字节）").arg(m_droppedBytes));
+        m_droppedBytes = 0;
+    }
+
+    if (m_pending.isEmpty())
+        return;
+
+    int take = m_pending.size();
+    if (take > maxBytes)
+    {
+        // 尽量在行尾处截断，避免一行被拆成两条日志
+        const int lineEnd = m_pending.lastIndexOf('\n', maxBytes - 1);
+        take = lineEnd > 0 ? lineEnd + 1 : maxBytes;
+    }
+
+    const QString text = m_decoder->toUnicode(m_pending.constData(), take);
+    m_pending.remove(0, take);
+
+    const QString trimmed = text.trimmed();
+    if (!trimmed.isEmpty())
+        emit outputReceived(trimmed);
+}
+
+void SolverJob::onProcessFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (m_state != Running)
+        return;
+    finalize(exitCode, status == QProcess::CrashExit);
+}
+
+void SolverJob::onProcessError(QProcess::ProcessError error)
+{
+    if (m_state != Running || error != QProcess::FailedToStart)
+        return;
+
+    emit outputReceived(tr("计算脚本执行异常：%1").arg(m_process->errorString()));
+    finalize(-1, true);
+}
+
+void SolverJob::finalize(int exitCode, bool crashed)
+{
+    onReadyRead();
+    m_flushTimer->stop();
+    m_logTimer->stop();
+    if (m_suspended)
+    {
+        m_suspended = false;
+        m_result.suspendedMs += m_suspendedAt.elapsed();
+    }
+    if (m_monitor->isRunning())
+    {
+        m_monitor->stop();
+        m_result.usage = m_monitor->usage();
+    }
+    if (m_msgTail && m_datTail)
+    {
+        m_msgTail->finish();
+        m_datTail->finish();
+    }
+    while (!m_pending.isEmpty() || m_droppedBytes > 0)
+        emitPending(kMaxChunkBytes);
+
+    m_result.finishedAt = QDateTime::currentDateTime();
+    m_result.cancelled = m_cancelRequested;
+    m_result.crashed = crashed && !m_cancelRequested;
+    m_result.exitCode = crashed ? -1 : exitCode;
+
+    const QString now = m_result.startedAt.toString("yyyy-MM-dd HH:mm:ss");
+
+    QString message;
+    if (m_result.cancelled)
+    {
+        message = tr("计算已取消，时间：%1").arg(now);
+    }
+    else
+    {
+        if (m_result.exitCode == 0)
+            message = tr("计算成功，时间：%1").arg(now);
+
+        m_result.errorMessage = currentErrorMessage();
+
+        if (!m_result.errorMessage.isEmpty())
+            message = tr("错误信息：%1 时间：%2").arg(m_result.errorMessage, now);
+
+        if (message.isEmpty())
+        {
+            // 兜底信息：既无错误也无成功码
+            message = tr("计算结束，退出码 %1 时间：%2")
+                          .arg(m_result.exitCode)
+                          .arg(now);
+            const QString tail = outputTailLines(10);
+            if (!tail.isEmpty())
+                message += QStringLiteral("\n%1").arg(tail);
+        }
+    }
+    m_result.message = message;
+
+    // 只认本次运行期间写完的文件，不再按目录中最新的结果猜测
+    const QStringList artifacts = m_msgTail ? collectArtifacts() : QStringList();
+    if (!m_result.cancelled)
+    {
+        const QString name = ResultReaderRegistry::instance().preferredResult(artifacts);
+        if (!name.isEmpty())
+            m_result.stlPath = QDir(m_workingDirectory).absoluteFilePath(name);
+    }
+    m_result.cacheKey = m_cacheKey;
+    storeInCache();
+    recordRun(artifacts);
+
+    m_state = Finished;
+    emit finished();
+}
+
+QString SolverJob::outputTailLines(int maxLines) const
+{
+    const QString text = QTextCodec::codecForLocale()->toUnicode(m_tail).trimmed();
+    if (text.isEmpty())
+        return QString();
+    QStringList lines = text.split(QLatin1Char('\n'));
+    if (lines.size() > maxLines)
+        lines = lines.mid(lines.size() - maxLines);
+    return lines.join(QLatin1Char('\n')).trimmed();
+}
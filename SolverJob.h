@@ -0,0 +1,136 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include "ResourceMonitor.h"
+#include "RunJournal.h"
+#include "SolverLogTail.h"
+
+class ArtifactWatcher;
+class QTextDecoder;
+class QTimer;
+class ResultCache;
+struct ResultCacheEntry;
+
+struct SolverRunResult
+{
+    int exitCode = -1;
+    bool cancelled = false;
+    bool crashed = false;
+    QString errorMessage;   // 从 .msg/.dat 中提取的错误
+    QString stlPath;        // 本次运行新生成或改写的结果文件，优先 STL，也可以是其他已注册的格式
+    QString message;        // 面向用户的结论
+    QDateTime startedAt;
+    QDateTime finishedAt;
+    bool fromCache = false;  // 命中结果缓存，未实际运行求解脚本
+    QString cacheKey;
+    ResourceUsage usage;     // 进程树的资源消耗，命中缓存或未能启动时无效
+    qint64 suspendedMs = 0;  // 被暂停的总时长，包含在墙钟时间内
+};
+
+// 以异步方式运行求解脚本：输出按块转发，内存占用有上限，可整体终止进程树
+class SolverJob : public QObject
+{
+    Q_OBJECT
+public:
+    enum State {
+        Idle = 0,
+        Running,
+        Finished
+    };
+
+    explicit SolverJob(const QString& workingDirectory, QObject* parent = nullptr);
+    ~SolverJob() override;
+
+    // 模型自己的启动脚本（ModelRecord::batPath）；为空或不适用于当前平台时沿用默认的
+    // calculate.bat / calculate.sh
+    void setLauncherScript(const QString& scriptPath);
+    void setThreadCount(int threads);
+    // 参数文件在启动时做快照写入运行日志
+    void setParameterFile(const QString& path);
+    // 设置后先按输入内容查找缓存，命中则直接恢复产物；成功的运行会写回缓存
+    void setResultCache(const QSharedPointer<ResultCache>& cache);
+    void start();
+    void cancel();
+    // 暂停/恢复整个进程树；只在求解进程运行期间有效
+    bool suspend();
+    bool resume();
+
+    State state() const { return m_state; }
+    bool isRunning() const { return m_state == Running; }
+    bool isSuspended() const { return m_suspended; }
+    QString workingDirectory() const { return m_workingDirectory; }
+    const SolverRunResult& result() const { return m_result; }
+    const SolverProgress& progress() const { return m_progress; }
+    // 结束后写入 .flexsim/runs.jsonl 的记录
+    const RunRecord& runRecord() const { return m_runRecord; }
+
+signals:
+    void started();
+    void outputReceived(const QString& text);
+    // 运行期间解析 .msg/.dat 得到的进度
+    void progressChanged(const SolverProgress& progress);
+    // 求解器在运行中报告了 ERROR，每次运行只发出一次
+    void problemDetected(const QString& message);
+    // 运行期间求解器写完了一个输出文件（例如中间步的 STL）
+    void artifactUpdated(const QString& path);
+    void suspendedChanged(bool suspended);
+    void finished();
+
+private slots:
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus status);
+    void onProcessError(QProcess::ProcessError error);
+    void flushPendingOutput();
+    void pollLogs();
+
+private:
+    void beginCacheLookup();
+    void onCacheLookupFinished(const QString& key, bool hit, const ResultCacheEntry& entry);
+    void launchProcess();
+    void storeInCache();
+    QStringList collectArtifacts();
+    void recordRun(const QStringList& artifacts);
+    void emitPending(int maxBytes);
+    void finalize(int exitCode, bool crashed);
+    QString outputTailLines(int maxLines) const;
+    QString currentErrorMessage() const;
+
+    QString m_workingDirectory;
+    QString m_program;
+    QStringList m_arguments;
+    QString m_datPath;
+    QString m_msgPath;
+
+    QProcess* m_process = nullptr;
+    QTimer* m_flushTimer = nullptr;
+    QTimer* m_logTimer = nullptr;
+    ResourceMonitor* m_monitor = nullptr;
+    ArtifactWatcher* m_artifactWatcher = nullptr;
+    QScopedPointer<SolverLogTail> m_msgTail;
+    QScopedPointer<SolverLogTail> m_datTail;
+    SolverProgress m_progress;
+    bool m_problemReported = false;
+    QScopedPointer<QTextDecoder> m_decoder;
+    QByteArray m_pending;        // 待写入日志的输出，超过上限时丢弃最旧部分
+    qint64 m_droppedBytes = 0;
+    QByteArray m_tail;           // 最近的输出，用于失败时给出上下文
+    QString m_parameterFile;
+    QJsonValue m_parameterSnapshot;
+    QDateTime m_launchedAt;
+    RunRecord m_runRecord;
+    QSharedPointer<ResultCache> m_cache;
+    QString m_cacheKey;
+    State m_state = Idle;
+    bool m_cancelRequested = false;
+    bool m_suspended = false;
+    QElapsedTimer m_suspendedAt;
+    SolverRunResult m_result;
+};
@@ -0,0 +1,233 @@
+﻿#include "SolverLogTail.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+namespace
+{
+// 单次最多读取的字节数，避免求解器一次写出大量内容时阻塞界面
+const qint64 kMaxReadPerPoll = 4 * 1024 * 1024;
+// 没有换行的超长行按此长度强制处理
+const int kMaxPartialBytes = 1024 * 1024;
+// ERROR 段落保留的最大字符数（只影响提示信息的长度）
+const int kMaxBlockChars = 64 * 1024;
+
+const QString kNumber = QStringLiteral("([-+]?[0-9]*\\.?[0-9]+(?:[EeDd][-+]?[0-9]+)?)");
+
+double parseNumber(QString text)
+{
+    // Fortran 风格的指数 1.0D-02
+    text.replace(QLatin1Char('D'), QLatin1Char('E')).replace(QLatin1Char('d'), QLatin1Char('e'));
+    return text.toDouble();
+}
+
+QString cleanText(QString s)
+{
+    // 去掉重复空格
+    s.replace(QRegularExpression("\\s+"), " ");
+    s = s.trimmed();
+    return s;
+}
+}
+
+SolverLogTail::SolverLogTail(const QString& path, Kind kind)
+    : m_path(path)
+    , m_terminator(kind == MsgFile ? QStringLiteral("ANALYSIS SUMMARY") : QStringLiteral("NOTE"))
+{
+}
+
+void SolverLogTail::markBaseline()
+{
+    const QFileInfo info(m_path);
+    m_baselineSize = info.exists() ? info.size() : -1;
+    m_baselineModified = info.exists() ? info.lastModified() : QDateTime();
+}
+
+bool SolverLogTail::poll()
+{
+    const QFileInfo info(m_path);
+    if (!info.exists())
+        return false;
+
+    const qint64 size = info.size();
+    if (!m_active)
+    {
+        // 上一次运行留下的文件在求解器重写之前不参与解析
+        if (m_baselineSize >= 0 && size == m_baselineSize &&
+            info.lastModified() == m_baselineModified)
+            return false;
+        m_active = true;
+        m_offset = 0;
+    }
+
+    if (size < m_offset)
+    {
+        // 文件被截断或重新创建，从头开始
+        m_offset = 0;
+        m_partial.clear();
+        m_inBlock = false;
+        m_errorSeen = false;
+        m_block.clear();
+        m_lastBlock.clear();
+        m_progress = SolverProgress();
+        m_stepPeriod = -1.0;
+    }
+    if (size == m_offset)
+        return false;
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(m_offset))
+        return false;
+    const QByteArray data = file.read(qMin(size - m_offset, kMaxReadPerPoll));
+    file.close();
+    if (data.isEmpty())
+        return false;
+    m_offset += data.size();
+
+    m_partial.append(data);
+    int start = 0;
+    for (;;)
+    {
+        const int newline = m_partial.indexOf('\n', start);
+        if (newline < 0)
+            break;
+        int end = newline;
+        if (end > start && m_partial.at(end - 1) == '\r')
+            --end;
+        processLine(QString::fromUtf8(m_partial.constData() + start, end - start));
+        start = newline + 1;
+    }
+    m_partial.remove(0, start);
+    if (m_partial.size() > kMaxPartialBytes)
+    {
+        processLine(QString::fromUtf8(m_partial));
+        m_partial.clear();
+    }
+    return true;
+}
+
+void SolverLogTail::finish()
+{
+    while (poll())
+    {
+    }
+    if (!m_partial.isEmpty())
+    {
+        processLine(QString::fromUtf8(m_partial));
+        m_partial.clear();
+    }
+}
+
+QString SolverLogTail::errorMessage() const
+{
+    return cleanText(m_inBlock ? m_block : m_lastBlock);
+}
+
+void SolverLogTail::processLine(const QString& line)
+{
+    parseProgress(line);
+
+    // 逐行复现 "ERROR:(.*?)(终止符|$)" 的全局匹配：段落从 ERROR: 之后开始，
+    // 到下一个终止符为止；没有终止符时一直延续到文件末尾
+    int pos = 0;
+    for (;;)
+    {
+        if (!m_inBlock)
+        {
+            const int index = line.indexOf(QLatin1String("ERROR:"), pos);
+            if (index < 0)
+                break;
+            m_inBlock = true;
+            m_errorSeen = true;
+            m_block.clear();
+            pos = index + 6;
+        }
+        else
+        {
+            const int index = line.indexOf(m_terminator, pos);
+            if (index < 0)
+            {
+                appendToBlock(line.mid(pos));
+                appendToBlock(QStringLiteral("\n"));
+                break;
+            }
+            appendToBlock(line.mid(pos, index - pos));
+            m_lastBlock = m_block;
+            m_block.clear();
+            m_inBlock = false;
+            pos = index + m_terminator.size();
+        }
+    }
+}
+
+void SolverLogTail::appendToBlock(const QString& text)
+{
+    if (m_block.size() < kMaxBlockChars)
+        m_block.append(text.left(kMaxBlockChars - m_block.size()));
+}
+
+void SolverLogTail::parseProgress(const QString& line)
+{
+    if (line.contains(QLatin1String("WARNING:")))
+        ++m_progress.warningCount;
+
+    if (line.contains(QLatin1String("THE ANALYSIS HAS BEEN COMPLETED")) ||
+        line.contains(QLatin1String("ANALYSIS COMPLETE")))
+        m_progress.completed = true;
+
+    const bool mayHaveStep = line.contains(QLatin1String("STEP")) ||
+                             line.contains(QLatin1String("S T E P"));
+    const bool mayHaveIncrement = line.contains(QLatin1String("INCREMENT"));
+    if (!mayHaveStep && !mayHaveIncrement && !line.contains(QLatin1String("TIME")))
+        return;
+
+    static const QRegularExpression stepRe(QStringLiteral("(?:^|\\s)S ?T ?E ?P\\s+(\\d+)\\b(?!\\.)"));
+    static const QRegularExpression incrementRe(QStringLiteral("INCREMENT\\s+(\\d+)\\b(?!\\.)"));
+    static const QRegularExpression fractionRe(
+        QStringLiteral("FRACTION OF STEP COMPLETED\\s+") + kNumber);
+    static const QRegularExpression stepTimeRe(QStringLiteral("STEP TIME COMPLETED\\s+") + kNumber);
+    static const QRegularExpression totalTimeRe(QStringLiteral("TOTAL TIME COMPLETED\\s+") + kNumber);
+    static const QRegularExpression periodRe(QStringLiteral("TIME PERIOD\\s+") + kNumber);
+
+    if (mayHaveStep)
+    {
+        const QRegularExpressionMatch m = stepRe.match(line);
+        if (m.hasMatch())
+        {
+            const int step = m.captured(1).toInt();
+            if (step != m_progress.step)
+            {
+                m_progress.step = step;
+                m_progress.increment = 0;
+                m_progress.stepFraction = 0.0;
+            }
+        }
+    }
+    if (mayHaveIncrement)
+    {
+        const QRegularExpressionMatch m = incrementRe.match(line);
+        if (m.hasMatch())
+            m_progress.increment = qMax(m_progress.increment, m.captured(1).toInt());
+    }
+
+    QRegularExpressionMatch m = periodRe.match(line);
+    if (m.hasMatch())
+        m_stepPeriod = parseNumber(m.captured(1));
+
+    m = fractionRe.match(line);
+    if (m.hasMatch())
+    {
+        m_progress.stepFraction = qBound(0.0, parseNumber(m.captured(1)), 1.0);
+    }
+    else
+    {
+        m = stepTimeRe.match(line);
+        if (m.hasMatch() && m_stepPeriod > 0.0)
+            m_progress.stepFraction = qBound(0.0, parseNumber(m.captured(1)) / m_stepPeriod, 1.0);
+    }
+
+    m = totalTimeRe.match(line);
+    if (m.hasMatch())
+        m_progress.totalTime = parseNumber(m.captured(1));
+}
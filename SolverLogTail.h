@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+
+struct SolverProgress
+{
+    int step = 0;               // 当前分析步，0 表示尚未读到
+    int increment = 0;          // 当前增量步
+    double stepFraction = -1.0; // 当前分析步完成比例 [0,1]，-1 表示未知
+    double totalTime = -1.0;    // 累计总时间
+    int warningCount = 0;
+    bool completed = false;     // 已读到分析结束标记
+};
+
+// 跟随读取求解器写出的 .msg/.dat：每次只读取新增的字节并逐行解析，
+// 提取 ERROR 段落、警告数量与分析步/增量步进度。
+class SolverLogTail
+{
+public:
+    enum Kind {
+        MsgFile = 0,    // ERROR 段落以 ANALYSIS SUMMARY 结束
+        DatFile         // ERROR 段落以 NOTE 结束
+    };
+
+    SolverLogTail(const QString& path, Kind kind);
+
+    // 记录启动时已有文件的状态；内容未变化的旧文件不会被解析
+    void markBaseline();
+
+    // 读取新增内容，返回本次是否有新的解析结果
+    bool poll();
+    // 求解结束后调用：处理最后一行不完整的内容
+    void finish();
+
+    bool isActive() const { return m_active; }
+    const SolverProgress& progress() const { return m_progress; }
+    bool hasError() const { return m_errorSeen; }
+    // 与旧版按全文正则提取的结果一致：最后一个 ERROR 段落，空白已合并
+    QString errorMessage() const;
+
+private:
+    void processLine(const QString& line);
+    void appendToBlock(const QString& text);
+    void parseProgress(const QString& line);
+
+    QString m_path;
+    QString m_terminator;
+
+    qint64 m_baselineSize = -1;
+    QDateTime m_baselineModified;
+    bool m_active = false;
+    qint64 m_offset = 0;
+    QByteArray m_partial;       // 尚未遇到换行的半行
+
+    bool m_inBlock = false;
+    bool m_errorSeen = false;
+    QString m_block;            // 正在收集的 ERROR 段落
+    QString m_lastBlock;        // 最近一个已结束的 ERROR 段落
+    SolverProgress m_progress;
+    double m_stepPeriod = -1.0; // 当前分析步的时长，用于由分析步时间换算进度
+};
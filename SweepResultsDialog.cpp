@@ -0,0 +1,229 @@
+﻿#include "SweepResultsDialog.h"
+#include "ParameterSweep.h"
+#include "SolverJob.h"
+
+#include <QColor>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QSet>
+#include <QTableWidget>
+#include <QTextStream>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace
+{
+QString csvField(QString text)
+{
+    if (text.contains(QLatin1Char(',')) || text.contains(QLatin1Char('"')) ||
+        text.contains(QLatin1Char('\n')))
+    {
+        text.replace(QStringLiteral("\""), QStringLiteral("\"\""));
+        return QStringLiteral("\"%1\"").arg(text);
+    }
+    return text;
+}
+}
+
+SweepResultsDialog::SweepResultsDialog(const QString& title,
+                                       const QStringList& parameterNames,
+                                       QWidget* parent)
+    : QDialog(parent)
+    , m_parameterCount(parameterNames.size())
+{
+    setWindowTitle(tr("参数扫描结果 - %1").arg(title));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(900, 480);
+
+    auto* v = new QVBoxLayout(this);
+    v->setContentsMargins(12, 12, 12, 12);
+    v->setSpacing(8);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setStyleSheet("font-weight:600;");
+    v->addWidget(m_summaryLabel);
+
+    QStringList headers;
+    headers << tr("变体") << parameterNames
+            << tr("状态") << tr("退出码") << tr("耗时(秒)") << tr("错误信息") << tr("STL");
+    m_table = new QTableWidget(0, headers.size(), this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->setSortingEnabled(false);
+    v->addWidget(m_table, 1);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto* exportButton = buttons->addButton(tr("导出 CSV..."), QDialogButtonBox::ActionRole);
+    connect(exportButton, &QPushButton::clicked, this, &SweepResultsDialog::exportCsv);
+    auto* compareButton = buttons->addButton(tr("对比显示选中结果"), QDialogButtonBox::ActionRole);
+    compareButton->setEnabled(false);
+    connect(compareButton, &QPushButton::clicked, this, [this]() {
+        emit compareRequested(selectedModelIds());
+    });
+    connect(m_table, &QTableWidget::itemSelectionChanged, this, [this, compareButton]() {
+        compareButton->setEnabled(selectedModelIds().size() >= 2);
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &SweepResultsDialog::close);
+    v->addWidget(buttons);
+
+    updateSummary();
+}
+
+void SweepResultsDialog::addVariant(const QString& modelId,
+                                    const QString& name,
+                                    const QVector<QJsonValue>& values)
+{
+    const int row = m_table->rowCount();
+    m_table->insertRow(row);
+    m_rows.insert(modelId, row);
+
+    setCell(row, 0, name);
+    for (int i = 0; i < m_parameterCount && i < values.size(); ++i)
+        setCell(row, 1 + i, ParameterSweep::valueText(values[i]));
+    setCell(row, m_parameterCount + 1, tr("未提交"));
+    updateSummary();
+}
+
+bool SweepResultsDialog::containsModel(const QString& modelId) const
+{
+    return m_rows.contains(modelId);
+}
+
+QStringList SweepResultsDialog::selectedModelIds() const
+{
+    QSet<int> rows;
+    for (const QTableWidgetItem* item : m_table->selectedItems())
+        rows.insert(item->row());
+
+    QStringList ids;
+    for (auto it = m_rows.cbegin(); it != m_rows.cend(); ++it)
+    {
+        if (rows.contains(it.value()))
+            ids << it.key();
+    }
+    // 按表格中的顺序排列
+    std::sort(ids.begin(), ids.end(), [this](const QString& a, const QString& b) {
+        return m_rows.value(a) < m_rows.value(b);
+    });
+    return ids;
+}
+
+void SweepResultsDialog::markQueued(const QString& modelId)
+{
+    const int row = m_rows.value(modelId, -1);
+    if (row < 0)
+        return;
+    setCell(row, m_parameterCount + 1, tr("排队中"));
+    m_outcomes.remove(modelId);
+    updateSummary();
+}
+
+void SweepResultsDialog::markStarted(const QString& modelId)
+{
+    const int row = m_rows.value(modelId, -1);
+    if (row < 0)
+        return;
+    setCell(row, m_parameterCount + 1, tr("计算中"));
+    m_outcomes.remove(modelId);
+    updateSummary();
+}
+
+void SweepResultsDialog::markFinished(const QString& modelId, const SolverRunResult& result)
+{
+    const int row = m_rows.value(modelId, -1);
+    if (row < 0)
+        return;
+
+    const bool ok = !result.cancelled && result.exitCode == 0 && result.errorMessage.isEmpty();
+    const QString status = result.cancelled ? tr("已取消") : ok ? tr("成功") : tr("失败");
+    const int base = m_parameterCount + 1;
+    setCell(row, base, status);
+    setCell(row, base + 1, result.cancelled ? QString() : QString::number(result.exitCode));
+    if (result.startedAt.isValid() && result.finishedAt.isValid())
+    {
+        const double seconds = result.startedAt.msecsTo(result.finishedAt) / 1000.0;
+        setCell(row, base + 2, QString::number(seconds, 'f', 1));
+    }
+    setCell(row, base + 3, result.errorMessage);
+    setCell(row, base + 4, QDir::toNativeSeparators(result.stlPath));
+
+    const QColor color = result.cancelled ? QColor("#6b7280")
+                                          : ok ? QColor("#15803d") : QColor("#b91c1c");
+    if (QTableWidgetItem* item = m_table->item(row, base))
+        item->setForeground(color);
+
+    m_outcomes.insert(modelId, !ok && !result.cancelled);
+    updateSummary();
+}
+
+void SweepResultsDialog::exportCsv()
+{
+    const QString path = QFileDialog::getSaveFileName(this, tr("导出扫描结果"),
+                                                      QString(), tr("CSV 文件 (*.csv)"));
+    if (path.isEmpty())
+        return;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        QMessageBox::warning(this, tr("导出失败"),
+                             tr("无法写入文件：%1").arg(QDir::toNativeSeparators(path)));
+        return;
+    }
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out.setGenerateByteOrderMark(true);   // Excel 依赖 BOM 识别中文
+
+    QStringList header;
+    for (int c = 0; c < m_table->columnCount(); ++c)
+        header << csvField(m_table->horizontalHeaderItem(c)->text());
+    out << header.join(QLatin1Char(',')) << '\n';
+
+    for (int r = 0; r < m_table->rowCount(); ++r)
+    {
+        QStringList fields;
+        for (int c = 0; c < m_table->columnCount(); ++c)
+        {
+            const QTableWidgetItem* item = m_table->item(r, c);
+            fields << csvField(item ? item->text() : QString());
+        }
+        out << fields.join(QLatin1Char(',')) << '\n';
+    }
+    out.flush();
+
+    if (!file.commit())
+        QMessageBox::warning(this, tr("导出失败"),
+                             tr("无法写入文件：%1").arg(QDir::toNativeSeparators(path)));
+}
+
+void SweepResultsDialog::setCell(int row, int column, const QString& text)
+{
+    QTableWidgetItem* item = m_table->item(row, column);
+    if (!item)
+    {
+        item = new QTableWidgetItem();
+        m_table->setItem(row, column, item);
+    }
+    item->setText(text);
+    item->setToolTip(text);
+}
+
+void SweepResultsDialog::updateSummary()
+{
+    int failed = 0;
+    for (bool value : m_outcomes)
+        failed += value ? 1 : 0;
+    m_summaryLabel->setText(tr("共 %1 个变体，已完成 %2 个，失败 %3 个")
+                                .arg(m_rows.size()).arg(m_outcomes.size()).arg(failed));
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <QDialog>
+#include <QHash>
+#include <QJsonValue>
+#include <QVector>
+
+class QLabel;
+class QTableWidget;
+struct SolverRunResult;
+
+// 汇总一次参数扫描中所有变体的计算结果
+class SweepResultsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit SweepResultsDialog(const QString& title,
+                                const QStringList& parameterNames,
+                                QWidget* parent = nullptr);
+
+    void addVariant(const QString& modelId,
+                    const QString& name,
+                    const QVector<QJsonValue>& values);
+    bool containsModel(const QString& modelId) const;
+
+    void markQueued(const QString& modelId);
+    void markStarted(const QString& modelId);
+    void markFinished(const QString& modelId, const SolverRunResult& result);
+
+signals:
+    // 在三维视图中并排显示选中变体的最近结果
+    void compareRequested(const QStringList& modelIds);
+
+private slots:
+    void exportCsv();
+
+private:
+    void setCell(int row, int column, const QString& text);
+    QStringList selectedModelIds() const;
+    void updateSummary();
+
+    QTableWidget* m_table = nullptr;
+    QLabel* m_summaryLabel = nullptr;
+    int m_parameterCount = 0;
+    QHash<QString, int> m_rows;
+    QHash<QString, bool> m_outcomes;   // 已结束的变体 -> 是否失败；重算时覆盖
+};
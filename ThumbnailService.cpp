@@ -0,0 +1,480 @@
+﻿#include "ThumbnailService.h"
+#include "FastStlReader.h"
+#include "GeometryCache.h"
+#include "ResultReaderRegistry.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUuid>
+#include <QtConcurrent>
+
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+const QSize kThumbnailSize(320, 240);
+// 超采样倍数，缩小后得到平滑的边缘
+const int kSupersample = 2;
+// 缩略图只需要外形，面片多的结果抽样到这个数量
+const qint64 kMaxTriangles = 300000;
+// 两次渲染之间的最小间隔，避免连续占用磁盘与处理器
+const int kRenderIntervalMs = 1500;
+// 索引写入的合并间隔，批量渲染时不必每张缩略图都重写一次
+const int kIndexSaveDelayMs = 5000;
+// 内存中缩放后缩略图的总量上限（KB）
+const int kPixmapCacheKb = 32 * 1024;
+
+QString tr(const char* text)
+{
+    return QCoreApplication::translate("ThumbnailService", text);
+}
+
+struct Vec3
+{
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+
+Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 cross(const Vec3& a, const Vec3& b)
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+Vec3 normalized(const Vec3& v)
+{
+    const double length = std::sqrt(dot(v, v));
+    return length > 0.0 ? Vec3{ v.x / length, v.y / length, v.z / length } : v;
+}
+
+// 正交投影的等轴测视角，与三维视图相同以 Y 轴向上；背景透明，卡片与树节点各自的底色可以透出
+QImage rasterize(vtkPolyData* mesh, const QSize& size)
+{
+    vtkPoints* points = mesh->GetPoints();
+    vtkCellArray* polys = mesh->GetPolys();
+    if (!points || !polys || points->GetNumberOfPoints() == 0)
+        return QImage();
+
+    const int width = size.width() * kSupersample;
+    const int height = size.height() * kSupersample;
+
+    const Vec3 view = normalized({ -1.0, -1.0, -1.0 });
+    const Vec3 right = normalized(cross(view, { 0.0, 1.0, 0.0 }));
+    const Vec3 up = cross(right, view);
+
+    // 先把全部点投影到视平面，再按范围缩放到图像中
+    const vtkIdType pointCount = points->GetNumberOfPoints();
+    std::vector<Vec3> world(static_cast<size_t>(pointCount));
+    std::vector<Vec3> screen(static_cast<size_t>(pointCount));
+    double minX = std::numeric_limits<double>::max();
+    double maxX = -minX;
+    double minY = minX;
+    double maxY = -minX;
+    for (vtkIdType i = 0; i < pointCount; ++i)
+    {
+        double p[3];
+        points->GetPoint(i, p);
+        const Vec3 w{ p[0], p[1], p[2] };
+        world[size_t(i)] = w;
+        const Vec3 s{ dot(w, right), dot(w, up), dot(w, view) };
+        screen[size_t(i)] = s;
+        minX = std::min(minX, s.x);
+        maxX = std::max(maxX, s.x);
+        minY = std::min(minY, s.y);
+        maxY = std::max(maxY, s.y);
+    }
+    const double margin = 0.08;
+    const double spanX = std::max(maxX - minX, 1e-12);
+    const double spanY = std::max(maxY - minY, 1e-12);
+    const double scale = std::min(width * (1.0 - 2 * margin) / spanX, height * (1.0 - 2 * margin) / spanY);
+    const double midX = 0.5 * (minX + maxX);
+    const double midY = 0.5 * (minY + maxY);
+    for (Vec3& s : screen)
+    {
+        s.x = width * 0.5 + (s.x - midX) * scale;
+        s.y = height * 0.5 - (s.y - midY) * scale;
+    }
+
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    std::vector<float> depth(size_t(width) * size_t(height), std::numeric_limits<float>::max());
+
+    // 与三维视图中模型的颜色一致，头灯照明，正反面同样着色
+    const double baseColor[3] = { 0.2 * 255, 0.45 * 255, 0.75 * 255 };
+    vtkIdType npts = 0;
+    const vtkIdType* ids = nullptr;
+    const vtkIdType cellCount = polys->GetNumberOfCells();
+    for (vtkIdType cell = 0; cell < cellCount; ++cell)
+    {
+        polys->GetCellAtId(cell, npts, ids);
+        if (npts < 3)
+            continue;
+        const Vec3& wa = world[size_t(ids[0])];
+        const Vec3 normal = normalized(cross(world[size_t(ids[1])] - wa, world[size_t(ids[2])] - wa));
+        const double shade = 0.3 + 0.7 * std::fabs(dot(normal, view));
+        const QRgb color = qRgb(int(baseColor[0] * shade), int(baseColor[1] * shade), int(baseColor[2] * shade));
+
+        // 多边形按扇形拆成三角形
+        for (vtkIdType k = 1; k + 1 < npts; ++k)
+        {
+            const Vec3& a = screen[size_t(ids[0])];
+            const Vec3& b = screen[size_t(ids[k])];
+            const Vec3& c = screen[size_t(ids[k + 1])];
+            const double area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (std::fabs(area) < 1e-12)
+                continue;
+
+            const int x0 = std::max(0, int(std::floor(std::min({ a.x, b.x, c.x }))));
+            const int x1 = std::min(width - 1, int(std::ceil(std::max({ a.x, b.x, c.x }))));
+            const int y0 = std::max(0, int(std::floor(std::min({ a.y, b.y, c.y }))));
+            const int y1 = std::min(height - 1, int(std::ceil(std::max({ a.y, b.y, c.y }))));
+            for (int y = y0; y <= y1; ++y)
+            {
+                QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+                const double py = y + 0.5;
+                for (int x = x0; x <= x1; ++x)
+                {
+                    const double px = x + 0.5;
+                    const double w0 = ((b.x - px) * (c.y - py) - (b.y - py) * (c.x - px)) / area;
+                    const double w1 = ((c.x - px) * (a.y - py) - (c.y - py) * (a.x - px)) / area;
+                    const double w2 = 1.0 - w0 - w1;
+                    if (w0 < 0.0 || w1 < 0.0 || w2 < 0.0)
+                        continue;
+                    const float z = float(w0 * a.z + w1 * b.z + w2 * c.z);
+                    float& stored = depth[size_t(y) * size_t(width) + size_t(x)];
+                    if (z >= stored)
+                        continue;
+                    stored = z;
+                    line[x] = color;
+                }
+            }
+        }
+    }
+
+    return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+QString cacheKey(const QString& modelId, const QSize& size)
+{
+    return QStringLiteral("%1@%2x%3").arg(modelId).arg(size.width()).arg(size.height());
+}
+
+int pixmapCost(const QPixmap& pixmap)
+{
+    return qMax(1, pixmap.width() * pixmap.height() * 4 / 1024);
+}
+
+// 读取时直接解码到目标尺寸，不在内存中保留原图
+QImage readScaled(const QString& path, const QSize& size)
+{
+    QImageReader reader(path);
+    const QSize original = reader.size();
+    if (original.isValid())
+        reader.setScaledSize(original.scaled(size, Qt::KeepAspectRatio));
+    return reader.read();
+}
+}
+
+ThumbnailService::ThumbnailService(QObject* parent)
+    : QObject(parent)
+{
+    m_pool = new QThreadPool(this);
+    m_pool->setMaxThreadCount(1);
+    m_loadPool = new QThreadPool(this);
+    m_loadPool->setMaxThreadCount(2);
+    m_pixmaps.setMaxCost(kPixmapCacheKb);
+    m_rateTimer = new QTimer(this);
+    m_rateTimer->setSingleShot(true);
+    m_rateTimer->setInterval(kRenderIntervalMs);
+    connect(m_rateTimer, &QTimer::timeout, this, &ThumbnailService::startNext);
+    m_indexTimer = new QTimer(this);
+    m_indexTimer->setSingleShot(true);
+    m_indexTimer->setInterval(kIndexSaveDelayMs);
+    connect(m_indexTimer, &QTimer::timeout, this, &ThumbnailService::saveIndex);
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    // 未开始的任务直接丢弃；正在执行的读取任务会访问本对象，等它们结束后再释放
+    m_pool->clear();
+    m_pool->waitForDone();
+    m_loadPool->clear();
+    m_loadPool->waitForDone();
+    saveIndex();
+}
+
+void ThumbnailService::setRootPath(const QString& rootPath)
+{
+    if (rootPath == m_rootPath)
+        return;
+    saveIndex();
+    ++m_generation;
+    m_rootPath = rootPath;
+    m_queue.clear();
+    m_queuedPaths.clear();
+    // 排队中的读取不从线程池移除，否则它们的 QFutureWatcher 永远等不到结束；
+    // 任务开始时发现代数已变会直接返回
+    m_loading.clear();
+    m_pixmaps.clear();
+    m_index.clear();
+    loadIndex();
+}
+
+QString ThumbnailService::imagePath(const QString& modelId) const
+{
+    return QDir(m_rootPath).filePath(modelId + QStringLiteral(".png"));
+}
+
+QPixmap ThumbnailService::thumbnail(const QString& modelId, const QSize& size)
+{
+    if (m_rootPath.isEmpty() || size.isEmpty() || !m_index.contains(modelId))
+        return QPixmap();
+    if (const QPixmap* cached = m_pixmaps.object(cacheKey(modelId, size)))
+        return *cached;
+    if (!m_sizes.contains(size))
+        m_sizes.append(size);
+    loadScaled(modelId, size);
+    return QPixmap();
+}
+
+void ThumbnailService::loadScaled(const QString& modelId, const QSize& size)
+{
+    const QString key = cacheKey(modelId, size);
+    if (m_loading.contains(key))
+        return;
+    m_loading.insert(key);
+
+    const QString path = imagePath(modelId);
+    const quint64 generation = m_generation;
+    auto* watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, generation, modelId, key]() {
+        const QImage image = watcher->result();
+        watcher->deleteLater();
+        if (generation != m_generation)
+            return;
+        m_loading.remove(key);
+        // 读取失败也记下空图，避免每次刷新都重新读取；重新渲染后会被覆盖
+        auto* pixmap = new QPixmap(QPixmap::fromImage(image));
+        m_pixmaps.insert(key, pixmap, pixmapCost(*pixmap));
+        if (!image.isNull())
+            emit thumbnailReady(modelId);
+    });
+    watcher->setFuture(QtConcurrent::run(m_loadPool, [this, generation, path, size]() {
+        // 析构时等待线程池结束，任务执行期间本对象一直有效
+        return generation == m_generation ? readScaled(path, size) : QImage();
+    }));
+}
+
+void ThumbnailService::request(const QString& modelId, const QString& stlPath)
+{
+    if (m_rootPath.isEmpty() || modelId.isEmpty() || stlPath.isEmpty())
+        return;
+    const QFileInfo info(stlPath);
+    if (!info.exists())
+        return;
+
+    // 文件状态未变时连摘要也不必重算
+    const QString absolute = info.absoluteFilePath();
+    const auto it = m_index.constFind(modelId);
+    if (it != m_index.constEnd() && it->fileKey == GeometryCache::Key::forFile(absolute).id() &&
+        QFileInfo::exists(imagePath(modelId)))
+        return;
+
+    if (!m_queuedPaths.contains(modelId))
+        m_queue.append(modelId);
+    m_queuedPaths.insert(modelId, absolute);
+    scheduleNext();
+}
+
+void ThumbnailService::setPaused(bool paused)
+{
+    m_paused = paused;
+    if (m_paused)
+        m_rateTimer->stop();
+    else
+        scheduleNext();
+}
+
+void ThumbnailService::scheduleNext()
+{
+    if (m_running || m_paused || m_queue.isEmpty() || m_rateTimer->isActive())
+        return;
+    m_rateTimer->start();
+}
+
+void ThumbnailService::startNext()
+{
+    if (m_running || m_paused || m_queue.isEmpty())
+        return;
+
+    Job job;
+    job.modelId = m_queue.takeFirst();
+    job.stlPath = m_queuedPaths.take(job.modelId);
+    job.imagePath = imagePath(job.modelId);
+    job.previous = m_index.value(job.modelId);
+    QDir().mkpath(m_rootPath);
+
+    m_running = true;
+    const quint64 generation = m_generation;
+    auto* watcher = new QFutureWatcher<Outcome>(this);
+    connect(watcher, &QFutureWatcher<Outcome>::finished, this, [this, watcher, generation]() {
+        const Outcome outcome = watcher->result();
+        watcher->deleteLater();
+        m_running = false;
+        if (generation == m_generation && outcome.errorMessage.isEmpty())
+        {
+            m_index.insert(outcome.modelId, outcome.entry);
+            scheduleIndexSave();
+            if (outcome.rendered)
+            {
+                // 刚渲染的图已在内存中，直接缩放到用过的尺寸，不必再从磁盘读取
+                for (const QSize& size : qAsConst(m_sizes))
+                {
+                    auto* pixmap = new QPixmap(QPixmap::fromImage(
+                        outcome.image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+                    m_pixmaps.insert(cacheKey(outcome.modelId, size), pixmap, pixmapCost(*pixmap));
+                }
+                emit thumbnailReady(outcome.modelId);
+            }
+        }
+        scheduleNext();
+    });
+    watcher->setFuture(QtConcurrent::run(m_pool, [job]() { return runJob(job); }));
+}
+
+ThumbnailService::Outcome ThumbnailService::runJob(const Job& job)
+{
+    // 线程池只服务缩略图，降到空闲优先级后前台线程总是先被调度。
+    // Linux 上 LowestPriority 对普通调度策略的线程不起作用，IdlePriority 对应 SCHED_IDLE
+    QThread::currentThread()->setPriority(QThread::IdlePriority);
+
+    Outcome outcome;
+    outcome.modelId = job.modelId;
+    outcome.entry.fileKey = GeometryCache::Key::forFile(job.stlPath).id();
+
+    QFile file(job.stlPath);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file))
+    {
+        outcome.errorMessage = tr("无法读取结果文件：%1").arg(job.stlPath);
+        return outcome;
+    }
+    file.close();
+    outcome.entry.contentHash = QString::fromLatin1(hash.result().toHex());
+
+    // 求解器重写了相同的结果或从结果缓存恢复时，内容不变，沿用已有的缩略图
+    if (outcome.entry.contentHash == job.previous.contentHash && QFileInfo::exists(job.imagePath))
+        return outcome;
+
+    outcome.image = render(job.stlPath, kThumbnailSize, &outcome.errorMessage);
+    if (outcome.image.isNull())
+        return outcome;
+
+    const QString staging = job.imagePath + QStringLiteral(".%1.tmp")
+                                                .arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    if (!outcome.image.save(staging, "PNG"))
+    {
+        QFile::remove(staging);
+        outcome.errorMessage = tr("无法保存缩略图：%1").arg(job.imagePath);
+        return outcome;
+    }
+    QFile::remove(job.imagePath);
+    if (!QFile::rename(staging, job.imagePath))
+    {
+        QFile::remove(staging);
+        outcome.errorMessage = tr("无法保存缩略图：%1").arg(job.imagePath);
+        return outcome;
+    }
+    outcome.rendered = true;
+    return outcome;
+}
+
+QImage ThumbnailService::render(const QString& stlPath, const QSize& size, QString* error)
+{
+    // STL 只抽样读取一部分面片，在当前线程中顺序读取，不把工作分给其他正常优先级的线程；
+    // 其他格式整体读取第一个时间步
+    vtkSmartPointer<vtkPolyData> mesh;
+    if (QFileInfo(stlPath).suffix().compare(QLatin1String("stl"), Qt::CaseInsensitive) == 0)
+    {
+        mesh = FastStlReader::readPreview(stlPath, kMaxTriangles, error, nullptr, nullptr, false);
+    }
+    else if (const std::shared_ptr<ResultReader> reader = ResultReaderRegistry::instance().readerFor(stlPath))
+    {
+        mesh = reader->read(stlPath, 0, nullptr, nullptr, error);
+    }
+    else if (error)
+    {
+        *error = tr("不支持的结果文件格式：%1").arg(stlPath);
+    }
+    if (!mesh)
+        return QImage();
+    const QImage image = rasterize(mesh, size);
+    if (image.isNull() && error)
+        *error = tr("结果中没有可绘制的面片");
+    return image;
+}
+
+void ThumbnailService::loadIndex()
+{
+    if (m_rootPath.isEmpty())
+        return;
+    QFile file(QDir(m_rootPath).filePath(QStringLiteral("index.json")));
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it)
+    {
+        const QJsonObject obj = it.value().toObject();
+        IndexEntry entry;
+        entry.fileKey = obj.value(QStringLiteral("fileKey")).toString();
+        entry.contentHash = obj.value(QStringLiteral("contentHash")).toString();
+        if (!entry.contentHash.isEmpty())
+            m_index.insert(it.key(), entry);
+    }
+}
+
+void ThumbnailService::scheduleIndexSave()
+{
+    m_indexDirty = true;
+    if (!m_indexTimer->isActive())
+        m_indexTimer->start();
+}
+
+void ThumbnailService::saveIndex()
+{
+    m_indexTimer->stop();
+    if (!m_indexDirty || m_rootPath.isEmpty())
+        return;
+    m_indexDirty = false;
+    QJsonObject root;
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it)
+    {
+        QJsonObject obj;
+        obj.insert(QStringLiteral("fileKey"), it->fileKey);
+        obj.insert(QStringLiteral("contentHash"), it->contentHash);
+        root.insert(it.key(), obj);
+    }
+    QSaveFile file(QDir(m_rootPath).filePath(QStringLiteral("index.json")));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
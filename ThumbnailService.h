@@ -0,0 +1,98 @@
+﻿#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+class QThreadPool;
+class QTimer;
+
+// 在后台为模型的最新结果生成缩略图：<工程>/.flexcache/thumbnails/<模型ID>.png。
+// 渲染使用纯 CPU 的深度缓冲光栅化，不依赖显卡与 OpenGL 上下文；
+// 任务在单个低优先级线程中逐个执行，两次渲染之间留出间隔，前台加载几何时暂停。
+// 只有结果文件的内容摘要变化时才重新渲染
+class ThumbnailService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailService(QObject* parent = nullptr);
+    ~ThumbnailService() override;
+
+    // 切换工程时调用，丢弃尚未开始的请求；为空时停用
+    void setRootPath(const QString& rootPath);
+    QString rootPath() const { return m_rootPath; }
+
+    bool hasThumbnail(const QString& modelId) const { return m_index.contains(modelId); }
+    // 缩放到 size 以内的缩略图。内存中只保留有限数量的缩放结果，不在时返回空图并在后台读取，
+    // 读取完成后发出 thumbnailReady
+    QPixmap thumbnail(const QString& modelId, const QSize& size);
+
+    // 结果文件与上次渲染时不同才排队；同一模型的重复请求只保留最后一次
+    void request(const QString& modelId, const QString& stlPath);
+    void setPaused(bool paused);
+
+    // 同步渲染，供后台任务使用
+    static QImage render(const QString& stlPath, const QSize& size, QString* error = nullptr);
+
+signals:
+    void thumbnailReady(const QString& modelId);
+
+private:
+    struct IndexEntry
+    {
+        QString fileKey;        // 结果文件的路径、大小与修改时间，用于跳过未变化的文件
+        QString contentHash;    // 结果文件内容的 SHA-1
+    };
+
+    struct Job
+    {
+        QString modelId;
+        QString stlPath;
+        QString imagePath;
+        IndexEntry previous;
+    };
+
+    struct Outcome
+    {
+        QString modelId;
+        IndexEntry entry;
+        QImage image;
+        bool rendered = false;
+        QString errorMessage;
+    };
+
+    static Outcome runJob(const Job& job);
+    QString imagePath(const QString& modelId) const;
+    void loadScaled(const QString& modelId, const QSize& size);
+    void loadIndex();
+    // 索引在渲染间隙合并写入，切换工程与退出时立即写入
+    void scheduleIndexSave();
+    void saveIndex();
+    void scheduleNext();
+    void startNext();
+
+    QString m_rootPath;
+    QHash<QString, IndexEntry> m_index;         // 模型 ID -> 上次渲染时的结果文件
+    QCache<QString, QPixmap> m_pixmaps;         // "模型 ID@宽x高" -> 缩放后的缩略图，代价按 KB 计
+    QSet<QString> m_loading;                    // 正在后台读取的缩放结果
+    QVector<QSize> m_sizes;                     // 请求过的尺寸，重新渲染后按这些尺寸更新缓存
+    QStringList m_queue;                        // 等待渲染的模型 ID，先到先做
+    QHash<QString, QString> m_queuedPaths;      // 模型 ID -> 结果文件
+    std::atomic<quint64> m_generation{ 0 };     // 切换工程后旧任务不再读取，结果直接丢弃
+    bool m_running = false;
+    bool m_paused = false;
+    bool m_indexDirty = false;
+    QThreadPool* m_pool = nullptr;
+    QThreadPool* m_loadPool = nullptr;
+    QTimer* m_rateTimer = nullptr;
+    QTimer* m_indexTimer = nullptr;
+};
@@ -1,11 +1,28 @@
-﻿#include "JsonPageBuilder.h"
+﻿#include "HeadlessRunner.h"
+#include "JsonPageBuilder.h"
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 #include <QFont>
+#include <QTextStream>
 
 int main(int argc, char *argv[])
 {
+    if (HeadlessRunner::isHeadlessInvocation(argc, argv))
+    {
+        // 计算节点上没有显示服务：只创建 QCoreApplication，不构建窗口与 VTK 渲染窗口
+        QCoreApplication app(argc, argv);
+        HeadlessRunner runner;
+        QString error;
+        if (!runner.start(app.arguments(), &error))
+        {
+            QTextStream(stderr) << error << '\n';
+            return 2;
+        }
+        return app.exec();
+    }
+
     QApplication a(argc, argv);
 
     QFont appFont(QStringLiteral("Microsoft YaHei"));
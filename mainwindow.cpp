@@ -1,13 +1,38 @@
 ﻿#include "MainWindow.h"
 #include "ui_MainWindow.h"
 
+#include "FailedRunsDialog.h"
+#include "GeometryCache.h"
+#include "GeometryDiff.h"
+#include "GeometryDiffDialog.h"
+#include "GeometryDiskCache.h"
+#include "GeometryLoader.h"
+#include "GeometryLod.h"
+#include "JobQueue.h"
+#include "JobQueueDock.h"
 #include "JsonPageBuilder.h"
+#include "ModelFiles.h"
+#include "ParameterSweep.h"
+#include "ParameterSweepDialog.h"
+#include "ProjectCatalog.h"
+#include "ProjectValidator.h"
+#include "ResultCache.h"
+#include "ResultReaderRegistry.h"
+#include "RunHistoryDialog.h"
 #include "SchemeGalleryWidget.h"
 #include "SchemeSettingsDialog.h"
+#include "SchemeStorage.h"
 #include "SchemeTreeWidget.h"
+#include "SolverJob.h"
+#include "SweepResultsDialog.h"
+#include "ThumbnailService.h"
 
 #include <QAction>
 #include <QApplication>
+#include <QBrush>
+#include <QCloseEvent>
+#include <QComboBox>
+#include <QColor>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QDesktopServices>
@@ -17,16 +42,19 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFont>
+#include <QFutureWatcher>
 #include <QFrame>
 #include <QHeaderView>
 #include <QIcon>
 #include <QGridLayout>
+#include <QHBoxLayout>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLabel>
 #include <QListWidget>
 #include <QList>
+#include <QLocale>
 #include <QInputDialog>
 #include <QImageReader>
 #include <QLineEdit>
@@ -42,28 +70,96 @@
 #include <QScrollArea>
 #include <QSet>
 #include <QShortcut>
+#include <QSignalBlocker>
+#include <QSlider>
 #include <QSplitter>
 #include <QCryptographicHash>
+#include <QDockWidget>
 #include <QStandardPaths>
+#include <QStatusBar>
 #include <QStringList>
+#include <QStyle>
+#include <QTimer>
 #include <QTreeWidgetItem>
 #include <QUuid>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 #include <algorithm>
+#include <cmath>
 
 #include <QVTKOpenGLNativeWidget.h>
 #include <vtkActor.h>
 #include <vtkCamera.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
 #include <vtkGenericOpenGLRenderWindow.h>
+#include <vtkLookupTable.h>
+#include <vtkLODProp3D.h>
+#include <vtkMath.h>
 #include <vtkNamedColors.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
-#include <vtkSTLReader.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkScalarBarActor.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkWeakPointer.h>
 
 namespace
 {
+// 在模型页面中点击“计算”的任务优先于批量任务
+const int kInteractivePriority = 1;
+const int kBatchPriority = 0;
+// 中间结果刷新的最小间隔
+const int kLiveFrameIntervalMs = 300;
+// 加载超过该时间才显示加载提示
+const int kLoadingOverlayDelayMs = 150;
+// 对比显示的视口上限
+const int kMaxComparisonViews = 9;
+// 拖动时间步滑块时停顿这么久才开始读取
+const int kTimeStepDelayMs = 200;
+// 画廊卡片使用的模型缩略图尺寸
+const QSize kGalleryThumbnailSize(320, 240);
+
+// 缓存中的 mapper 会被对比视图等其他场景复用，离开主视图时恢复纯色
+void clearFieldColoring(const GeometryCache::Entry& entry)
+{
+    if (entry.mapper)
+        entry.mapper->ScalarVisibilityOff();
+    if (entry.lodMapper)
+        entry.lodMapper->ScalarVisibilityOff();
+}
+
+// 视口标签使用系统中的中文字体，VTK 自带字体不含中文字形
+void applyOverlayFont(vtkTextProperty* property)
+{
+    property->SetFontSize(14);
+    property->SetColor(0.06, 0.09, 0.16);
+    property->BoldOn();
+    static const char* const candidates[] = { "C:/Windows/Fonts/msyh.ttc", "C:/Windows/Fonts/simhei.ttf" };
+    for (const char* candidate : candidates)
+    {
+        if (QFile::exists(QString::fromLatin1(candidate)))
+        {
+            property->SetFontFamily(VTK_FONT_FILE);
+            property->SetFontFile(candidate);
+            break;
+        }
+    }
+}
+
+// 模型节点上显示的计算状态
+enum ModelRunState {
+    IdleState = 0,
+    QueuedState,
+    RunningState,
+    SuspendedState
+};
+
 QString canonicalPathForDir(const QDir& dir)
 {
     QString canonical = dir.canonicalPath();
@@ -144,14 +240,23 @@ QString uniqueChildPath(const QDir& parent, const QString& baseName)
     return candidatePath;
 }
 
-QString latestStlFile(const QString& directory)
+// 参数扫描在工作线程中生成的变体目录，samples 为对应的采样行号
+struct SweepVariants
 {
-    QDir dir(directory);
-    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.stl" << "*.STL",
-                                                  QDir::Files, QDir::Time | QDir::IgnoreCase);
-    if (!files.isEmpty())
-        return files.first().absoluteFilePath();
-    return QString();
+    QStringList directories;
+    QVector<int> samples;
+    QStringList errors;
+};
+
+// 对比视口共用一次读取的依据。结果缓存键相同的成功运行产生相同的结果，
+// 从缓存复制回来的也一样；运行后被改写过的文件或没有运行记录的按文件本身区分
+QString comparisonContentKey(const RunRecord& run, const QString& stlPath)
+{
+    const QFileInfo info(stlPath);
+    if (run.isValid() && run.succeeded() && !run.cacheKey.isEmpty() &&
+        info.lastModified() <= run.finishedAt)
+        return QStringLiteral("run|%1|%2").arg(run.cacheKey, info.fileName());
+    return GeometryCache::Key::forFile(stlPath).id();
 }
 }
 
@@ -167,8 +272,23 @@ MainWindow::MainWindow(QWidget *parent)
     if (!dataDir.exists())
         dataDir.mkpath(QStringLiteral("."));
     m_appStateFilePath = dataDir.filePath(QStringLiteral("app_state.json"));
+    m_persistence = new PersistenceWorker(this);
+    m_validator = new ProjectValidator(this);
+    connect(m_validator, &ProjectValidator::batchValidated, this, &MainWindow::applyValidationBatch);
+    connect(m_validator, &ProjectValidator::finished, this,
+            [this](int schemeCount, int modelCount, qint64 elapsedMs) {
+        QString summary = tr("路径检查完成：%1 个方案、%2 个模型，用时 %3 ms")
+                              .arg(schemeCount).arg(modelCount).arg(elapsedMs);
+        if (!m_missingPaths.isEmpty())
+            summary += tr("，%1 项目录或参数文件不存在").arg(m_missingPaths.size());
+        if (m_correctedPaths > 0)
+            summary += tr("，更正 %1 个路径").arg(m_correctedPaths);
+        appendLogMessage(summary);
+    });
 
     setupUiHelpers();
+    setupJobQueue();
+    setupCatalogActions();
     setupConnections();
     loadSchemeLibrary();
     loadInitialSchemes();
@@ -176,12 +296,33 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    saveSchemesToStorage();
+    persistSchemes();
     saveSchemeLibrary();
     saveApplicationState();
+    // 合并窗口内尚未写出的内容在这里写完，之后才释放界面
+    m_persistence->flush();
     delete ui;
 }
 
+void MainWindow::closeEvent(QCloseEvent* event)
+{
+    const int active = m_jobQueue ? m_jobQueue->activeCount() : 0;
+    if (active > 0)
+    {
+        const QString text = tr("仍有 %1 个计算正在运行或排队，退出将终止这些计算。确定要退出吗？")
+                                 .arg(active);
+        if (QMessageBox::question(this, tr("退出"), text,
+                                  QMessageBox::Yes | QMessageBox::No,
+                                  QMessageBox::No) != QMessageBox::Yes)
+        {
+            event->ignore();
+            return;
+        }
+        m_jobQueue->cancelAll();
+    }
+    QMainWindow::closeEvent(event);
+}
+
 void MainWindow::setupUiHelpers()
 {
     m_galleryWidget = new SchemeGalleryWidget(this);
@@ -209,6 +350,7 @@ void MainWindow::setupUiHelpers()
         ui->projectBadge->setToolTip(tr("请选择或创建工程"));
 
     ui->treeModels->header()->setStretchLastSection(true);
+    ui->treeModels->setSelectionMode(QAbstractItemView::ExtendedSelection);
     ui->treeModels->setContextMenuPolicy(Qt::CustomContextMenu);
     ui->treeModels->setEditTriggers(QAbstractItemView::EditKeyPressed |
                                     QAbstractItemView::SelectedClicked);
@@ -238,6 +380,140 @@ void MainWindow::setupUiHelpers()
     m_renderer->SetBackground(colors->GetColor3d("AliceBlue").GetData());
     m_renderWindow->AddRenderer(m_renderer);
     ui->vtkWidget->setRenderWindow(m_renderWindow);
+    applyLodSettings();
+
+    m_geometryLoader = new GeometryLoader(this);
+    connect(m_geometryLoader, &GeometryLoader::loaded, this,
+            [this](const QString& path, const GeometryCache::Key& key,
+                   vtkSmartPointer<vtkPolyData> polyData, qint64 elapsedMs) {
+        // 中间帧很快会被下一帧替换，不放入缓存
+        const GeometryCache::Key cacheKey = m_pendingCacheInsert ? key : GeometryCache::Key();
+        const GeometryCache::Entry entry = GeometryCache::instance().insert(cacheKey, polyData);
+        updateGeometryCacheStatus();
+        showGeometry(path, cacheKey, entry, elapsedMs);
+    });
+    connect(m_geometryLoader, &GeometryLoader::previewLoaded, this,
+            [this](const QString& path, vtkSmartPointer<vtkPolyData> polyData,
+                   qint64 sampled, qint64 total) {
+        // 预览不进缓存；只在第一份预览时按要求重置视角，之后的预览与完整网格沿用当前视角
+        const GeometryCache::Entry entry = GeometryCache::instance().insert(GeometryCache::Key(), polyData);
+        showGeometry(path, GeometryCache::Key(), entry, 0);
+        m_pendingCameraReset = false;
+        appendLogMessage(tr("%1 较大，先显示抽样预览（%2 / 约 %3 个三角面片）")
+                             .arg(QFileInfo(path).fileName())
+                             .arg(sampled)
+                             .arg(total));
+    });
+    connect(m_geometryLoader, &GeometryLoader::progressChanged, this,
+            [this](const QString& path, int percent) {
+        const QString name = QFileInfo(path).fileName();
+        m_loadingOverlay->setText(tr("正在加载 %1 ... %2%").arg(name).arg(percent));
+        m_loadingOverlay->adjustSize();
+        const int step = percent / 25 * 25;
+        if (step > m_loggedLoadProgress && step < 100)
+        {
+            m_loggedLoadProgress = step;
+            appendLogMessage(tr("正在加载 %1：%2%").arg(name).arg(step));
+        }
+    });
+    connect(m_geometryLoader, &GeometryLoader::timeStepsLoaded, this,
+            [this](const QString& path, const QVector<double>& timeSteps) {
+        m_resultTimeSteps.insert(path, timeSteps);
+    });
+    connect(m_geometryLoader, &GeometryLoader::failed, this,
+            [this](const QString&, const QString& message) { appendLogMessage(message); });
+    connect(m_geometryLoader, &GeometryLoader::busyChanged, this, &MainWindow::setGeometryLoading);
+
+    // 缩略图在后台逐个生成，前台加载几何时让出磁盘与处理器
+    m_thumbnails = new ThumbnailService(this);
+    connect(m_thumbnails, &ThumbnailService::thumbnailReady, this,
+            [this](const QString& modelId) { onThumbnailReady(modelId); });
+    connect(m_geometryLoader, &GeometryLoader::busyChanged, m_thumbnails, &ThumbnailService::setPaused);
+
+    // 加载提示浮在三维视图左上角，很快完成的加载不显示，避免闪烁
+    m_loadingOverlay = new QLabel(ui->vtkWidget);
+    m_loadingOverlay->setStyleSheet(
+        "QLabel{background:rgba(15,23,42,170);color:#f8fafc;border-radius:4px;padding:4px 10px;}");
+    m_loadingOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_loadingOverlay->move(12, 12);
+    m_loadingOverlay->hide();
+    m_loadingOverlayTimer = new QTimer(this);
+    m_loadingOverlayTimer->setSingleShot(true);
+    m_loadingOverlayTimer->setInterval(kLoadingOverlayDelayMs);
+    setupResultBar();
+    m_geometryCacheLabel = new QLabel(this);
+    m_geometryCacheLabel->setContentsMargins(6, 0, 6, 0);
+    statusBar()->addPermanentWidget(m_geometryCacheLabel);
+    updateGeometryCacheStatus();
+
+    connect(m_loadingOverlayTimer, &QTimer::timeout, this, [this]() {
+        m_loadingOverlay->setText(tr("正在加载 %1 ...")
+                                      .arg(QFileInfo(m_geometryLoader->currentFile()).fileName()));
+        m_loadingOverlay->adjustSize();
+        m_loadingOverlay->show();
+        m_loadingOverlay->raise();
+    });
+}
+
+void MainWindow::setupJobQueue()
+{
+    m_jobQueue = new JobQueue(this);
+    m_jobDock = new JobQueueDock(m_jobQueue, this);
+    addDockWidget(Qt::BottomDockWidgetArea, m_jobDock);
+    m_jobDock->hide();
+
+    if (ui->menuModel)
+    {
+        QAction* runSelected = ui->menuModel->addAction(tr("计算选中模型"));
+        connect(runSelected, &QAction::triggered, this, &MainWindow::enqueueSelectedModels);
+        ui->menuModel->addSeparator();
+        QAction* toggleDock = m_jobDock->toggleViewAction();
+        toggleDock->setText(tr("任务队列"));
+        ui->menuModel->addAction(toggleDock);
+    }
+
+    connect(m_jobQueue, &JobQueue::jobStarted, this,
+            [this](quint64, const QString& modelId, SolverJob* job) {
+        onSolverJobStarted(modelId, job);
+    });
+    connect(m_jobQueue, &JobQueue::jobFinished, this,
+            [this](quint64, const QString& modelId, SolverJob* job) {
+        onSolverJobFinished(modelId, job);
+    });
+    connect(m_jobQueue, &JobQueue::queueChanged, this, [this]() {
+        if (m_currentBuilder)
+            m_currentBuilder->setQueued(m_jobQueue->isModelQueued(m_currentBuilderModelId));
+        refreshModelRunStates();
+    });
+    connect(m_jobDock, &JobQueueDock::settingsChanged, this, [this]() {
+        saveApplicationState();
+    });
+}
+
+void MainWindow::resetResultCache()
+{
+    // 缓存按工程隔离；运行中的任务仍持有旧缓存的引用，直到结束
+    m_resultCache.reset();
+    if (m_resultCacheEnabled && !m_projectRoot.isEmpty())
+    {
+        const QString root = QDir(m_projectRoot).filePath(QStringLiteral(".flexcache/results"));
+        m_resultCache.reset(new ResultCache(root, qint64(m_resultCacheLimitMb) * 1024 * 1024));
+    }
+    if (m_jobQueue)
+        m_jobQueue->setResultCache(m_resultCache);
+
+    m_geometryDiskCache.reset();
+    if (m_geometryDiskCacheLimitMb > 0 && !m_projectRoot.isEmpty())
+    {
+        const QString root = QDir(m_projectRoot).filePath(QStringLiteral(".flexcache/geometry"));
+        m_geometryDiskCache.reset(new GeometryDiskCache(root, qint64(m_geometryDiskCacheLimitMb) * 1024 * 1024));
+    }
+    if (m_geometryLoader)
+        m_geometryLoader->setDiskCache(m_geometryDiskCache);
+    if (m_thumbnails)
+        m_thumbnails->setRootPath(m_projectRoot.isEmpty()
+                                      ? QString()
+                                      : QDir(m_projectRoot).filePath(QStringLiteral(".flexcache/thumbnails")));
 }
 
 void MainWindow::setupConnections()
@@ -430,14 +706,7 @@ void MainWindow::saveSchemeLibrary() const
 
     QJsonObject rootObj;
     rootObj.insert(QStringLiteral("schemes"), array);
-
-    QFile file(root.filePath(QStringLiteral("library.json")));
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-
-    QJsonDocument doc(rootObj);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    m_persistence->submitDocument(root.filePath(QStringLiteral("library.json")), QJsonDocument(rootObj));
 }
 
 void MainWindow::loadInitialSchemes()
@@ -460,6 +729,38 @@ void MainWindow::loadApplicationState()
         {
             const QJsonObject obj = doc.object();
             lastProject = obj.value(QStringLiteral("lastProject")).toString().trimmed();
+
+            const QJsonObject queue = obj.value(QStringLiteral("jobQueue")).toObject();
+            const QSignalBlocker blocker(m_jobDock);
+            if (queue.contains(QStringLiteral("maxCores")))
+                m_jobQueue->setMaxCores(queue.value(QStringLiteral("maxCores")).toInt());
+            m_jobQueue->setLicenseTokens(queue.value(QStringLiteral("licenseTokens")).toInt());
+            m_jobDock->setThreadsPerJob(qMax(1, queue.value(QStringLiteral("threadsPerJob")).toInt(1)));
+            QHash<QString, int> modelThreads;
+            const QJsonObject savedThreads = queue.value(QStringLiteral("modelThreads")).toObject();
+            for (auto it = savedThreads.constBegin(); it != savedThreads.constEnd(); ++it)
+            {
+                if (it.value().toInt() >= 1)
+                    modelThreads.insert(it.key(), it.value().toInt());
+            }
+            m_jobDock->setModelThreads(modelThreads);
+            m_jobQueue->setAutoPreempt(queue.value(QStringLiteral("autoPreempt")).toBool(true));
+
+            const QJsonObject cache = obj.value(QStringLiteral("resultCache")).toObject();
+            m_resultCacheEnabled = cache.value(QStringLiteral("enabled")).toBool(true);
+            m_resultCacheLimitMb = qMax(0, cache.value(QStringLiteral("maxMegabytes"))
+                                               .toInt(m_resultCacheLimitMb));
+
+            const QJsonObject geometry = obj.value(QStringLiteral("geometryCache")).toObject();
+            m_geometryCacheLimitMb = qMax(0, geometry.value(QStringLiteral("maxMegabytes"))
+                                                 .toInt(m_geometryCacheLimitMb));
+            m_geometryDiskCacheLimitMb = qMax(0, geometry.value(QStringLiteral("diskMegabytes"))
+                                                     .toInt(m_geometryDiskCacheLimitMb));
+            GeometryCache::instance().setMaxBytes(qint64(m_geometryCacheLimitMb) * 1024 * 1024);
+            updateGeometryCacheStatus();
+
+            m_lodSettings = LodSettings::fromJson(obj.value(QStringLiteral("lod")).toObject());
+            applyLodSettings();
         }
     }
 
@@ -474,31 +775,75 @@ void MainWindow::saveApplicationState() const
     if (m_appStateFilePath.isEmpty())
         return;
 
-    QFileInfo info(m_appStateFilePath);
-    QDir dir = info.dir();
-    if (!dir.exists())
-        dir.mkpath(QStringLiteral("."));
-
     QJsonObject root;
     root.insert(QStringLiteral("lastProject"), m_projectRoot);
+    if (m_jobQueue && m_jobDock)
+    {
+        QJsonObject queue;
+        queue.insert(QStringLiteral("maxCores"), m_jobQueue->maxCores());
+        queue.insert(QStringLiteral("licenseTokens"), m_jobQueue->licenseTokens());
+        queue.insert(QStringLiteral("threadsPerJob"), m_jobDock->threadsPerJob());
+        QJsonObject modelThreads;
+        const QHash<QString, int> threads = m_jobDock->modelThreads();
+        for (auto it = threads.constBegin(); it != threads.constEnd(); ++it)
+            modelThreads.insert(it.key(), it.value());
+        queue.insert(QStringLiteral("modelThreads"), modelThreads);
+        queue.insert(QStringLiteral("autoPreempt"), m_jobQueue->autoPreempt());
+        root.insert(QStringLiteral("jobQueue"), queue);
+    }
+    QJsonObject cache;
+    cache.insert(QStringLiteral("enabled"), m_resultCacheEnabled);
+    cache.insert(QStringLiteral("maxMegabytes"), m_resultCacheLimitMb);
+    root.insert(QStringLiteral("resultCache"), cache);
+    QJsonObject geometry;
+    geometry.insert(QStringLiteral("maxMegabytes"), m_geometryCacheLimitMb);
+    geometry.insert(QStringLiteral("diskMegabytes"), m_geometryDiskCacheLimitMb);
+    root.insert(QStringLiteral("geometryCache"), geometry);
+    root.insert(QStringLiteral("lod"), m_lodSettings.toJson());
+    m_persistence->submitDocument(m_appStateFilePath, QJsonDocument(root));
+}
 
-    QFile file(m_appStateFilePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+void MainWindow::setupCatalogActions()
+{
+    if (!ui->menuProject)
         return;
 
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    ui->menuProject->addSeparator();
+    m_migrateCatalogAction = ui->menuProject->addAction(tr("迁移到 SQLite 目录"));
+    m_migrateCatalogAction->setToolTip(tr("模型很多的工程改用 catalog.sqlite 保存方案、模型与运行记录"));
+    connect(m_migrateCatalogAction, &QAction::triggered, this, &MainWindow::migrateProjectToCatalog);
+    m_exportJsonAction = ui->menuProject->addAction(tr("导出为 JSON..."));
+    connect(m_exportJsonAction, &QAction::triggered, this, &MainWindow::exportSchemesToJson);
+    m_failedRunsAction = ui->menuProject->addAction(tr("最近失败的运行..."));
+    connect(m_failedRunsAction, &QAction::triggered, this, &MainWindow::showFailedRuns);
+
+    connect(ui->menuProject, &QMenu::aboutToShow, this, [this]() {
+        const bool open = !m_projectRoot.isEmpty();
+        const bool catalog = open && m_persistence->isCatalogMode();
+        m_migrateCatalogAction->setEnabled(open && !catalog && ProjectCatalog::isAvailable());
+        m_exportJsonAction->setEnabled(open);
+        m_failedRunsAction->setEnabled(catalog);
+    });
 }
 
 void MainWindow::enterProjectlessState()
 {
+    if (!m_projectRoot.isEmpty())
+        logPersistenceStats();
     m_projectRoot.clear();
     m_workspaceRoot.clear();
     m_storageFilePath.clear();
+    resetResultCache();
+    m_latestRuns.clear();
+    m_loadingRuns.clear();
     m_activeSchemeId.clear();
     m_activeModelId.clear();
-    m_schemes.clear();
+    m_registry.clear();
+    m_persistence->closeSchemes();
+    m_validator->cancel();
+    m_unvalidatedSchemes.clear();
+    m_unvalidatedModels.clear();
+    m_missingPaths.clear();
     m_schemeItems.clear();
     m_modelItems.clear();
     m_projectRootItem = nullptr;
@@ -528,6 +873,7 @@ bool MainWindow::openProjectAt(const QString& path, bool silent)
     const QString trimmed = path.trimmed();
     if (trimmed.isEmpty())
         return false;
+    m_openTimer.start();
 
     if (!ensureProjectStructure(trimmed))
     {
@@ -558,6 +904,8 @@ bool MainWindow::openProjectAt(const QString& path, bool silent)
         return true;
     }
 
+    if (!m_projectRoot.isEmpty())
+        logPersistenceStats();
     m_projectRoot = canonicalProject;
 
     QDir canonicalDir(m_projectRoot);
@@ -568,12 +916,31 @@ bool MainWindow::openProjectAt(const QString& path, bool silent)
         m_workspaceRoot = QDir::cleanPath(workspacePath);
 
     m_storageFilePath = canonicalDir.filePath(QStringLiteral("schemes.json"));
+    resetResultCache();
+    m_latestRuns.clear();
+    m_loadingRuns.clear();
 
-    m_schemes.clear();
+    m_registry.clear();
     if (!loadSchemesFromStorage())
     {
-        m_schemes.clear();
-        persistSchemes();
+        m_registry.clear();
+        m_persistence->resetSchemes(m_storageFilePath, m_projectRoot, m_workspaceRoot,
+                                    QVector<SchemeRecord>(), 0);
+        saveSchemesToStorage();
+    }
+    m_reportedPersistence = m_persistence->stats();
+
+    // 树先按记录中的路径显示，目录检查、运行状态与缩略图由后台分批补上
+    m_validator->cancel();
+    m_unvalidatedSchemes.clear();
+    m_unvalidatedModels.clear();
+    m_missingPaths.clear();
+    m_correctedPaths = 0;
+    for (const SchemeRecord& scheme : m_registry.schemes())
+    {
+        m_unvalidatedSchemes.insert(scheme.id);
+        for (const ModelRecord& model : scheme.models)
+            m_unvalidatedModels.insert(model.id);
     }
 
     refreshNavigation();
@@ -581,6 +948,11 @@ bool MainWindow::openProjectAt(const QString& path, bool silent)
         ui->stackedWidget->setCurrentWidget(ui->planPage);
     updateToolbarState();
     updateWindowTitle();
+    m_validator->start(m_registry.schemes());
+    // 事件循环下一次空闲时界面已绘制完成，可以响应操作
+    QTimer::singleShot(0, this, [this, modelCount = m_registry.modelCount()]() {
+        appendLogMessage(tr("工程可操作：用时 %1 ms（%2 个模型）").arg(m_openTimer.elapsed()).arg(modelCount));
+    });
 
     if (!silent)
         appendLogMessage(tr("已打开工程：%1")
@@ -1001,6 +1373,9 @@ void MainWindow::onTreeContextMenuRequested(const QPoint& pos)
             menu.addAction(tr("添加模型"), this, [this, schemeId]() {
                 promptAddModel(schemeId);
             });
+            menu.addAction(tr("计算全部模型"), this, [this, schemeId]() {
+                enqueueScheme(schemeId);
+            });
             menu.addAction(tr("打开方案目录"), this, [this, schemeId]() {
                 if (SchemeRecord* scheme = schemeById(schemeId))
                     QDesktopServices::openUrl(QUrl::fromLocalFile(scheme->workingDirectory));
@@ -1017,6 +1392,55 @@ void MainWindow::onTreeContextMenuRequested(const QPoint& pos)
         else if (type == ModelItem)
         {
             const QString modelId = item->data(0, IdRole).toString();
+            const QStringList selected = selectedModelIds();
+            if (selected.size() > 1 && selected.contains(modelId))
+            {
+                menu.addAction(tr("计算选中的 %1 个模型").arg(selected.size()), this,
+                               [this, selected]() { enqueueModels(selected, kBatchPriority); });
+            }
+            else
+            {
+                menu.addAction(tr("加入计算队列"), this, [this, modelId]() {
+                    enqueueModels(QStringList() << modelId, kBatchPriority);
+                });
+            }
+            if (selected.size() >= 2 && selected.contains(modelId))
+            {
+                menu.addAction(tr("对比显示选中的 %1 个结果").arg(selected.size()), this,
+                               [this, selected]() { showComparison(selected); });
+            }
+            if (selected.size() == 2 && selected.contains(modelId))
+            {
+                menu.addAction(tr("计算形状差异（以第一个为基准）"), this,
+                               [this, selected]() { compareGeometry(selected.at(0), selected.at(1)); });
+            }
+            menu.addAction(tr("紧急计算（暂停低优先级任务）"), this, [this, modelId, selected]() {
+                const QStringList ids = selected.contains(modelId) ? selected
+                                                                   : QStringList() << modelId;
+                enqueueModels(ids, kInteractivePriority, /*useCache*/true, /*urgent*/true);
+            });
+            if (m_jobQueue->runningJobForModel(modelId))
+            {
+                if (m_jobQueue->isModelSuspended(modelId))
+                    menu.addAction(tr("继续计算"), this, [this, modelId]() {
+                        m_jobQueue->resumeModel(modelId);
+                    });
+                else
+                    menu.addAction(tr("暂停计算"), this, [this, modelId]() {
+                        m_jobQueue->suspendModel(modelId);
+                    });
+            }
+            menu.addAction(tr("重新计算（忽略缓存）"), this, [this, modelId, selected]() {
+                const QStringList ids = selected.contains(modelId) ? selected
+                                                                   : QStringList() << modelId;
+                enqueueModels(ids, kBatchPriority, /*useCache*/false);
+            });
+            menu.addAction(tr("参数扫描..."), this, [this, modelId]() {
+                runParameterSweep(modelId);
+            });
+            menu.addAction(tr("运行历史..."), this, [this, modelId]() {
+                showRunHistory(modelId);
+            });
             menu.addAction(tr("打开模型目录"), this, [this, modelId]() {
                 SchemeRecord* owner = nullptr;
                 if (ModelRecord* model = modelById(modelId, &owner))
@@ -1259,7 +1683,6 @@ void MainWindow::rebuildTree()
 
     const QIcon libraryIcon(QStringLiteral(":/icons/icons/gallery.svg"));
     const QIcon schemeIcon(QStringLiteral(":/icons/icons/plan.svg"));
-    const QIcon modelIcon(QStringLiteral(":/icons/icons/model.svg"));
 
     m_libraryRootItem = new QTreeWidgetItem(ui->treeModels);
     m_libraryRootItem->setText(0, tr("方案库"));
@@ -1279,7 +1702,7 @@ void MainWindow::rebuildTree()
         schemeParent = m_projectRootItem;
     }
 
-    for (const SchemeRecord& scheme : m_schemes)
+    for (const SchemeRecord& scheme : m_registry.schemes())
     {
         QTreeWidgetItem* parentItem = schemeParent;
         if (!parentItem)
@@ -1293,6 +1716,7 @@ void MainWindow::rebuildTree()
                              Qt::ItemIsDragEnabled | Qt::ItemIsEditable |
                              Qt::ItemIsDropEnabled);
         m_schemeItems.insert(scheme.id, schemeItem);
+        updateSchemeItemStatus(scheme);
 
         ui->treeModels->expandItem(schemeItem);
 
@@ -1300,13 +1724,14 @@ void MainWindow::rebuildTree()
         {
             auto* modelItem = new QTreeWidgetItem(schemeItem);
             modelItem->setText(0, model.name);
-            modelItem->setIcon(0, modelIcon);
+            modelItem->setIcon(0, modelIdleIcon(model.id));
             modelItem->setData(0, TypeRole, ModelItem);
             modelItem->setData(0, IdRole, model.id);
             modelItem->setData(0, SchemeRole, scheme.id);
             modelItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled |
                                 Qt::ItemIsDragEnabled | Qt::ItemIsEditable);
             m_modelItems.insert(model.id, modelItem);
+            updateModelItemStatus(model);
         }
     }
 
@@ -1318,9 +1743,160 @@ void MainWindow::rebuildTree()
     {
         ui->treeModels->expandAll();
     }
+    refreshModelRunStates();
     m_blockTreeSignals = false;
 }
 
+void MainWindow::refreshModelRunStates()
+{
+    if (!m_jobQueue)
+        return;
+
+    QHash<QString, int> states;
+    const QVector<JobQueue::Entry> entries = m_jobQueue->entries();
+    for (const JobQueue::Entry& entry : entries)
+    {
+        if (entry.status == JobQueue::Running)
+            states.insert(entry.request.modelId, entry.suspended ? SuspendedState : RunningState);
+        else if (entry.status == JobQueue::Queued && !states.contains(entry.request.modelId))
+            states.insert(entry.request.modelId, QueuedState);
+    }
+
+    QScopedValueRollback<bool> guard(m_blockTreeSignals, true);
+    for (auto it = m_modelItems.constBegin(); it != m_modelItems.constEnd(); ++it)
+    {
+        QTreeWidgetItem* item = it.value();
+        const int state = states.value(it.key(), IdleState);
+        if (item->data(0, RunStateRole).toInt() == state)
+            continue;
+        item->setData(0, RunStateRole, state);
+        switch (state)
+        {
+        case QueuedState:
+            item->setIcon(0, style()->standardIcon(QStyle::SP_BrowserReload));
+            break;
+        case RunningState:
+            item->setIcon(0, style()->standardIcon(QStyle::SP_MediaPlay));
+            break;
+        case SuspendedState:
+            item->setIcon(0, style()->standardIcon(QStyle::SP_MediaPause));
+            break;
+        default:
+            item->setIcon(0, modelIdleIcon(it.key()));
+            break;
+        }
+    }
+}
+
+QIcon MainWindow::modelIdleIcon(const QString& modelId)
+{
+    // 尚未检查到的模型不读取缩略图文件，检查完成后再替换
+    if (m_unvalidatedModels.contains(modelId))
+        return QIcon(QStringLiteral(":/icons/icons/model.svg"));
+    // 只取树节点图标大小的缩略图；尚未读入内存时先用默认图标，读取完成后由 onThumbnailReady 替换
+    const int extent = int(std::ceil(style()->pixelMetric(QStyle::PM_SmallIconSize) * devicePixelRatioF()));
+    const QPixmap thumb = m_thumbnails ? m_thumbnails->thumbnail(modelId, QSize(extent, extent)) : QPixmap();
+    if (thumb.isNull())
+        return QIcon(QStringLiteral(":/icons/icons/model.svg"));
+    return QIcon(thumb);
+}
+
+QPixmap MainWindow::schemeModelThumbnail(const SchemeRecord& scheme)
+{
+    // 只取第一个有缩略图的模型，不为其余模型读取
+    if (!m_thumbnails)
+        return QPixmap();
+    for (const ModelRecord& model : scheme.models)
+    {
+        if (m_thumbnails->hasThumbnail(model.id))
+            return m_thumbnails->thumbnail(model.id, kGalleryThumbnailSize);
+    }
+    return QPixmap();
+}
+
+void MainWindow::applyValidationBatch(const ProjectValidator::Batch& batch)
+{
+    bool changed = false;
+    QHash<QString, QString> movedSchemes;
+    for (const ProjectValidator::SchemeState& state : batch.schemes)
+    {
+        m_unvalidatedSchemes.remove(state.schemeId);
+        const SchemeRecord* scheme = schemeById(state.schemeId);
+        if (!scheme)
+            continue;
+        if (state.canonicalDirectory.isEmpty())
+            m_missingPaths.insert(scheme->id);
+        else if (state.canonicalDirectory != scheme->workingDirectory)
+            movedSchemes.insert(scheme->id, state.canonicalDirectory);
+        updateSchemeItemStatus(*scheme);
+    }
+    if (!movedSchemes.isEmpty())
+    {
+        // 工作目录参与索引，整体重建一次
+        QVector<SchemeRecord> schemes = m_registry.schemes();
+        for (SchemeRecord& scheme : schemes)
+        {
+            const auto it = movedSchemes.constFind(scheme.id);
+            if (it != movedSchemes.constEnd())
+                scheme.workingDirectory = it.value();
+        }
+        m_registry.reset(schemes);
+        m_correctedPaths += movedSchemes.size();
+        changed = true;
+    }
+
+    for (const ProjectValidator::ModelState& state : batch.models)
+    {
+        m_unvalidatedModels.remove(state.modelId);
+        ModelRecord* model = modelById(state.modelId);
+        if (!model)
+            continue;
+        if (state.canonicalDirectory.isEmpty() || !state.jsonExists)
+            m_missingPaths.insert(model->id);
+        if (!state.canonicalDirectory.isEmpty() && state.canonicalDirectory != model->directory)
+        {
+            model->directory = state.canonicalDirectory;
+            ++m_correctedPaths;
+            changed = true;
+        }
+        // 检查期间结束的任务已写入更新的记录
+        if (!m_latestRuns.contains(model->id))
+            m_latestRuns.insert(model->id, state.latestRun);
+        updateModelItemStatus(*model);
+
+        QTreeWidgetItem* item = m_modelItems.value(model->id, nullptr);
+        if (item && item->data(0, RunStateRole).toInt() == IdleState)
+        {
+            QScopedValueRollback<bool> guard(m_blockTreeSignals, true);
+            item->setIcon(0, modelIdleIcon(model->id));
+        }
+        if (m_thumbnails && !state.resultFile.isEmpty())
+            m_thumbnails->request(model->id, state.resultFile);
+    }
+    if (changed)
+        persistSchemes();
+}
+
+void MainWindow::onThumbnailReady(const QString& modelId)
+{
+    QTreeWidgetItem* item = m_modelItems.value(modelId, nullptr);
+    if (item && item->data(0, RunStateRole).toInt() == IdleState)
+    {
+        QScopedValueRollback<bool> guard(m_blockTreeSignals, true);
+        item->setIcon(0, modelIdleIcon(modelId));
+    }
+
+    // 没有封面的方案用第一个有缩略图的模型作为卡片图片，只替换这一张卡片
+    const QString schemeId = item ? item->data(0, SchemeRole).toString() : QString();
+    const SchemeRecord* scheme = schemeById(schemeId);
+    if (m_galleryWidget && scheme && scheme->thumbnailPath.isEmpty())
+    {
+        const QPixmap thumb = schemeModelThumbnail(*scheme);
+        if (!thumb.isNull())
+            m_galleryWidget->setSchemeThumbnail(scheme->id, thumb);
+    }
+}
+
 void MainWindow::updateGallery()
 {
     if (!m_galleryWidget)
@@ -1353,9 +1929,11 @@ void MainWindow::updateGallery()
         m_galleryWidget->addScheme(entry.id, entry.name, thumb, options);
     }
 
-    for (const SchemeRecord& scheme : m_schemes)
+    for (const SchemeRecord& scheme : m_registry.schemes())
     {
         QPixmap thumb = loadSchemeThumbnail(scheme);
+        if (thumb.isNull())
+            thumb = schemeModelThumbnail(scheme);
         if (thumb.isNull())
             thumb = makeSchemePlaceholder(scheme.name);
 
@@ -1440,12 +2018,12 @@ void MainWindow::showModelSettings(const QString& modelId)
     setVisualizationVisible(true);
     updateSelectionInfo(model->directory, model->remarks);
 
-    const QString stl = latestStlFile(model->directory);
-    if (!stl.isEmpty())
+    const QString stl = latestResultStl(*model);
+    if (!stl.isEmpty() && QFileInfo::exists(stl))
     {
         appendLogMessage(tr("加载最近的 STL：%1")
                              .arg(QDir::toNativeSeparators(stl)));
-        displayStlFile(stl);
+        displayResultFile(stl);
     }
     else
     {
@@ -1613,16 +2191,38 @@ QWidget* MainWindow::buildModelSettingsWidget(const ModelRecord& model)
 
     connect(builder, &JsonPageBuilder::logMessage,
             this, &MainWindow::appendLogMessage);
-    connect(builder, &JsonPageBuilder::calculationFinished,
-            this, [this](const QString& stlPath) {
-        if (stlPath.isEmpty())
-        {
-            appendLogMessage(tr("未检测到新的 STL 输出文件"));
-            return;
-        }
-        appendLogMessage(tr("加载 STL：%1").arg(QDir::toNativeSeparators(stlPath)));
-        displayStlFile(stlPath);
+    connect(builder, &JsonPageBuilder::calculationRequested,
+            this, [this, id = model.id]() {
+        startModelCalculation(id);
     });
+    connect(builder, &JsonPageBuilder::cancelRequested,
+            this, [this, id = model.id]() {
+        m_jobQueue->cancelModel(id);
+        appendLogMessage(tr("已取消排队中的计算"));
+    });
+    connect(builder, &JsonPageBuilder::pauseRequested,
+            this, [this, id = model.id]() {
+        if (m_jobQueue->suspendModel(id))
+            appendLogMessage(tr("已暂停计算，核数已让给其他任务"));
+        else
+            appendLogMessage(tr("无法暂停：求解进程尚未启动或已经结束"));
+    });
+    connect(builder, &JsonPageBuilder::resumeRequested,
+            this, [this, id = model.id]() {
+        if (m_jobQueue->resumeModel(id))
+            appendLogMessage(tr("已继续计算"));
+    });
+    connect(builder, &JsonPageBuilder::sweepRequested,
+            this, [this, id = model.id]() {
+        runParameterSweep(id);
+    });
+    m_currentBuilder = builder;
+    m_currentBuilderModelId = model.id;
+    builder->setLastRunUsage(latestRun(model).usage);
+    if (SolverJob* job = m_jobQueue->runningJobForModel(model.id))
+        builder->attachJob(job);
+    else if (m_jobQueue->isModelQueued(model.id))
+        builder->setQueued(true);
 
     auto* openBtn = new QPushButton(tr("打开模型目录"), container);
     openBtn->setCursor(Qt::PointingHandCursor);
@@ -1635,7 +2235,19 @@ QWidget* MainWindow::buildModelSettingsWidget(const ModelRecord& model)
     connect(openBtn, &QPushButton::clicked, this, [path = model.directory]() {
         QDesktopServices::openUrl(QUrl::fromLocalFile(path));
     });
-    layout->addWidget(openBtn, 0, Qt::AlignLeft);
+
+    auto* historyBtn = new QPushButton(tr("运行历史"), container);
+    historyBtn->setCursor(Qt::PointingHandCursor);
+    historyBtn->setStyleSheet(openBtn->styleSheet());
+    connect(historyBtn, &QPushButton::clicked, this, [this, id = model.id]() {
+        showRunHistory(id);
+    });
+
+    auto* buttonRow = new QHBoxLayout();
+    buttonRow->addWidget(openBtn);
+    buttonRow->addWidget(historyBtn);
+    buttonRow->addStretch(1);
+    layout->addLayout(buttonRow);
 
     return container;
 }
@@ -1652,70 +2264,38 @@ void MainWindow::refreshCurrentDetail()
 
 MainWindow::SchemeRecord* MainWindow::schemeById(const QString& id)
 {
-    for (SchemeRecord& scheme : m_schemes)
-    {
-        if (scheme.id == id)
-            return &scheme;
-    }
-    return nullptr;
+    return m_registry.scheme(id);
 }
 
 const MainWindow::SchemeRecord* MainWindow::schemeById(const QString& id) const
 {
-    for (const SchemeRecord& scheme : m_schemes)
-    {
-        if (scheme.id == id)
-            return &scheme;
-    }
-    return nullptr;
+    return m_registry.scheme(id);
 }
 
 MainWindow::SchemeRecord* MainWindow::schemeByWorkingDirectory(const QString& canonicalPath)
 {
-    for (SchemeRecord& scheme : m_schemes)
+    if (SchemeRecord* scheme = m_registry.schemeByWorkingDirectory(canonicalPath))
+        return scheme;
+
+    // 后台检查完成前，记录中的工作目录可能还不是规范化路径（符号链接、大小写等），
+    // 索引查不到时逐个规范化这些方案的目录再比较，避免重复添加同一目录
+    for (const QString& id : qAsConst(m_unvalidatedSchemes))
     {
-        if (canonicalPathForDir(QDir(scheme.workingDirectory)) == canonicalPath)
-            return &scheme;
+        SchemeRecord* scheme = schemeById(id);
+        if (scheme && canonicalPathForDir(QDir(scheme->workingDirectory)) == canonicalPath)
+            return scheme;
     }
     return nullptr;
 }
 
 MainWindow::ModelRecord* MainWindow::modelById(const QString& id, SchemeRecord** owner)
 {
-    for (SchemeRecord& scheme : m_schemes)
-    {
-        for (ModelRecord& model : scheme.models)
-        {
-            if (model.id == id)
-            {
-                if (owner)
-                    *owner = &scheme;
-                return &model;
-            }
-        }
-    }
-    if (owner)
-        *owner = nullptr;
-    return nullptr;
+    return m_registry.model(id, owner);
 }
 
 const MainWindow::ModelRecord* MainWindow::modelById(const QString& id, const SchemeRecord** owner) const
 {
-    for (const SchemeRecord& scheme : m_schemes)
-    {
-        for (const ModelRecord& model : scheme.models)
-        {
-            if (model.id == id)
-            {
-                if (owner)
-                    *owner = &scheme;
-                return &model;
-            }
-        }
-    }
-    if (owner)
-        *owner = nullptr;
-    return nullptr;
+    return m_registry.model(id, owner);
 }
 
 QString MainWindow::createScheme(const QString& name, const QString& workingDir)
@@ -1735,7 +2315,7 @@ QString MainWindow::createScheme(const QString& name, const QString& workingDir)
     scheme.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
     scheme.name = makeUniqueSchemeName(trimmedName, scheme.id);
     scheme.workingDirectory = canonical;
-    m_schemes.push_back(scheme);
+    m_registry.addScheme(scheme);
     return scheme.id;
 }
 
@@ -1755,7 +2335,7 @@ QString MainWindow::importSchemeFromDirectory(const QString& dirPath, bool showE
     if (SchemeRecord* existing = schemeByWorkingDirectory(canonical))
     {
         existing->name = makeUniqueSchemeName(dir.dirName(), existing->id);
-        existing->models = scanSchemeFolder(canonical);
+        m_registry.setModels(existing->id, scanSchemeFolder(canonical));
         ensureUniqueModelNames(*existing);
         persistSchemes();
         refreshNavigation(existing->id);
@@ -1773,7 +2353,7 @@ QString MainWindow::importSchemeFromDirectory(const QString& dirPath, bool showE
     if (!covers.isEmpty())
         scheme.thumbnailPath = QDir::cleanPath(dir.filePath(covers.first()));
 
-    m_schemes.push_back(scheme);
+    m_registry.addScheme(scheme);
     persistSchemes();
     refreshNavigation(scheme.id);
     return scheme.id;
@@ -1838,7 +2418,7 @@ QVector<QString> MainWindow::importModelsIntoScheme(const QString& schemeId,
             if (existingPaths.contains(model.directory))
                 continue;
 
-            scheme->models.push_back(model);
+            m_registry.addModel(schemeId, model);
             addedIds.push_back(model.id);
             existingPaths.insert(model.directory);
             continue;
@@ -1877,7 +2457,7 @@ QVector<QString> MainWindow::importModelsIntoScheme(const QString& schemeId,
             if (existingPaths.contains(model.directory))
                 continue;
 
-            scheme->models.push_back(model);
+            m_registry.addModel(schemeId, model);
             addedIds.push_back(model.id);
             existingPaths.insert(model.directory);
         }
@@ -2210,7 +2790,7 @@ void MainWindow::promptAddScheme()
         return;
     }
 
-    const QString defaultName = tr("新方案%1").arg(m_schemes.size() + 1);
+    const QString defaultName = tr("新方案%1").arg(m_registry.schemeCount() + 1);
     SchemeSettingsDialog dlg(defaultName, QString(), false, this);
     dlg.setDirectoryHint(tr("工作目录将在工程中自动生成"));
     if (dlg.exec() != QDialog::Accepted)
@@ -2373,62 +2953,43 @@ bool MainWindow::confirmModelDeletion(const ModelRecord& model,
 
 void MainWindow::removeSchemeById(const QString& id)
 {
-    for (int i = 0; i < m_schemes.size(); ++i)
+    const SchemeRecord* scheme = schemeById(id);
+    if (!scheme)
+        return;
+
+    if (isPathWithinDirectory(scheme->thumbnailPath, scheme->workingDirectory))
+        QFile::remove(scheme->thumbnailPath);
+    for (const ModelRecord& model : scheme->models)
+        m_jobQueue->cancelModel(model.id);
+    m_registry.removeScheme(id);
+    if (m_activeSchemeId == id)
     {
-        if (m_schemes[i].id == id)
-        {
-            if (isPathWithinDirectory(m_schemes[i].thumbnailPath,
-                                      m_schemes[i].workingDirectory))
-                QFile::remove(m_schemes[i].thumbnailPath);
-            m_schemes.removeAt(i);
-            if (m_activeSchemeId == id)
-            {
-                m_activeSchemeId.clear();
-                m_activeModelId.clear();
-            }
-            persistSchemes();
-            refreshNavigation();
-            appendLogMessage(tr("已删除方案"));
-            return;
-        }
+        m_activeSchemeId.clear();
+        m_activeModelId.clear();
     }
+    persistSchemes();
+    refreshNavigation();
+    appendLogMessage(tr("已删除方案"));
 }
 
 void MainWindow::removeModelById(const QString& id)
 {
-    for (int i = 0; i < m_schemes.size(); ++i)
-    {
-        SchemeRecord& scheme = m_schemes[i];
-        for (int j = 0; j < scheme.models.size(); ++j)
-        {
-            if (scheme.models[j].id == id)
-            {
-                scheme.models.removeAt(j);
-                if (m_activeModelId == id)
-                    m_activeModelId.clear();
-                persistSchemes();
-                refreshNavigation(scheme.id);
-                appendLogMessage(tr("已删除模型"));
-                return;
-            }
-        }
-    }
+    SchemeRecord* owner = nullptr;
+    if (!modelById(id, &owner))
+        return;
+
+    const QString schemeId = owner->id;
+    m_jobQueue->cancelModel(id);
+    m_registry.removeModel(id);
+    if (m_activeModelId == id)
+        m_activeModelId.clear();
+    persistSchemes();
+    refreshNavigation(schemeId);
+    appendLogMessage(tr("已删除模型"));
 }
 
 void MainWindow::syncDataFromTree()
 {
-    const QVector<SchemeRecord> previous = m_schemes;
-
-    QHash<QString, SchemeRecord> schemeMap;
-    for (const SchemeRecord& scheme : previous)
-        schemeMap.insert(scheme.id, scheme);
-
-    QHash<QString, ModelRecord> modelMap;
-    for (const SchemeRecord& scheme : previous)
-        for (const ModelRecord& model : scheme.models)
-            modelMap.insert(model.id, model);
-
-    QVector<SchemeRecord> updated;
     QList<QTreeWidgetItem*> schemeItems;
     if (m_projectRootItem)
     {
@@ -2456,35 +3017,58 @@ void MainWindow::syncDataFromTree()
         }
     }
 
+    // 拖放只改变方案顺序与模型的归属，逐个方案比较，只替换模型列表有变化的方案，不整体重建索引
+    QVector<QPair<QString, QVector<ModelRecord>>> changedSchemes;
+    int position = 0;
     for (QTreeWidgetItem* schemeItem : schemeItems)
     {
         const QString schemeId = schemeItem->data(0, IdRole).toString();
-        if (schemeId.isEmpty())
+        SchemeRecord* scheme = schemeById(schemeId);
+        if (!scheme)
             continue;
-
-        SchemeRecord scheme = schemeMap.value(schemeId);
-        scheme.name = schemeItem->text(0);
-        scheme.models.clear();
+        if (m_registry.schemes().at(position).id != schemeId)
+        {
+            m_registry.moveScheme(schemeId, position);
+            scheme = schemeById(schemeId);
+        }
+        ++position;
+        scheme->name = schemeItem->text(0);
 
         const int childCount = schemeItem->childCount();
+        bool same = childCount == scheme->models.size();
+        for (int j = 0; same && j < childCount; ++j)
+            same = schemeItem->child(j)->data(0, IdRole).toString() == scheme->models.at(j).id;
+        if (same)
+            continue;
+
+        QVector<ModelRecord> models;
+        models.reserve(childCount);
         for (int j = 0; j < childCount; ++j)
         {
             QTreeWidgetItem* modelItem = schemeItem->child(j);
-            const QString modelId = modelItem->data(0, IdRole).toString();
-            if (modelId.isEmpty())
-                continue;
-
-            ModelRecord model = modelMap.value(modelId);
-            if (model.id.isEmpty())
+            const ModelRecord* previous = modelById(modelItem->data(0, IdRole).toString());
+            if (!previous)
                 continue;
+            ModelRecord model = *previous;
             model.name = modelItem->text(0);
-            scheme.models.push_back(model);
+            models.push_back(model);
         }
+        changedSchemes.append(qMakePair(schemeId, models));
+    }
 
-        updated.push_back(scheme);
+    // 先从原方案中移出跨方案移动的模型，再替换各方案的模型列表，索引不会指向旧位置
+    for (const auto& changed : qAsConst(changedSchemes))
+    {
+        for (const ModelRecord& model : changed.second)
+        {
+            SchemeRecord* owner = nullptr;
+            if (modelById(model.id, &owner) && owner && owner->id != changed.first)
+                m_registry.removeModel(model.id);
+        }
     }
+    for (const auto& changed : qAsConst(changedSchemes))
+        m_registry.setModels(changed.first, changed.second);
 
-    m_schemes = updated;
     persistSchemes();
     refreshNavigation(m_activeSchemeId, m_activeModelId);
 }
@@ -2529,7 +3113,7 @@ QString MainWindow::makeUniqueSchemeName(const QString& desired,
                                          const QString& excludeId) const
 {
     QSet<QString> taken;
-    for (const SchemeRecord& scheme : m_schemes)
+    for (const SchemeRecord& scheme : m_registry.schemes())
     {
         if (scheme.id == excludeId)
             continue;
@@ -2559,10 +3143,10 @@ void MainWindow::ensureUniqueModelNames(SchemeRecord& scheme) const
         model.name = makeUniqueName(model.name, taken, tr("未命名模型"));
 }
 
-void MainWindow::ensureUniqueSchemeAndModelNames()
+void MainWindow::ensureUniqueSchemeAndModelNames(QVector<SchemeRecord>& schemes) const
 {
     QSet<QString> taken;
-    for (SchemeRecord& scheme : m_schemes)
+    for (SchemeRecord& scheme : schemes)
     {
         scheme.name = makeUniqueName(scheme.name, taken, tr("未命名方案"));
         ensureUniqueModelNames(scheme);
@@ -2666,98 +3250,1180 @@ void MainWindow::appendLogMessage(const QString& message)
         bar->setValue(bar->maximum());
 }
 
-void MainWindow::displayStlFile(const QString& filePath)
+void MainWindow::startModelCalculation(const QString& modelId)
 {
-    if (filePath.isEmpty())
+    if (enqueueModels(QStringList() << modelId, kInteractivePriority) == 0)
         return;
 
-    QFileInfo info(filePath);
-    if (!info.exists())
-    {
-        appendLogMessage(tr("未找到 STL 文件：%1")
-                             .arg(QDir::toNativeSeparators(filePath)));
-        return;
-    }
+    if (m_currentBuilder && m_currentBuilderModelId == modelId &&
+        m_jobQueue->isModelQueued(modelId))
+        m_currentBuilder->setQueued(true);
+}
 
-    auto reader = vtkSmartPointer<vtkSTLReader>::New();
-    reader->SetFileName(qPrintable(info.absoluteFilePath()));
-    reader->Update();
+int MainWindow::enqueueModels(const QStringList& modelIds, int priority, bool useCache, bool urgent)
+{
+    int added = 0;
+    for (const QString& modelId : modelIds)
+    {
+        SchemeRecord* owner = nullptr;
+        const ModelRecord* model = modelById(modelId, &owner);
+        if (!model)
+            continue;
 
-    auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    mapper->SetInputConnection(reader->GetOutputPort());
+        JobRequest request;
+        request.modelId = modelId;
+        request.name = owner ? QStringLiteral("%1 / %2").arg(owner->name, model->name)
+                             : model->name;
+        request.workingDirectory = ModelFiles::solverDirectory(*model);
+        request.parameterFile = model->jsonPath;
+        request.launcherScript = model->batPath;
+        request.priority = priority;
+        request.threads = m_jobDock->threadsForModel(modelId);
+        request.useCache = useCache;
+        request.urgent = urgent;
+        if (m_jobQueue->enqueue(request) != 0)
+            ++added;
+    }
 
-    auto actor = vtkSmartPointer<vtkActor>::New();
-    actor->SetMapper(mapper);
-    actor->GetProperty()->SetColor(0.2, 0.45, 0.75);
-    actor->GetProperty()->SetDiffuse(0.8);
-    actor->GetProperty()->SetSpecular(0.3);
+    if (added > 1)
+        appendLogMessage(tr("已将 %1 个模型加入计算队列").arg(added));
+    else if (added == 0 && !modelIds.isEmpty())
+        appendLogMessage(tr("所选模型已在计算队列中"));
+    return added;
+}
 
-    if (!m_renderer)
+void MainWindow::enqueueScheme(const QString& schemeId)
+{
+    const SchemeRecord* scheme = schemeById(schemeId);
+    if (!scheme)
         return;
 
-    m_renderer->RemoveAllViewProps();
-    m_currentActor = actor;
-    m_renderer->AddActor(actor);
-    m_renderer->ResetCamera();
-    if (ui->vtkWidget && ui->vtkWidget->renderWindow())
-        ui->vtkWidget->renderWindow()->Render();
+    QStringList ids;
+    for (const ModelRecord& model : scheme->models)
+        ids << model.id;
+    if (ids.isEmpty())
+    {
+        appendLogMessage(tr("方案 %1 中没有模型").arg(scheme->name));
+        return;
+    }
+    if (enqueueModels(ids, kBatchPriority) > 0)
+        m_jobDock->show();
 }
 
-void MainWindow::clearVtkScene()
+void MainWindow::enqueueSelectedModels()
 {
-    if (!m_renderer)
+    const QStringList ids = selectedModelIds();
+    if (ids.isEmpty())
+    {
+        QMessageBox::information(this, tr("计算选中模型"), tr("请先在左侧选择一个或多个模型。"));
         return;
-    m_renderer->RemoveAllViewProps();
-    if (ui->vtkWidget && ui->vtkWidget->renderWindow())
-        ui->vtkWidget->renderWindow()->Render();
-    m_currentActor = nullptr;
+    }
+    if (enqueueModels(ids, kBatchPriority) > 0)
+        m_jobDock->show();
 }
 
-bool MainWindow::loadSchemesFromStorage()
+QStringList MainWindow::selectedModelIds() const
 {
-    if (m_storageFilePath.isEmpty())
-        return false;
+    QStringList ids;
+    const QList<QTreeWidgetItem*> items = ui->treeModels->selectedItems();
+    for (QTreeWidgetItem* item : items)
+    {
+        if (item->data(0, TypeRole).toInt() == ModelItem)
+            ids << item->data(0, IdRole).toString();
+    }
+    return ids;
+}
 
-    QFile file(m_storageFilePath);
-    if (!file.exists())
-        return false;
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        return false;
+void MainWindow::runParameterSweep(const QString& modelId)
+{
+    SchemeRecord* scheme = nullptr;
+    const ModelRecord* model = modelById(modelId, &scheme);
+    if (!model || !scheme)
+        return;
 
-    const QByteArray data = file.readAll();
-    file.close();
+    QJsonArray sections;
+    if (!JsonPageBuilder::loadJson(model->jsonPath, sections))
+    {
+        QMessageBox::warning(this, tr("参数扫描"),
+                             tr("无法读取 JSON：%1").arg(QDir::toNativeSeparators(model->jsonPath)));
+        return;
+    }
 
-    QJsonParseError err{};
-    const QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-    if (err.error != QJsonParseError::NoError || !doc.isObject())
-        return false;
+    ParameterSweepDialog dialog(model->name, sections, this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    const QVector<SweepParameter> parameters = dialog.parameters();
+    const QVector<QVector<QJsonValue>> samples =
+        ParameterSweep::generate(parameters, dialog.method(), dialog.sampleCount(), dialog.seed());
+    if (samples.isEmpty())
+        return;
+
+    // 变体追加到 scheme->models 后 model 指针会失效，先取出需要的信息
+    const QString schemeId = scheme->id;
+    const QString baseName = model->name;
+    const QString sourceDir = model->directory;
+    const QString jsonName = QDir(sourceDir).relativeFilePath(model->jsonPath);
+    const QString batName = model->batPath.isEmpty()
+                                ? QString()
+                                : QDir(sourceDir).relativeFilePath(model->batPath);
+    const QString dirBase = QFileInfo(sourceDir).fileName();
+
+    if (!ensureDirectoryExists(scheme->workingDirectory))
+    {
+        QMessageBox::warning(this, tr("参数扫描"),
+                             tr("无法创建方案工作目录：%1")
+                                 .arg(QDir::toNativeSeparators(scheme->workingDirectory)));
+        return;
+    }
+    const QString workingPath = scheme->workingDirectory;
+    const bool launchImmediately = dialog.launchImmediately();
+
+    // 复制输入文件可能耗时较长，在工作线程中生成全部变体目录，完成后再登记模型
+    appendLogMessage(tr("参数扫描：正在生成 %1 个变体…").arg(samples.size()));
+    auto* watcher = new QFutureWatcher<SweepVariants>(this);
+    connect(watcher, &QFutureWatcher<SweepVariants>::finished, this,
+            [this, watcher, schemeId, modelId, baseName, jsonName, batName, parameters, samples,
+             launchImmediately]() {
+        const SweepVariants generated = watcher->result();
+        watcher->deleteLater();
+        for (const QString& error : generated.errors)
+            appendLogMessage(tr("参数扫描：%1").arg(error));
+
+        // 期间方案被删除或切换了工程时，已生成的目录保留在磁盘上，不再登记
+        SchemeRecord* scheme = schemeById(schemeId);
+        if (!scheme)
+            return;
+        if (generated.directories.isEmpty())
+        {
+            QMessageBox::warning(this, tr("参数扫描"), tr("未能生成任何变体，详情见日志。"));
+            return;
+        }
+
+        QStringList parameterNames;
+        for (const SweepParameter& parameter : parameters)
+            parameterNames << parameter.name;
+        auto* results = new SweepResultsDialog(baseName, parameterNames, this);
+        connect(results, &SweepResultsDialog::compareRequested, this, &MainWindow::showComparison);
+
+        QStringList variantIds;
+        for (int k = 0; k < generated.directories.size(); ++k)
+        {
+            const int i = generated.samples.at(k);
+            const QString suffix = QStringLiteral("_v%1").arg(i + 1, 3, 10, QLatin1Char('0'));
+            QStringList remarks;
+            for (int p = 0; p < parameters.size(); ++p)
+                remarks << QStringLiteral("%1=%2").arg(parameters[p].name,
+                                                       ParameterSweep::valueText(samples[i][p]));
+
+            const QDir variantDir(generated.directories.at(k));
+            ModelRecord variant;
+            variant.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+            variant.name = makeUniqueModelName(*scheme, baseName + suffix);
+            variant.directory = generated.directories.at(k);
+            variant.jsonPath = variantDir.filePath(jsonName);
+            variant.batPath = batName.isEmpty() ? QString() : variantDir.filePath(batName);
+            variant.remarks = remarks.join(QStringLiteral("; "));
+            // addModel 之后 scheme 中的模型指针失效，scheme 本身仍然有效
+            m_registry.addModel(schemeId, variant);
+            variantIds << variant.id;
+            results->addVariant(variant.id, variant.name, samples[i]);
+        }
+
+        // 一次性登记全部变体，只写一次存储、只重建一次导航树
+        persistSchemes();
+        refreshNavigation(schemeId, modelId);
+        appendLogMessage(tr("参数扫描：已生成 %1 个变体").arg(variantIds.size()));
+        if (!generated.errors.isEmpty())
+            appendLogMessage(tr("参数扫描：%1 个变体生成失败").arg(generated.errors.size()));
+
+        m_sweepDialogs.append(results);
+        results->show();
+
+        if (launchImmediately)
+        {
+            enqueueModels(variantIds, kBatchPriority);
+            for (const QString& id : variantIds)
+            {
+                if (m_jobQueue->isModelQueued(id))
+                    results->markQueued(id);
+            }
+            m_jobDock->show();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([sourceDir, jsonName, dirBase, workingPath, sections, parameters,
+                                          samples]() {
+        SweepVariants generated;
+        const QDir workingDir(workingPath);
+        for (int i = 0; i < samples.size(); ++i)
+        {
+            const QString suffix = QStringLiteral("_v%1").arg(i + 1, 3, 10, QLatin1Char('0'));
+            const QString targetPath = uniqueChildPath(workingDir, dirBase + suffix);
+            const QJsonArray variantSections =
+                ParameterSweep::applyValues(sections, parameters, samples[i]);
+
+            QString error;
+            if (!ParameterSweep::materialiseVariant(sourceDir, jsonName, variantSections,
+                                                    targetPath, &error))
+            {
+                generated.errors << error;
+                continue;
+            }
+            generated.samples << i;
+            generated.directories << canonicalPathForDir(QDir(targetPath));
+        }
+        return generated;
+    }));
+}
+
+void MainWindow::onSolverJobStarted(const QString& modelId, SolverJob* job)
+{
+    for (const QPointer<SweepResultsDialog>& dialog : m_sweepDialogs)
+    {
+        if (dialog && dialog->containsModel(modelId))
+            dialog->markStarted(modelId);
+    }
+
+    const ModelRecord* model = modelById(modelId);
+    const QString modelName = model ? model->name : tr("未命名模型");
+    appendLogMessage(tr("[%1] 开始计算").arg(modelName));
+    connect(job, &SolverJob::outputReceived, this, [this, modelName](const QString& text) {
+        appendLogMessage(QStringLiteral("[%1] %2").arg(modelName, text));
+    });
+    connect(job, &SolverJob::problemDetected, this, [this, modelName](const QString& message) {
+        appendLogMessage(tr("[%1] 求解器报告错误：%2").arg(modelName, message));
+    });
+    auto announced = QSharedPointer<bool>::create(false);
+    connect(job, &SolverJob::artifactUpdated, this,
+            [this, modelId, modelName, announced](const QString& path) {
+        if (m_activeModelId != modelId || !ResultReaderRegistry::instance().canRead(path))
+            return;
+        if (!*announced)
+        {
+            *announced = true;
+            appendLogMessage(tr("[%1] 求解器输出了中间结果，视图将随计算更新").arg(modelName));
+        }
+        showLiveFrame(modelId, path);
+    });
+
+    if (m_currentBuilder && m_currentBuilderModelId == modelId)
+        m_currentBuilder->attachJob(job);
+}
+
+void MainWindow::onSolverJobFinished(const QString& modelId, SolverJob* job)
+{
+    const ModelRecord* model = modelById(modelId);
+    const QString modelName = model ? model->name : tr("未命名模型");
+    const SolverRunResult& result = job->result();
+    if (result.fromCache)
+        appendLogMessage(tr("[%1] 命中结果缓存 %2，跳过计算脚本")
+                             .arg(modelName, result.cacheKey.left(12)));
+    appendLogMessage(QStringLiteral("[%1] %2").arg(modelName, result.message));
+    if (result.usage.valid)
+        appendLogMessage(tr("[%1] 资源：%2").arg(modelName, result.usage.summaryText()));
+    if (job->runRecord().isValid())
+    {
+        m_latestRuns.insert(modelId, job->runRecord());
+        m_persistence->submitRun(modelId, job->runRecord());
+        if (model)
+            updateModelItemStatus(*model);
+    }
+
+    m_sweepDialogs.removeAll(QPointer<SweepResultsDialog>());
+    for (const QPointer<SweepResultsDialog>& dialog : m_sweepDialogs)
+    {
+        if (dialog->containsModel(modelId))
+            dialog->markFinished(modelId, result);
+    }
+    if (result.cancelled)
+        return;
+
+    if (result.stlPath.isEmpty())
+    {
+        appendLogMessage(tr("未检测到新的 STL 输出文件"));
+        return;
+    }
+
+    appendLogMessage(tr("检测到新的 STL 输出：%1")
+                         .arg(QDir::toNativeSeparators(result.stlPath)));
+    if (m_thumbnails)
+        m_thumbnails->request(modelId, result.stlPath);
+    if (m_activeModelId == modelId)
+    {
+        appendLogMessage(tr("加载 STL：%1").arg(QDir::toNativeSeparators(result.stlPath)));
+        displayResultFile(result.stlPath);
+    }
+}
+
+RunRecord MainWindow::latestRun(const ModelRecord& model)
+{
+    auto it = m_latestRuns.find(model.id);
+    if (it == m_latestRuns.end())
+        it = m_latestRuns.insert(model.id, RunJournal::latest(ModelFiles::solverDirectory(model)));
+    return it.value();
+}
+
+void MainWindow::requestLatestRun(const ModelRecord& model)
+{
+    if (m_loadingRuns.contains(model.id))
+        return;
+    m_loadingRuns.insert(model.id);
+
+    const QString modelId = model.id;
+    auto* watcher = new QFutureWatcher<RunRecord>(this);
+    connect(watcher, &QFutureWatcher<RunRecord>::finished, this, [this, watcher, modelId]() {
+        const RunRecord record = watcher->result();
+        watcher->deleteLater();
+        // 期间切换了工程时结果作废
+        if (!m_loadingRuns.remove(modelId))
+            return;
+        // 期间结束的任务已写入更新的记录
+        if (!m_latestRuns.contains(modelId))
+            m_latestRuns.insert(modelId, record);
+        if (const ModelRecord* current = modelById(modelId))
+            updateModelItemStatus(*current);
+    });
+    watcher->setFuture(QtConcurrent::run([model]() {
+        return RunJournal::latest(ModelFiles::solverDirectory(model));
+    }));
+}
+
+void MainWindow::updateModelItemStatus(const ModelRecord& model)
+{
+    QTreeWidgetItem* item = m_modelItems.value(model.id, nullptr);
+    if (!item)
+        return;
+
+    // 界面线程不读取运行日志：尚未检查到的模型由后台检查补上，其余的在后台单独读取
+    const bool validating = m_unvalidatedModels.contains(model.id);
+    const auto cached = m_latestRuns.constFind(model.id);
+    if (!validating && cached == m_latestRuns.constEnd())
+        requestLatestRun(model);
+    const bool pending = validating || cached == m_latestRuns.constEnd();
+    const bool missing = m_missingPaths.contains(model.id);
+    const RunRecord last = pending ? RunRecord() : cached.value();
+    QString tip = QDir::toNativeSeparators(model.directory);
+    if (missing)
+        tip += tr("\n目录或参数文件不存在");
+    if (pending)
+    {
+        tip += tr("\n正在检查…");
+    }
+    else if (last.isValid())
+    {
+        tip += tr("\n上次运行：%1，%2").arg(last.statusText(),
+                                          last.finishedAt.toString("yyyy-MM-dd HH:mm:ss"));
+        if (!last.errorMessage.isEmpty())
+            tip += QStringLiteral("\n") + last.errorMessage.left(200);
+    }
+    else
+    {
+        tip += tr("\n尚未计算");
+    }
+    QScopedValueRollback<bool> guard(m_blockTreeSignals, true);
+    item->setToolTip(0, tip);
+    item->setForeground(0, missing ? QBrush(QColor("#b91c1c")) : QBrush());
+}
+
+void MainWindow::updateSchemeItemStatus(const SchemeRecord& scheme)
+{
+    QTreeWidgetItem* item = m_schemeItems.value(scheme.id, nullptr);
+    if (!item)
+        return;
+
+    const bool missing = m_missingPaths.contains(scheme.id);
+    QString tip = QDir::toNativeSeparators(scheme.workingDirectory);
+    if (missing)
+        tip += tr("\n工作目录不存在");
+    QScopedValueRollback<bool> guard(m_blockTreeSignals, true);
+    item->setToolTip(0, tip);
+    item->setForeground(0, missing ? QBrush(QColor("#b91c1c")) : QBrush());
+}
+
+void MainWindow::showRunHistory(const QString& modelId)
+{
+    const ModelRecord* model = modelById(modelId);
+    if (!model)
+        return;
+
+    auto* dialog = new RunHistoryDialog(model->name, ModelFiles::solverDirectory(*model), this);
+    connect(dialog, &RunHistoryDialog::showStlRequested, this, [this, modelId](const QString& path) {
+        if (m_activeModelId != modelId)
+            selectTreeItem(QString(), modelId);
+        appendLogMessage(tr("加载 STL：%1").arg(QDir::toNativeSeparators(path)));
+        displayResultFile(path);
+    });
+    dialog->show();
+}
+
+void MainWindow::showLiveFrame(const QString& modelId, const QString& filePath)
+{
+    // 求解器可能连续写出多帧，只加载间隔内的最后一帧
+    const bool scheduled = !m_pendingLiveFrame.isEmpty();
+    m_pendingLiveFrame = filePath;
+    if (scheduled)
+        return;
+    QTimer::singleShot(kLiveFrameIntervalMs, this, [this, modelId]() {
+        const QString path = m_pendingLiveFrame;
+        m_pendingLiveFrame.clear();
+        // 对比显示期间不打断用户的对比
+        if (m_activeModelId == modelId && m_comparisonViews.isEmpty())
+            displayResultFile(path, /*resetCamera*/false, /*timeStep*/0, /*liveFrame*/true);
+    });
+}
+
+void MainWindow::displayResultFile(const QString& filePath, bool resetCamera, int timeStep,
+                                   bool liveFrame)
+{
+    if (filePath.isEmpty())
+        return;
+
+    QFileInfo info(filePath);
+    if (!info.exists())
+    {
+        appendLogMessage(tr("未找到结果文件：%1")
+                             .arg(QDir::toNativeSeparators(filePath)));
+        return;
+    }
+    if (!ResultReaderRegistry::instance().canRead(filePath))
+    {
+        appendLogMessage(tr("不支持的结果文件格式：%1")
+                             .arg(QDir::toNativeSeparators(filePath)));
+        return;
+    }
+    leaveComparison();
+    if (m_diffCancel)
+        m_diffCancel->store(true);
+    m_diffCancel.reset();
+
+    // 连续的中间帧之间只要有一次要求重置视角就保留该要求
+    if (!m_geometryLoader->isLoading())
+        m_pendingCameraReset = resetCamera;
+    else
+        m_pendingCameraReset = m_pendingCameraReset || resetCamera;
+    m_pendingCacheInsert = !liveFrame;
+    m_resultPath = info.absoluteFilePath();
+    m_resultTimeStep = timeStep;
+
+    // 每个时间步单独占一个缓存条目，来回切换时不必重新读取
+    GeometryCache::Entry cached;
+    const GeometryCache::Key key = GeometryCache::Key::forFile(info.absoluteFilePath(), timeStep);
+    if (GeometryCache::instance().lookup(key, &cached))
+    {
+        m_geometryLoader->cancel();
+        updateGeometryCacheStatus();
+        showGeometry(info.absoluteFilePath(), key, cached, 0);
+        return;
+    }
+    m_geometryLoader->load(info.absoluteFilePath(), m_pendingCacheInsert, timeStep);
+}
+
+void MainWindow::setupResultBar()
+{
+    // 结果带有字段或多个时间步时显示在三维视图下方
+    m_resultBar = new QFrame(ui->vtkFrame);
+    auto* layout = new QHBoxLayout(m_resultBar);
+    layout->setContentsMargins(8, 4, 8, 4);
+    layout->setSpacing(8);
+    layout->addWidget(new QLabel(tr("着色"), m_resultBar));
+    m_fieldCombo = new QComboBox(m_resultBar);
+    m_fieldCombo->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    layout->addWidget(m_fieldCombo);
+    m_timeSlider = new QSlider(Qt::Horizontal, m_resultBar);
+    layout->addWidget(m_timeSlider, 1);
+    m_timeLabel = new QLabel(m_resultBar);
+    layout->addWidget(m_timeLabel);
+    ui->vtkFrameLayout->addWidget(m_resultBar);
+    m_resultBar->hide();
+
+    m_fieldLut = vtkSmartPointer<vtkLookupTable>::New();
+    m_fieldLut->SetHueRange(0.667, 0.0);
+    m_fieldLut->SetVectorModeToMagnitude();
+    m_fieldLut->Build();
+    m_fieldScalarBar = vtkSmartPointer<vtkScalarBarActor>::New();
+    m_fieldScalarBar->SetLookupTable(m_fieldLut);
+    m_fieldScalarBar->SetNumberOfLabels(5);
+    m_fieldScalarBar->SetMaximumWidthInPixels(90);
+    applyOverlayFont(m_fieldScalarBar->GetTitleTextProperty());
+    applyOverlayFont(m_fieldScalarBar->GetLabelTextProperty());
+    m_fieldScalarBar->GetLabelTextProperty()->BoldOff();
+
+    m_timeStepTimer = new QTimer(this);
+    m_timeStepTimer->setSingleShot(true);
+    m_timeStepTimer->setInterval(kTimeStepDelayMs);
+    connect(m_timeStepTimer, &QTimer::timeout, this, [this]() {
+        if (!m_resultPath.isEmpty() && m_timeSlider->value() != m_resultTimeStep)
+            displayResultFile(m_resultPath, /*resetCamera*/false, m_timeSlider->value());
+    });
+    connect(m_timeSlider, &QSlider::valueChanged, this, [this](int step) {
+        updateTimeStepLabel(step);
+        m_timeStepTimer->start();
+    });
+    connect(m_fieldCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        m_colorField = m_fieldCombo->currentData().toString();
+        applyFieldColoring();
+        if (ui->vtkWidget && ui->vtkWidget->renderWindow())
+            ui->vtkWidget->renderWindow()->Render();
+    });
+}
+
+void MainWindow::updateResultControls()
+{
+    vtkPolyData* polyData = m_currentEntry.polyData;
+    {
+        const QSignalBlocker blocker(m_fieldCombo);
+        m_fieldCombo->clear();
+        m_fieldCombo->addItem(tr("纯色"), QString());
+        if (polyData)
+        {
+            vtkPointData* pointData = polyData->GetPointData();
+            for (int i = 0; i < pointData->GetNumberOfArrays(); ++i)
+            {
+                vtkDataArray* array = pointData->GetArray(i);
+                // 加载时计算的法向只用于光照
+                if (!array || !array->GetName() || array == pointData->GetNormals())
+                    continue;
+                const QString name = QString::fromUtf8(array->GetName());
+                m_fieldCombo->addItem(tr("点：%1").arg(name), QStringLiteral("p:") + name);
+            }
+            vtkCellData* cellData = polyData->GetCellData();
+            for (int i = 0; i < cellData->GetNumberOfArrays(); ++i)
+            {
+                vtkDataArray* array = cellData->GetArray(i);
+                if (!array || !array->GetName() || array == cellData->GetNormals())
+                    continue;
+                const QString name = QString::fromUtf8(array->GetName());
+                m_fieldCombo->addItem(tr("单元：%1").arg(name), QStringLiteral("c:") + name);
+            }
+        }
+        // 切换时间步或同类结果时保留所选字段
+        int index = m_fieldCombo->findData(m_colorField);
+        if (index < 0)
+            index = 0;
+        m_fieldCombo->setCurrentIndex(index);
+        m_colorField = m_fieldCombo->currentData().toString();
+    }
+
+    const QVector<double> steps = m_resultTimeSteps.value(m_resultPath);
+    {
+        const QSignalBlocker blocker(m_timeSlider);
+        m_timeSlider->setRange(0, qMax(0, steps.size() - 1));
+        m_timeSlider->setValue(m_resultTimeStep);
+    }
+    m_timeSlider->setVisible(steps.size() > 1);
+    m_timeLabel->setVisible(steps.size() > 1);
+    updateTimeStepLabel(m_resultTimeStep);
+    m_resultBar->setVisible(m_fieldCombo->count() > 1 || steps.size() > 1);
+}
+
+void MainWindow::updateTimeStepLabel(int step)
+{
+    const QVector<double> steps = m_resultTimeSteps.value(m_resultPath);
+    if (step < 0 || step >= steps.size())
+    {
+        m_timeLabel->clear();
+        return;
+    }
+    m_timeLabel->setText(tr("时间 %1（%2/%3）")
+                             .arg(steps.at(step), 0, 'g', 6)
+                             .arg(step + 1)
+                             .arg(steps.size()));
+}
+
+void MainWindow::applyFieldColoring()
+{
+    const bool cellField = m_colorField.startsWith(QLatin1String("c:"));
+    const QString name = m_colorField.mid(2);
+    vtkDataArray* array = nullptr;
+    if (m_currentEntry.polyData && !m_colorField.isEmpty())
+    {
+        const QByteArray utf8 = name.toUtf8();
+        array = cellField ? m_currentEntry.polyData->GetCellData()->GetArray(utf8.constData())
+                          : m_currentEntry.polyData->GetPointData()->GetArray(utf8.constData());
+    }
+
+    double range[2] = { 0.0, 1.0 };
+    if (array)
+        array->GetRange(range, array->GetNumberOfComponents() > 1 ? -1 : 0);
+    // 简化层级保留了点数据；单元字段在简化层级上找不到时按纯色绘制
+    for (vtkPolyDataMapper* mapper : { m_currentEntry.mapper.Get(), m_currentEntry.lodMapper.Get() })
+    {
+        if (!mapper)
+            continue;
+        if (!array)
+        {
+            mapper->ScalarVisibilityOff();
+            continue;
+        }
+        mapper->ScalarVisibilityOn();
+        mapper->SetScalarMode(cellField ? VTK_SCALAR_MODE_USE_CELL_FIELD_DATA
+                                        : VTK_SCALAR_MODE_USE_POINT_FIELD_DATA);
+        mapper->SelectColorArray(name.toUtf8().constData());
+        mapper->SetLookupTable(m_fieldLut);
+        mapper->SetScalarRange(range);
+    }
+
+    if (array)
+    {
+        m_fieldScalarBar->SetTitle(name.toUtf8().constData());
+        if (!m_renderer->HasViewProp(m_fieldScalarBar))
+            m_renderer->AddViewProp(m_fieldScalarBar);
+    }
+    else
+    {
+        m_renderer->RemoveViewProp(m_fieldScalarBar);
+    }
+}
+
+vtkSmartPointer<vtkProp3D> MainWindow::createGeometryProp(const GeometryCache::Key& key,
+                                                          const GeometryCache::Entry& entry)
+{
+    auto property = vtkSmartPointer<vtkProperty>::New();
+    property->SetColor(0.2, 0.45, 0.75);
+    property->SetDiffuse(0.8);
+    property->SetSpecular(0.3);
+
+    // 大模型交给 vtkLODProp3D：交互时按目标帧率自动选用简化层级，静止后绘制完整网格。
+    // 中间帧没有缓存键，很快会被替换，不生成简化层级
+    const qint64 triangles = entry.polyData ? entry.polyData->GetNumberOfCells() : 0;
+    if (m_lodSettings.enabled && key.isValid() && triangles >= m_lodSettings.minTriangles)
+    {
+        auto lod = vtkSmartPointer<vtkLODProp3D>::New();
+        const int fullId = lod->AddLOD(entry.mapper, property,
+                                       GeometryLod::estimatedRenderSeconds(triangles));
+        lod->SetLODLevel(fullId, 0.0);
+        if (entry.lodMapper)
+            addCoarseLod(lod, entry.lodMapper, property);
+        else
+            requestCoarseLod(key, entry.polyData, lod, property);
+        return lod;
+    }
+
+    // 同一份 mapper 可以被多个 actor 共用，同一渲染窗口内共享显存中的缓冲区
+    auto actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(entry.mapper);
+    actor->SetProperty(property);
+    return actor;
+}
+
+void MainWindow::showGeometry(const QString& filePath, const GeometryCache::Key& key,
+                              const GeometryCache::Entry& entry, qint64 elapsedMs)
+{
+    if (!m_renderer || !entry.mapper)
+        return;
+
+    const vtkSmartPointer<vtkProp3D> prop = createGeometryProp(key, entry);
+
+    // 中间帧保持用户当前的视角
+    const bool keepCamera = !m_pendingCameraReset && m_currentProp;
+    m_renderer->RemoveAllViewProps();
+    m_currentProp = prop;
+    m_currentEntry = entry;
+    m_renderer->AddViewProp(prop);
+    updateResultControls();
+    applyFieldColoring();
+    if (!keepCamera)
+        m_renderer->ResetCamera();
+    if (ui->vtkWidget && ui->vtkWidget->renderWindow())
+        ui->vtkWidget->renderWindow()->Render();
+
+    if (elapsedMs >= 1000)
+        appendLogMessage(tr("已加载 %1（%2 个三角面片，用时 %3 秒）")
+                             .arg(QFileInfo(filePath).fileName())
+                             .arg(entry.polyData ? entry.polyData->GetNumberOfCells() : 0)
+                             .arg(elapsedMs / 1000.0, 0, 'f', 1));
+}
+
+void MainWindow::addCoarseLod(vtkLODProp3D* lod, vtkPolyDataMapper* mapper, vtkProperty* property)
+{
+    const int coarseId = lod->AddLOD(mapper, property,
+                                     GeometryLod::estimatedRenderSeconds(mapper->GetInput()->GetNumberOfCells()));
+    lod->SetLODLevel(coarseId, 1.0);
+}
+
+void MainWindow::requestCoarseLod(const GeometryCache::Key& key, vtkPolyData* polyData,
+                                  vtkLODProp3D* lod, vtkProperty* property)
+{
+    // 同一模型同时显示在多个视口时只简化一次
+    const QString id = key.id();
+    const bool pending = m_pendingLods.contains(id);
+    m_pendingLods[id].append(qMakePair(vtkWeakPointer<vtkLODProp3D>(lod), vtkSmartPointer<vtkProperty>(property)));
+    if (pending)
+        return;
+
+    const qint64 target = m_lodSettings.targetTriangles;
+    // 简化会写入边界缓存并改动管线信息；原数据正在界面线程中绘制，
+    // 所以在这里做浅拷贝，后台只接触拷贝
+    auto input = vtkSmartPointer<vtkPolyData>::New();
+    input->ShallowCopy(polyData);
+    auto* watcher = new QFutureWatcher<vtkSmartPointer<vtkPolyData>>(this);
+    connect(watcher, &QFutureWatcher<vtkSmartPointer<vtkPolyData>>::finished, this,
+            [this, watcher, key, id, source = polyData]() {
+        const vtkSmartPointer<vtkPolyData> coarse = watcher->result();
+        watcher->deleteLater();
+        const auto targets = m_pendingLods.take(id);
+        if (!coarse)
+            return;
+
+        auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(coarse);
+        // 即使模型已切换，简化结果也留给下次显示
+        GeometryCache::instance().setLodMapper(key, mapper);
+        updateGeometryCacheStatus();
+        // 主视图仍显示该模型时，新的简化层级也按所选字段着色
+        if (m_currentEntry.polyData == source)
+        {
+            m_currentEntry.lodMapper = mapper;
+            applyFieldColoring();
+        }
+
+        // 已从场景移除的 vtkLODProp3D 随之销毁，弱指针为空
+        for (const auto& target : targets)
+        {
+            if (vtkLODProp3D* lod = target.first.GetPointer())
+                addCoarseLod(lod, mapper, target.second);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([input, target]() {
+        return GeometryLod::decimate(input, target);
+    }));
+}
+
+QString MainWindow::latestResultStl(const ModelRecord& model)
+{
+    const RunRecord last = latestRun(model);
+    return last.isValid() ? last.stlPath(ModelFiles::solverDirectory(model))
+                          : ModelFiles::latestResultFile(model.directory);
+}
+
+void MainWindow::showComparison(const QStringList& modelIds)
+{
+    if (!m_renderWindow || !m_renderer)
+        return;
+
+    QStringList ids;
+    QStringList paths;
+    QStringList contents;
+    for (const QString& id : modelIds)
+    {
+        const ModelRecord* model = modelById(id);
+        if (!model)
+            continue;
+        const QString stl = latestResultStl(*model);
+        if (stl.isEmpty() || !QFileInfo::exists(stl))
+        {
+            appendLogMessage(tr("对比显示：%1 没有可显示的结果").arg(model->name));
+            continue;
+        }
+        ids << id;
+        paths << QFileInfo(stl).absoluteFilePath();
+        contents << comparisonContentKey(latestRun(*model), paths.last());
+    }
+    if (ids.size() > kMaxComparisonViews)
+    {
+        appendLogMessage(tr("对比显示：最多同时显示 %1 个结果，其余已忽略").arg(kMaxComparisonViews));
+        ids = ids.mid(0, kMaxComparisonViews);
+        paths = paths.mid(0, kMaxComparisonViews);
+        contents = contents.mid(0, kMaxComparisonViews);
+    }
+    if (ids.isEmpty())
+        return;
+
+    clearVtkScene();
+    setVisualizationVisible(true);
+
+    // 按接近正方形的网格排列视口，全部共用主渲染器的相机
+    const int count = ids.size();
+    const int columns = int(std::ceil(std::sqrt(double(count))));
+    const int rows = (count + columns - 1) / columns;
+    vtkCamera* camera = m_renderer->GetActiveCamera();
+    for (int i = 0; i < count; ++i)
+    {
+        ComparisonView view;
+        view.modelId = ids.at(i);
+        view.renderer = i == 0 ? m_renderer : vtkSmartPointer<vtkRenderer>::New();
+        if (i > 0)
+        {
+            view.renderer->SetBackground(m_renderer->GetBackground());
+            view.renderer->SetActiveCamera(camera);
+            m_renderWindow->AddRenderer(view.renderer);
+        }
+        const int column = i % columns;
+        const int row = i / columns;
+        view.renderer->SetViewport(double(column) / columns, 1.0 - double(row + 1) / rows,
+                                   double(column + 1) / columns, 1.0 - double(row) / rows);
+
+        auto label = vtkSmartPointer<vtkTextActor>::New();
+        const ModelRecord* model = modelById(view.modelId);
+        label->SetInput(model ? model->name.toUtf8().constData() : "");
+        applyOverlayFont(label->GetTextProperty());
+        label->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+        label->GetPositionCoordinate()->SetValue(0.02, 0.92);
+        view.renderer->AddViewProp(label);
+        m_comparisonViews.push_back(view);
+    }
+
+    // 内容相同的结果只读取一次，分给所有显示它的视口；各组的加载器立即并行开始
+    QVector<QVector<int>> groups;
+    QHash<QString, int> groupIndex;
+    for (int i = 0; i < count; ++i)
+    {
+        auto it = groupIndex.constFind(contents.at(i));
+        if (it == groupIndex.constEnd())
+        {
+            it = groupIndex.insert(contents.at(i), groups.size());
+            groups.append(QVector<int>());
+        }
+        groups[it.value()].append(i);
+    }
+    loadComparisonGroups(paths, groups);
+
+    m_renderWindow->Render();
+    appendLogMessage(tr("对比显示 %1 个结果").arg(count));
+}
+
+void MainWindow::loadComparisonGroups(const QStringList& paths, const QVector<QVector<int>>& groups)
+{
+    for (const QVector<int>& views : groups)
+    {
+        // 组内任一副本已在内存缓存中时直接使用
+        bool attached = false;
+        for (int index : views)
+        {
+            GeometryCache::Entry cached;
+            const GeometryCache::Key key = GeometryCache::Key::forFile(paths.at(index));
+            if (GeometryCache::instance().lookup(key, &cached))
+            {
+                attachComparisonGeometry(views, key, cached);
+                attached = true;
+                break;
+            }
+        }
+        if (attached)
+            continue;
+
+        // 每组一个加载器，各组在线程池中并行读取
+        auto* loader = new GeometryLoader(this);
+        loader->setDiskCache(m_geometryDiskCache);
+        connect(loader, &GeometryLoader::loaded, this,
+                [this, views](const QString&, const GeometryCache::Key& loadedKey,
+                              vtkSmartPointer<vtkPolyData> polyData, qint64) {
+            const GeometryCache::Entry entry = GeometryCache::instance().insert(loadedKey, polyData);
+            updateGeometryCacheStatus();
+            attachComparisonGeometry(views, loadedKey, entry);
+        });
+        connect(loader, &GeometryLoader::failed, this,
+                [this](const QString&, const QString& message) { appendLogMessage(message); });
+        m_comparisonLoaders.append(loader);
+        loader->load(paths.at(views.first()));
+    }
+    updateGeometryCacheStatus();
+}
+
+void MainWindow::attachComparisonGeometry(const QVector<int>& views, const GeometryCache::Key& key,
+                                          const GeometryCache::Entry& entry)
+{
+    if (!entry.mapper)
+        return;
+    for (int index : views)
+    {
+        if (index < 0 || index >= m_comparisonViews.size())
+            continue;
+        m_comparisonViews[index].renderer->AddViewProp(createGeometryProp(key, entry));
+    }
+
+    // 相机按所有已加载结果的包围盒重置，保证各视口比例一致
+    double bounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                         VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+    bool any = false;
+    for (const ComparisonView& view : m_comparisonViews)
+    {
+        double viewBounds[6];
+        view.renderer->ComputeVisiblePropBounds(viewBounds);
+        if (!vtkMath::AreBoundsInitialized(viewBounds))
+            continue;
+        any = true;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bounds[2 * axis] = qMin(bounds[2 * axis], viewBounds[2 * axis]);
+            bounds[2 * axis + 1] = qMax(bounds[2 * axis + 1], viewBounds[2 * axis + 1]);
+        }
+    }
+    if (any)
+    {
+        m_renderer->ResetCamera(bounds);
+        for (const ComparisonView& view : m_comparisonViews)
+            view.renderer->ResetCameraClippingRange(bounds);
+    }
+    m_renderWindow->Render();
+}
+
+void MainWindow::leaveComparison()
+{
+    for (GeometryLoader* loader : m_comparisonLoaders)
+    {
+        loader->cancel();
+        loader->deleteLater();
+    }
+    m_comparisonLoaders.clear();
+    if (m_comparisonViews.isEmpty())
+        return;
+
+    for (const ComparisonView& view : m_comparisonViews)
+    {
+        view.renderer->RemoveAllViewProps();
+        if (view.renderer != m_renderer)
+            m_renderWindow->RemoveRenderer(view.renderer);
+    }
+    m_comparisonViews.clear();
+    m_renderer->SetViewport(0.0, 0.0, 1.0, 1.0);
+}
+
+void MainWindow::applyLodSettings()
+{
+    if (!m_renderWindow || !m_renderWindow->GetInteractor())
+        return;
+    m_renderWindow->GetInteractor()->SetDesiredUpdateRate(m_lodSettings.interactiveFps);
+    m_renderWindow->GetInteractor()->SetStillUpdateRate(0.0001);
+}
+
+void MainWindow::updateGeometryCacheStatus()
+{
+    if (!m_geometryCacheLabel)
+        return;
+    const GeometryCache& cache = GeometryCache::instance();
+    const QLocale locale;
+    m_geometryCacheLabel->setText(tr("几何缓存 %1 / %2")
+                                      .arg(locale.formattedDataSize(cache.totalBytes()),
+                                           locale.formattedDataSize(cache.maxBytes())));
+    m_geometryCacheLabel->setToolTip(tr("已缓存 %1 个模型，切换回这些模型时无需重新读取 STL")
+                                         .arg(cache.count()));
+}
+
+void MainWindow::setGeometryLoading(bool loading)
+{
+    if (loading)
+    {
+        m_loggedLoadProgress = 0;
+        if (!m_loadingOverlay->isVisible())
+            m_loadingOverlayTimer->start();
+        return;
+    }
+    m_loadingOverlayTimer->stop();
+    m_loadingOverlay->hide();
+}
 
-    const QJsonObject root = doc.object();
-    const QString storedRoot = root.value(QStringLiteral("workspaceRoot")).toString().trimmed();
-    if (!storedRoot.isEmpty())
+void MainWindow::compareGeometry(const QString& referenceId, const QString& targetId)
+{
+    const ModelRecord* reference = modelById(referenceId);
+    const ModelRecord* target = modelById(targetId);
+    if (!reference || !target)
+        return;
+    const QString referenceName = reference->name;
+    const QString targetName = target->name;
+    const QString referenceStl = latestResultStl(*reference);
+    const QString targetStl = latestResultStl(*target);
+    if (referenceStl.isEmpty() || !QFileInfo::exists(referenceStl) ||
+        targetStl.isEmpty() || !QFileInfo::exists(targetStl))
     {
-        QDir rootDir(storedRoot);
-        if (rootDir.isAbsolute())
+        appendLogMessage(tr("形状差异：%1 与 %2 需要都有计算结果").arg(referenceName, targetName));
+        return;
+    }
+
+    const GeometryCache::Key referenceKey = GeometryCache::Key::forFile(QFileInfo(referenceStl).absoluteFilePath());
+    const GeometryCache::Key targetKey = GeometryCache::Key::forFile(QFileInfo(targetStl).absoluteFilePath());
+    GeometryDiff::Result cached;
+    if (GeometryDiff::lookup(referenceKey, targetKey, &cached))
+    {
+        showGeometryDiff(referenceName, targetName, cached);
+        return;
+    }
+
+    if (m_diffCancel)
+        m_diffCancel->store(true);
+    m_diffCancel = std::make_shared<std::atomic_bool>(false);
+    const GeometryLoader::CancelToken token = m_diffCancel;
+    const QSharedPointer<GeometryDiskCache> diskCache = m_geometryDiskCache;
+    appendLogMessage(tr("形状差异：正在计算 %1 相对于 %2 的距离 ...").arg(targetName, referenceName));
+
+    // 已在内存缓存中的网格在界面线程取出，后台只拿到网格的浅拷贝；缓存条目中的 mapper
+    // 持有图形资源，不能让它的最后一个引用在工作线程中释放
+    auto cachedMesh = [](const GeometryCache::Key& key) -> vtkSmartPointer<vtkPolyData> {
+        GeometryCache::Entry entry;
+        if (!GeometryCache::instance().lookup(key, &entry) || !entry.polyData)
+            return nullptr;
+        auto copy = vtkSmartPointer<vtkPolyData>::New();
+        copy->ShallowCopy(entry.polyData);
+        return copy;
+    };
+    const vtkSmartPointer<vtkPolyData> referenceCached = cachedMesh(referenceKey);
+    const vtkSmartPointer<vtkPolyData> targetCached = cachedMesh(targetKey);
+
+    auto* watcher = new QFutureWatcher<GeometryDiff::Result>(this);
+    connect(watcher, &QFutureWatcher<GeometryDiff::Result>::finished, this,
+            [this, watcher, token, referenceName, targetName, referenceKey, targetKey]() {
+        const GeometryDiff::Result result = watcher->result();
+        watcher->deleteLater();
+        if (token != m_diffCancel || result.cancelled)
+            return;
+        m_diffCancel.reset();
+        if (!result.isValid())
+        {
+            appendLogMessage(tr("形状差异：%1").arg(result.errorMessage));
+            return;
+        }
+        GeometryDiff::insert(referenceKey, targetKey, result);
+        showGeometryDiff(referenceName, targetName, result);
+    });
+    watcher->setFuture(QtConcurrent::run([token, diskCache, referenceStl, targetStl,
+                                          referenceCached, targetCached]() {
+        // 不在内存缓存中的网格与普通显示一样经过磁盘缓存读取
+        auto meshFor = [&](const QString& path, const vtkSmartPointer<vtkPolyData>& cachedMesh,
+                           QString* error) -> vtkSmartPointer<vtkPolyData> {
+            if (cachedMesh)
+                return cachedMesh;
+            const GeometryLoader::Result loaded = GeometryLoader::readFile(path, token, diskCache, true);
+            *error = loaded.errorMessage;
+            return loaded.polyData;
+        };
+        GeometryDiff::Result result;
+        QString error;
+        const vtkSmartPointer<vtkPolyData> referenceMesh = meshFor(referenceStl, referenceCached, &error);
+        vtkSmartPointer<vtkPolyData> targetMesh;
+        if (referenceMesh)
+            targetMesh = meshFor(targetStl, targetCached, &error);
+        if (token->load())
         {
-            m_workspaceRoot = canonicalPathForDir(rootDir);
-            if (m_workspaceRoot.isEmpty())
-                m_workspaceRoot = QDir::cleanPath(storedRoot);
+            result.cancelled = true;
+            return result;
         }
-        else if (!m_projectRoot.isEmpty())
+        if (!referenceMesh || !targetMesh)
         {
-            QDir projectDir(m_projectRoot);
-            const QString absolute = projectDir.filePath(storedRoot);
-            m_workspaceRoot = canonicalPathForDir(QDir(absolute));
-            if (m_workspaceRoot.isEmpty())
-                m_workspaceRoot = QDir::cleanPath(absolute);
+            result.errorMessage = error;
+            return result;
+        }
+        return GeometryDiff::compute(referenceMesh, targetMesh, token.get());
+    }));
+}
+
+void MainWindow::showGeometryDiff(const QString& referenceName, const QString& targetName,
+                                  const GeometryDiff::Result& result)
+{
+    if (!m_renderer)
+        return;
+    leaveComparison();
+    m_geometryLoader->cancel();
+    clearFieldColoring(m_currentEntry);
+    m_currentEntry = GeometryCache::Entry();
+    m_resultPath.clear();
+    m_resultBar->hide();
+
+    const double range = result.histogramRange;
+    auto lut = vtkSmartPointer<vtkLookupTable>::New();
+    const int colors = 256;
+    lut->SetNumberOfTableValues(colors);
+    for (int i = 0; i < colors; ++i)
+    {
+        const QColor color = GeometryDiff::divergingColor(double(i) / (colors - 1));
+        lut->SetTableValue(i, color.redF(), color.greenF(), color.blueF(), 1.0);
+    }
+    lut->SetTableRange(-range, range);
+
+    auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(result.mesh);
+    mapper->SetLookupTable(lut);
+    mapper->SetScalarModeToUsePointData();
+    mapper->SetScalarRange(-range, range);
+    mapper->ScalarVisibilityOn();
+    auto actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(mapper);
+
+    auto scalarBar = vtkSmartPointer<vtkScalarBarActor>::New();
+    scalarBar->SetLookupTable(lut);
+    scalarBar->SetTitle(tr("距离").toUtf8().constData());
+    scalarBar->SetNumberOfLabels(5);
+    scalarBar->SetMaximumWidthInPixels(90);
+    applyOverlayFont(scalarBar->GetTitleTextProperty());
+    applyOverlayFont(scalarBar->GetLabelTextProperty());
+    scalarBar->GetLabelTextProperty()->BoldOff();
+
+    m_renderer->RemoveAllViewProps();
+    m_currentProp = actor;
+    m_renderer->AddViewProp(actor);
+    m_renderer->AddViewProp(scalarBar);
+    m_renderer->ResetCamera();
+    if (ui->vtkWidget && ui->vtkWidget->renderWindow())
+        ui->vtkWidget->renderWindow()->Render();
+
+    appendLogMessage(tr("形状差异：%1 相对于 %2，最大偏差 %3，用时 %4 秒")
+                         .arg(targetName, referenceName)
+                         .arg(qMax(std::fabs(result.minDistance), std::fabs(result.maxDistance)), 0, 'g', 5)
+                         .arg(result.elapsedMs / 1000.0, 0, 'f', 1));
+    auto* dialog = new GeometryDiffDialog(referenceName, targetName, result, this);
+    dialog->show();
+}
+
+void MainWindow::clearVtkScene()
+{
+    // 选择已经改变，尚未完成的加载与差异计算不再需要
+    if (m_geometryLoader)
+        m_geometryLoader->cancel();
+    if (m_diffCancel)
+        m_diffCancel->store(true);
+    m_diffCancel.reset();
+    leaveComparison();
+    if (!m_renderer)
+        return;
+    m_renderer->RemoveAllViewProps();
+    if (ui->vtkWidget && ui->vtkWidget->renderWindow())
+        ui->vtkWidget->renderWindow()->Render();
+    m_currentProp = nullptr;
+    clearFieldColoring(m_currentEntry);
+    m_currentEntry = GeometryCache::Entry();
+    m_resultPath.clear();
+    if (m_resultBar)
+        m_resultBar->hide();
+}
+
+bool MainWindow::loadSchemesFromStorage()
+{
+    // 读取前写完之前工程的待写内容，重新打开同一工程时也能读到最新的状态
+    m_persistence->flush();
+
+    QVector<SchemeRecord> loaded;
+    bool fromCatalog = false;
+    if (ProjectCatalog::exists(m_projectRoot))
+    {
+        // 已迁移的工程以目录为准，schemes.json 只是迁移前的备份；目录损坏时退回读取备份
+        ProjectCatalog catalog;
+        QString storedRoot;
+        QString error;
+        fromCatalog = catalog.open(ProjectCatalog::catalogPath(m_projectRoot), &error) &&
+                      catalog.load(&loaded, &storedRoot, &error);
+        if (fromCatalog)
+        {
+            if (!storedRoot.isEmpty())
+                m_workspaceRoot = SchemeStorage::resolveWorkspaceRoot(storedRoot, m_projectRoot);
+            m_persistence->resetCatalog(ProjectCatalog::catalogPath(m_projectRoot), m_projectRoot,
+                                        m_workspaceRoot, loaded);
         }
         else
         {
-            m_workspaceRoot = canonicalPathForDir(QDir(storedRoot));
-            if (m_workspaceRoot.isEmpty())
-                m_workspaceRoot = QDir::cleanPath(storedRoot);
+            appendLogMessage(tr("无法读取工程目录，改为读取 schemes.json：%1").arg(error));
         }
     }
+    if (!fromCatalog)
+    {
+        qint64 sequence = 0;
+        QString warning;
+        if (!SchemeStorage::load(m_storageFilePath, m_projectRoot, &loaded, &m_workspaceRoot, &sequence,
+                                 &warning))
+            return false;
+        if (!warning.isEmpty())
+            appendLogMessage(warning);
+        // 以磁盘上的内容为基准，下面补全的工作区与去重后的名称在下次保存时作为增量写入
+        m_persistence->resetSchemes(m_storageFilePath, m_projectRoot, m_workspaceRoot, loaded, sequence);
+    }
 
     if (m_workspaceRoot.isEmpty() && !m_projectRoot.isEmpty())
     {
@@ -2772,109 +4438,107 @@ bool MainWindow::loadSchemesFromStorage()
     if (!m_workspaceRoot.isEmpty())
         ensureDirectoryExists(m_workspaceRoot);
 
-    QVector<SchemeRecord> loaded;
-    const QJsonArray schemeArray = root.value(QStringLiteral("schemes")).toArray();
-    for (const QJsonValue& value : schemeArray)
-    {
-        const QJsonObject obj = value.toObject();
-        SchemeRecord scheme;
-        scheme.id = obj.value(QStringLiteral("id")).toString();
-        if (scheme.id.isEmpty())
-            scheme.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        scheme.name = obj.value(QStringLiteral("name")).toString();
-        scheme.workingDirectory = canonicalPathForDir(QDir(obj.value(QStringLiteral("workingDirectory")).toString()));
-        if (scheme.workingDirectory.isEmpty())
-            continue;
-        const QString storedThumb = obj.value(QStringLiteral("thumbnailPath")).toString().trimmed();
-        if (!storedThumb.isEmpty())
-            scheme.thumbnailPath = QDir::cleanPath(QFileInfo(storedThumb).absoluteFilePath());
-        scheme.remarks = obj.value(QStringLiteral("remarks")).toString();
-
-        const QJsonArray modelArray = obj.value(QStringLiteral("models")).toArray();
-        for (const QJsonValue& mv : modelArray)
-        {
-            const QJsonObject mo = mv.toObject();
-            ModelRecord model;
-            model.id = mo.value(QStringLiteral("id")).toString();
-            if (model.id.isEmpty())
-                model.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-            model.name = mo.value(QStringLiteral("name")).toString();
-            model.directory = canonicalPathForDir(QDir(mo.value(QStringLiteral("directory")).toString()));
-            model.jsonPath = QDir::cleanPath(mo.value(QStringLiteral("jsonPath")).toString());
-            model.batPath = QDir::cleanPath(mo.value(QStringLiteral("batPath")).toString());
-            model.remarks = mo.value(QStringLiteral("remarks")).toString();
-            if (model.directory.isEmpty() || model.jsonPath.isEmpty())
-                continue;
-            scheme.models.push_back(model);
-        }
-        loaded.push_back(scheme);
-    }
-
-    m_schemes = loaded;
-    ensureUniqueSchemeAndModelNames();
+    ensureUniqueSchemeAndModelNames(loaded);
+    m_registry.reset(loaded);
     return true;
 }
 
-void MainWindow::saveSchemesToStorage() const
+void MainWindow::saveSchemesToStorage()
 {
     if (m_storageFilePath.isEmpty())
         return;
+    m_persistence->submitSchemes(m_workspaceRoot, m_registry.schemes(), /*compact*/true);
+}
 
-    QFileInfo info(m_storageFilePath);
-    QDir dir = info.dir();
-    if (!dir.exists())
-        dir.mkpath(QStringLiteral("."));
+void MainWindow::persistSchemes()
+{
+    if (m_storageFilePath.isEmpty())
+        return;
+    m_persistence->submitSchemes(m_workspaceRoot, m_registry.schemes());
+}
 
-    QJsonArray schemeArray;
-    for (const SchemeRecord& scheme : m_schemes)
-    {
-        QJsonObject obj;
-        obj.insert(QStringLiteral("id"), scheme.id);
-        obj.insert(QStringLiteral("name"), scheme.name);
-        obj.insert(QStringLiteral("workingDirectory"), scheme.workingDirectory);
-        obj.insert(QStringLiteral("thumbnailPath"), scheme.thumbnailPath);
-        obj.insert(QStringLiteral("remarks"), scheme.remarks);
+void MainWindow::logPersistenceStats()
+{
+    // 关闭或切换工程时报告该工程打开期间的写入情况。先写完待写内容，
+    // 否则最后一批写入会记到下一个工程名下
+    m_persistence->flush();
+    const PersistenceWorker::Stats stats = m_persistence->stats();
+    const qint64 submitted = stats.submitted - m_reportedPersistence.submitted;
+    if (submitted <= 0)
+        return;
+    appendLogMessage(tr("工程状态保存：提交 %1 次，合并 %2 次，实际写入 %3 次%4")
+                         .arg(submitted)
+                         .arg(stats.coalesced - m_reportedPersistence.coalesced)
+                         .arg(stats.written - m_reportedPersistence.written)
+                         .arg(stats.failed > m_reportedPersistence.failed
+                                  ? tr("，失败 %1 次").arg(stats.failed - m_reportedPersistence.failed)
+                                  : QString()));
+    m_reportedPersistence = stats;
+}
+
+void MainWindow::migrateProjectToCatalog()
+{
+    if (m_projectRoot.isEmpty() || m_persistence->isCatalogMode())
+        return;
 
-        QJsonArray modelArray;
+    QHash<QString, QString> modelDirectories;
+    for (const SchemeRecord& scheme : m_registry.schemes())
+    {
         for (const ModelRecord& model : scheme.models)
-        {
-            QJsonObject mo;
-            mo.insert(QStringLiteral("id"), model.id);
-            mo.insert(QStringLiteral("name"), model.name);
-            mo.insert(QStringLiteral("directory"), model.directory);
-            mo.insert(QStringLiteral("jsonPath"), model.jsonPath);
-            mo.insert(QStringLiteral("batPath"), model.batPath);
-            mo.insert(QStringLiteral("remarks"), model.remarks);
-            modelArray.append(mo);
-        }
-        obj.insert(QStringLiteral("models"), modelArray);
-        schemeArray.append(obj);
+            modelDirectories.insert(model.id, ModelFiles::solverDirectory(model));
     }
 
-    QJsonObject root;
-    QString workspaceToStore = m_workspaceRoot;
-    if (!m_projectRoot.isEmpty())
+    QString error;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool ok = m_persistence->migrateToCatalog(ProjectCatalog::catalogPath(m_projectRoot), m_projectRoot,
+                                                    m_workspaceRoot, m_registry.schemes(),
+                                                    modelDirectories, &error);
+    QApplication::restoreOverrideCursor();
+    if (!ok)
     {
-        QDir projectDir(m_projectRoot);
-        const QString relative = projectDir.relativeFilePath(m_workspaceRoot);
-        if (!relative.startsWith(QStringLiteral("..")) && !relative.startsWith(QLatin1Char('/')))
-            workspaceToStore = relative;
+        QMessageBox::warning(this, tr("迁移到 SQLite 目录"), tr("迁移失败：%1").arg(error));
+        return;
     }
-    root.insert(QStringLiteral("workspaceRoot"), workspaceToStore);
-    root.insert(QStringLiteral("schemes"), schemeArray);
+    appendLogMessage(tr("工程已迁移到 %1，共 %2 个方案、%3 个模型；schemes.json 保留为迁移前的备份")
+                         .arg(QDir::toNativeSeparators(ProjectCatalog::catalogPath(m_projectRoot)))
+                         .arg(m_registry.schemeCount())
+                         .arg(m_registry.modelCount()));
+}
 
-    QFile file(m_storageFilePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+void MainWindow::exportSchemesToJson()
+{
+    if (m_projectRoot.isEmpty())
         return;
 
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    const QString path = QFileDialog::getSaveFileName(this, tr("导出为 JSON"),
+                                                      QDir(m_projectRoot).filePath(QStringLiteral("schemes.json")),
+                                                      tr("JSON 文件 (*.json)"));
+    if (path.isEmpty())
+        return;
+    // 导出的文件与 schemes.json 格式相同；覆盖本工程的 schemes.json 前先写完变更日志，
+    // 导出后删除的日志不会再被重放
+    m_persistence->flush();
+    if (!SchemeStorage::save(path, m_projectRoot, m_workspaceRoot, m_registry.schemes()))
+    {
+        QMessageBox::warning(this, tr("导出为 JSON"),
+                             tr("无法写入 %1").arg(QDir::toNativeSeparators(path)));
+        return;
+    }
+    if (!m_persistence->isCatalogMode() && QFileInfo(path) == QFileInfo(m_storageFilePath))
+        m_persistence->resetSchemes(m_storageFilePath, m_projectRoot, m_workspaceRoot, m_registry.schemes(), 0);
+    appendLogMessage(tr("已导出方案与模型：%1").arg(QDir::toNativeSeparators(path)));
 }
 
-void MainWindow::persistSchemes() const
+void MainWindow::showFailedRuns()
 {
-    saveSchemesToStorage();
+    if (!m_persistence->isCatalogMode())
+        return;
+
+    // 后台写入尚在合并窗口内的运行记录先写入，查询结果才完整
+    m_persistence->flush();
+    auto* dialog = new FailedRunsDialog(ProjectCatalog::catalogPath(m_projectRoot), this);
+    connect(dialog, &FailedRunsDialog::showHistoryRequested, this, &MainWindow::showRunHistory);
+    dialog->show();
 }
 
 QString MainWindow::makeUniqueWorkspaceSubdir(const QString& baseName) const